@@ -1,23 +1,30 @@
 /*
  * alias.h - 命令别名管理
- * 
+ *
  * 功能：管理Shell命令别名
- * 
+ *
  * 别名允许用户为常用命令创建简短的替代名称
  * 例如：alias ll="xls -lah"
+ *
+ * 实现：
+ *   - 开放寻址哈希表（线性探测），没有数量上限，装载率过高时自动扩容
+ *   - 定义别名时就把值切分成单词（只做一次词法分析），
+ *     执行命令时直接把这些单词拼接到命令前面，不再重新解析文本
+ *   - 每个别名的名称、值和单词都放在它自己的内存池中，删除时一次释放
  */
 
 #ifndef ALIAS_H
 #define ALIAS_H
 
-// 最大别名数量
-#define MAX_ALIASES 100
+#include "lexer.h"          // Word（别名值切分后的单词）
+#include "arena.h"          // Arena
 
-// 别名结构体
-typedef struct {
-    char name[64];      // 别名名称
-    char value[256];    // 别名对应的命令
-} Alias;
+// 别名展开的最大嵌套层数（a -> b -> c ...），超过后停止展开
+#define ALIAS_MAX_DEPTH 16
+
+// alias_set 的返回值
+#define ALIAS_ERROR       -1    // 参数无效或内存不足
+#define ALIAS_NOT_SIMPLE  -2    // 值不是简单命令（含有 | ; & 重定向等）、引号未闭合或命令替换有语法错误
 
 // 别名初始化
 // 返回：0=成功，-1=失败
@@ -26,8 +33,8 @@ int alias_init(void);
 // 添加或更新别名
 // 参数：
 //   name  - 别名名称
-//   value - 别名对应的命令
-// 返回：0=成功，-1=失败
+//   value - 别名对应的命令（只能是单词，不能含有操作符）
+// 返回：0=成功，ALIAS_ERROR / ALIAS_NOT_SIMPLE=失败
 int alias_set(const char *name, const char *value);
 
 // 获取别名对应的命令
@@ -42,7 +49,7 @@ const char* alias_get(const char *name);
 // 返回：0=成功，-1=失败（别名不存在）
 int alias_remove(const char *name);
 
-// 列出所有别名
+// 列出所有别名（按名称排序）
 // 参数：无
 // 返回：无
 void alias_list(void);
@@ -51,12 +58,21 @@ void alias_list(void);
 // 返回：当前别名数量
 int alias_count(void);
 
+// 展开命令第一个单词上的别名
+// 说明：
+//   第一个单词是未加引号的纯文本且是别名时，用别名的单词替换它；
+//   替换后的第一个单词如果又是别名则继续展开，
+//   已经展开过的别名不再展开（如 ls='ls -la'、a='b' b='a'），最多 ALIAS_MAX_DEPTH 层
+//   别名的单词被复制到 arena 中，之后修改或删除别名不影响本次执行
+// 参数：
+//   words      - 输入为命令的单词链表，输出为展开后的链表（没有别名时不变）
+//   arena      - 复制单词用的内存池
+//   word_count - 输入为单词个数，输出为展开后的单词个数
+// 返回：0=成功，-1=内存不足
+int alias_expand(const Word **words, Arena *arena, int *word_count);
+
 // 清理别名系统
 // 释放所有资源
 void alias_cleanup(void);
 
 #endif // ALIAS_H
-
-
-
-
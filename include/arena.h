@@ -0,0 +1,84 @@
+// 头文件保护：防止重复包含
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>                         // size_t
+
+// ============================================
+// 内存池（Arena / 线性分配器）
+// ============================================
+// 背景：
+//   解析和执行一行命令需要大量小块内存（Command 结构体、每个参数、
+//   变量展开结果、大括号展开后的参数数组……），
+//   原来每一块都单独 malloc，最后再在 free_command() 中逐个 free。
+// 做法：
+//   从一大块内存中“顺序切”出小块（只移动指针），不支持单独释放，
+//   整行命令执行完后一次性归还。
+// 用法：
+//   Arena arena;  arena_init(&arena, 0);
+//   ArenaMark mark = arena_mark(&arena);
+//   char *s = arena_strdup(&arena, "hello");   // 不需要 free
+//   arena_release(&arena, mark);               // mark 之后分配的内存全部归还
+//   arena_destroy(&arena);                     // 不再使用时释放所有内存块
+// 注意：
+//   - 全部清零的 Arena（如静态变量）等价于 arena_init(&arena, 0)
+//   - arena_release 按“后进先出”归还，可以嵌套使用（for 循环、xsource 等）
+//   - 同一个 Arena 不能被多个线程同时使用
+// ============================================
+
+// 默认内存块大小（字节）：一般的命令行一块就够用
+#define ARENA_DEFAULT_BLOCK_SIZE 4096
+
+// 内存块（链表，从新到旧）
+typedef struct ArenaBlock {
+    struct ArenaBlock *prev;                // 上一个（更旧的）内存块
+    size_t size;                            // 可用容量（字节）
+    size_t used;                            // 已使用（字节）
+} ArenaBlock;
+
+// 内存池
+typedef struct Arena {
+    ArenaBlock *current;                    // 当前正在切分的内存块
+    size_t block_size;                      // 新内存块的默认大小（0 表示 ARENA_DEFAULT_BLOCK_SIZE）
+    unsigned long block_allocs;             // 统计：累计向 malloc 申请内存块的次数
+} Arena;
+
+// 位置标记：记录某一时刻的分配位置，用于 arena_release 回退
+typedef struct {
+    ArenaBlock *block;
+    size_t used;
+} ArenaMark;
+
+// 初始化内存池（不会立即分配内存）
+// 参数：block_size - 内存块大小，0 表示使用默认值
+void arena_init(Arena *arena, size_t block_size);
+
+// 创建一个自身也位于第一个内存块中的内存池（只需一次 malloc）
+// 返回：失败返回 NULL；用 arena_destroy 释放
+Arena* arena_create(size_t block_size);
+
+// 释放内存池的所有内存块
+// 注意：对 arena_create 创建的内存池调用后，arena 指针本身也失效
+void arena_destroy(Arena *arena);
+
+// 分配 size 字节（按指针大小的两倍对齐），失败返回 NULL
+void* arena_alloc(Arena *arena, size_t size);
+
+// 分配 count * size 字节并清零
+void* arena_calloc(Arena *arena, size_t count, size_t size);
+
+// 复制字符串到内存池
+char* arena_strdup(Arena *arena, const char *str);
+
+// 复制字符串的前 len 个字节到内存池（结果以 '\0' 结尾）
+char* arena_strndup(Arena *arena, const char *str, size_t len);
+
+// 记录当前分配位置
+ArenaMark arena_mark(Arena *arena);
+
+// 回退到 mark 记录的位置：之后分配的内存全部归还
+// 说明：mark 之后新申请的内存块会被释放，但最早的一个内存块始终保留，
+//       下一行命令可以直接复用，不再调用 malloc
+void arena_release(Arena *arena, ArenaMark mark);
+
+#endif // ARENA_H
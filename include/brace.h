@@ -0,0 +1,42 @@
+// 头文件保护：防止重复包含
+#ifndef BRACE_H
+#define BRACE_H
+
+#include <stddef.h>                         // size_t
+
+// ============================================
+// 大括号范围展开（惰性生成器）
+// ============================================
+// 语法：前缀{start..end[..step]}后缀
+//   f{1..3}.txt     -> f1.txt f2.txt f3.txt
+//   {1..10..3}      -> 1 4 7 10          （步长取绝对值，方向由 start/end 决定）
+//   {5..1}          -> 5 4 3 2 1
+//   {01..10}        -> 01 02 ... 10      （任一端点有前导 0 时按最长端点补齐）
+// 说明：
+//   不预先生成所有元素，每次调用 brace_range_next() 才格式化下一个，
+//   for i in {1..10000000} 只占用一个元素的缓冲区
+// ============================================
+
+typedef struct {
+    const char *prefix;                     // { 之前的文本（指向原字符串）
+    size_t prefix_len;
+    const char *suffix;                     // } 之后的文本（指向原字符串）
+    long current;                           // 下一个要生成的值
+    long step;                              // 步长（带方向）
+    unsigned long remaining;                // 还剩多少个元素
+    int width;                              // 零填充宽度（0 表示不填充）
+} BraceRange;
+
+// 在 arg 中查找 {start..end[..step]}
+// 返回：1=找到（range 已初始化），0=不是范围表达式（按普通文本处理）
+// 注意：range 中的前缀、后缀指向 arg，arg 在使用期间必须有效
+int brace_range_init(BraceRange *range, const char *arg);
+
+// 一个元素格式化后的最大长度（包括 '\0'），用于分配缓冲区
+size_t brace_range_max_len(const BraceRange *range);
+
+// 生成下一个元素，写入 buf（大小至少为 brace_range_max_len）
+// 返回：1=成功，0=已经没有元素
+int brace_range_next(BraceRange *range, char *buf, size_t size);
+
+#endif // BRACE_H
@@ -425,6 +425,14 @@ int cmd_xtype(Command *cmd, ShellContext *ctx);
 // 用法：xwhich <command>...
 int cmd_xwhich(Command *cmd, ShellContext *ctx);
 
+// xhash 命令：管理命令路径缓存
+// 功能：
+//   1. 显示已缓存的命令路径及命中次数
+//   2. 预先缓存命令路径、删除单条缓存或清空缓存
+// 对应系统命令：hash
+// 用法：xhash [-r] [-d] [command]...
+int cmd_xhash(Command *cmd, ShellContext *ctx);
+
 // xsleep 命令：休眠指定秒数
 // 功能：
 //   1. 暂停执行指定的秒数
@@ -492,6 +500,14 @@ int cmd_xfg(Command *cmd, ShellContext *ctx);
 // 用法：xbg [job_id]
 int cmd_xbg(Command *cmd, ShellContext *ctx);
 
+// xxargs 命令：从标准输入构造参数并执行命令
+// 功能：
+//   1. 把标准输入的每一行（或 NUL 分隔的条目）追加到命令后面执行
+//   2. 每次执行尽量放入更多条目（-n 限制个数），-P 指定同时执行的个数
+// 对应系统命令：xargs
+// 用法：xxargs [-0] [-d C] [-n N] [-P N] [command [args...]]
+int cmd_xxargs(Command *cmd, ShellContext *ctx);
+
 // xsysmon 命令：系统监控
 // 功能：
 //   1. 实时显示 CPU、内存、磁盘使用情况
@@ -501,5 +517,59 @@ int cmd_xbg(Command *cmd, ShellContext *ctx);
 int cmd_xsysmon(struct Command *cmd, struct ShellContext *ctx);
 void xsysmon(void);
 
+// ============================================
+// 内置命令注册表
+// ============================================
+// 所有内置命令登记在 src/builtin/builtin_table.c 的一张静态表里，
+// 执行器、补全、xtype/xwhich/xhash、xhelp 都从这张表查询，不再各自维护列表。
+// 表按命令名的 strcmp 顺序排列，查找使用二分查找（O(log n)，约 7 次比较）。
+// 新增内置命令时只需：实现 cmd_xxx 函数 + 在表中按字母顺序加一行。
+
+// 内置命令属性标志（可按位组合）
+#define BUILTIN_PIPE_SAFE       0x01    // 只读写标准输入输出，不修改 Shell 状态，可在管道中安全运行
+#define BUILTIN_MUTATES_STATE   0x02    // 会修改 Shell 状态（目录、变量、别名、作业、缓存等），必须在 Shell 进程中执行才有效
+#define BUILTIN_INTERACTIVE     0x04    // 交互式程序（需要独占终端），不能放到后台运行
+#define BUILTIN_XIO             0x08    // 通过 xio_stdin/xio_stdout 读写（见 xio.h），管道中可用线程运行
+
+// 内置命令分类（xhelp 按此分组显示）
+typedef enum {
+    BUILTIN_CAT_BASIC = 0,              // 基础命令
+    BUILTIN_CAT_FILE,                   // 文件操作
+    BUILTIN_CAT_DIR,                    // 目录操作
+    BUILTIN_CAT_PERM,                   // 权限与链接
+    BUILTIN_CAT_TEXT,                   // 文本处理
+    BUILTIN_CAT_SYSINFO,                // 系统信息
+    BUILTIN_CAT_ENV,                    // 环境变量和别名
+    BUILTIN_CAT_JOB,                    // 进程与作业控制
+    BUILTIN_CAT_UTIL,                   // 实用工具
+    BUILTIN_CAT_FEATURE,                // 特色功能
+    BUILTIN_CAT_COUNT                   // 分类数量
+} BuiltinCategory;
+
+// 内置命令处理函数类型
+typedef int (*BuiltinHandler)(Command *cmd, ShellContext *ctx);
+
+// 注册表条目
+typedef struct {
+    const char *name;                   // 命令名
+    BuiltinHandler handler;             // 处理函数
+    unsigned int flags;                 // 属性标志（BUILTIN_PIPE_SAFE 等）
+    BuiltinCategory category;           // 分类
+    const char *options;                // 支持的选项，空格分隔（用于 Tab 补全）
+    const char *summary;                // 一句话说明（用于 xhelp 列表）
+} BuiltinEntry;
+
+// 按命令名查找内置命令
+// 返回：找到返回表项指针，否则返回 NULL
+const BuiltinEntry* builtin_lookup(const char *name);
+
+// 获取整张注册表
+// 参数：count - 输出表项数量
+// 返回：表首地址（按命令名排序）
+const BuiltinEntry* builtin_table(int *count);
+
+// 获取分类名称（如 "基础命令"）
+const char* builtin_category_name(BuiltinCategory category);
+
 #endif // BUILTIN_H  // 头文件保护结束
 
@@ -5,6 +5,7 @@
 // 依赖的头文件
 #include "parser.h"                         // Command 结构体定义（需要用于函数参数）
 #include "xshell.h"                         // ShellContext结构体定义（需要用于函数参数）
+#include <sys/types.h>                      // pid_t
 
 // 函数声明
 // 命令执行器：负责分发和执行各类命令
@@ -15,6 +16,14 @@
 // 返回：命令退出状态（0=成功，非0=失败）
 int execute_command(Command *cmd, ShellContext *ctx);
 
+// 启动外部命令（不等待）
+// 功能：在 PATH 中查找命令、打开重定向，用进程启动器创建子进程
+// 参数：cmd - 已展开的命令（name / args），ctx - Shell 上下文（导出变量作为子进程环境）
+// 返回：子进程 PID，由调用者 waitpid；失败返回 -1（已输出错误信息），
+//       *error_status 为应报告的退出状态（命令不存在为 127）
+// 用途：执行器执行前台/后台外部命令，xxargs 批量启动命令
+pid_t spawn_external(Command *cmd, ShellContext *ctx, int *error_status);
+
 // 判断是否为内置命令
 // 功能：检查命令名是否在内置命令列表中
 // 参数：cmd_name - 命令名称字符串（如"xpwd", "quit")
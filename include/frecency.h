@@ -0,0 +1,65 @@
+// 头文件保护：防止重复包含
+#ifndef FRECENCY_H
+#define FRECENCY_H
+
+#include <time.h>                           // time_t
+
+// ============================================
+// 频率 + 最近使用（frecency）模型
+// ============================================
+// 用途：
+//   1. 输入时的行内建议：光标在行尾时，在后面用暗色显示最可能的历史命令，
+//      按右箭头接受（类似 fish / zsh-autosuggestions）
+//   2. xcd -z 关键字：跳转到匹配关键字、得分最高的目录（类似 z / zoxide）
+// 得分：
+//   - 每次使用加上 2^((使用时间 - 模型创建时间) / 半衰期)，越新的使用权重越大，
+//     相当于所有得分随时间按同一比例衰减，因此得分的相对顺序不随时间变化
+//   - 命令记录最近一次使用时所在的目录，在同一目录中使用过的命令额外加分
+// 实现：
+//   - 命令和目录各是一棵压缩前缀树（radix tree），边上的文本引用记录的文本，
+//     不为每个字符分配节点
+//   - 每个节点缓存子树中得分最高的 FRECENCY_TOP 条记录，使用一次只需沿路径更新，
+//     查找建议只需沿前缀走到节点，再比较这几条（加上当前目录的分数），与历史条数无关
+//   - 启动时加载的历史不一次性加入模型：每次查找建议前从新到旧加入一批，
+//     每次最多用 FRECENCY_FEED_BUDGET_US 微秒，历史很多时也不会让按键等待
+//   - 目录模型由工作目录的变化（ctx->cwd）建立，保存在历史文件旁边的 .xshell_dirs 中
+// ============================================
+
+// 每个节点缓存的最高得分记录数
+#define FRECENCY_TOP 4
+
+// 得分减半的时间（秒）：3 天
+#define FRECENCY_HALF_LIFE (3 * 24 * 3600)
+
+// 每次查找建议前加入历史最多用的时间（微秒）
+#define FRECENCY_FEED_BUDGET_US 2000
+
+// .xshell_dirs 中最多保存的目录数（按得分保留）
+#define FRECENCY_MAX_DIRS 1000
+
+// 初始化模型
+// 参数：dirs_file - 目录得分文件路径（NULL 表示不读写文件）
+// 说明：启动时加载的历史（见 history_loaded_next）在之后逐批加入
+void frecency_init(const char *dirs_file);
+
+// 记录执行了一条命令（在当前目录中）
+void frecency_add_command(const char *line);
+
+// 记录进入了一个目录（工作目录变化时调用），之后的命令记在这个目录下
+void frecency_visit_dir(const char *path);
+
+// 行内建议：以 prefix 开头、得分最高的命令（不包括 prefix 本身）
+// 返回：完整的命令文本（由模型持有，下次修改模型前有效），没有返回 NULL
+const char* frecency_suggest(const char *prefix);
+
+// 按关键字查找目录（xcd -z）
+// 规则：关键字按顺序出现在路径中（不区分大小写），最后一个关键字出现在最后一级目录名中；
+//       没有这样的目录时，把关键字连起来按顺序模糊匹配最后一级目录名（如 prj 匹配 project）
+// 参数：exclude - 不返回的目录（当前目录）
+// 返回：得分最高且仍然存在的目录（由模型持有），没有返回 NULL
+const char* frecency_find_dir(char **keywords, int count, const char *exclude);
+
+// 保存目录得分并释放模型
+void frecency_cleanup(void);
+
+#endif // FRECENCY_H
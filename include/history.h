@@ -2,8 +2,11 @@
 #ifndef HISTORY_H
 #define HISTORY_H
 
-// 历史记录最大条数
-#define MAX_HISTORY 1000
+#include <time.h>                   // time_t
+
+// 历史记录默认条数 / 最大条数
+#define HISTORY_DEFAULT_SIZE 1000
+#define HISTORY_MAX_SIZE     10000000
 
 // ============================================
 // 历史记录模块
@@ -13,6 +16,28 @@
 //   1. 记录每条执行的命令
 //   2. 显示历史命令列表（xhistory）
 //   3. 持久化存储历史（保存到文件）
+// 配置（环境变量，history_init 时读取）：
+//   XHISTSIZE=N            最多保存 N 条（默认 1000，最大 1000 万）
+//   XHISTFILESIZE=N        历史文件超过 N 行时压缩为最新的 XHISTSIZE 条（默认 2 * XHISTSIZE）
+//   XHISTCONTROL=erasedups 添加命令时删除历史中所有相同的旧命令
+//                          （默认只忽略与上一条相同的命令）
+// 实现：
+//   - 环形缓冲区：满了以后新命令覆盖最旧的，添加是 O(1)（原来要整体移动数组）；
+//     缓冲区按需翻倍增长到 XHISTSIZE，不预先分配
+//   - 命令字符串驻留在内存池中，相同的命令只存一份（哈希表查找）；
+//     被淘汰的字符串超过存活的字符串时整体重建内存池
+//   - erasedups：哈希表记录每条命令所在的位置，旧位置 O(1) 标记为已删除，
+//     下一次按序号读取（history_get 等）前再统一压缩
+//   - Ctrl+R 搜索使用三字母索引，记录每个组合出现在哪些历史中（见 history_search）
+// 历史文件（.xshell_history，只追加的日志）：
+//   - 每条命令执行完立即追加一行（O_APPEND，一次 write），崩溃时不会丢失整个会话；
+//     多个 Shell 同时运行时各自追加到同一个文件，互不覆盖
+//   - 行格式：": 开始时间:耗时毫秒:退出状态;命令"（类似 zsh 的扩展格式），
+//     没有这些字段的普通行（旧版本的文件）同样可以读取
+//   - 启动时用 mmap 映射文件并只记录每行的偏移，不复制每一行；
+//     命令文本在第一次读取时才就地截断（erasedups 模式需要去重，仍逐条加入）
+//   - 文件超过 XHISTFILESIZE 行时才压缩：持有文件锁（flock）写临时文件再 rename，
+//     追加时持有共享锁，发现文件已被替换（链接数为 0）就重新打开
 // ============================================
 
 // 函数声明
@@ -26,8 +51,15 @@ int history_init(void);
 // 参数：
 //   line: 要添加的命令行字符串
 // 返回值：无
+// 说明：命令执行完后调用 history_finish 写入历史文件
 void history_add(const char *line);
 
+// 记录刚才 history_add 的命令执行完毕，追加到历史文件（带开始时间、耗时和退出状态）
+// 参数：
+//   status: 命令的退出状态
+// 返回值：无
+void history_finish(int status);
+
 // 显示所有历史记录
 // 参数：无
 // 返回值：无
@@ -44,6 +76,22 @@ int history_count(void);
 // 返回值：历史记录字符串，如果索引无效返回 NULL
 const char* history_get(int index);
 
+// 反向搜索历史（Ctrl+R）：查找 before 之前最近一条包含 query 的历史
+// 参数：
+//   query: 要查找的子串（空串匹配任何历史）
+//   before: 只查找索引小于它的历史（传 history_count() 从最新的开始，
+//           传上一次的结果继续查找更旧的匹配）
+// 返回值：匹配的历史索引，找不到返回 -1
+// 说明：第一次搜索时为所有历史建立三字母（trigram）索引，之后 history_add 增量更新；
+//       每次只检查包含查询中最少见的三字母组合的历史，不再逐条 strstr
+int history_search(const char *query, int before);
+
+// 从新到旧逐条取出启动时从文件加载的历史（供 frecency 模型分批建立）
+// 参数：
+//   when: 返回命令的开始时间（没有时间字段的旧格式行为 0）
+// 返回值：命令文本，全部取完（或剩下的已被淘汰）返回 NULL
+const char* history_loaded_next(time_t *when);
+
 // 获取上一条历史记录（用于上箭头）
 // 参数：
 //   current_index: 指向当前索引的指针，会被更新
@@ -56,12 +104,14 @@ const char* history_prev(int *current_index);
 // 返回值：历史记录字符串，如果已到最新返回 NULL
 const char* history_next(int *current_index);
 
-// 保存历史记录到文件
+// 压缩历史文件：只保留最新的 XHISTSIZE 条（包括其他会话追加的）
+// 说明：命令已经逐条追加到文件中，不需要在退出时整体保存；
+//       history_init / history_cleanup 在文件超过 XHISTFILESIZE 行时自动调用
 // 参数：无
 // 返回值：0-成功，-1-失败
 int history_save(void);
 
-// 从文件加载历史记录
+// 从文件加载历史记录（mmap 映射，只建立行偏移索引）
 // 参数：无
 // 返回值：0-成功，-1-失败
 int history_load(void);
@@ -3,6 +3,7 @@
 #define INPUT_H                                         // 则定义 INPUT_H
 
 #include <stddef.h>                                     // size_t 类型定义
+#include <stdio.h>                                      // FILE
 
 // 输入处理模块
 // 功能说明：实现带 Tab 补全功能的用户输入处理
@@ -12,27 +13,20 @@
 //   3. 支持退格键编辑
 //   4. 支持 Ctrl+D 退出
 
-// 提示符显示回调函数类型
-// 用途：在显示补全选项后，重新显示命令提示符
-// 使用场景：当用户按两次 Tab 显示所有匹配项后，需要重新显示提示符
-// 例如：
-//   [\home]# xcd l<Tab><Tab>
-//   lab/  lost+found/          <- 显示匹配项
-//   [\home]# xcd l              <- 回调函数显示这一行
-typedef void (*PromptCallback)(void);
-
 // 读取带 Tab 补全功能的用户输入
 // 功能：替代标准的 fgets()，提供更强大的交互式输入功能
 // 工作原理：
-//   1. 设置终端为原始模式（逐字符读取）
+//   1. 设置终端为原始模式（逐字符读取），显示提示符
 //   2. 捕获特殊按键（Tab, 退格, Ctrl+D, 回车）
 //   3. Tab 键触发路径补全逻辑
 //   4. 回车时恢复终端设置并返回
+// 显示：输入可以包含 UTF-8 字符（中文等宽字符占两列），超过终端宽度时自动换行；
+//       每次按键只重画改变的部分，用一次 write() 输出
 // 参数：
 //   - buffer: 存储用户输入的缓冲区（由调用者分配）
 //   - size: 缓冲区大小（字节数）
-//   - prompt_callback: 显示提示符的回调函数（可为 NULL）
-//                      当需要重新显示提示符时会调用此函数
+//   - prompt: 提示符（如 "[~]# "，可为 NULL），由本函数显示；
+//             清屏、显示补全选项后重新显示，也用来计算输入所在的列
 // 返回值：
 //   - 成功：返回 buffer 指针（指向输入的字符串）
 //   - EOF/Ctrl+D：返回 NULL
@@ -41,6 +35,25 @@ typedef void (*PromptCallback)(void);
 //   2. 返回前会自动恢复终端设置
 //   3. buffer 必须足够大以容纳用户输入
 //   4. 返回的字符串不包含换行符
-char* read_line_with_completion(char *buffer, size_t size, PromptCallback prompt_callback);
+char* read_line_with_completion(char *buffer, size_t size, const char *prompt);
+
+// 非交互模式（脚本文件、管道输入）的读缓冲区大小
+#define INPUT_BLOCK_SIZE 65536
+
+// 设置非交互输入流按 INPUT_BLOCK_SIZE 大块读取
+// 注意：必须在第一次读取 stream 之前调用
+void input_use_block_buffer(FILE *stream);
+
+// read_line_plain 缓冲区的初始大小（行更长时按需翻倍）
+#define INPUT_LINE_INITIAL 4096
+
+// 读取一行非交互输入
+// 功能：不切换终端模式、不回显、不补全；从 stdio 缓冲区中按换行切分出一行
+// 参数：buffer / capacity - 调用者持有的缓冲区（可以是 NULL / 0），行较长时用 realloc 扩大
+// 说明：行的长度没有限制（与 xsource 相同），长行不会被截断或丢弃
+// 返回值：
+//   - 成功：返回 *buffer（不包含换行符）
+//   - EOF 或内存不足：返回 NULL
+char* read_line_plain(FILE *stream, char **buffer, size_t *capacity);
 
 #endif // INPUT_H                                       // 头文件保护结束
@@ -1,16 +1,26 @@
 /**
  * @file job.h
  * @brief 后台作业管理
+ *
+ * 一个作业是一条后台管道：所有进程在同一个进程组中（组号为第一个进程的 pid），
+ * xfg / xbg 向整个进程组发送信号。
+ * 子进程的结束通过 pidfd 得知（poll 可读即已结束），
+ * SIGCHLD 处理器只设置标志，回收和更新作业列表都在主循环中进行。
+ *
+ * 作业列表按需增长（没有数量上限），按作业 ID 排序；另有 pid -> 进程的哈希表，
+ * 回收时先用 waitid(WNOWAIT) 查看哪个子进程有变化，再直接找到它所属的作业，
+ * 不必对每个作业逐个 waitpid。
+ * 回收使用 wait4()，每个作业累计自己的资源使用（CPU 时间、最大内存、上下文切换、I/O），
+ * 供 xjobs -l 和完成通知显示。
  */
 
 #ifndef JOB_H
 #define JOB_H
 
 #include <sys/types.h>
+#include <sys/resource.h>
 #include <stdbool.h>
-
-// 最大作业数
-#define MAX_JOBS 64
+#include <time.h>
 
 // 作业状态
 typedef enum {
@@ -19,20 +29,36 @@ typedef enum {
     JOB_DONE        // 已完成
 } JobStatus;
 
+// 作业中的一个进程
+typedef struct {
+    pid_t pid;          // 进程 ID
+    int pidfd;          // 进程的 pidfd（-1 表示内核不支持，退回 waitpid(WNOHANG) 轮询）
+    int status;         // 退出状态（与 $? 相同，结束后有效）
+    bool done;          // 是否已结束并回收
+} JobProcess;
+
 // 作业结构
 typedef struct {
     int id;             // 作业 ID (1-based)
-    pid_t pid;          // 进程 ID
+    pid_t pgid;         // 进程组 ID
+    JobProcess *procs;  // 管道中的每个进程（按管道顺序）
+    int proc_count;     // 进程数
+    int live;           // 还没有结束的进程数
     JobStatus status;   // 作业状态
     char command[256];  // 命令字符串
     bool notified;      // 是否已通知完成
+    struct rusage usage;        // 已结束进程的资源使用（CPU 时间、I/O 等累加，最大内存取最大值）
+    struct timespec started;    // 启动时间（CLOCK_MONOTONIC）
+    struct timespec finished;   // 全部进程结束的时间
 } Job;
 
 // 初始化作业管理
 void job_init(void);
 
 // 添加作业
-int job_add(pid_t pid, const char *command);
+// 参数：pgid - 进程组 ID，pids - 管道中的每个进程，count - 进程数
+// 返回：作业 ID，内存不足（作业表无法扩容）返回 -1
+int job_add(pid_t pgid, const pid_t *pids, int count, const char *command);
 
 // 移除作业
 void job_remove(int job_id);
@@ -40,22 +66,40 @@ void job_remove(int job_id);
 // 根据作业 ID 获取作业
 Job* job_get(int job_id);
 
-// 根据 PID 获取作业
+// 根据 PID 获取作业（哈希表查找）
 Job* job_get_by_pid(pid_t pid);
 
+// 获取最后一个（作业 ID 最大的）处于指定状态的作业，没有返回 NULL
+Job* job_latest(JobStatus status);
+
 // 获取作业数量
 int job_count(void);
 
-// 更新所有作业状态
+// 更新所有作业状态（回收已结束的进程，不阻塞）
 void job_update_status(void);
 
+// 等待前台子进程全部结束
+// 说明：所有子进程的 pidfd（包括后台作业的）放在同一个 poll 中等待，
+//       哪个先结束就先回收哪个，不会阻塞在还没结束的进程上；
+//       期间结束的后台进程也一并回收（完成通知仍在提示符前输出）
+// 参数：pids - 进程号（<= 0 的位置跳过），statuses - 返回每个进程的退出状态（与 $? 相同）
+void job_wait_foreground(const pid_t *pids, int count, int *statuses);
+
+// 把 waitpid 得到的状态转换成 $? 的值（被信号终止时为 128 + 信号编号）
+int job_exit_status(int wait_status);
+
+// 阻塞等待作业（xfg）：所有进程结束，或其中一个停止
+// 返回：true=作业停止（Ctrl+Z），false=作业已结束
+bool job_wait(Job *job);
+
 // 打印所有作业
-void job_print_all(void);
+// 参数：verbose - 同时显示进程号和资源使用（xjobs -l）
+void job_print_all(bool verbose);
 
 // 清理已完成的作业
 void job_cleanup_done(void);
 
-// 信号处理器（用于 SIGCHLD）
+// 信号处理器（用于 SIGCHLD，只设置标志）
 void job_sigchld_handler(int sig);
 
 // 信号处理器（用于 SIGINT - Ctrl+C）
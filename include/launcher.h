@@ -0,0 +1,48 @@
+// 头文件保护：防止重复包含
+#ifndef LAUNCHER_H
+#define LAUNCHER_H
+
+#include <sys/types.h>                      // pid_t
+
+// ============================================
+// 进程启动器模块
+// ============================================
+// 功能：统一负责外部命令的创建与 exec
+// 背景：
+//   原来每条外部命令都走 fork() + execv()。Shell 进程越大，fork 时
+//   复制页表的开销越高，脚本里成千上万次启动短命令时非常明显。
+// 实现：
+//   默认使用 posix_spawn（glibc 内部基于 clone(CLONE_VM|CLONE_VFORK)，
+//   子进程与父进程共享地址空间，不复制页表），
+//   重定向和管道的 dup2 通过 file actions 在子进程中完成。
+//   保留传统的 fork + execve 路径，便于对比测试（XSHELL_LAUNCHER=fork）。
+// ============================================
+
+// 启动方式
+typedef enum {
+    LAUNCH_SPAWN = 0,       // posix_spawn（默认）
+    LAUNCH_FORK             // 传统 fork + execve
+} LaunchMode;
+
+// 初始化启动器：读取环境变量 XSHELL_LAUNCHER（spawn / fork）选择启动方式
+void launcher_init(void);
+
+// 设置 / 获取当前启动方式
+void launcher_set_mode(LaunchMode mode);
+LaunchMode launcher_get_mode(void);
+
+// 启动一个外部程序（不等待）
+// 参数：
+//   path - 可执行文件的完整路径（已在 PATH 中解析好）
+//   argv - 参数数组，以 NULL 结尾
+//   envp - 子进程的环境变量数组，以 NULL 结尾；NULL 表示使用当前进程的 environ
+//   fds  - 子进程标准输入/输出/错误要使用的描述符，-1 表示继承父进程
+//          fds[0] -> STDIN_FILENO, fds[1] -> STDOUT_FILENO, fds[2] -> STDERR_FILENO
+//          建议这些描述符带 FD_CLOEXEC，避免泄漏给其他子进程
+//   pgid - 子进程的进程组：-1 表示留在 Shell 的进程组，0 表示新建进程组（组号为子进程 pid），
+//          大于 0 表示加入该进程组（后台管道的所有进程在同一个组中）
+// 返回：成功返回子进程 pid；失败返回 -1 并设置 errno
+// 注意：子进程中 SIGINT/SIGQUIT/SIGTSTP/SIGTTIN/SIGTTOU/SIGPIPE 等信号恢复默认处理
+pid_t launch_process(const char *path, char *const argv[], char *const envp[], const int fds[3], pid_t pgid);
+
+#endif // LAUNCHER_H
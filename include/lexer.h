@@ -0,0 +1,116 @@
+// 头文件保护：防止重复包含
+#ifndef LEXER_H
+#define LEXER_H
+
+#include "arena.h"                          // 内存池（单词、文本都分配在这里）
+
+// ============================================
+// 词法分析器（一次扫描整行命令）
+// ============================================
+// 功能：把命令行切分成记号（Token）：单词、| || & && ; < > >> 2> 2>> << <<- <<<
+// 引号规则（与 sh 一致）：
+//   '...'  单引号：内容原样保留，不展开变量
+//   "..."  双引号：展开 $VAR，反斜杠只转义 $ " \ `
+//   \c     引号外的反斜杠：c 按普通字符处理
+//   #      单词开头的 # 表示注释，直到行尾
+//   $(...) `...`  命令替换：括号（反引号）中的命令由语法分析器解析，执行时展开为输出
+// here-document：
+//   << 所在行结束后，由语法分析器调用 lexer_read_heredoc 读取内容（直到结束标记行），
+//   读完后从结束标记的下一行继续切分记号
+// 延迟展开：
+//   单词不在词法分析时展开，而是记录成若干部分（文本 / $变量 / ~ / 通配符），
+//   执行前再展开。这样同一棵语法树可以反复执行（例如 for 循环体），
+//   每次都使用变量的当前值。
+// ============================================
+
+// 单词组成部分的类型
+typedef enum {
+    WORD_LITERAL,                           // 普通文本（引号和转义已去除）
+    WORD_VAR,                               // $NAME、${NAME} 或 $? $$，text 为变量名
+    WORD_TILDE,                             // 未加引号的 ~（展开为 $HOME）
+    WORD_SLOT,                              // for 循环体中的循环变量（由语法分析器绑定）
+    WORD_GLOB,                              // 未加引号的通配符 * ? [（见 wildcard.h）
+    WORD_SUBST,                             // 未加引号的命令替换 $(...)：输出按 IFS 分割成多个参数
+    WORD_SUBST_QUOTED                       // 双引号中的命令替换 "$(...)"：输出作为一个整体
+} WordPartType;
+
+struct Command;
+
+// 单词的一个组成部分
+typedef struct WordPart {
+    WordPartType type;
+    char *text;                             // 文本内容或变量名
+    const char **slot;                      // WORD_SLOT：指向循环变量的当前值
+    struct Command *subst;                  // 命令替换：text 解析成的命令（由语法分析器填写）
+    struct WordPart *next;
+} WordPart;
+
+// 单词（命令名、参数、重定向文件名）
+typedef struct Word {
+    WordPart *parts;                        // 组成部分链表（空字符串 "" 时为一个空文本）
+    int quoted;                             // 含有引号（展开为空时仍保留为空参数）
+    int has_brace;                          // 引号外含有 {（需要做大括号展开）
+    int has_glob;                           // 引号外含有 * ? [（需要做通配符展开）
+    int has_subst;                          // 含有命令替换（每个替换只执行一次，结果可能分割成多个参数）
+    struct Word *next;                      // 命令中的下一个单词
+} Word;
+
+// 记号类型
+typedef enum {
+    TOKEN_EOF,                              // 行结束
+    TOKEN_WORD,                             // 单词
+    TOKEN_PIPE,                             // |
+    TOKEN_AND_IF,                           // &&
+    TOKEN_OR_IF,                            // ||
+    TOKEN_SEMI,                             // ; 或换行
+    TOKEN_AMP,                              // &
+    TOKEN_LESS,                             // <
+    TOKEN_GREAT,                            // >
+    TOKEN_DGREAT,                           // >>
+    TOKEN_DLESS,                            // << here-document
+    TOKEN_DLESSDASH,                        // <<- here-document（去掉每行开头的制表符）
+    TOKEN_TLESS,                            // <<< here-string
+    TOKEN_ERROR                             // 词法错误（如引号未闭合）
+} TokenType;
+
+// 记号
+typedef struct {
+    TokenType type;
+    Word *word;                             // TOKEN_WORD 时有效
+    int fd;                                 // 重定向的文件描述符（< 默认 0，> 默认 1，2> 为 2）
+} Token;
+
+// 词法分析器状态
+typedef struct {
+    const char *p;                          // 当前扫描位置
+    Arena *arena;                           // 单词和文本所在的内存池
+    char *scratch;                          // 拼接文本用的缓冲区（长度不超过整行）
+    const char *error;                      // TOKEN_ERROR 时的错误信息
+} Lexer;
+
+// 初始化词法分析器
+// 返回：0=成功，-1=内存不足
+int lexer_init(Lexer *lexer, const char *line, Arena *arena);
+
+// 读取下一个记号
+void lexer_next(Lexer *lexer, Token *token);
+
+// 读取 here-document 的内容（lexer->p 指向 << 所在行的下一行）
+// 参数：
+//   delim      - 结束标记（单独一行）
+//   strip_tabs - <<-：去掉每行（包括结束标记行）开头的制表符
+//   expand     - 结束标记没有加引号：内容中的 $变量 和命令替换在执行时展开，
+//                反斜杠只转义 $ ` \ 和换行；否则内容原样保留
+//   body       - 返回内容（一个加了引号的单词，执行时展开）
+// 返回：0=成功（lexer->p 移到结束标记的下一行），1=输入中没有结束标记，
+//       -1=错误（lexer->error 已设置）
+int lexer_read_heredoc(Lexer *lexer, const char *delim, int strip_tabs, int expand, Word **body);
+
+// 记号的显示名称（用于错误信息，如 "&&"）
+const char* token_name(TokenType type);
+
+// 判断单词是否是不需要展开的纯文本
+// 返回：纯文本返回其内容，否则返回 NULL
+const char* word_literal(const Word *word);
+
+#endif // LEXER_H
@@ -0,0 +1,71 @@
+// 头文件保护：防止重复包含
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <sys/types.h>                      // pid_t
+#include "parser.h"                         // Command, ForLoop
+#include "xshell.h"                         // ShellContext
+
+// ============================================
+// 并行 for 循环的工作进程池
+// ============================================
+// 用法：for -P 4 f in *.log; do xgrep ERROR $f; done
+//       xfind . -name '*.c' | xxargs -P 4 xwc -l（见 xxargs.c）
+// 实现：
+//   - 每次迭代 fork 一个工作进程执行循环体，同时最多运行 jobs 个
+//   - 工作进程的标准输出/错误写到各自的临时文件，结束后整块输出，
+//     不同迭代的行不会交错（按完成顺序输出）
+//   - 父进程用 sigsuspend 等待 SIGCHLD，只回收自己的工作进程，
+//     不影响作业列表中的后台作业
+//   - Ctrl+C：工作进程恢复默认的 SIGINT 处理直接退出；
+//     父进程通过 job_sigint_received() 发现后终止其余工作进程，不再启动新的迭代
+// 注意：
+//   循环体在子进程中执行，其中的变量赋值、xcd 等不影响当前 Shell
+// ============================================
+
+// -P 的最大值
+#define PARALLEL_MAX_JOBS 256
+
+// 正在运行的一个工作进程
+typedef struct {
+    pid_t pid;                              // 0 表示空闲
+    int captured;                           // 输出是否写到临时文件（parallel_submit 启动的）
+    int out_fd;                             // 标准输出临时文件
+    int err_fd;                             // 标准错误临时文件
+} ParallelSlot;
+
+// 工作进程池
+typedef struct {
+    ParallelSlot *slots;
+    int jobs;                               // 最多同时运行的工作进程数
+    int running;                            // 正在运行的工作进程数
+    int failed;                             // 失败的迭代数
+    int cancelled;                          // 收到 Ctrl+C
+} ParallelPool;
+
+// 初始化工作进程池
+// 参数：jobs - 同时运行的进程数，0 表示 CPU 核数
+// 返回：0=成功，-1=失败
+int parallel_init(ParallelPool *pool, int jobs);
+
+// 启动一次迭代（没有空闲位置时先等待一个工作进程结束）
+// 参数：loop - for 循环（工作进程中把 loop->value 设为 value 后执行循环体）
+// 返回：0=已启动，-1=已取消（Ctrl+C）或启动失败，调用者应停止提交
+int parallel_submit(ParallelPool *pool, ForLoop *loop, const char *value, ShellContext *ctx);
+
+// 等待直到有空闲位置（供自己启动进程的调用者使用，如 xxargs）
+// 返回：0=有空闲位置，-1=已取消（Ctrl+C）
+int parallel_wait_slot(ParallelPool *pool);
+
+// 登记一个调用者启动的子进程（输出不重定向，直接写到终端/管道）
+// 注意：调用前必须用 parallel_wait_slot 确认有空闲位置
+void parallel_track(ParallelPool *pool, pid_t pid);
+
+// 记录一次没有启动成功的执行（计入失败次数）
+void parallel_fail(ParallelPool *pool);
+
+// 等待所有工作进程结束并释放资源
+// 返回：0=全部成功；有迭代失败时为失败的次数（最多 100）；被 Ctrl+C 取消时为 130
+int parallel_finish(ParallelPool *pool);
+
+#endif // PARALLEL_H
@@ -2,16 +2,47 @@
 #ifndef PARSER_H                                //如果PARSER_H 未定义
 #define PARSER_H                                // 则定义PARSER_H
 
-// 重定向类型
-typedef enum {
-    REDIRECT_NONE = 0,      // 无重定向
-    REDIRECT_OUT,           // > 覆盖输出
-    REDIRECT_APPEND,        // >> 追加输出
-    REDIRECT_ERR,           // 2> 错误输出
-    REDIRECT_IN             // < 输入重定向
-} RedirectType;
+#include "arena.h"                              // 内存池（命令的所有内存都从这里分配）
+#include "lexer.h"                              // 词法分析器（Word：未展开的单词）
 
-// 命令结构体：存储解析后的单个命令信息
+// 命令链类型（命令后面的分隔符）
+#define CHAIN_NONE 0                            // 最后一条命令
+#define CHAIN_AND  1                            // &&：本命令成功才执行下一条
+#define CHAIN_OR   2                            // ||：本命令失败才执行下一条
+#define CHAIN_SEQ  3                            // ; 或 &：无条件执行下一条
+
+// 标准输入重定向的类型（stdin_word 的含义）
+#define HERE_NONE   0                           // < 文件名
+#define HERE_DOC    1                           // << here-document 的内容
+#define HERE_STRING 2                           // <<< here-string（展开后再加一个换行）
+
+// parse_is_incomplete 的返回值
+#define PARSE_COMPLETE      0                   // 已完整（或有其他语法错误）
+#define PARSE_MORE_LOOP     1                   // for 循环缺少 do / done
+#define PARSE_MORE_HEREDOC  2                   // here-document 还没有读到结束标记
+
+struct Command;
+
+// for 循环（复合命令）：for [-P N] NAME in WORD...; do LIST; done
+// 循环体只解析一次；循环体中的 $NAME 在解析时被绑定到 value，
+// 每次迭代只需更新 value 再执行循环体
+// -P N：最多 N 个迭代同时在子进程中执行（见 parallel.h），0 表示 CPU 核数
+typedef struct ForLoop {
+    char *var_name;                             // 循环变量名
+    int parallel;                               // 是否并行执行（-P）
+    int jobs;                                   // -P 指定的进程数
+    Word *words;                                // in 后面的单词（执行时逐个展开）
+    struct Command *body;                       // 循环体（命令列表）
+    const char *value;                          // 循环变量的当前值
+} ForLoop;
+
+// 命令结构体：语法树中的一条简单命令（或一个 for 循环）
+// 语法树的形状：
+//   命令列表  a && b | c ; d
+//   chain_next 把管道连成列表：  [a] --&&--> [b | c] --;--> [d]
+//   pipe_next  把简单命令连成管道：[b] --|--> [c]
+// 解析阶段只填写 words / *_word（未展开的单词），
+// 执行前由执行器展开成 name / args / *_file（每次执行都重新展开）
 typedef struct Command
 {
     char *name;                                 // 命令名称（指向 args[0]，不单独分配内存
@@ -25,26 +56,37 @@ typedef struct Command
     int arg_count;                              // 参数数量（不包含末尾的NULL）
                                                 // 例如：对于"ls -l /home", arg_count = 2
     
-    // 重定向信息（支持多个重定向）
-    RedirectType redirect_type;                 // 主要重定向类型（保持兼容性）
-    char *redirect_file;                        // 主要重定向文件名（保持兼容性）
-    
-    // 多重定向支持
+    // 多重定向支持（展开后的文件名）
     char *stdout_file;                          // 标准输出重定向文件 (>)
     char *stderr_file;                          // 错误输出重定向文件 (2>)
     char *stdin_file;                           // 输入重定向文件 (<)
+    char *stdin_text;                           // here-document / here-string 展开后的内容 (<< <<<)
     int stdout_append;                          // 标准输出是否追加模式 (>>)
     int stderr_append;                          // 错误输出是否追加模式 (2>>)
     
+    // 解析结果（未展开的单词）
+    Word *words;                                // 命令名和参数（链表）
+    int word_count;                             // 单词数量
+    Word *stdout_word;                          // > 或 >> 的目标
+    Word *stderr_word;                          // 2> 或 2>> 的目标
+    Word *stdin_word;                           // < 的来源，或 << / <<< 的内容
+    int stdin_here;                             // stdin_word 的类型：HERE_NONE / HERE_DOC / HERE_STRING
+    ForLoop *loop;                              // 非 NULL 表示这是一个 for 循环（没有 words）
+    
     // 管道信息
     struct Command *pipe_next;                  // 管道中的下一个命令（NULL表示没有管道）
     
-    // 命令链信息（&& 和 ||）
-    struct Command *chain_next;                 // 命令链中的下一个命令（NULL表示没有链）
-    int chain_type;                             // 链类型：0=无, 1=&&, 2=||
+    // 命令链信息（只在管道的第一条命令上设置）
+    struct Command *chain_next;                 // 命令列表中的下一条管道（NULL表示没有）
+    int chain_type;                             // 链类型：CHAIN_NONE / CHAIN_AND / CHAIN_OR / CHAIN_SEQ
     
     // 后台执行
     int background;                             // 是否后台执行（以 & 结尾）
+    
+    // 内存管理
+    Arena *arena;                               // 分配本命令（及参数、展开结果）的内存池
+                                                // 执行阶段的展开结果也从这里分配
+    int owns_arena;                             // 1=free_command() 时销毁内存池（parse_command 创建）
 } Command;
 
 //  函数声明
@@ -52,13 +94,34 @@ typedef struct Command
 
 // 解析命令行字符串，返回Command 结构体指针
 // 参数：line - 用户输入的命令行字符串
-// 返回：成功返回Command* 指针，失败返回NULL
+// 返回：成功返回命令列表的第一条命令，空行、注释行或语法错误返回NULL
+//       （语法错误会向 stderr 输出 "parse error ..."）
 // 注意：调用者负责调用 free_command() 释放返回的内存
+//       （内部为这条命令创建一个内存池，free_command 时一次性释放）
 Command* parse_command(const char *line);
 
-// 释放 Command 结构体及其内部动态分配的所有内存
+// 在调用者提供的内存池中解析命令行
+// 参数：line - 命令行字符串，arena - 内存池
+// 返回：成功返回Command* 指针，失败返回NULL
+// 注意：不要对返回值调用 free_command()，用 arena_mark/arena_release 回收
+Command* parse_command_arena(const char *line, Arena *arena);
+
+// 在内存池中解析命令行，不向 stderr 输出错误信息
+// 参数：error - 语法错误时写入错误信息（如 "parse error near `done'"），否则为空字符串
+// 返回：同 parse_command_arena；返回 NULL 且 error 为空表示空行或注释行
+// 说明：脚本预编译时保存错误信息，执行到出错的行时再连同行号一起报告
+Command* parse_command_quiet(const char *line, Arena *arena, char *error, size_t error_size);
+
+// 判断命令行是否还没有写完（for 循环缺少 do / done，或 here-document 没有结束标记）
+// 说明：交互模式下用来决定是否继续读取下一行（显示 "> " 提示符）
+// 返回：PARSE_COMPLETE=已完整（或有其他语法错误），
+//       PARSE_MORE_LOOP / PARSE_MORE_HEREDOC=需要继续输入
+//       （here-document 的内容要原样拼接：保留换行、空行和行首空白）
+int parse_is_incomplete(const char *line);
+
+// 释放 parse_command() 返回的 Command（销毁它的内存池）
 // 参数：cmd - 需要释放的Command指针
-//注意：会释放 cmd->args 中的所有字符串以及args数组本省
+// 注意：管道中的后续命令、所有参数字符串都在同一个内存池中，一起被释放
 void free_command(Command *cmd);
 
 # endif                                         // PARSER_H 头文件保护结束
\ No newline at end of file
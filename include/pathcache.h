@@ -0,0 +1,39 @@
+// 头文件保护：防止重复包含
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+// ============================================
+// PATH 查找缓存模块（类似 bash 的 hash）
+// ============================================
+// 功能：记住“命令名 -> 可执行文件完整路径”的映射，
+//       避免每次执行外部命令都对 PATH 中的每个目录调用 access()
+// 特性：
+//   1. 哈希表存储，查找 O(1)
+//   2. 负缓存：记住“找不到”的命令，PATH_CACHE_NEGATIVE_TTL 秒内不再重复搜索
+//   3. 失效：PATH 被 xexport/xunset 修改时整表清空；
+//            已缓存的程序被删除（启动时 ENOENT）时单条删除
+// ============================================
+
+// 负缓存有效期（秒）：过期后重新在 PATH 中搜索，避免新安装的程序一直“找不到”
+#define PATH_CACHE_NEGATIVE_TTL 2
+
+// 在 PATH 中查找命令（优先查缓存）
+// 参数：name - 命令名（不含 '/'）
+// 返回：完整路径（由缓存持有，调用者不要释放；下次修改缓存前有效），找不到返回 NULL
+const char* path_cache_lookup(const char *name);
+
+// 删除单条缓存（程序被删除或移动时使用）
+// 返回：0=已删除，-1=不存在
+int path_cache_forget(const char *name);
+
+// 清空整个缓存（PATH 改变或 xhash -r 时使用）
+void path_cache_clear(void);
+
+// 显示缓存内容（xhash 无参数时使用）
+// 格式：命中次数  完整路径（负缓存条目不显示）
+void path_cache_print(void);
+
+// 获取缓存条目数量（包含负缓存条目）
+int path_cache_count(void);
+
+#endif // PATHCACHE_H
@@ -0,0 +1,44 @@
+// 头文件保护：防止重复包含
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include "xshell.h"                         // ShellContext
+
+// ============================================
+// 脚本预编译缓存（xsource、启动配置文件 ~/.xshellrc）
+// ============================================
+// 背景：
+//   原来 xsource 每次都用 1024 字节的 fgets 逐行读取、逐行解析再执行，
+//   反复 xsource 同一个函数库时每次都重新解析，也不支持多行的 for 循环。
+// 实现：
+//   - 第一次执行时读入整个文件，按行切分成命令（for 循环可以跨多行），
+//     每条命令解析成语法树，连同起始行号一起保存在脚本自己的内存池中
+//   - 编译结果按文件（设备号 + inode）缓存，修改时间或大小变化时重新编译
+//   - 再次执行时直接执行缓存的语法树，不再读取和解析文件
+//   - 语法错误也被缓存：执行到出错的行时连同文件名和行号一起报告
+// 说明：
+//   语法树只保存未展开的单词，变量和别名在每次执行时展开，
+//   所以缓存不受执行期间变量、别名变化的影响
+// ============================================
+
+// 缓存的脚本数量上限（超过时淘汰最久未使用的）
+#define SCRIPT_CACHE_MAX 16
+
+// 脚本嵌套执行的最大层数（防止脚本 xsource 自己时无限递归导致栈溢出）
+#define SCRIPT_MAX_DEPTH 64
+
+// 执行脚本文件（优先使用缓存的编译结果）
+// 参数：
+//   ctx  - Shell 上下文（每条命令执行后更新 last_exit_status）
+//   path - 脚本文件路径
+//   who  - 错误信息的前缀（如 "xsource"）
+// 返回：出错（语法错误或执行失败）的命令数，0 表示全部成功；
+//       文件无法打开或读取返回 -1（errno 有效）
+//       嵌套超过 SCRIPT_MAX_DEPTH 层时报告错误，不执行该脚本
+// 说明：执行 quit（ctx->running 变为 0）后停止执行剩余的命令
+int script_source(ShellContext *ctx, const char *path, const char *who);
+
+// 清空脚本缓存，释放所有编译结果
+void script_cache_clear(void);
+
+#endif // SCRIPT_H
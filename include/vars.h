@@ -0,0 +1,78 @@
+// 头文件保护：防止重复包含
+#ifndef VARS_H
+#define VARS_H
+
+#include <stddef.h>                         // size_t
+
+// ============================================
+// Shell 变量表
+// ============================================
+// 背景：
+//   原来变量全部放在进程环境变量中：每次展开 $NAME 都用 getenv() 线性扫描 environ，
+//   A=1 这样的普通 Shell 变量也无法与导出变量区分，都会传给子进程。
+// 实现：
+//   - 哈希表（链地址法），展开时一次查找、不分配内存
+//   - 每个变量带 exported 标志：只有导出变量会传给子进程
+//   - 子进程的环境数组（envp）按需构建并缓存，导出变量改变时才重建
+//   - 启动时从 environ 导入（全部视为导出变量）
+// 说明：
+//   导出变量的修改同时写回进程环境（setenv/unsetenv），
+//   供仍然使用 getenv() 的模块（PATH 缓存、终端类型等）读取
+// ============================================
+
+// 变量（条目文本为 "NAME=value"，envp 直接引用它，不需要再拼接）
+typedef struct Var {
+    char *entry;                            // "NAME=value"
+    size_t name_len;                        // NAME 的长度（value 从 entry + name_len + 1 开始）
+    int exported;                           // 是否导出给子进程
+    struct Var *next;                       // 同一个桶中的下一个变量
+} Var;
+
+// 变量表
+typedef struct VarTable {
+    Var **buckets;                          // 桶数组（数量为 2 的幂）
+    size_t bucket_count;
+    size_t count;                           // 变量个数
+    size_t exported_count;                  // 导出变量个数
+    char **envp;                            // 缓存的子进程环境数组（NULL 表示需要重建）
+} VarTable;
+
+// set 时导出标志的处理方式
+#define VAR_KEEP   0                        // 保持原来的标志（新变量不导出）
+#define VAR_EXPORT 1                        // 设置为导出变量
+
+// 初始化为空表
+void vars_init(VarTable *table);
+
+// 导入环境变量数组（"NAME=value" 格式，全部作为导出变量）
+void vars_import(VarTable *table, char **env);
+
+// 释放变量表
+void vars_destroy(VarTable *table);
+
+// 查找变量的值
+// 返回：变量值（指向表内部，下次修改该变量前有效）；未定义返回 NULL
+const char* vars_get(const VarTable *table, const char *name);
+
+// 设置变量
+// 参数：export_flag - VAR_KEEP 或 VAR_EXPORT
+// 返回：0=成功，-1=内存不足
+int vars_set(VarTable *table, const char *name, const char *value, int export_flag);
+
+// 把已有变量标记为导出
+// 返回：0=成功，-1=变量不存在
+int vars_export(VarTable *table, const char *name);
+
+// 删除变量
+// 返回：1=删除了变量，0=变量不存在
+int vars_unset(VarTable *table, const char *name);
+
+// 判断字符串是否是合法的变量名（字母或下划线开头，由字母、数字、下划线组成）
+// 参数：len - 名字长度
+int vars_valid_name(const char *name, size_t len);
+
+// 获取子进程的环境数组（以 NULL 结尾，只包含导出变量）
+// 说明：数组被缓存，导出变量没有变化时直接返回上次的结果；不要修改或释放
+char** vars_envp(VarTable *table);
+
+#endif // VARS_H
@@ -0,0 +1,43 @@
+// 头文件保护：防止重复包含
+#ifndef WILDCARD_H
+#define WILDCARD_H
+
+#include "arena.h"                          // 匹配结果分配在内存池中
+
+// ============================================
+// 通配符展开（* ? [...] 和 **）
+// ============================================
+// 语法：
+//   *.c          当前目录下的 .c 文件
+//   src/?ain.c   ? 匹配一个字符
+//   [abc]*.h     [...] 匹配其中一个字符（[!...] 取反，支持 a-z 范围）
+//   src/**/*.c   ** 单独作为一级目录时匹配任意层子目录（包括 0 层）
+//   */           以 / 结尾只匹配目录
+// 规则（与 sh 一致）：
+//   - 以 . 开头的文件只有模式也以 . 开头时才匹配
+//   - 结果按字典序排列；没有匹配时保留原单词
+//   - 模式中的 \c 表示普通字符 c（执行器用它标记引号中的 * ? [）
+// 实现：
+//   - 逐级目录用 openat 打开，不拼接完整路径再 open
+//   - 用 readdir 返回的 d_type 判断是否是目录，只有符号链接和
+//     d_type 未知时才调用 fstatat
+//   - 目录内容按（设备号, inode）缓存，同一行命令中多个模式扫描同一个目录时
+//     只读取一次；目录的修改时间变化后重新读取
+//   - 常见的 * 和 *.ext 直接比较后缀，其余模式用 fnmatch
+// ============================================
+
+// 判断文本是否含有通配符（* ? 或成对的 [...]，\ 转义的除外）
+int wildcard_has_magic(const char *pattern);
+
+// 展开通配符模式
+// 参数：
+//   pattern - 模式（如 "src/*.c"）
+//   arena   - 匹配结果（字符串和数组）所在的内存池
+//   matches - 返回以 NULL 结尾的结果数组
+// 返回：匹配的个数（0 表示没有匹配，*matches 为 NULL），-1=内存不足
+int wildcard_expand(const char *pattern, Arena *arena, char ***matches);
+
+// 清空目录内容缓存（每行命令执行完调用）
+void wildcard_cache_clear(void);
+
+#endif // WILDCARD_H
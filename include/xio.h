@@ -0,0 +1,74 @@
+// 头文件保护：防止重复包含
+#ifndef XIO_H
+#define XIO_H
+
+#include <stdio.h>                          // FILE
+
+// ============================================
+// 内置命令标准流抽象（xio）
+// ============================================
+// 背景：
+//   管道中的内置命令原来要 fork 出子进程，再通过 dup2 把管道接到 0/1 上，
+//   因为它们直接写 stdout、读 stdin。
+//   现在连续的内置命令阶段在 Shell 进程内用线程运行，每个线程有自己的
+//   “标准输入/输出”，因此内置命令改为通过 xio_stdin / xio_stdout 读写：
+//     - 在 Shell 主线程中（普通执行）它们就是 stdin / stdout
+//     - 在管道工作线程中它们是该阶段的输入/输出流
+//       （线程之间是内存环形缓冲区，与外部命令相邻处是内核管道）
+// 用法：
+//   printf(...)     -> fprintf(xio_stdout, ...)
+//   putchar(c)      -> xio_putchar(c)
+//   getchar()       -> xio_getchar()
+//   fgets(.., stdin)-> fgets(.., xio_stdin)
+// 注意：
+//   已改造的内置命令在注册表中带 BUILTIN_XIO 标志；标准错误仍然直接写 stderr。
+// ============================================
+
+// 当前线程的输入/输出流（NULL 表示使用进程的 stdin/stdout）
+extern __thread FILE *xio_cur_in;
+extern __thread FILE *xio_cur_out;
+
+#define xio_stdin   (xio_cur_in != NULL ? xio_cur_in : stdin)
+#define xio_stdout  (xio_cur_out != NULL ? xio_cur_out : stdout)
+
+#define xio_putchar(c)  fputc((c), xio_stdout)
+#define xio_getchar()   fgetc(xio_stdin)
+
+// 线程之间传递数据的块大小：每个流的 stdio 缓冲区大小，
+// 也是环形缓冲区一次交接的数据量
+#define XIO_BLOCK_SIZE  (64 * 1024)
+
+// 环形缓冲区容量（块数）：写端最多领先读端这么多块，之后阻塞等待
+#define XIO_RING_BLOCKS 4
+
+// 初始化：读取环境变量 XSHELL_PIPELINE（thread / fork）
+// 说明：XSHELL_PIPELINE=fork 时管道中的内置命令仍然 fork 子进程运行，便于对比
+void xio_init(void);
+
+// 管道中的内置命令是否使用线程运行
+int xio_threads_enabled(void);
+void xio_set_threads_enabled(int enabled);
+
+// 创建一对通过内存环形缓冲区相连的流
+// 参数：reader - 输出读端，writer - 输出写端（两者都是全缓冲）
+// 返回：0=成功，-1=失败
+// 说明：
+//   - 写端 fclose 后，读端读完剩余数据返回 EOF
+//   - 读端 fclose 后，写端再写入会失败（errno = EPIPE），相当于 SIGPIPE
+//   - 两端都 fclose 后缓冲区自动释放
+int xio_channel_open(FILE **reader, FILE **writer);
+
+// 把内核管道/文件描述符包装成全缓冲的流（fdopen + XIO_BLOCK_SIZE 缓冲）
+// 返回：成功返回 FILE*（fclose 时关闭 fd），失败返回 NULL
+FILE* xio_fdopen(int fd, const char *mode);
+
+// 把输入流映射到内存（流背后是普通文件时，如 here-document 的 memfd、< file 或 fopen 打开的文件）
+// 参数：file - 还没有读取过的输入流，len - 返回数据长度
+// 返回：私有的可写映射（修改不影响文件，可以把 '\n' 改成 '\0' 就地切分行），
+//       最后一行没有换行时 data[len] 为 '\0'；
+//       不能映射（管道、终端、环形缓冲区、已经读取过、空文件）时返回 NULL，调用者改用 fgets 逐行读取
+// 说明：映射成功后流的读位置移到文件末尾；用 xio_unmap 释放
+char* xio_map(FILE *file, size_t *len);
+void xio_unmap(char *data, size_t len);
+
+#endif // XIO_H
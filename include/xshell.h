@@ -10,20 +10,25 @@
 #include <linux/limits.h>           // 提供 PATH_MAX 常量（最大路径长度）
 #include <errno.h>                  // 提供 errno
 
+#include "vars.h"                   // Shell 变量表
+
 // 常量定义
 #define MAX_INPUT_LENGTH 4096       // 用户输入命令的最大长度（字节）
 #define MAX_TOKEN 256               // 命令行最多可分割的token数量
 #define MAX_ARGS 128                // 单个命令最多可接收的参数数量
+#define SYNTAX_ERROR_STATUS 2       // 命令行有语法错误时的退出状态（与 sh 相同）
 
 // 数据结构定义
 // Shell 上下文结构体：保存 Shell 运行时的全局状态
-typedef struct {
+typedef struct ShellContext {
     char cwd[PATH_MAX];             // 当前工作目录的完整路径
     char prev_dir[PATH_MAX];        // 上一个工作目录（用于 xcd，返回）
     char *home_dir;                 // 用户主目录（用于xcd无参数时返回）
     int running;                    // Shell 运行标志：1 = 运行中，0 = 退出
     int last_exit_status;           // 上一条命令的退出状态码（0表示成功）
+    int interactive;                // 交互模式：1 = 终端输入（提示符、补全、历史），0 = 脚本/管道输入
     FILE *log_file;                 // 日志文件指针（用于记录错误信息）
+    VarTable vars;                  // Shell 变量表（$NAME 展开、导出给子进程的环境变量）
 } ShellContext;
 
 // 函数声明
@@ -33,10 +38,15 @@ typedef struct {
 int init_shell(ShellContext *ctx);
 
 // Shell 主循环（读取命令、解析、执行，循环往复）
+// 说明：从标准输入读取；非交互模式下不显示欢迎信息和提示符，也不读写历史记录
 void shell_loop(ShellContext *ctx);
 
-// 显示命令提示符（如:[\home\user\]#)
-void display_prompt(ShellContext *ctx);
+// 执行脚本文件（非交互模式，逐行读取执行，直到文件结束或 quit）
+// 返回：最后一条命令的退出状态；文件无法打开返回 127
+int shell_run_file(ShellContext *ctx, const char *path);
+
+// 生成命令提示符（如:[\home\user\]# ），由行编辑器显示
+void format_prompt(ShellContext *ctx, char *buffer, size_t size);
 
 // 执行单条命令行（解析并执行用户输入的命令）
 int execute_command_line(const char *line, ShellContext *ctx);
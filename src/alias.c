@@ -1,57 +1,205 @@
 /*
  * alias.c - 命令别名管理实现
- * 
+ *
  * 功能：管理Shell命令别名
  */
 
 #include "alias.h"
+#include "parser.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-// 别名表（静态数组）
-static Alias aliases[MAX_ALIASES];
-static int alias_count_value = 0;
+// 初始槽数量（必须是 2 的幂）
+#define ALIAS_INITIAL_SLOTS 16
+
+// 别名条目（与名称、值、单词一起放在自己的内存池中）
+typedef struct {
+    Arena *arena;           // 条目所在的内存池（删除别名时整体释放）
+    char *name;             // 别名名称
+    char *value;            // 别名对应的命令（原文，用于显示）
+    Word *words;            // 值切分后的单词链表
+    int word_count;         // 单词个数
+} AliasEntry;
+
+// 已删除的槽（墓碑）：查找时继续向后探测，插入时可以复用
+static AliasEntry g_tombstone;
+#define TOMBSTONE (&g_tombstone)
+
+// 哈希表（开放寻址，线性探测）
+static AliasEntry **g_slots = NULL;     // 槽数组：NULL=空，TOMBSTONE=已删除
+static size_t g_slot_count = 0;         // 槽数量
+static size_t g_used = 0;               // 别名数量
+static size_t g_tombstones = 0;         // 墓碑数量
+
+// FNV-1a 字符串哈希
+static size_t hash_name(const char *name) {
+    size_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)name; *p != '\0'; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// 查找别名所在的槽
+// 返回：找到返回槽下标；找不到返回 -1
+static long find_slot(const char *name) {
+    if (g_slot_count == 0) {
+        return -1;
+    }
+    size_t mask = g_slot_count - 1;
+    for (size_t i = hash_name(name) & mask; g_slots[i] != NULL; i = (i + 1) & mask) {
+        if (g_slots[i] != TOMBSTONE && strcmp(g_slots[i]->name, name) == 0) {
+            return (long)i;
+        }
+    }
+    return -1;
+}
+
+// 把条目放入第一个空槽或墓碑（调用前已确认名称不存在）
+static void insert_entry(AliasEntry *entry) {
+    size_t mask = g_slot_count - 1;
+    size_t i = hash_name(entry->name) & mask;
+    while (g_slots[i] != NULL && g_slots[i] != TOMBSTONE) {
+        i = (i + 1) & mask;
+    }
+    if (g_slots[i] == TOMBSTONE) {
+        g_tombstones--;
+    }
+    g_slots[i] = entry;
+}
+
+// 调整槽数量并重新放入所有条目（同时清除墓碑）
+static int resize_table(size_t new_count) {
+    AliasEntry **old_slots = g_slots;
+    size_t old_count = g_slot_count;
+
+    g_slots = calloc(new_count, sizeof(AliasEntry *));
+    if (g_slots == NULL) {
+        g_slots = old_slots;
+        return -1;
+    }
+    g_slot_count = new_count;
+    g_tombstones = 0;
+    for (size_t i = 0; i < old_count; i++) {
+        if (old_slots[i] != NULL && old_slots[i] != TOMBSTONE) {
+            insert_entry(old_slots[i]);
+        }
+    }
+    free(old_slots);
+    return 0;
+}
+
+// 检查单词中的命令替换能否解析（定义别名时就报告语法错误）
+// 返回：0=可以解析，-1=语法错误
+static int check_substitutions(const Word *word, Arena *arena) {
+    if (!word->has_subst) {
+        return 0;
+    }
+    for (const WordPart *part = word->parts; part != NULL; part = part->next) {
+        if (part->type != WORD_SUBST && part->type != WORD_SUBST_QUOTED) {
+            continue;
+        }
+        char error[128];
+        ArenaMark mark = arena_mark(arena);
+        Command *sub = parse_command_quiet(part->text, arena, error, sizeof(error));
+        arena_release(arena, mark);                 // 只检查语法，展开时再解析到命令的内存池
+        if (sub == NULL && error[0] != '\0') {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 把别名值切分成单词，创建条目
+// 返回：新条目；值不是简单命令（或命令替换有语法错误）时 *status 为 ALIAS_NOT_SIMPLE
+static AliasEntry* create_entry(const char *name, const char *value, int *status) {
+    // 词法分析需要的内存大约是文本长度的几倍，一个内存块通常就够
+    Arena *arena = arena_create(sizeof(AliasEntry) + 4 * (strlen(name) + strlen(value)) + 256);
+    if (arena == NULL) {
+        *status = ALIAS_ERROR;
+        return NULL;
+    }
+    AliasEntry *entry = arena_alloc(arena, sizeof(AliasEntry));
+    if (entry == NULL) {
+        arena_destroy(arena);
+        *status = ALIAS_ERROR;
+        return NULL;
+    }
+    entry->arena = arena;
+    entry->name = arena_strdup(arena, name);
+    entry->value = arena_strdup(arena, value);
+    entry->words = NULL;
+    entry->word_count = 0;
+
+    Lexer lexer;
+    if (entry->name == NULL || entry->value == NULL || lexer_init(&lexer, entry->value, arena) != 0) {
+        arena_destroy(arena);
+        *status = ALIAS_ERROR;
+        return NULL;
+    }
+    Word **tail = &entry->words;
+    Token token;
+    for (lexer_next(&lexer, &token); token.type == TOKEN_WORD; lexer_next(&lexer, &token)) {
+        if (check_substitutions(token.word, arena) != 0) {
+            arena_destroy(arena);
+            *status = ALIAS_NOT_SIMPLE;
+            return NULL;
+        }
+        *tail = token.word;
+        tail = &token.word->next;
+        entry->word_count++;
+    }
+    if (token.type != TOKEN_EOF) {
+        arena_destroy(arena);
+        *status = (lexer.error != NULL && strcmp(lexer.error, "out of memory") == 0)
+                  ? ALIAS_ERROR : ALIAS_NOT_SIMPLE;
+        return NULL;
+    }
+    *status = 0;
+    return entry;
+}
 
 // 初始化别名系统
 int alias_init(void) {
-    alias_count_value = 0;
-    memset(aliases, 0, sizeof(aliases));
+    alias_cleanup();
     return 0;
 }
 
 // 添加或更新别名
 int alias_set(const char *name, const char *value) {
-    if (name == NULL || value == NULL) {
-        return -1;
+    if (name == NULL || value == NULL || *name == '\0') {
+        return ALIAS_ERROR;
     }
-    
-    // 检查名称和值的长度
-    if (strlen(name) >= sizeof(aliases[0].name) ||
-        strlen(value) >= sizeof(aliases[0].value)) {
-        return -1;
+
+    int status;
+    AliasEntry *entry = create_entry(name, value, &status);
+    if (entry == NULL) {
+        return status;
     }
-    
-    // 检查是否已存在，如果存在则更新
-    for (int i = 0; i < alias_count_value; i++) {
-        if (strcmp(aliases[i].name, name) == 0) {
-            strncpy(aliases[i].value, value, sizeof(aliases[i].value) - 1);
-            aliases[i].value[sizeof(aliases[i].value) - 1] = '\0';
-            return 0;
-        }
+
+    // 已存在：直接替换
+    long slot = find_slot(name);
+    if (slot >= 0) {
+        arena_destroy(g_slots[slot]->arena);
+        g_slots[slot] = entry;
+        return 0;
     }
-    
-    // 添加新别名
-    if (alias_count_value >= MAX_ALIASES) {
-        return -1;
+
+    // 新别名：装载率（含墓碑）超过 3/4 时扩容；墓碑较多时只重建不扩容
+    if ((g_used + g_tombstones + 1) * 4 > g_slot_count * 3) {
+        size_t new_count = (g_slot_count == 0) ? ALIAS_INITIAL_SLOTS : g_slot_count;
+        while ((g_used + 1) * 2 > new_count) {
+            new_count *= 2;
+        }
+        if (resize_table(new_count) != 0) {
+            arena_destroy(entry->arena);
+            return ALIAS_ERROR;
+        }
     }
-    
-    strncpy(aliases[alias_count_value].name, name, sizeof(aliases[alias_count_value].name) - 1);
-    aliases[alias_count_value].name[sizeof(aliases[alias_count_value].name) - 1] = '\0';
-    
-    strncpy(aliases[alias_count_value].value, value, sizeof(aliases[alias_count_value].value) - 1);
-    aliases[alias_count_value].value[sizeof(aliases[alias_count_value].value) - 1] = '\0';
-    
-    alias_count_value++;
+    insert_entry(entry);
+    g_used++;
     return 0;
 }
 
@@ -60,14 +208,8 @@ const char* alias_get(const char *name) {
     if (name == NULL) {
         return NULL;
     }
-    
-    for (int i = 0; i < alias_count_value; i++) {
-        if (strcmp(aliases[i].name, name) == 0) {
-            return aliases[i].value;
-        }
-    }
-    
-    return NULL;
+    long slot = find_slot(name);
+    return (slot >= 0) ? g_slots[slot]->value : NULL;
 }
 
 // 删除别名
@@ -75,48 +217,143 @@ int alias_remove(const char *name) {
     if (name == NULL) {
         return -1;
     }
-    
-    // 查找别名
-    for (int i = 0; i < alias_count_value; i++) {
-        if (strcmp(aliases[i].name, name) == 0) {
-            // 找到了，将后面的别名前移
-            for (int j = i; j < alias_count_value - 1; j++) {
-                aliases[j] = aliases[j + 1];
-            }
-            alias_count_value--;
-            // 清空最后一个位置
-            memset(&aliases[alias_count_value], 0, sizeof(Alias));
-            return 0;
-        }
+    long slot = find_slot(name);
+    if (slot < 0) {
+        return -1;
     }
-    
-    // 未找到
-    return -1;
+    arena_destroy(g_slots[slot]->arena);
+    g_slots[slot] = TOMBSTONE;
+    g_used--;
+    g_tombstones++;
+    return 0;
+}
+
+// 按名称比较（qsort 用）
+static int compare_entries(const void *a, const void *b) {
+    const AliasEntry *x = *(const AliasEntry * const *)a;
+    const AliasEntry *y = *(const AliasEntry * const *)b;
+    return strcmp(x->name, y->name);
 }
 
 // 列出所有别名
 void alias_list(void) {
-    if (alias_count_value == 0) {
+    if (g_used == 0) {
         // 没有别名
         return;
     }
-    
-    for (int i = 0; i < alias_count_value; i++) {
-        printf("alias %s='%s'\n", aliases[i].name, aliases[i].value);
+
+    AliasEntry **sorted = malloc(g_used * sizeof(AliasEntry *));
+    if (sorted == NULL) {
+        return;
+    }
+    size_t n = 0;
+    for (size_t i = 0; i < g_slot_count; i++) {
+        if (g_slots[i] != NULL && g_slots[i] != TOMBSTONE) {
+            sorted[n++] = g_slots[i];
+        }
     }
+    qsort(sorted, n, sizeof(AliasEntry *), compare_entries);
+    for (size_t i = 0; i < n; i++) {
+        printf("alias %s='%s'\n", sorted[i]->name, sorted[i]->value);
+    }
+    free(sorted);
 }
 
 // 获取别名数量
 int alias_count(void) {
-    return alias_count_value;
+    return (int)g_used;
 }
 
-// 清理别名系统
-void alias_cleanup(void) {
-    alias_count_value = 0;
-    memset(aliases, 0, sizeof(aliases));
+// 复制一个单词（包括组成部分）到 arena
+// 说明：命令替换在 arena 中重新解析，执行时的展开结果随这一行一起释放，
+//       命令替换中删除别名也不会影响正在执行的语法树
+static Word* copy_word(const Word *word, Arena *arena) {
+    Word *copy = arena_alloc(arena, sizeof(Word));
+    if (copy == NULL) {
+        return NULL;
+    }
+    *copy = *word;
+    copy->next = NULL;
+    WordPart **tail = &copy->parts;
+    for (const WordPart *part = word->parts; part != NULL; part = part->next) {
+        WordPart *part_copy = arena_alloc(arena, sizeof(WordPart));
+        if (part_copy == NULL) {
+            return NULL;
+        }
+        *part_copy = *part;
+        part_copy->text = arena_strdup(arena, part->text);
+        if (part_copy->text == NULL) {
+            return NULL;
+        }
+        if (part->type == WORD_SUBST || part->type == WORD_SUBST_QUOTED) {
+            char error[128];
+            part_copy->subst = parse_command_quiet(part_copy->text, arena, error, sizeof(error));
+            if (part_copy->subst == NULL && error[0] != '\0') {
+                return NULL;                        // 定义时已检查过语法，这里只会是内存不足
+            }
+        }
+        *tail = part_copy;
+        tail = &part_copy->next;
+    }
+    *tail = NULL;
+    return copy;
 }
 
+// 展开命令第一个单词上的别名
+int alias_expand(const Word **words_io, Arena *arena, int *word_count) {
+    const AliasEntry *expanded[ALIAS_MAX_DEPTH];
+    int depth = 0;
+    const Word *words = *words_io;
 
+    while (words != NULL && g_used > 0 && depth < ALIAS_MAX_DEPTH) {
+        // 只展开未加引号的纯文本（"ll" 或 \ll 可以绕过别名）
+        const char *name = word_literal(words);
+        if (name == NULL || words->quoted) {
+            break;
+        }
+        long slot = find_slot(name);
+        if (slot < 0) {
+            break;
+        }
+        const AliasEntry *entry = g_slots[slot];
+        for (int i = 0; i < depth; i++) {
+            if (expanded[i] == entry) {
+                *words_io = words;          // 已经展开过：避免无限循环
+                return 0;
+            }
+        }
+        expanded[depth++] = entry;
 
+        // 别名的单词复制到 arena，后面接上原命令第一个单词之后的部分
+        const Word *rest = words->next;
+        Word *head = NULL;
+        Word **tail = &head;
+        for (const Word *word = entry->words; word != NULL; word = word->next) {
+            Word *copy = copy_word(word, arena);
+            if (copy == NULL) {
+                return -1;
+            }
+            *tail = copy;
+            tail = &copy->next;
+        }
+        *tail = (Word *)rest;
+        *word_count += entry->word_count - 1;
+        words = head;
+    }
+    *words_io = words;
+    return 0;
+}
 
+// 清理别名系统
+void alias_cleanup(void) {
+    for (size_t i = 0; i < g_slot_count; i++) {
+        if (g_slots[i] != NULL && g_slots[i] != TOMBSTONE) {
+            arena_destroy(g_slots[i]->arena);
+        }
+    }
+    free(g_slots);
+    g_slots = NULL;
+    g_slot_count = 0;
+    g_used = 0;
+    g_tombstones = 0;
+}
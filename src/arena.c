@@ -0,0 +1,135 @@
+// 引入自定义头文件
+#include "arena.h"                          // 内存池声明
+
+// 引入标准库
+#include <stdlib.h>                         // malloc, free
+#include <string.h>                         // memcpy, memset, strlen
+#include <stdint.h>                         // uintptr_t
+
+// 对齐字节数：两个指针大小，满足 double / long / 指针等常见类型的对齐要求
+#define ARENA_ALIGN (2 * sizeof(void *))
+
+// 内存块的数据区紧跟在块头之后
+static char* block_data(ArenaBlock *block) {
+    return (char *)(block + 1);
+}
+
+// 在内存块中切出 size 字节，空间不够返回 NULL
+static void* block_take(ArenaBlock *block, size_t size) {
+    uintptr_t base = (uintptr_t)block_data(block);
+    uintptr_t pos = (base + block->used + ARENA_ALIGN - 1) & ~(uintptr_t)(ARENA_ALIGN - 1);
+    size_t offset = (size_t)(pos - base);
+    if (offset > block->size || size > block->size - offset) {
+        return NULL;
+    }
+    block->used = offset + size;
+    return (void *)pos;
+}
+
+// ============================================
+// 初始化 / 创建 / 销毁
+// ============================================
+void arena_init(Arena *arena, size_t block_size) {
+    arena->current = NULL;
+    arena->block_size = block_size;
+    arena->block_allocs = 0;
+}
+
+Arena* arena_create(size_t block_size) {
+    Arena tmp;
+    arena_init(&tmp, block_size);
+    Arena *arena = arena_alloc(&tmp, sizeof(Arena));   // 内存池结构体本身放在第一个块里
+    if (arena == NULL) {
+        return NULL;
+    }
+    *arena = tmp;
+    return arena;
+}
+
+void arena_destroy(Arena *arena) {
+    ArenaBlock *block = arena->current;
+    arena->current = NULL;                  // arena 可能就位于某个块中，先取出链表再释放
+    while (block != NULL) {
+        ArenaBlock *prev = block->prev;
+        free(block);
+        block = prev;
+    }
+}
+
+// ============================================
+// 分配
+// ============================================
+void* arena_alloc(Arena *arena, size_t size) {
+    if (arena->current != NULL) {
+        void *ptr = block_take(arena->current, size);
+        if (ptr != NULL) {
+            return ptr;
+        }
+    }
+
+    // 当前块不够：申请新块（超大请求单独申请一个刚好够用的块）
+    size_t block_size = (arena->block_size != 0) ? arena->block_size : ARENA_DEFAULT_BLOCK_SIZE;
+    if (size + ARENA_ALIGN > block_size) {
+        block_size = size + ARENA_ALIGN;
+    }
+    ArenaBlock *block = malloc(sizeof(ArenaBlock) + block_size);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->prev = arena->current;
+    block->size = block_size;
+    block->used = 0;
+    arena->current = block;
+    arena->block_allocs++;
+    return block_take(block, size);
+}
+
+void* arena_calloc(Arena *arena, size_t count, size_t size) {
+    if (size != 0 && count > (size_t)-1 / size) {
+        return NULL;                        // 乘法溢出
+    }
+    void *ptr = arena_alloc(arena, count * size);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+char* arena_strndup(Arena *arena, const char *str, size_t len) {
+    char *copy = arena_alloc(arena, len + 1);
+    if (copy != NULL) {
+        memcpy(copy, str, len);
+        copy[len] = '\0';
+    }
+    return copy;
+}
+
+char* arena_strdup(Arena *arena, const char *str) {
+    return arena_strndup(arena, str, strlen(str));
+}
+
+// ============================================
+// 标记 / 回退
+// ============================================
+ArenaMark arena_mark(Arena *arena) {
+    ArenaMark mark;
+    mark.block = arena->current;
+    mark.used = (arena->current != NULL) ? arena->current->used : 0;
+    return mark;
+}
+
+void arena_release(Arena *arena, ArenaMark mark) {
+    // 释放 mark 之后申请的内存块（保留最早的一块以便复用）
+    while (arena->current != NULL && arena->current != mark.block) {
+        ArenaBlock *block = arena->current;
+        if (block->prev == NULL && mark.block == NULL) {
+            block->used = 0;
+            return;
+        }
+        arena->current = block->prev;
+        free(block);
+    }
+    if (arena->current != NULL) {
+        arena->current->used = mark.used;
+    }
+}
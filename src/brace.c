@@ -0,0 +1,105 @@
+// 引入自定义头文件
+#include "brace.h"                          // 大括号范围生成器
+
+// 引入标准库
+#include <stdio.h>                          // snprintf
+#include <stdlib.h>                         // strtol
+#include <string.h>                         // strchr, strlen, strncmp
+#include <ctype.h>                          // isdigit
+#include <errno.h>                          // errno, ERANGE
+#include <limits.h>                         // LONG_MAX
+
+// 解析一个整数端点，记录它的文本宽度和是否有前导 0
+// 返回：整数之后的位置，不是整数返回 NULL
+static const char* parse_endpoint(const char *p, long *value, int *width, int *zero_pad) {
+    // 只接受 [-]数字（strtol 还会跳过空白、接受 +，这里不需要）
+    if (!(isdigit((unsigned char)*p) || (*p == '-' && isdigit((unsigned char)p[1])))) {
+        return NULL;
+    }
+    char *end;
+    errno = 0;
+    *value = strtol(p, &end, 10);
+    if (errno == ERANGE) {
+        return NULL;
+    }
+    const char *digits = (*p == '-') ? p + 1 : p;
+    if (digits[0] == '0' && end - digits > 1) {
+        *zero_pad = 1;
+    }
+    *width = (int)(end - p);
+    return end;
+}
+
+// 尝试把 open 处的 { 解析为范围表达式
+static int parse_range(BraceRange *range, const char *arg, const char *open) {
+    long start, end, step = 1;
+    int start_width, end_width, step_width;
+    int zero_pad = 0;
+    int step_zero_pad = 0;                  // 步长的前导 0 不影响填充
+
+    const char *p = parse_endpoint(open + 1, &start, &start_width, &zero_pad);
+    if (p == NULL || strncmp(p, "..", 2) != 0) {
+        return 0;
+    }
+    p = parse_endpoint(p + 2, &end, &end_width, &zero_pad);
+    if (p == NULL) {
+        return 0;
+    }
+    if (strncmp(p, "..", 2) == 0) {
+        p = parse_endpoint(p + 2, &step, &step_width, &step_zero_pad);
+        if (p == NULL) {
+            return 0;
+        }
+    }
+    if (*p != '}') {
+        return 0;
+    }
+
+    // 步长取绝对值（0 按 1 处理），方向由 start 和 end 决定
+    unsigned long abs_step = (step < 0) ? 0UL - (unsigned long)step : (unsigned long)step;
+    if (abs_step == 0) {
+        abs_step = 1;
+    } else if (abs_step > LONG_MAX) {
+        abs_step = LONG_MAX;                // 步长为 LONG_MIN 时取反会溢出
+    }
+    unsigned long span = (start <= end) ? (unsigned long)end - (unsigned long)start
+                                        : (unsigned long)start - (unsigned long)end;
+
+    range->prefix = arg;
+    range->prefix_len = (size_t)(open - arg);
+    range->suffix = p + 1;
+    range->current = start;
+    range->step = (start <= end) ? (long)abs_step : -(long)abs_step;
+    range->remaining = span / abs_step + 1;
+    range->width = zero_pad ? ((start_width > end_width) ? start_width : end_width) : 0;
+    return 1;
+}
+
+int brace_range_init(BraceRange *range, const char *arg) {
+    // 使用第一个合法的范围表达式（如 a{b}{1..3} 中的 {1..3}）
+    for (const char *open = strchr(arg, '{'); open != NULL; open = strchr(open + 1, '{')) {
+        if (parse_range(range, arg, open)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+size_t brace_range_max_len(const BraceRange *range) {
+    // long 最多 20 个字符（含负号），零填充宽度不超过端点文本的长度
+    int digits = (range->width > 20) ? range->width : 20;
+    return range->prefix_len + (size_t)digits + strlen(range->suffix) + 1;
+}
+
+int brace_range_next(BraceRange *range, char *buf, size_t size) {
+    if (range->remaining == 0) {
+        return 0;
+    }
+    snprintf(buf, size, "%.*s%0*ld%s", (int)range->prefix_len, range->prefix,
+             range->width, range->current, range->suffix);
+    range->remaining--;
+    if (range->remaining > 0) {
+        range->current += range->step;
+    }
+    return 1;
+}
@@ -0,0 +1,146 @@
+/*
+ * builtin_table.c - 内置命令注册表
+ *
+ * 功能：所有内置命令的唯一登记处（命令名、处理函数、属性标志、分类、选项、说明）
+ * 说明：表必须按命令名的 strcmp 顺序排列，builtin_lookup() 用二分查找
+ */
+
+#include "builtin.h"
+#include "xui.h"                            // cmd_xui
+#include "xweb.h"                           // cmd_xweb
+#include "xgame.h"                          // cmd_xsnake, cmd_xtetris, cmd_x2048
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 缩写：让表格更紧凑
+#define P BUILTIN_PIPE_SAFE
+#define M BUILTIN_MUTATES_STATE
+#define I BUILTIN_INTERACTIVE
+#define X BUILTIN_XIO
+
+// 内置命令注册表（按命令名排序！新增命令时请插入到正确位置）
+static const BuiltinEntry g_builtins[] = {
+    { "quit",      cmd_quit,       M,        BUILTIN_CAT_BASIC,     "--help",                                "退出 Shell" },
+    { "x2048",     cmd_x2048,      I,        BUILTIN_CAT_FEATURE,   "",                                      "2048 游戏" },
+    { "xalias",    cmd_xalias,     M,        BUILTIN_CAT_ENV,       "--help",                                "设置命令别名" },
+    { "xbasename", cmd_xbasename,  P,        BUILTIN_CAT_FILE,      "--help",                                "提取文件名" },
+    { "xbg",       cmd_xbg,        M,        BUILTIN_CAT_JOB,       "--help",                                "将任务放到后台继续执行" },
+    { "xcalc",     cmd_xcalc,      P,        BUILTIN_CAT_UTIL,      "--help",                                "简单计算器" },
+    { "xcat",      cmd_xcat,       P|X,      BUILTIN_CAT_FILE,      "-n -A -T --help",                       "显示文件内容（支持 -n 行号）" },
+    { "xcd",       cmd_xcd,        M,        BUILTIN_CAT_BASIC,     "--help",                                "切换目录" },
+    { "xchmod",    cmd_xchmod,     0,        BUILTIN_CAT_PERM,      "--help",                                "修改文件权限（支持八进制和符号模式）" },
+    { "xchown",    cmd_xchown,     0,        BUILTIN_CAT_PERM,      "-R -h --help",                          "修改文件所有者" },
+    { "xclear",    cmd_xclear,     P,        BUILTIN_CAT_BASIC,     "--help",                                "清屏" },
+    { "xcomm",     cmd_xcomm,      P,        BUILTIN_CAT_TEXT,      "-1 -2 -3 --help",                       "比较排序文件" },
+    { "xcp",       cmd_xcp,        0,        BUILTIN_CAT_FILE,      "-r -R --help",                          "复制文件或目录（支持 -r 递归）" },
+    { "xcut",      cmd_xcut,       P|X,      BUILTIN_CAT_TEXT,      "-d -f -c --help",                       "提取列（-f 字段, -d 分隔符）" },
+    { "xdate",     cmd_xdate,      P,        BUILTIN_CAT_SYSINFO,   "-u --help",                             "日期时间（支持 -u UTC）" },
+    { "xdf",       cmd_xdf,        P,        BUILTIN_CAT_DIR,       "-h --human-readable --help",            "显示磁盘空间" },
+    { "xdiff",     cmd_xdiff,      P,        BUILTIN_CAT_TEXT,      "-u --unified --help",                   "比较文件差异（支持 -u 统一格式）" },
+    { "xdirname",  cmd_xdirname,   P,        BUILTIN_CAT_FILE,      "--help",                                "提取目录名" },
+    { "xdu",       cmd_xdu,        P,        BUILTIN_CAT_DIR,       "-h -s --human-readable --summarize --help", "显示目录大小" },
+    { "xecho",     cmd_xecho,      P|X,      BUILTIN_CAT_BASIC,     "-n -e -E --help",                       "输出字符串（支持 -n, -e 转义）" },
+    { "xenv",      cmd_xenv,       P,        BUILTIN_CAT_ENV,       "--help",                                "显示所有环境变量" },
+    { "xexport",   cmd_xexport,    M,        BUILTIN_CAT_ENV,       "-p --help",                             "设置环境变量" },
+    { "xfg",       cmd_xfg,        M|I,      BUILTIN_CAT_JOB,       "--help",                                "将后台任务调到前台" },
+    { "xfile",     cmd_xfile,      P,        BUILTIN_CAT_FILE,      "-b --brief --help",                     "显示文件类型" },
+    { "xfind",     cmd_xfind,      P,        BUILTIN_CAT_DIR,       "-name --help",                          "查找文件（支持 -name 模式）" },
+    { "xgrep",     cmd_xgrep,      P|X,      BUILTIN_CAT_TEXT,      "-i -n -v -c -w --help",                 "搜索文本（支持 -i, -n, -v, -c, -w）" },
+    { "xhash",     cmd_xhash,      M,        BUILTIN_CAT_UTIL,      "-r -d --help",                          "管理命令路径缓存" },
+    { "xhead",     cmd_xhead,      P|X,      BUILTIN_CAT_TEXT,      "-n --help",                             "显示文件前N行（-n N）" },
+    { "xhelp",     cmd_xhelp,      P,        BUILTIN_CAT_UTIL,      "--help",                                "显示帮助信息" },
+    { "xhistory",  cmd_xhistory,   P,        BUILTIN_CAT_UTIL,      "--help",                                "命令历史记录" },
+    { "xhostname", cmd_xhostname,  P,        BUILTIN_CAT_SYSINFO,   "--help",                                "主机名" },
+    { "xjobs",     cmd_xjobs,      M,        BUILTIN_CAT_JOB,       "--help",                                "显示后台任务" },
+    { "xjoin",     cmd_xjoin,      P,        BUILTIN_CAT_TEXT,      "-1 -2 -t --help",                       "连接文件" },
+    { "xkill",     cmd_xkill,      0,        BUILTIN_CAT_JOB,       "-s --help",                             "终止进程（支持信号名）" },
+    { "xln",       cmd_xln,        0,        BUILTIN_CAT_PERM,      "-s --help",                             "创建链接（支持 -s 符号链接）" },
+    { "xls",       cmd_xls,        P,        BUILTIN_CAT_BASIC,     "-l -a -h --help",                       "列出文件和目录（支持 -l, -a, -h）" },
+    { "xmenu",     cmd_xmenu,      M|I,      BUILTIN_CAT_FEATURE,   "-f --help",                             "交互式菜单系统" },
+    { "xmkdir",    cmd_xmkdir,     0,        BUILTIN_CAT_DIR,       "-p --help",                             "创建目录（支持 -p 递归）" },
+    { "xmv",       cmd_xmv,        0,        BUILTIN_CAT_FILE,      "--help",                                "移动或重命名文件" },
+    { "xpaste",    cmd_xpaste,     P|X,      BUILTIN_CAT_TEXT,      "-d --help",                             "合并文件行" },
+    { "xps",       cmd_xps,        P,        BUILTIN_CAT_SYSINFO,   "--help",                                "进程信息" },
+    { "xpwd",      cmd_xpwd,       P,        BUILTIN_CAT_BASIC,     "--help",                                "显示当前工作目录" },
+    { "xreadlink", cmd_xreadlink,  P,        BUILTIN_CAT_FILE,      "-f --canonicalize --help",              "读取符号链接目标" },
+    { "xrealpath", cmd_xrealpath,  P,        BUILTIN_CAT_FILE,      "-s --no-symlinks --help",               "显示绝对路径" },
+    { "xrm",       cmd_xrm,        0,        BUILTIN_CAT_FILE,      "-r -R -f --help",                       "删除文件或目录（支持 -r 递归）" },
+    { "xrmdir",    cmd_xrmdir,     0,        BUILTIN_CAT_DIR,       "--help",                                "删除空目录" },
+    { "xsleep",    cmd_xsleep,     P,        BUILTIN_CAT_UTIL,      "--help",                                "休眠指定秒数" },
+    { "xsnake",    cmd_xsnake,     I,        BUILTIN_CAT_FEATURE,   "",                                      "贪吃蛇游戏" },
+    { "xsort",     cmd_xsort,      P|X,      BUILTIN_CAT_TEXT,      "-r -n -u --help",                       "排序文件内容（-r, -n, -u）" },
+    { "xsource",   cmd_xsource,    M,        BUILTIN_CAT_UTIL,      "--help",                                "执行脚本文件" },
+    { "xsplit",    cmd_xsplit,     0,        BUILTIN_CAT_TEXT,      "-l -b --help",                          "分割文件" },
+    { "xstat",     cmd_xstat,      P,        BUILTIN_CAT_FILE,      "-c --help",                             "显示文件详细信息" },
+    { "xsysmon",   cmd_xsysmon,    I,        BUILTIN_CAT_FEATURE,   "",                                      "系统监控（CPU/内存/磁盘）" },
+    { "xtail",     cmd_xtail,      P|X,      BUILTIN_CAT_TEXT,      "-n --help",                             "显示文件后N行（-n N）" },
+    { "xtec",      cmd_xtec,       P|X,      BUILTIN_CAT_UTIL,      "-a --help",                             "Tee 功能（输出到文件和屏幕）" },
+    { "xtetris",   cmd_xtetris,    I,        BUILTIN_CAT_FEATURE,   "",                                      "俄罗斯方块游戏" },
+    { "xtime",     cmd_xtime,      M,        BUILTIN_CAT_UTIL,      "--help",                                "测量命令执行时间" },
+    { "xtouch",    cmd_xtouch,     0,        BUILTIN_CAT_FILE,      "--help",                                "创建文件或更新时间戳" },
+    { "xtr",       cmd_xtr,        P|X,      BUILTIN_CAT_TEXT,      "-d --help",                             "字符转换" },
+    { "xtree",     cmd_xtree,      P,        BUILTIN_CAT_DIR,       "-L --help",                             "树形显示目录结构（支持 -L 深度）" },
+    { "xtype",     cmd_xtype,      P,        BUILTIN_CAT_UTIL,      "--help",                                "显示命令类型" },
+    { "xui",       cmd_xui,        I,        BUILTIN_CAT_FEATURE,   "",                                      "交互式终端 UI 界面" },
+    { "xunalias",  cmd_xunalias,   M,        BUILTIN_CAT_ENV,       "--help",                                "删除命令别名" },
+    { "xuname",    cmd_xuname,     P,        BUILTIN_CAT_SYSINFO,   "-a -s -n -r -v -m --help",              "系统信息（-a, -s, -r, -m）" },
+    { "xuniq",     cmd_xuniq,      P|X,      BUILTIN_CAT_TEXT,      "-c -d -u --help",                       "去除重复行（-c, -d, -u）" },
+    { "xunset",    cmd_xunset,     M,        BUILTIN_CAT_ENV,       "--help",                                "删除环境变量" },
+    { "xuptime",   cmd_xuptime,    P,        BUILTIN_CAT_SYSINFO,   "--help",                                "系统运行时间" },
+    { "xwc",       cmd_xwc,        P|X,      BUILTIN_CAT_TEXT,      "-l -w -c --help",                       "统计行数/字数/字节数（-l, -w, -c）" },
+    { "xweb",      cmd_xweb,       I,        BUILTIN_CAT_FEATURE,   "--help",                                "网页浏览器（搜索引擎）" },
+    { "xwhich",    cmd_xwhich,     P,        BUILTIN_CAT_UTIL,      "--help",                                "显示命令路径" },
+    { "xwhoami",   cmd_xwhoami,    P,        BUILTIN_CAT_SYSINFO,   "--help",                                "当前用户" },
+    { "xxargs",    cmd_xxargs,     0,        BUILTIN_CAT_UTIL,      "-0 -d -n -P --help",                    "从标准输入构造参数并批量执行命令" },
+};
+
+#undef P
+#undef M
+#undef I
+#undef X
+
+#define BUILTIN_COUNT (int)(sizeof(g_builtins) / sizeof(g_builtins[0]))
+
+// 分类名称（顺序与 BuiltinCategory 一致）
+static const char *g_category_names[BUILTIN_CAT_COUNT] = {
+    "基础命令",
+    "文件操作",
+    "目录操作",
+    "权限与链接",
+    "文本处理",
+    "系统信息",
+    "环境变量和别名",
+    "进程与作业控制",
+    "实用工具",
+    "特色功能",
+};
+
+// bsearch 比较函数：key 是命令名，elem 是表项
+static int compare_entry(const void *key, const void *elem) {
+    return strcmp((const char *)key, ((const BuiltinEntry *)elem)->name);
+}
+
+// ============================================
+// 按命令名查找
+// ============================================
+const BuiltinEntry* builtin_lookup(const char *name) {
+    if (name == NULL) {
+        return NULL;
+    }
+    return bsearch(name, g_builtins, BUILTIN_COUNT, sizeof(BuiltinEntry), compare_entry);
+}
+
+const BuiltinEntry* builtin_table(int *count) {
+    if (count != NULL) {
+        *count = BUILTIN_COUNT;
+    }
+    return g_builtins;
+}
+
+const char* builtin_category_name(BuiltinCategory category) {
+    if (category < 0 || category >= BUILTIN_CAT_COUNT) {
+        return "";
+    }
+    return g_category_names[category];
+}
@@ -7,9 +7,12 @@
  *       xalias (显示所有别名)
  */
 
+#define _POSIX_C_SOURCE 200809L  // 启用 strndup
+
 #include "builtin.h"
 #include "alias.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 int cmd_xalias(Command *cmd, ShellContext *ctx) {
@@ -43,8 +46,9 @@ int cmd_xalias(Command *cmd, ShellContext *ctx) {
         printf("  xalias ll='xls -lah'\n");
         printf("  ll                         # 等同于 xls -lah\n\n");
         printf("注意:\n");
-        printf("  • 别名不能递归展开\n");
-        printf("  • 别名最多%d个\n", MAX_ALIASES);
+        printf("  • 别名可以指向另一个别名，但不会循环展开（如 ls='ls -la'）\n");
+        printf("  • 别名只能是简单命令，不能含有 | ; & 和重定向\n");
+        printf("  • 加引号的命令名不展开别名（如 \\ll 或 'll'）\n");
         printf("  • 别名仅在当前Shell会话中有效\n\n");
         printf("相关命令:\n");
         printf("  xunalias  - 删除别名\n\n");
@@ -74,50 +78,38 @@ int cmd_xalias(Command *cmd, ShellContext *ctx) {
                 return -1;
             }
             
-            char name[64];
-            if (name_len >= sizeof(name)) {
-                XSHELL_LOG_ERROR(ctx, "xalias: alias name too long\n");
-                return -1;
-            }
-            
-            strncpy(name, arg, name_len);
-            name[name_len] = '\0';
-            
             // 验证别名名称
             for (size_t j = 0; j < name_len; j++) {
-                char c = name[j];
+                char c = arg[j];
                 if (!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
                       (c >= '0' && c <= '9') || c == '_')) {
-                    XSHELL_LOG_ERROR(ctx, "xalias: invalid alias name: '%s'\n", name);
+                    XSHELL_LOG_ERROR(ctx, "xalias: invalid alias name: '%.*s'\n", (int)name_len, arg);
                     return -1;
                 }
             }
             
-            // 获取值（去除引号）
+            // 获取值（去除首尾的单引号或双引号）
             const char *value = eq + 1;
-            char value_buf[256];
             size_t value_len = strlen(value);
-            
-            // 去除首尾的单引号或双引号
             if (value_len >= 2 &&
                 ((value[0] == '\'' && value[value_len - 1] == '\'') ||
                  (value[0] == '"' && value[value_len - 1] == '"'))) {
-                if (value_len - 2 >= sizeof(value_buf)) {
-                    XSHELL_LOG_ERROR(ctx, "xalias: alias value too long\n");
-                    return -1;
-                }
-                strncpy(value_buf, value + 1, value_len - 2);
-                value_buf[value_len - 2] = '\0';
-                value = value_buf;
+                value++;
+                value_len -= 2;
             }
             
-            // 设置别名
-            if (alias_get(name) == NULL && alias_count() >= MAX_ALIASES) {
-                XSHELL_LOG_ERROR(ctx, "xalias: too many aliases (max %d)\n", MAX_ALIASES);
-                return -1;
+            // 设置别名（定义时就切分成单词，见 alias.c）
+            char *name = strndup(arg, name_len);
+            char *value_copy = strndup(value, value_len);
+            int ret = (name != NULL && value_copy != NULL) ? alias_set(name, value_copy) : ALIAS_ERROR;
+            if (ret == ALIAS_NOT_SIMPLE) {
+                XSHELL_LOG_ERROR(ctx, "xalias: %s: alias value must be a simple command\n", name);
+            } else if (ret != 0) {
+                XSHELL_LOG_ERROR(ctx, "xalias: failed to set alias '%.*s'\n", (int)name_len, arg);
             }
-            if (alias_set(name, value) != 0) {
-                XSHELL_LOG_ERROR(ctx, "xalias: failed to set alias '%s'\n", name);
+            free(name);
+            free(value_copy);
+            if (ret != 0) {
                 return -1;
             }
         } else {
@@ -42,11 +42,9 @@ int cmd_xbg(Command *cmd, ShellContext *ctx) {
         job_id = atoi(arg);
     } else {
         // 没有指定，找最后一个停止的作业
-        for (int i = 1; i <= 64; i++) {
-            Job *job = job_get(i);
-            if (job != NULL && job->status == JOB_STOPPED) {
-                job_id = i;
-            }
+        Job *latest = job_latest(JOB_STOPPED);
+        if (latest != NULL) {
+            job_id = latest->id;
         }
     }
     
@@ -66,8 +64,8 @@ int cmd_xbg(Command *cmd, ShellContext *ctx) {
         return -1;
     }
     
-    // 发送 SIGCONT 继续执行
-    kill(job->pid, SIGCONT);
+    // 向整个进程组发送 SIGCONT 继续执行
+    kill(-job->pgid, SIGCONT);
     job->status = JOB_RUNNING;
     
     printf("[%d]+ %s &\n", job->id, job->command);
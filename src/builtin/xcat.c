@@ -1,5 +1,6 @@
 // 引入自定义头文件
 #include "builtin.h"                // 内置命令函数声明
+#include "xio.h"                    // 内置命令标准流（xio_stdout 等）
 
 // 引入标准库
 #include <stdio.h>                  // 标准输入输出（printf, perror, fopen, fclose）
@@ -31,7 +32,7 @@ static int cat_file(const char *filename, int show_line_numbers,
     // 步骤1：打开文件
     // 特殊处理："-" 表示标准输入
     if (strcmp(filename, "-") == 0) {           // 文件名是 "-"
-        file = stdin;                           // 使用标准输入
+        file = xio_stdin;                       // 使用标准输入
     } else {                                    // 普通文件
         // 先检查是否是目录
         struct stat st;
@@ -49,11 +50,27 @@ static int cat_file(const char *filename, int show_line_numbers,
         }
     }
 
+    // 步骤2（快速路径）：没有任何显示选项时按块复制，不逐字符处理
+    if (!show_line_numbers && !show_all && !show_tabs) {
+        char block[XIO_BLOCK_SIZE];
+        size_t n;
+        FILE *out = xio_stdout;
+        while ((n = fread(block, 1, sizeof(block), file)) > 0) {
+            if (fwrite(block, 1, n, out) != n) {
+                break;                          // 下游已关闭（如 | xhead），不必再读
+            }
+        }
+        if (file != xio_stdin) {
+            fclose(file);
+        }
+        return 0;
+    }
+
     // 步骤2：逐字符读取并输出文件内容
     while ((ch = fgetc(file)) != EOF) {         // 读取一个字符，直到文件结束（EOF）
         // 如果需要显示行号，且当前在行首，则输出行号
         if (show_line_numbers && *at_line_start) {
-            printf("%6d  ", *line_number);      // 输出行号（右对齐，6位宽）
+            fprintf(xio_stdout, "%6d  ", *line_number); // 输出行号（右对齐，6位宽）
             *at_line_start = 0;                 // 标记已经不在行首
         }
 
@@ -61,23 +78,23 @@ static int cat_file(const char *filename, int show_line_numbers,
         if (show_all) {
             // -A 选项：显示所有不可见字符
             if (ch == '\t') {
-                printf("^I");                   // 制表符显示为 ^I
+                fprintf(xio_stdout, "^I");      // 制表符显示为 ^I
             } else if (ch == '\n') {
-                printf("$\n");                  // 换行符显示为 $ 后跟换行
+                fprintf(xio_stdout, "$\n");     // 换行符显示为 $ 后跟换行
                 (*line_number)++;               // 行号加1
                 *at_line_start = 1;             // 标记下一个字符在行首
             } else if (ch < 32 || ch == 127) {
                 // 其他控制字符显示为 ^X
-                printf("^%c", ch + 64);
+                fprintf(xio_stdout, "^%c", ch + 64);
             } else {
-                putchar(ch);                    // 普通字符直接输出
+                xio_putchar(ch);                // 普通字符直接输出
             }
         } else if (show_tabs && ch == '\t') {
             // -T 选项：只显示制表符
-            printf("^I");                       // 制表符显示为 ^I
+            fprintf(xio_stdout, "^I");          // 制表符显示为 ^I
         } else {
             // 普通模式：直接输出字符
-            putchar(ch);                        // 输出字符到标准输出
+            xio_putchar(ch);                    // 输出字符到标准输出
             if (ch == '\n') {                   // 遇到换行符
                 (*line_number)++;               // 行号加1
                 *at_line_start = 1;             // 标记下一个字符在行首
@@ -87,7 +104,7 @@ static int cat_file(const char *filename, int show_line_numbers,
 
     // 步骤3：关闭文件
     // 注意：不关闭标准输入（stdin）
-    if (file != stdin) {                        // 如果不是标准输入
+    if (file != xio_stdin) {                    // 如果不是标准输入
         fclose(file);                           // 关闭文件，释放资源
     }
 
@@ -126,33 +143,33 @@ int cmd_xcat(Command *cmd, ShellContext *ctx) {
 
     // 步骤0：检查是否请求帮助信息
     if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
-        printf("xcat - 连接文件并打印到标准输出\n\n");
-        printf("用法:\n");
-        printf("  xcat [选项] [文件...] [--help]\n\n");
-        printf("说明:\n");
-        printf("  连接文件内容并打印到标准输出。\n");
-        printf("  若没有指定文件，或文件名为 -，则从标准输入读取。\n\n");
-        printf("参数:\n");
-        printf("  文件      要显示的文件名（可以指定多个）\n");
-        printf("  -         表示标准输入\n\n");
-        printf("选项:\n");
-        printf("  -n        显示行号\n");
-        printf("  -A        显示所有不可见字符（制表符显示为 ^I，行尾显示为 $）\n");
-        printf("  -T        显示制表符为 ^I\n");
-        printf("  --help    显示此帮助信息\n\n");
-        printf("示例:\n");
-        printf("  xcat file.txt              # 显示文件内容\n");
-        printf("  xcat file1 file2           # 连接显示多个文件\n");
-        printf("  xcat -n file.txt           # 显示内容并加行号\n");
-        printf("  xcat -A file.txt           # 显示所有不可见字符\n");
-        printf("  xcat -T file.txt            # 显示制表符为 ^I\n");
-        printf("  xcat -                     # 从标准输入读取\n");
-        printf("  xecho \"Hello\" | xcat -     # 管道使用（未来支持）\n\n");
-        printf("行为说明:\n");
-        printf("  • 多个文件会按顺序连接显示\n");
-        printf("  • -n 选项会在每行前显示行号\n");
-        printf("  • 无参数时从标准输入读取\n\n");
-        printf("对应系统命令: cat\n");
+        fprintf(xio_stdout, "xcat - 连接文件并打印到标准输出\n\n");
+        fprintf(xio_stdout, "用法:\n");
+        fprintf(xio_stdout, "  xcat [选项] [文件...] [--help]\n\n");
+        fprintf(xio_stdout, "说明:\n");
+        fprintf(xio_stdout, "  连接文件内容并打印到标准输出。\n");
+        fprintf(xio_stdout, "  若没有指定文件，或文件名为 -，则从标准输入读取。\n\n");
+        fprintf(xio_stdout, "参数:\n");
+        fprintf(xio_stdout, "  文件      要显示的文件名（可以指定多个）\n");
+        fprintf(xio_stdout, "  -         表示标准输入\n\n");
+        fprintf(xio_stdout, "选项:\n");
+        fprintf(xio_stdout, "  -n        显示行号\n");
+        fprintf(xio_stdout, "  -A        显示所有不可见字符（制表符显示为 ^I，行尾显示为 $）\n");
+        fprintf(xio_stdout, "  -T        显示制表符为 ^I\n");
+        fprintf(xio_stdout, "  --help    显示此帮助信息\n\n");
+        fprintf(xio_stdout, "示例:\n");
+        fprintf(xio_stdout, "  xcat file.txt              # 显示文件内容\n");
+        fprintf(xio_stdout, "  xcat file1 file2           # 连接显示多个文件\n");
+        fprintf(xio_stdout, "  xcat -n file.txt           # 显示内容并加行号\n");
+        fprintf(xio_stdout, "  xcat -A file.txt           # 显示所有不可见字符\n");
+        fprintf(xio_stdout, "  xcat -T file.txt            # 显示制表符为 ^I\n");
+        fprintf(xio_stdout, "  xcat -                     # 从标准输入读取\n");
+        fprintf(xio_stdout, "  xecho \"Hello\" | xcat -     # 管道使用（未来支持）\n\n");
+        fprintf(xio_stdout, "行为说明:\n");
+        fprintf(xio_stdout, "  • 多个文件会按顺序连接显示\n");
+        fprintf(xio_stdout, "  • -n 选项会在每行前显示行号\n");
+        fprintf(xio_stdout, "  • 无参数时从标准输入读取\n\n");
+        fprintf(xio_stdout, "对应系统命令: cat\n");
         return 0;
     }
 
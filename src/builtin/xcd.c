@@ -1,6 +1,7 @@
 // 引入自定义头文件
 #include "builtin.h"                        // 内置命令函数声明
 #include "utils.h"                          // 工具函数（normalize_path）
+#include "frecency.h"                       // 目录得分（frecency_find_dir）
 
 // 引入标准库
 #include <stdio.h>                          // 标准输入输出（perror）
@@ -16,12 +17,14 @@
 //   [\home\user\]# xcd /tmp      -> 切换到 /tmp
 //   [\tmp\]# xcd                 -> 返回主目录
 //   [\home\user\]# xcd .         -> 返回上一个目录
+//   [\home\user\]# xcd -z proj   -> 跳转到常用的、名字含 proj 的目录
 int cmd_xcd(Command *cmd, ShellContext *ctx) {
     // 步骤0：检查是否请求帮助信息
     if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
         printf("xcd - 切换工作目录\n\n");
         printf("用法:\n");
-        printf("  xcd [目录] [--help]\n\n");
+        printf("  xcd [目录] [--help]\n");
+        printf("  xcd -z 关键字...\n\n");
         printf("说明:\n");
         printf("  改变当前工作目录。\n");
         printf("  Change Directory - 切换目录。\n\n");
@@ -35,6 +38,9 @@ int cmd_xcd(Command *cmd, ShellContext *ctx) {
         printf("            - .  ：当前目录（不变）\n");
         printf("            - .. ：上级目录\n\n");
         printf("选项:\n");
+        printf("  -z 关键字 跳转到匹配关键字的目录中最常用、最近使用的一个\n");
+        printf("            （关键字按顺序出现在路径中，最后一个在最后一级目录名中；\n");
+        printf("             没有时按字母顺序模糊匹配，如 prj 匹配 project）\n");
         printf("  --help    显示此帮助信息\n\n");
         printf("特性:\n");
         printf("  • 支持 Windows 风格路径（自动转换 \\ 为 /）\n");
@@ -46,7 +52,8 @@ int cmd_xcd(Command *cmd, ShellContext *ctx) {
         printf("  xcd /tmp         # 切换到 /tmp\n");
         printf("  xcd ..           # 上级目录\n");
         printf("  xcd LJ/XShell    # 相对路径\n");
-        printf("  xcd LJ\\XShell    # Windows 风格\n\n");
+        printf("  xcd LJ\\XShell    # Windows 风格\n");
+        printf("  xcd -z proj      # 跳转到常用的 ~/work/project\n\n");
         printf("对应系统命令: cd\n");
         return 0;
     }
@@ -54,7 +61,22 @@ int cmd_xcd(Command *cmd, ShellContext *ctx) {
     char *target_dir = NULL;                // 目标目录指针
     
     // 步骤1：根据参数量确定目标目录
-    if (cmd->arg_count == 1) {
+    if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "-z") == 0) {
+        // xcd -z 关键字... -> 按得分查找去过的目录
+        if (cmd->arg_count == 2) {
+            XSHELL_LOG_ERROR(ctx, "xcd: -z: keyword required\n");
+            return -1;
+        }
+        const char *found = frecency_find_dir(cmd->args + 2, cmd->arg_count - 2, ctx->cwd);
+        if (found == NULL) {
+            XSHELL_LOG_ERROR(ctx, "xcd: -z: no match for '%s'\n", cmd->args[2]);
+            return -1;
+        }
+        static char jump_path[PATH_MAX];
+        snprintf(jump_path, sizeof(jump_path), "%s", found);
+        target_dir = jump_path;
+    }
+    else if (cmd->arg_count == 1) {
         // 情况1：无参数->返回用户主目录
         target_dir = ctx->home_dir;
     }
@@ -12,6 +12,7 @@
  */
 
 #include "builtin.h"
+#include "xio.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -115,7 +116,7 @@ int cmd_xcomm(Command *cmd, ShellContext *ctx) {
     FILE *f1, *f2;
     
     if (strcmp(file1, "-") == 0) {
-        f1 = stdin;
+        f1 = xio_stdin;
     } else {
         f1 = fopen(file1, "r");
         if (f1 == NULL) {
@@ -125,12 +126,12 @@ int cmd_xcomm(Command *cmd, ShellContext *ctx) {
     }
     
     if (strcmp(file2, "-") == 0) {
-        f2 = stdin;
+        f2 = xio_stdin;
     } else {
         f2 = fopen(file2, "r");
         if (f2 == NULL) {
             XSHELL_LOG_ERROR(ctx, "xcomm: %s: %s\n", file2, strerror(errno));
-            if (f1 != stdin) fclose(f1);
+            if (f1 != xio_stdin) fclose(f1);
             return -1;
         }
     }
@@ -180,8 +181,8 @@ int cmd_xcomm(Command *cmd, ShellContext *ctx) {
     }
     
     // 关闭文件
-    if (f1 != stdin) fclose(f1);
-    if (f2 != stdin) fclose(f2);
+    if (f1 != xio_stdin) fclose(f1);
+    if (f2 != xio_stdin) fclose(f2);
     
     return 0;
 }
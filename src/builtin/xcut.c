@@ -12,6 +12,7 @@
  */
 
 #include "builtin.h"
+#include "xio.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -31,16 +32,16 @@ typedef struct {
 
 // 显示帮助信息
 static void show_help(const char *cmd_name) {
-    printf("用法: %s [选项] [文件...]\n", cmd_name);
-    printf("功能: 从文件中提取指定的列（字段）\n");
-    printf("选项:\n");
-    printf("  -d <分隔符>    指定字段分隔符（默认制表符）\n");
-    printf("  -f <字段列表>  指定要提取的字段（如 1,2,3 或 1-3）\n");
-    printf("  -c <字符位置>  指定要提取的字符位置（如 1-10）\n");
-    printf("  -h, --help     显示此帮助信息\n");
-    printf("示例:\n");
-    printf("  %s -d: -f1 /etc/passwd\n", cmd_name);
-    printf("  %s -c1-10 file.txt\n", cmd_name);
+    fprintf(xio_stdout, "用法: %s [选项] [文件...]\n", cmd_name);
+    fprintf(xio_stdout, "功能: 从文件中提取指定的列（字段）\n");
+    fprintf(xio_stdout, "选项:\n");
+    fprintf(xio_stdout, "  -d <分隔符>    指定字段分隔符（默认制表符）\n");
+    fprintf(xio_stdout, "  -f <字段列表>  指定要提取的字段（如 1,2,3 或 1-3）\n");
+    fprintf(xio_stdout, "  -c <字符位置>  指定要提取的字符位置（如 1-10）\n");
+    fprintf(xio_stdout, "  -h, --help     显示此帮助信息\n");
+    fprintf(xio_stdout, "示例:\n");
+    fprintf(xio_stdout, "  %s -d: -f1 /etc/passwd\n", cmd_name);
+    fprintf(xio_stdout, "  %s -c1-10 file.txt\n", cmd_name);
 }
 
 // 解析字段规格（如 "1,2,3" 或 "1-3"）
@@ -126,12 +127,10 @@ static int process_file_fields(FILE *file, const CutOptions *opts, const char *f
                 for (int j = 0; j < field_count; j++) {
                     if (fields[j] == field_num) {
                         if (output_count > 0) {
-                            putchar(opts->delimiter);
+                            xio_putchar(opts->delimiter);
                         }
                         // 输出字段
-                        for (size_t k = 0; k < (size_t)(line + i - token); k++) {
-                            putchar(token[k]);
-                        }
+                        fwrite(token, 1, (size_t)(line + i - token), xio_stdout);
                         output_count++;
                         break;
                     }
@@ -142,7 +141,7 @@ static int process_file_fields(FILE *file, const CutOptions *opts, const char *f
             }
         }
         
-        putchar('\n');
+        xio_putchar('\n');
     }
     
     return 0;
@@ -182,13 +181,11 @@ static int process_file_chars(FILE *file, const CutOptions *opts, const char *fi
                 end_idx = len - 1;
             }
             
-            for (int i = start_idx; i <= end_idx && i < (int)len; i++) {
-                putchar(line[i]);
-            }
+            fwrite(line + start_idx, 1, (size_t)(end_idx - start_idx + 1), xio_stdout);
         }
         
         if (has_newline) {
-            putchar('\n');
+            xio_putchar('\n');
         }
     }
     
@@ -269,7 +266,7 @@ int cmd_xcut(Command *cmd, ShellContext *ctx) {
         FILE *file;
         
         if (strcmp(filename, "-") == 0) {
-            file = stdin;
+            file = xio_stdin;
             filename = "(standard input)";
         } else {
             file = fopen(filename, "r");
@@ -287,7 +284,7 @@ int cmd_xcut(Command *cmd, ShellContext *ctx) {
             process_file_chars(file, &opts, filename);
         }
         
-        if (file != stdin) {
+        if (file != xio_stdin) {
             fclose(file);
         }
     }
@@ -295,9 +292,9 @@ int cmd_xcut(Command *cmd, ShellContext *ctx) {
     // 如果没有文件，从标准输入读取
     if (!has_files) {
         if (opts.use_fields) {
-            process_file_fields(stdin, &opts, "(standard input)", ctx);
+            process_file_fields(xio_stdin, &opts, "(standard input)", ctx);
         } else {
-            process_file_chars(stdin, &opts, "(standard input)");
+            process_file_chars(xio_stdin, &opts, "(standard input)");
         }
     }
     
@@ -10,6 +10,7 @@
  */
 
 #include "builtin.h"
+#include "xio.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -45,7 +46,7 @@ static int read_file_lines(const char *filename, char ***lines, int *line_count,
     
     // 打开文件
     if (strcmp(filename, "-") == 0) {
-        file = stdin;
+        file = xio_stdin;
     } else {
         file = fopen(filename, "r");
         if (file == NULL) {
@@ -57,7 +58,7 @@ static int read_file_lines(const char *filename, char ***lines, int *line_count,
     // 分配初始内存
     line_array = (char**)malloc(capacity * sizeof(char*));
     if (line_array == NULL) {
-        if (file != stdin) fclose(file);
+        if (file != xio_stdin) fclose(file);
         XSHELL_LOG_PERROR(ctx, "xdiff");
         return -1;
     }
@@ -74,7 +75,7 @@ static int read_file_lines(const char *filename, char ***lines, int *line_count,
                     free(line_array[i]);
                 }
                 free(line_array);
-                if (file != stdin) fclose(file);
+                if (file != xio_stdin) fclose(file);
                 XSHELL_LOG_PERROR(ctx, "xdiff");
                 return -1;
             }
@@ -90,7 +91,7 @@ static int read_file_lines(const char *filename, char ***lines, int *line_count,
                 free(line_array[i]);
             }
             free(line_array);
-            if (file != stdin) fclose(file);
+            if (file != xio_stdin) fclose(file);
             XSHELL_LOG_PERROR(ctx, "xdiff");
             return -1;
         }
@@ -104,7 +105,7 @@ static int read_file_lines(const char *filename, char ***lines, int *line_count,
         }
     }
     
-    if (file != stdin) {
+    if (file != xio_stdin) {
         fclose(file);
     }
     
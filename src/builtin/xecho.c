@@ -6,6 +6,7 @@
 
 // 引入自定义头文件
 #include "builtin.h"                        // 内置命令函数声明
+#include "xio.h"                            // 内置命令标准流（xio_stdout 等）
 #include "utils.h"                          // 工具函数（彩色输出）
 
 // 引入标准库
@@ -43,7 +44,7 @@ static void print_with_escapes(const char *str, int *stop_output) {
     for (int i = 0; str[i] != '\0'; i++) {
         // 如果当前字符不是反斜杠，直接输出
         if (str[i] != '\\') {
-            putchar(str[i]);                // 输出普通字符
+            xio_putchar(str[i]);            // 输出普通字符
             continue;                       // 继续下一个字符
         }
 
@@ -52,41 +53,41 @@ static void print_with_escapes(const char *str, int *stop_output) {
         
         // 如果反斜杠是字符串的最后一个字符，直接输出反斜杠
         if (str[i] == '\0') {
-            putchar('\\');                  // 输出反斜杠本身
+            xio_putchar('\\');              // 输出反斜杠本身
             break;                          // 字符串结束
         }
 
         // 根据转义字符类型进行处理
         switch (str[i]) {
             case '\\':                      // \\ → 反斜杠
-                putchar('\\');
+                xio_putchar('\\');
                 break;
             case 'a':                       // \a → 响铃（ASCII 7）
-                putchar('\a');
+                xio_putchar('\a');
                 break;
             case 'b':                       // \b → 退格
-                putchar('\b');
+                xio_putchar('\b');
                 break;
             case 'c':                       // \c → 停止输出
                 *stop_output = 1;           // 设置停止标志
                 return;                     // 立即返回，不再输出任何内容
             case 'e':                       // \e → ESC（ASCII 27）
-                putchar('\033');            // 八进制 033 = 十进制 27
+                xio_putchar('\033');        // 八进制 033 = 十进制 27
                 break;
             case 'f':                       // \f → 换页
-                putchar('\f');
+                xio_putchar('\f');
                 break;
             case 'n':                       // \n → 换行
-                putchar('\n');
+                xio_putchar('\n');
                 break;
             case 'r':                       // \r → 回车
-                putchar('\r');
+                xio_putchar('\r');
                 break;
             case 't':                       // \t → 水平制表符
-                putchar('\t');
+                xio_putchar('\t');
                 break;
             case 'v':                       // \v → 垂直制表符
-                putchar('\v');
+                xio_putchar('\v');
                 break;
             
             // 八进制转义序列：\0nnn（1-3位八进制数字）
@@ -106,11 +107,11 @@ static void print_with_escapes(const char *str, int *stop_output) {
                 
                 // 如果至少读取了1位数字，输出转换后的字符
                 if (digits_read > 0) {
-                    putchar(octal_value & 0xFF);
+                    xio_putchar(octal_value & 0xFF);
                     i = j - 1;              // 更新索引（-1 是因为循环会 i++）
                 } else {
                     // 如果没有读取到数字，输出 \0（空字符）
-                    putchar('\0');
+                    xio_putchar('\0');
                 }
                 break;
             }
@@ -136,11 +137,11 @@ static void print_with_escapes(const char *str, int *stop_output) {
                 
                 // 如果没有有效的十六进制数字，输出 \x 字面量
                 if (j == i + 1) {
-                    putchar('\\');          // 输出反斜杠
-                    putchar('x');           // 输出 x
+                    xio_putchar('\\');      // 输出反斜杠
+                    xio_putchar('x');       // 输出 x
                 } else {
                     // 输出转换后的字符
-                    putchar(hex_value & 0xFF);
+                    xio_putchar(hex_value & 0xFF);
                     i = j - 1;              // 更新索引
                 }
                 break;
@@ -148,8 +149,8 @@ static void print_with_escapes(const char *str, int *stop_output) {
             
             // 未识别的转义序列：输出反斜杠和字符本身
             default:
-                putchar('\\');              // 输出反斜杠
-                putchar(str[i]);            // 输出原字符
+                xio_putchar('\\');          // 输出反斜杠
+                xio_putchar(str[i]);        // 输出原字符
                 break;
         }
     }
@@ -191,40 +192,40 @@ int cmd_xecho(Command *cmd, ShellContext *ctx) {
 
     // 步骤0.5：检查是否请求帮助信息
     if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
-        printf("xecho - 输出字符串到标准输出\n\n");
-        printf("用法:\n");
-        printf("  xecho [选项] [字符串...] [--help]\n\n");
-        printf("说明:\n");
-        printf("  输出字符串到标准输出。\n");
-        printf("  Echo - 回显字符串。\n\n");
-        printf("选项:\n");
-        printf("  -n        不输出换行符（默认会在末尾输出换行）\n");
-        printf("  -e        启用转义字符解释\n");
-        printf("  -E        禁用转义字符解释（默认）\n");
-        printf("  --help    显示此帮助信息\n\n");
-        printf("转义序列（需要 -e 选项）:\n");
-        printf("  \\\\        反斜杠\n");
-        printf("  \\a        响铃（BEL）\n");
-        printf("  \\b        退格\n");
-        printf("  \\c        停止输出（包括换行符）\n");
-        printf("  \\e        ESC 字符\n");
-        printf("  \\f        换页\n");
-        printf("  \\n        换行\n");
-        printf("  \\r        回车\n");
-        printf("  \\t        水平制表符\n");
-        printf("  \\v        垂直制表符\n");
-        printf("  \\0nnn     八进制值（1-3 位）\n");
-        printf("  \\xHH      十六进制值（1-2 位）\n\n");
-        printf("示例:\n");
-        printf("  xecho Hello World            # 基本输出\n");
-        printf("  xecho -n Hello               # 不换行\n");
-        printf("  xecho -e \"Line1\\nLine2\"     # 多行\n");
-        printf("  xecho -e \"Tab\\there\"        # 制表符\n");
-        printf("  xecho -ne \"No\\nnewline\"     # 组合选项\n");
-        printf("  xecho -e \"\\x48\\x65\\x6c\\x6c\\x6f\"  # 十六进制（Hello）\n");
-        printf("  xecho -c red \"Error message\"  # 红色输出\n");
-        printf("  xecho -c green \"Success\"     # 绿色输出\n\n");
-        printf("对应系统命令: echo\n");
+        fprintf(xio_stdout, "xecho - 输出字符串到标准输出\n\n");
+        fprintf(xio_stdout, "用法:\n");
+        fprintf(xio_stdout, "  xecho [选项] [字符串...] [--help]\n\n");
+        fprintf(xio_stdout, "说明:\n");
+        fprintf(xio_stdout, "  输出字符串到标准输出。\n");
+        fprintf(xio_stdout, "  Echo - 回显字符串。\n\n");
+        fprintf(xio_stdout, "选项:\n");
+        fprintf(xio_stdout, "  -n        不输出换行符（默认会在末尾输出换行）\n");
+        fprintf(xio_stdout, "  -e        启用转义字符解释\n");
+        fprintf(xio_stdout, "  -E        禁用转义字符解释（默认）\n");
+        fprintf(xio_stdout, "  --help    显示此帮助信息\n\n");
+        fprintf(xio_stdout, "转义序列（需要 -e 选项）:\n");
+        fprintf(xio_stdout, "  \\\\        反斜杠\n");
+        fprintf(xio_stdout, "  \\a        响铃（BEL）\n");
+        fprintf(xio_stdout, "  \\b        退格\n");
+        fprintf(xio_stdout, "  \\c        停止输出（包括换行符）\n");
+        fprintf(xio_stdout, "  \\e        ESC 字符\n");
+        fprintf(xio_stdout, "  \\f        换页\n");
+        fprintf(xio_stdout, "  \\n        换行\n");
+        fprintf(xio_stdout, "  \\r        回车\n");
+        fprintf(xio_stdout, "  \\t        水平制表符\n");
+        fprintf(xio_stdout, "  \\v        垂直制表符\n");
+        fprintf(xio_stdout, "  \\0nnn     八进制值（1-3 位）\n");
+        fprintf(xio_stdout, "  \\xHH      十六进制值（1-2 位）\n\n");
+        fprintf(xio_stdout, "示例:\n");
+        fprintf(xio_stdout, "  xecho Hello World            # 基本输出\n");
+        fprintf(xio_stdout, "  xecho -n Hello               # 不换行\n");
+        fprintf(xio_stdout, "  xecho -e \"Line1\\nLine2\"     # 多行\n");
+        fprintf(xio_stdout, "  xecho -e \"Tab\\there\"        # 制表符\n");
+        fprintf(xio_stdout, "  xecho -ne \"No\\nnewline\"     # 组合选项\n");
+        fprintf(xio_stdout, "  xecho -e \"\\x48\\x65\\x6c\\x6c\\x6f\"  # 十六进制（Hello）\n");
+        fprintf(xio_stdout, "  xecho -c red \"Error message\"  # 红色输出\n");
+        fprintf(xio_stdout, "  xecho -c green \"Success\"     # 绿色输出\n\n");
+        fprintf(xio_stdout, "对应系统命令: echo\n");
         return 0;
     }
 
@@ -281,7 +282,7 @@ end_option_parsing:
     
     // 如果指定了颜色，输出颜色代码
     if (color != NULL) {
-        printf("%s", set_color(color));
+        fprintf(xio_stdout, "%s", set_color(color));
     }
 
     // 步骤3：输出所有参数
@@ -294,30 +295,30 @@ end_option_parsing:
             print_with_escapes(cmd->args[i], &stop_output);
         } else {
             // 不解释转义字符，直接输出
-            printf("%s", cmd->args[i]);
+            fprintf(xio_stdout, "%s", cmd->args[i]);
         }
         
         // 如果不是最后一个参数且未停止输出，输出空格分隔符
         if (i < cmd->arg_count - 1 && !stop_output) {
-            putchar(' ');
+            xio_putchar(' ');
         }
     }
 
     // 步骤4：根据选项决定是否输出换行符
     // 如果没有 -n 选项且未遇到 \c，则输出换行符
     if (!no_newline && !stop_output) {
-        putchar('\n');
+        xio_putchar('\n');
     }
     
     // 如果指定了颜色，重置颜色
     if (color != NULL) {
-        printf("%s", reset_color());
+        fprintf(xio_stdout, "%s", reset_color());
     }
     
     // 步骤5：如果使用了 \c 停止输出，确保输出缓冲区被刷新
     // 这样即使没有换行符，输出也会立即显示
     if (stop_output) {
-        fflush(stdout);
+        fflush(xio_stdout);
     }
 
     // 步骤6：返回成功状态
@@ -8,13 +8,10 @@
  */
 
 #include "builtin.h"
+#include "vars.h"
 #include <stdio.h>
 #include <string.h>
 
-// 外部变量：指向环境变量数组
-// environ 是一个全局变量，包含所有环境变量
-extern char **environ;
-
 int cmd_xenv(Command *cmd, ShellContext *ctx) {
     // 显示帮助信息
     if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
@@ -54,13 +51,14 @@ int cmd_xenv(Command *cmd, ShellContext *ctx) {
         return -1;
     }
     
-    // 遍历并打印所有环境变量
-    if (environ == NULL) {
+    // 遍历并打印所有导出的变量（即子进程得到的环境）
+    char **envp = vars_envp(&ctx->vars);
+    if (envp == NULL) {
         XSHELL_LOG_ERROR(ctx, "xenv: no environment available\n");
         return -1;
     }
     
-    for (char **env = environ; *env != NULL; env++) {
+    for (char **env = envp; *env != NULL; env++) {
         printf("%s\n", *env);
     }
     
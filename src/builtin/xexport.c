@@ -1,39 +1,38 @@
 /*
  * xexport.c - 设置环境变量
  * 
- * 功能：设置或导出环境变量
+ * 功能：设置或导出环境变量（保存在 Shell 变量表中，标记为导出）
  * 用法：xexport VAR=value
- *       xexport VAR (显示指定变量)
+ *       xexport VAR (导出已有的 Shell 变量并显示)
  * 
  * 选项：
  *   -p    显示所有导出的变量（格式：export VAR="value"）
  *   --help 显示帮助信息
  */
 
-#define _POSIX_C_SOURCE 200809L  // 启用 setenv
-
 #include "builtin.h"
+#include "pathcache.h"
+#include "vars.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
-extern char **environ;
-
 // 显示单个环境变量
-static void print_export_var(const char *name) {
-    char *value = getenv(name);
+static void print_export_var(ShellContext *ctx, const char *name) {
+    const char *value = vars_get(&ctx->vars, name);
     if (value) {
         printf("export %s=\"%s\"\n", name, value);
     }
 }
 
-// 显示所有环境变量（export格式）
-static void print_all_exports(void) {
-    if (environ == NULL) {
+// 显示所有导出的变量（export格式）
+static void print_all_exports(ShellContext *ctx) {
+    char **envp = vars_envp(&ctx->vars);
+    if (envp == NULL) {
         return;
     }
     
-    for (char **env = environ; *env != NULL; env++) {
+    for (char **env = envp; *env != NULL; env++) {
         // 找到等号位置
         char *eq = strchr(*env, '=');
         if (eq) {
@@ -55,7 +54,7 @@ int cmd_xexport(Command *cmd, ShellContext *ctx) {
         printf("xexport - 设置环境变量\n\n");
         printf("用法:\n");
         printf("  xexport VAR=value          # 设置环境变量\n");
-        printf("  xexport VAR                # 显示指定变量\n");
+        printf("  xexport VAR                # 导出已有变量并显示\n");
         printf("  xexport -p                 # 显示所有导出的变量\n");
         printf("  xexport                    # 显示所有导出的变量\n\n");
         printf("说明:\n");
@@ -63,7 +62,7 @@ int cmd_xexport(Command *cmd, ShellContext *ctx) {
         printf("  Export - 导出。\n\n");
         printf("参数:\n");
         printf("  VAR=value 变量名和值，用等号连接\n");
-        printf("  VAR       只显示指定变量的值\n\n");
+        printf("  VAR       导出已有的 Shell 变量（如 VAR=1 设置的）并显示\n\n");
         printf("选项:\n");
         printf("  -p        以 export 格式显示所有变量\n");
         printf("  --help    显示此帮助信息\n\n");
@@ -96,7 +95,7 @@ int cmd_xexport(Command *cmd, ShellContext *ctx) {
     
     // 没有参数：显示所有导出的变量
     if (cmd->arg_count == 1 || (print_format && cmd->arg_count == 2)) {
-        print_all_exports();
+        print_all_exports(ctx);
         return 0;
     }
     
@@ -140,17 +139,25 @@ int cmd_xexport(Command *cmd, ShellContext *ctx) {
                 }
             }
             
-            // 设置环境变量
+            // 设置环境变量（同时写回进程环境，见 vars.c）
             const char *value = eq + 1;
             
-            if (setenv(name, value, 1) != 0) {
+            if (vars_set(&ctx->vars, name, value, VAR_EXPORT) != 0) {
                 XSHELL_LOG_PERROR(ctx, "xexport");
                 XSHELL_LOG_ERROR(ctx, "Failed to set environment variable %s\n", name);
                 return -1;
             }
+            
+            // PATH 改变后，之前缓存的命令路径全部失效
+            if (strcmp(name, "PATH") == 0) {
+                path_cache_clear();
+            }
         } else {
-            // VAR 格式：显示指定变量
-            print_export_var(arg);
+            // VAR 格式：把已有的 Shell 变量标记为导出，并显示
+            if (vars_export(&ctx->vars, arg) == 0 && strcmp(arg, "PATH") == 0) {
+                path_cache_clear();
+            }
+            print_export_var(ctx, arg);
         }
     }
     
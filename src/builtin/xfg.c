@@ -10,7 +10,6 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <sys/wait.h>
 #include <signal.h>
 
 int cmd_xfg(Command *cmd, ShellContext *ctx) {
@@ -44,11 +43,9 @@ int cmd_xfg(Command *cmd, ShellContext *ctx) {
         job_id = atoi(arg);
     } else {
         // 没有指定，找最后一个运行中的作业
-        for (int i = 1; i <= 64; i++) {
-            Job *job = job_get(i);
-            if (job != NULL && job->status == JOB_RUNNING) {
-                job_id = i;
-            }
+        Job *latest = job_latest(JOB_RUNNING);
+        if (latest != NULL) {
+            job_id = latest->id;
         }
     }
     
@@ -65,17 +62,16 @@ int cmd_xfg(Command *cmd, ShellContext *ctx) {
     
     printf("%s\n", job->command);
     
-    // 如果是停止状态，发送 SIGCONT
+    // 如果是停止状态，向整个进程组发送 SIGCONT
     if (job->status == JOB_STOPPED) {
-        kill(job->pid, SIGCONT);
+        kill(-job->pgid, SIGCONT);
         job->status = JOB_RUNNING;
     }
     
-    // 等待进程完成
-    int status;
-    waitpid(job->pid, &status, WUNTRACED);
+    // 等待管道中的每个进程完成（任何一个停止，作业就是停止状态）
+    bool stopped = job_wait(job);
     
-    if (WIFSTOPPED(status)) {
+    if (stopped) {
         job->status = JOB_STOPPED;
         printf("\n[%d]+  Stopped                 %s\n", job->id, job->command);
     } else {
@@ -14,6 +14,7 @@
  */
 
 #include "builtin.h"
+#include "xio.h"
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
@@ -76,19 +77,48 @@ static int is_whole_word_match(const char* text, const char* match_pos, const ch
     return 1;  // 是整词匹配
 }
 
+// 读取下一行（去掉换行符）
+// 说明：映射到内存的文件（*next 非 NULL）就地切分，否则用 fgets 读到 buffer
+// 返回：行的内容，没有更多行时返回 NULL
+static char* read_line(FILE* file, char* buffer, size_t size, char** next, char* end) {
+    if (*next == NULL) {
+        if (!fgets(buffer, size, file)) {
+            return NULL;
+        }
+        size_t len = strlen(buffer);
+        if (len > 0 && buffer[len - 1] == '\n') {
+            buffer[len - 1] = '\0';
+        }
+        return buffer;
+    }
+    if (*next >= end) {
+        return NULL;
+    }
+    char* line = *next;
+    char* newline = memchr(line, '\n', end - line);
+    if (newline != NULL) {
+        *newline = '\0';
+        *next = newline + 1;
+    } else {
+        *next = end;                                // 最后一行没有换行（映射保证其后是 '\0'）
+    }
+    return line;
+}
+
 // 在文件中搜索模式
 static int grep_file(const char* filename, const char* pattern, 
                      const GrepOptions* opts, int show_filename,
                      ShellContext *ctx) {
     FILE* file;
-    char line[4096];
+    char buffer[4096];
+    char* line;
     int line_num = 0;
     int match_count = 0;
     int found_match = 0;
     
     // 打开文件（"-" 表示标准输入）
     if (strcmp(filename, "-") == 0) {
-        file = stdin;
+        file = xio_stdin;
         filename = "(standard input)";
     } else {
         file = fopen(filename, "r");
@@ -98,16 +128,14 @@ static int grep_file(const char* filename, const char* pattern,
         }
     }
     
-    // 逐行读取
-    while (fgets(line, sizeof(line), file)) {
+    // 逐行读取：普通文件（包括 here-document 的内存文件）映射到内存后就地切分，不逐行复制
+    size_t map_len = 0;
+    char* data = xio_map(file, &map_len);
+    char* next = data;
+    char* end = (data != NULL) ? data + map_len : NULL;
+    while ((line = read_line(file, buffer, sizeof(buffer), &next, end)) != NULL) {
         line_num++;
         
-        // 移除行尾的换行符
-        size_t len = strlen(line);
-        if (len > 0 && line[len - 1] == '\n') {
-            line[len - 1] = '\0';
-        }
-        
         // 检查是否匹配
         int is_match = 0;
         
@@ -158,29 +186,30 @@ static int grep_file(const char* filename, const char* pattern,
             
             // 输出文件名（如果有多个文件）
             if (show_filename) {
-                printf("%s:", filename);
+                fprintf(xio_stdout, "%s:", filename);
             }
             
             // 输出行号
             if (opts->show_line_num) {
-                printf("%d:", line_num);
+                fprintf(xio_stdout, "%d:", line_num);
             }
             
             // 输出行内容
-            printf("%s\n", line);
+            fprintf(xio_stdout, "%s\n", line);
         }
     }
     
     // 如果只显示计数，输出计数结果
     if (opts->count_only) {
         if (show_filename) {
-            printf("%s:", filename);
+            fprintf(xio_stdout, "%s:", filename);
         }
-        printf("%d\n", match_count);
+        fprintf(xio_stdout, "%d\n", match_count);
     }
     
     // 关闭文件
-    if (file != stdin) {
+    xio_unmap(data, map_len);
+    if (file != xio_stdin) {
         fclose(file);
     }
     
@@ -190,34 +219,34 @@ static int grep_file(const char* filename, const char* pattern,
 int cmd_xgrep(Command* cmd, ShellContext* ctx) {
     // 显示帮助信息
     if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
-        printf("xgrep - 在文件中搜索文本\n\n");
-        printf("用法:\n");
-        printf("  xgrep [选项] <pattern> <file>...\n");
-        printf("  xgrep [选项] <pattern>            # 从标准输入读取\n\n");
-        printf("说明:\n");
-        printf("  在文件中搜索包含指定模式的行。\n");
-        printf("  Global Regular Expression Print - 全局正则表达式打印。\n\n");
-        printf("参数:\n");
-        printf("  pattern   要搜索的文本模式\n");
-        printf("  file      要搜索的文件（可以多个）\n");
-        printf("            使用 - 表示从标准输入读取\n\n");
-        printf("选项:\n");
-        printf("  -i        忽略大小写\n");
-        printf("  -n        显示行号\n");
-        printf("  -v        反向匹配（显示不匹配的行）\n");
-        printf("  -c        只显示匹配行的计数\n");
-        printf("  -w        整词匹配\n");
-        printf("  --help    显示此帮助信息\n\n");
-        printf("示例:\n");
-        printf("  xgrep hello file.txt           # 搜索包含 hello 的行\n");
-        printf("  xgrep -i hello file.txt        # 忽略大小写搜索\n");
-        printf("  xgrep -n error log.txt         # 显示行号\n");
-        printf("  xgrep -v comment file.c        # 显示不包含 comment 的行\n");
-        printf("  xgrep -c TODO *.txt            # 统计匹配行数\n");
-        printf("  xgrep -w apple file.txt        # 整词匹配\n");
-        printf("  xgrep -in error *.log          # 组合选项\n");
-        printf("  xcat file.txt | xgrep pattern  # 从管道读取\n\n");
-        printf("对应系统命令: grep\n");
+        fprintf(xio_stdout, "xgrep - 在文件中搜索文本\n\n");
+        fprintf(xio_stdout, "用法:\n");
+        fprintf(xio_stdout, "  xgrep [选项] <pattern> <file>...\n");
+        fprintf(xio_stdout, "  xgrep [选项] <pattern>            # 从标准输入读取\n\n");
+        fprintf(xio_stdout, "说明:\n");
+        fprintf(xio_stdout, "  在文件中搜索包含指定模式的行。\n");
+        fprintf(xio_stdout, "  Global Regular Expression Print - 全局正则表达式打印。\n\n");
+        fprintf(xio_stdout, "参数:\n");
+        fprintf(xio_stdout, "  pattern   要搜索的文本模式\n");
+        fprintf(xio_stdout, "  file      要搜索的文件（可以多个）\n");
+        fprintf(xio_stdout, "            使用 - 表示从标准输入读取\n\n");
+        fprintf(xio_stdout, "选项:\n");
+        fprintf(xio_stdout, "  -i        忽略大小写\n");
+        fprintf(xio_stdout, "  -n        显示行号\n");
+        fprintf(xio_stdout, "  -v        反向匹配（显示不匹配的行）\n");
+        fprintf(xio_stdout, "  -c        只显示匹配行的计数\n");
+        fprintf(xio_stdout, "  -w        整词匹配\n");
+        fprintf(xio_stdout, "  --help    显示此帮助信息\n\n");
+        fprintf(xio_stdout, "示例:\n");
+        fprintf(xio_stdout, "  xgrep hello file.txt           # 搜索包含 hello 的行\n");
+        fprintf(xio_stdout, "  xgrep -i hello file.txt        # 忽略大小写搜索\n");
+        fprintf(xio_stdout, "  xgrep -n error log.txt         # 显示行号\n");
+        fprintf(xio_stdout, "  xgrep -v comment file.c        # 显示不包含 comment 的行\n");
+        fprintf(xio_stdout, "  xgrep -c TODO *.txt            # 统计匹配行数\n");
+        fprintf(xio_stdout, "  xgrep -w apple file.txt        # 整词匹配\n");
+        fprintf(xio_stdout, "  xgrep -in error *.log          # 组合选项\n");
+        fprintf(xio_stdout, "  xcat file.txt | xgrep pattern  # 从管道读取\n\n");
+        fprintf(xio_stdout, "对应系统命令: grep\n");
         return 0;
     }
     
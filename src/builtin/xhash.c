@@ -0,0 +1,93 @@
+/*
+ * xhash.c - 管理命令路径缓存
+ *
+ * 功能：显示、清空或预先填充 PATH 查找缓存
+ * 用法：xhash                 (显示缓存)
+ *       xhash -r              (清空缓存)
+ *       xhash -d <command>... (删除指定条目)
+ *       xhash <command>...    (查找并缓存命令路径)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "builtin.h"
+#include "pathcache.h"
+#include <stdio.h>
+#include <string.h>
+
+int cmd_xhash(Command *cmd, ShellContext *ctx) {
+    // 显示帮助信息
+    if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
+        printf("xhash - 管理命令路径缓存\n\n");
+        printf("用法:\n");
+        printf("  xhash                      # 显示已缓存的命令路径\n");
+        printf("  xhash <command>...         # 查找并缓存命令路径\n");
+        printf("  xhash -r                   # 清空缓存\n");
+        printf("  xhash -d <command>...      # 删除指定命令的缓存\n\n");
+        printf("说明:\n");
+        printf("  Shell 第一次执行外部命令时会在 PATH 中查找，并记住找到的路径，\n");
+        printf("  之后再执行同一命令时直接使用缓存，不再逐个目录搜索。\n");
+        printf("  Hash - 哈希表。\n\n");
+        printf("参数:\n");
+        printf("  command   要缓存的命令名（可以多个）\n\n");
+        printf("选项:\n");
+        printf("  -r        清空整个缓存\n");
+        printf("  -d        删除指定命令的缓存\n");
+        printf("  --help    显示此帮助信息\n\n");
+        printf("示例:\n");
+        printf("  xhash                      # 显示缓存及命中次数\n");
+        printf("  xhash ls cat grep          # 预先缓存常用命令\n");
+        printf("  xhash -r                   # 安装新程序后清空缓存\n\n");
+        printf("注意:\n");
+        printf("  • 修改 PATH（xexport/xunset）会自动清空缓存\n");
+        printf("  • 缓存的程序被删除后，下次执行时会自动重新查找\n");
+        printf("  • 找不到的命令也会缓存 %d 秒，避免重复搜索\n\n", PATH_CACHE_NEGATIVE_TTL);
+        printf("相关命令:\n");
+        printf("  xwhich    - 显示命令路径\n");
+        printf("  xtype     - 显示命令类型\n\n");
+        printf("对应系统命令: hash\n");
+        return 0;
+    }
+
+    // 无参数：显示缓存
+    if (cmd->arg_count == 1) {
+        path_cache_print();
+        return 0;
+    }
+
+    // -r：清空缓存
+    if (strcmp(cmd->args[1], "-r") == 0) {
+        path_cache_clear();
+        return 0;
+    }
+
+    // -d：删除指定条目
+    if (strcmp(cmd->args[1], "-d") == 0) {
+        if (cmd->arg_count < 3) {
+            XSHELL_LOG_ERROR(ctx, "xhash: -d: missing command name\n");
+            return -1;
+        }
+        int has_error = 0;
+        for (int i = 2; i < cmd->arg_count; i++) {
+            if (path_cache_forget(cmd->args[i]) != 0) {
+                XSHELL_LOG_ERROR(ctx, "xhash: %s: not found\n", cmd->args[i]);
+                has_error = 1;
+            }
+        }
+        return has_error ? -1 : 0;
+    }
+
+    // 其他参数：逐个查找并缓存
+    int has_error = 0;
+    for (int i = 1; i < cmd->arg_count; i++) {
+        const char *name = cmd->args[i];
+        if (strchr(name, '/') != NULL || builtin_lookup(name) != NULL) {
+            continue;                       // 带路径的命令和内置命令不需要缓存
+        }
+        if (path_cache_lookup(name) == NULL) {
+            XSHELL_LOG_ERROR(ctx, "xhash: %s: not found\n", name);
+            has_error = 1;
+        }
+    }
+
+    return has_error ? -1 : 0;
+}
@@ -10,6 +10,7 @@
  */
 
 #include "builtin.h"
+#include "xio.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -23,7 +24,7 @@ static int head_file(const char* filename, int num_lines, int show_header, Shell
     
     // 打开文件（"-" 表示标准输入）
     if (strcmp(filename, "-") == 0) {
-        file = stdin;
+        file = xio_stdin;
         filename = "(standard input)";
     } else {
         file = fopen(filename, "r");
@@ -35,17 +36,17 @@ static int head_file(const char* filename, int num_lines, int show_header, Shell
     
     // 显示文件名头部（多个文件时）
     if (show_header) {
-        printf("==> %s <==\n", filename);
+        fprintf(xio_stdout, "==> %s <==\n", filename);
     }
     
     // 读取并显示前 N 行
     while (line_count < num_lines && fgets(line, sizeof(line), file)) {
-        printf("%s", line);
+        fprintf(xio_stdout, "%s", line);
         line_count++;
     }
     
     // 关闭文件
-    if (file != stdin) {
+    if (file != xio_stdin) {
         fclose(file);
     }
     
@@ -55,33 +56,33 @@ static int head_file(const char* filename, int num_lines, int show_header, Shell
 int cmd_xhead(Command* cmd, ShellContext* ctx) {
     // 显示帮助信息
     if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
-        printf("xhead - 显示文件的前 N 行\n\n");
-        printf("用法:\n");
-        printf("  xhead [选项] [file]...\n");
-        printf("  xhead [选项]               # 从标准输入读取\n\n");
-        printf("说明:\n");
-        printf("  显示文件的开头部分（默认前 10 行）。\n");
-        printf("  Head - 头部。\n\n");
-        printf("参数:\n");
-        printf("  file      要显示的文件（可以多个）\n");
-        printf("            不指定文件则从标准输入读取\n");
-        printf("            使用 - 表示标准输入\n\n");
-        printf("选项:\n");
-        printf("  -n N      显示前 N 行（默认 10）\n");
-        printf("  --help    显示此帮助信息\n\n");
-        printf("示例:\n");
-        printf("  xhead file.txt             # 显示前 10 行\n");
-        printf("  xhead -n 5 file.txt        # 显示前 5 行\n");
-        printf("  xhead -n 20 *.txt          # 显示多个文件的前 20 行\n");
-        printf("  xcat file.txt | xhead      # 从管道读取\n");
-        printf("  xcat file.txt | xhead -n 3 # 显示管道输入的前 3 行\n\n");
-        printf("多个文件:\n");
-        printf("  当指定多个文件时，会在每个文件内容前显示文件名：\n");
-        printf("  ==> file1.txt <==\n");
-        printf("  （文件内容）\n\n");
-        printf("  ==> file2.txt <==\n");
-        printf("  （文件内容）\n\n");
-        printf("对应系统命令: head\n");
+        fprintf(xio_stdout, "xhead - 显示文件的前 N 行\n\n");
+        fprintf(xio_stdout, "用法:\n");
+        fprintf(xio_stdout, "  xhead [选项] [file]...\n");
+        fprintf(xio_stdout, "  xhead [选项]               # 从标准输入读取\n\n");
+        fprintf(xio_stdout, "说明:\n");
+        fprintf(xio_stdout, "  显示文件的开头部分（默认前 10 行）。\n");
+        fprintf(xio_stdout, "  Head - 头部。\n\n");
+        fprintf(xio_stdout, "参数:\n");
+        fprintf(xio_stdout, "  file      要显示的文件（可以多个）\n");
+        fprintf(xio_stdout, "            不指定文件则从标准输入读取\n");
+        fprintf(xio_stdout, "            使用 - 表示标准输入\n\n");
+        fprintf(xio_stdout, "选项:\n");
+        fprintf(xio_stdout, "  -n N      显示前 N 行（默认 10）\n");
+        fprintf(xio_stdout, "  --help    显示此帮助信息\n\n");
+        fprintf(xio_stdout, "示例:\n");
+        fprintf(xio_stdout, "  xhead file.txt             # 显示前 10 行\n");
+        fprintf(xio_stdout, "  xhead -n 5 file.txt        # 显示前 5 行\n");
+        fprintf(xio_stdout, "  xhead -n 20 *.txt          # 显示多个文件的前 20 行\n");
+        fprintf(xio_stdout, "  xcat file.txt | xhead      # 从管道读取\n");
+        fprintf(xio_stdout, "  xcat file.txt | xhead -n 3 # 显示管道输入的前 3 行\n\n");
+        fprintf(xio_stdout, "多个文件:\n");
+        fprintf(xio_stdout, "  当指定多个文件时，会在每个文件内容前显示文件名：\n");
+        fprintf(xio_stdout, "  ==> file1.txt <==\n");
+        fprintf(xio_stdout, "  （文件内容）\n\n");
+        fprintf(xio_stdout, "  ==> file2.txt <==\n");
+        fprintf(xio_stdout, "  （文件内容）\n\n");
+        fprintf(xio_stdout, "对应系统命令: head\n");
         return 0;
     }
     
@@ -105,6 +106,16 @@ int cmd_xhead(Command* cmd, ShellContext* ctx) {
             return -1;
         }
         start_index++;
+    } else if (start_index < cmd->arg_count && cmd->args[start_index][0] == '-' &&
+               cmd->args[start_index][1] >= '0' && cmd->args[start_index][1] <= '9') {
+        // 简写形式 -N（等同于 -n N）
+        num_lines = atoi(cmd->args[start_index] + 1);
+        if (num_lines <= 0) {
+            XSHELL_LOG_ERROR(ctx, "xhead: invalid number of lines: '%s'\n",
+                             cmd->args[start_index] + 1);
+            return -1;
+        }
+        start_index++;
     }
     
     // 如果没有指定文件，从标准输入读取
@@ -120,7 +131,7 @@ int cmd_xhead(Command* cmd, ShellContext* ctx) {
         // 多个文件时显示文件名，文件之间空一行
         int show_header = (file_count > 1);
         if (i > start_index && show_header) {
-            printf("\n");
+            fprintf(xio_stdout, "\n");
         }
         
         if (head_file(cmd->args[i], num_lines, show_header, ctx) != 0) {
@@ -2,7 +2,7 @@
  * xjobs.c - 显示后台任务
  * 
  * 功能：显示当前Shell的后台任务列表
- * 用法：xjobs
+ * 用法：xjobs [-l]
  */
 
 #include "builtin.h"
@@ -11,22 +11,23 @@
 #include <string.h>
 
 int cmd_xjobs(Command *cmd, ShellContext *ctx) {
-    (void)ctx;
-    
     // 显示帮助信息
     if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
         printf("xjobs - 显示后台任务\n\n");
         printf("用法:\n");
-        printf("  xjobs\n\n");
+        printf("  xjobs [-l]\n\n");
         printf("说明:\n");
         printf("  显示当前Shell的所有后台任务。\n\n");
         printf("选项:\n");
+        printf("  -l        同时显示进程号和资源使用（CPU 时间、运行时间、\n");
+        printf("            最大内存、上下文切换、I/O 块数，只统计已结束的进程）\n");
         printf("  --help    显示此帮助信息\n\n");
         printf("输出格式:\n");
         printf("  [任务ID] 状态  命令\n");
         printf("  例如: [1] Running  sleep 10 &\n\n");
         printf("示例:\n");
-        printf("  xjobs                      # 显示所有后台任务\n\n");
+        printf("  xjobs                      # 显示所有后台任务\n");
+        printf("  xjobs -l                   # 显示进程号和资源使用\n\n");
         printf("提示:\n");
         printf("  • 使用 '命令 &' 在后台执行命令\n");
         printf("  • 使用 'xfg [id]' 将后台任务调到前台\n\n");
@@ -34,8 +35,20 @@ int cmd_xjobs(Command *cmd, ShellContext *ctx) {
         return 0;
     }
     
+    // 解析选项
+    bool verbose = false;
+    for (int i = 1; i < cmd->arg_count; i++) {
+        if (strcmp(cmd->args[i], "-l") == 0) {
+            verbose = true;
+        } else {
+            XSHELL_LOG_ERROR(ctx, "xjobs: invalid option '%s'\n", cmd->args[i]);
+            XSHELL_LOG_ERROR(ctx, "Try 'xjobs --help' for more information.\n");
+            return -1;
+        }
+    }
+    
     // 显示所有任务
-    job_print_all();
+    job_print_all(verbose);
     
     return 0;
 }
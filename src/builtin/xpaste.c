@@ -10,6 +10,7 @@
  */
 
 #include "builtin.h"
+#include "xio.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -20,14 +21,14 @@
 
 // 显示帮助信息
 static void show_help(const char *cmd_name) {
-    printf("用法: %s [选项] [文件...]\n", cmd_name);
-    printf("功能: 将多个文件的行按列合并\n");
-    printf("选项:\n");
-    printf("  -d <分隔符>    指定分隔符（默认制表符）\n");
-    printf("  -h, --help     显示此帮助信息\n");
-    printf("示例:\n");
-    printf("  %s file1.txt file2.txt\n", cmd_name);
-    printf("  %s -d: file1.txt file2.txt\n", cmd_name);
+    fprintf(xio_stdout, "用法: %s [选项] [文件...]\n", cmd_name);
+    fprintf(xio_stdout, "功能: 将多个文件的行按列合并\n");
+    fprintf(xio_stdout, "选项:\n");
+    fprintf(xio_stdout, "  -d <分隔符>    指定分隔符（默认制表符）\n");
+    fprintf(xio_stdout, "  -h, --help     显示此帮助信息\n");
+    fprintf(xio_stdout, "示例:\n");
+    fprintf(xio_stdout, "  %s file1.txt file2.txt\n", cmd_name);
+    fprintf(xio_stdout, "  %s -d: file1.txt file2.txt\n", cmd_name);
 }
 
 // xpaste 命令实现
@@ -54,6 +55,10 @@ int cmd_xpaste(Command *cmd, ShellContext *ctx) {
             }
             delimiter = cmd->args[i + 1][0];
             i += 2;
+        } else if (strncmp(cmd->args[i], "-d", 2) == 0) {
+            // 分隔符紧跟在 -d 后面（如 -d:）
+            delimiter = cmd->args[i][2];
+            i++;
         } else {
             break;
         }
@@ -65,14 +70,14 @@ int cmd_xpaste(Command *cmd, ShellContext *ctx) {
         FILE *file;
         
         if (strcmp(filename, "-") == 0) {
-            file = stdin;
+            file = xio_stdin;
         } else {
             file = fopen(filename, "r");
             if (file == NULL) {
                 XSHELL_LOG_ERROR(ctx, "xpaste: %s: %s\n", filename, strerror(errno));
                 // 关闭已打开的文件
                 for (int j = 0; j < file_count; j++) {
-                    if (files[j] != stdin) {
+                    if (files[j] != xio_stdin) {
                         fclose(files[j]);
                     }
                 }
@@ -85,7 +90,7 @@ int cmd_xpaste(Command *cmd, ShellContext *ctx) {
     
     // 如果没有文件，使用标准输入
     if (file_count == 0) {
-        files[0] = stdin;
+        files[0] = xio_stdin;
         file_count = 1;
     }
     
@@ -126,17 +131,17 @@ int cmd_xpaste(Command *cmd, ShellContext *ctx) {
         if (has_data) {
             for (int j = 0; j < file_count; j++) {
                 if (j > 0) {
-                    putchar(delimiter);
+                    xio_putchar(delimiter);
                 }
-                printf("%s", lines[j]);
+                fprintf(xio_stdout, "%s", lines[j]);
             }
-            putchar('\n');
+            xio_putchar('\n');
         }
     }
     
     // 关闭文件
     for (int j = 0; j < file_count; j++) {
-        if (files[j] != stdin) {
+        if (files[j] != xio_stdin) {
             fclose(files[j]);
         }
     }
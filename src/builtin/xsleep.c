@@ -5,12 +5,16 @@
  * 用法：xsleep <seconds>
  */
 
+#define _POSIX_C_SOURCE 200809L
 #include "builtin.h"
+#include "job.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <ctype.h>
+#include <errno.h>
+#include <time.h>
 
 // 检查字符串是否是有效的数字
 static int is_valid_number(const char *str) {
@@ -100,7 +104,17 @@ int cmd_xsleep(Command *cmd, ShellContext *ctx) {
     }
     
     // 休眠
-    sleep(seconds);
+    // 后台作业结束时的 SIGCHLD 会提前打断 sleep，此时继续睡剩下的时间；只有 Ctrl+C 才提前结束
+    struct timespec left = { seconds, 0 };
+    while (nanosleep(&left, &left) != 0) {
+        if (errno != EINTR) {
+            perror("xsleep");
+            return -1;
+        }
+        if (job_sigint_received()) {
+            return 130;                                 // 与 sh 相同：128 + SIGINT
+        }
+    }
     
     return 0;
 }
@@ -14,6 +14,7 @@
 #define _POSIX_C_SOURCE 200809L  // 启用 strdup 函数
 
 #include "builtin.h"
+#include "xio.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -63,7 +64,38 @@ static int num_compare_reverse(const void* a, const void* b) {
     return num_compare(b, a);
 }
 
+// 释放读取的行（映射到内存的行指向映射区，不单独释放）
+static void free_lines(char** lines, int line_count, int mapped) {
+    for (int i = 0; i < line_count && !mapped; i++) {
+        free(lines[i]);
+    }
+    free(lines);
+}
+
+// 读取下一行
+// 说明：映射到内存的文件（*next 非 NULL）就地切分，返回的行不含换行符；
+//       否则用 fgets 读到 buffer，返回的行保留换行符
+// 返回：行的内容，没有更多行时返回 NULL
+static char* read_line(FILE* file, char* buffer, size_t size, char** next, char* end) {
+    if (*next == NULL) {
+        return fgets(buffer, size, file);
+    }
+    if (*next >= end) {
+        return NULL;
+    }
+    char* line = *next;
+    char* newline = memchr(line, '\n', end - line);
+    if (newline != NULL) {
+        *newline = '\0';
+        *next = newline + 1;
+    } else {
+        *next = end;                                // 最后一行没有换行（映射保证其后是 '\0'）
+    }
+    return line;
+}
+
 // 排序文件
+// 说明：普通文件（包括 here-document 的内存文件）映射到内存后直接排序行指针，不逐行复制
 static int sort_file(const char* filename, const SortOptions* opts, ShellContext *ctx) {
     FILE* file;
     char** lines = NULL;
@@ -79,7 +111,7 @@ static int sort_file(const char* filename, const SortOptions* opts, ShellContext
     
     // 打开文件（"-" 表示标准输入）
     if (strcmp(filename, "-") == 0) {
-        file = stdin;
+        file = xio_stdin;
     } else {
         file = fopen(filename, "r");
         if (!file) {
@@ -90,8 +122,14 @@ static int sort_file(const char* filename, const SortOptions* opts, ShellContext
     }
     
     // 读取所有行
-    char line[MAX_LINE_LENGTH];
-    while (fgets(line, sizeof(line), file)) {
+    size_t map_len = 0;
+    char* data = xio_map(file, &map_len);
+    char* next = data;
+    char* end = (data != NULL) ? data + map_len : NULL;
+    int mapped = (data != NULL);
+    char buffer[MAX_LINE_LENGTH];
+    char* line;
+    while ((line = read_line(file, buffer, sizeof(buffer), &next, end)) != NULL) {
         // 扩展数组容量
         if (line_count >= capacity) {
             capacity *= 2;
@@ -102,32 +140,27 @@ static int sort_file(const char* filename, const SortOptions* opts, ShellContext
             char** new_lines = realloc(lines, capacity * sizeof(char*));
             if (!new_lines) {
                 XSHELL_LOG_ERROR(ctx, "xsort: memory allocation failed\n");
-                for (int i = 0; i < line_count; i++) {
-                    free(lines[i]);
-                }
-                free(lines);
-                if (file != stdin) fclose(file);
+                free_lines(lines, line_count, mapped);
+                xio_unmap(data, map_len);
+                if (file != xio_stdin) fclose(file);
                 return -1;
             }
             lines = new_lines;
         }
         
-        // 复制行内容
-        lines[line_count] = strdup(line);
+        // 复制行内容（映射的行直接使用）
+        lines[line_count] = mapped ? line : strdup(line);
         if (!lines[line_count]) {
             XSHELL_LOG_ERROR(ctx, "xsort: memory allocation failed\n");
-            for (int i = 0; i < line_count; i++) {
-                free(lines[i]);
-            }
-            free(lines);
-            if (file != stdin) fclose(file);
+            free_lines(lines, line_count, mapped);
+            if (file != xio_stdin) fclose(file);
             return -1;
         }
         line_count++;
     }
     
     // 关闭文件
-    if (file != stdin) {
+    if (file != xio_stdin) {
         fclose(file);
     }
     
@@ -152,14 +185,12 @@ static int sort_file(const char* filename, const SortOptions* opts, ShellContext
         if (opts->unique && i > 0 && strcmp(lines[i], lines[i-1]) == 0) {
             continue;
         }
-        printf("%s", lines[i]);
+        fprintf(xio_stdout, mapped ? "%s\n" : "%s", lines[i]);
     }
     
     // 释放内存
-    for (int i = 0; i < line_count; i++) {
-        free(lines[i]);
-    }
-    free(lines);
+    free_lines(lines, line_count, mapped);
+    xio_unmap(data, map_len);
     
     return 0;
 }
@@ -167,40 +198,40 @@ static int sort_file(const char* filename, const SortOptions* opts, ShellContext
 int cmd_xsort(Command* cmd, ShellContext* ctx) {
     // 显示帮助信息
     if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
-        printf("xsort - 排序文件内容\n\n");
-        printf("用法:\n");
-        printf("  xsort [选项] [file]...\n");
-        printf("  xsort [选项]               # 从标准输入读取\n\n");
-        printf("说明:\n");
-        printf("  对文件的行进行排序。\n");
-        printf("  Sort - 排序。\n\n");
-        printf("参数:\n");
-        printf("  file      要排序的文件\n");
-        printf("            不指定文件则从标准输入读取\n");
-        printf("            多个文件会被合并后排序\n\n");
-        printf("选项:\n");
-        printf("  -r        逆序排序（从大到小）\n");
-        printf("  -n        按数值排序\n");
-        printf("  -u        去除重复行（unique）\n");
-        printf("  --help    显示此帮助信息\n\n");
-        printf("排序规则:\n");
-        printf("  默认排序：  按字典顺序（ASCII码）\n");
-        printf("  数值排序：  将每行开头解析为数字\n");
-        printf("  逆序排序：  从大到小排序\n");
-        printf("  去重排序：  输出时跳过连续重复的行\n\n");
-        printf("示例:\n");
-        printf("  xsort file.txt             # 正序排序\n");
-        printf("  xsort -r file.txt          # 逆序排序\n");
-        printf("  xsort -n numbers.txt       # 数值排序\n");
-        printf("  xsort -u file.txt          # 排序并去重\n");
-        printf("  xsort -rn numbers.txt      # 数值逆序排序\n");
-        printf("  xsort -un file.txt         # 数值排序并去重\n");
-        printf("  xecho -e \"3\\n1\\n2\" | xsort  # 从管道读取\n");
-        printf("  xcat *.txt | xsort -u      # 合并多个文件并去重\n\n");
-        printf("性能限制:\n");
-        printf("  最大行数：%d 行\n", MAX_LINES);
-        printf("  最大行长：%d 字节\n\n", MAX_LINE_LENGTH);
-        printf("对应系统命令: sort\n");
+        fprintf(xio_stdout, "xsort - 排序文件内容\n\n");
+        fprintf(xio_stdout, "用法:\n");
+        fprintf(xio_stdout, "  xsort [选项] [file]...\n");
+        fprintf(xio_stdout, "  xsort [选项]               # 从标准输入读取\n\n");
+        fprintf(xio_stdout, "说明:\n");
+        fprintf(xio_stdout, "  对文件的行进行排序。\n");
+        fprintf(xio_stdout, "  Sort - 排序。\n\n");
+        fprintf(xio_stdout, "参数:\n");
+        fprintf(xio_stdout, "  file      要排序的文件\n");
+        fprintf(xio_stdout, "            不指定文件则从标准输入读取\n");
+        fprintf(xio_stdout, "            多个文件会被合并后排序\n\n");
+        fprintf(xio_stdout, "选项:\n");
+        fprintf(xio_stdout, "  -r        逆序排序（从大到小）\n");
+        fprintf(xio_stdout, "  -n        按数值排序\n");
+        fprintf(xio_stdout, "  -u        去除重复行（unique）\n");
+        fprintf(xio_stdout, "  --help    显示此帮助信息\n\n");
+        fprintf(xio_stdout, "排序规则:\n");
+        fprintf(xio_stdout, "  默认排序：  按字典顺序（ASCII码）\n");
+        fprintf(xio_stdout, "  数值排序：  将每行开头解析为数字\n");
+        fprintf(xio_stdout, "  逆序排序：  从大到小排序\n");
+        fprintf(xio_stdout, "  去重排序：  输出时跳过连续重复的行\n\n");
+        fprintf(xio_stdout, "示例:\n");
+        fprintf(xio_stdout, "  xsort file.txt             # 正序排序\n");
+        fprintf(xio_stdout, "  xsort -r file.txt          # 逆序排序\n");
+        fprintf(xio_stdout, "  xsort -n numbers.txt       # 数值排序\n");
+        fprintf(xio_stdout, "  xsort -u file.txt          # 排序并去重\n");
+        fprintf(xio_stdout, "  xsort -rn numbers.txt      # 数值逆序排序\n");
+        fprintf(xio_stdout, "  xsort -un file.txt         # 数值排序并去重\n");
+        fprintf(xio_stdout, "  xecho -e \"3\\n1\\n2\" | xsort  # 从管道读取\n");
+        fprintf(xio_stdout, "  xcat *.txt | xsort -u      # 合并多个文件并去重\n\n");
+        fprintf(xio_stdout, "性能限制:\n");
+        fprintf(xio_stdout, "  最大行数：%d 行\n", MAX_LINES);
+        fprintf(xio_stdout, "  最大行长：%d 字节\n\n", MAX_LINE_LENGTH);
+        fprintf(xio_stdout, "对应系统命令: sort\n");
         return 0;
     }
     
@@ -296,7 +327,7 @@ int cmd_xsort(Command* cmd, ShellContext* ctx) {
         if (opts.unique && i > 0 && strcmp(all_lines[i], all_lines[i-1]) == 0) {
             continue;
         }
-        printf("%s", all_lines[i]);
+        fprintf(xio_stdout, "%s", all_lines[i]);
     }
     
     // 释放内存
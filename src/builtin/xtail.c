@@ -10,6 +10,7 @@
  */
 
 #include "builtin.h"
+#include "xio.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -83,7 +84,7 @@ static void add_line(CircularBuffer* buf, const char* line) {
 static void print_buffer(const CircularBuffer* buf) {
     for (int i = 0; i < buf->count; i++) {
         int index = (buf->start + i) % buf->capacity;
-        printf("%s", buf->lines[index]);
+        fprintf(xio_stdout, "%s", buf->lines[index]);
     }
 }
 
@@ -102,7 +103,7 @@ static int tail_file(const char* filename, int num_lines, int show_header, Shell
     
     // 打开文件（"-" 表示标准输入）
     if (strcmp(filename, "-") == 0) {
-        file = stdin;
+        file = xio_stdin;
         filename = "(standard input)";
     } else {
         file = fopen(filename, "r");
@@ -120,14 +121,14 @@ static int tail_file(const char* filename, int num_lines, int show_header, Shell
     
     // 显示文件名头部（多个文件时）
     if (show_header) {
-        printf("==> %s <==\n", filename);
+        fprintf(xio_stdout, "==> %s <==\n", filename);
     }
     
     // 打印最后 N 行
     print_buffer(buf);
     
     // 关闭文件并释放缓冲区
-    if (file != stdin) {
+    if (file != xio_stdin) {
         fclose(file);
     }
     free_buffer(buf);
@@ -138,38 +139,38 @@ static int tail_file(const char* filename, int num_lines, int show_header, Shell
 int cmd_xtail(Command* cmd, ShellContext* ctx) {
     // 显示帮助信息
     if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
-        printf("xtail - 显示文件的后 N 行\n\n");
-        printf("用法:\n");
-        printf("  xtail [选项] [file]...\n");
-        printf("  xtail [选项]               # 从标准输入读取\n\n");
-        printf("说明:\n");
-        printf("  显示文件的末尾部分（默认后 10 行）。\n");
-        printf("  Tail - 尾部。\n\n");
-        printf("参数:\n");
-        printf("  file      要显示的文件（可以多个）\n");
-        printf("            不指定文件则从标准输入读取\n");
-        printf("            使用 - 表示标准输入\n\n");
-        printf("选项:\n");
-        printf("  -n N      显示后 N 行（默认 10）\n");
-        printf("  --help    显示此帮助信息\n\n");
-        printf("示例:\n");
-        printf("  xtail file.txt             # 显示后 10 行\n");
-        printf("  xtail -n 5 file.txt        # 显示后 5 行\n");
-        printf("  xtail -n 20 log.txt        # 显示日志文件的后 20 行\n");
-        printf("  xtail -n 20 *.log          # 显示多个日志文件的后 20 行\n");
-        printf("  xcat file.txt | xtail      # 从管道读取\n");
-        printf("  xcat file.txt | xtail -n 3 # 显示管道输入的后 3 行\n\n");
-        printf("多个文件:\n");
-        printf("  当指定多个文件时，会在每个文件内容前显示文件名：\n");
-        printf("  ==> file1.txt <==\n");
-        printf("  （文件内容）\n\n");
-        printf("  ==> file2.txt <==\n");
-        printf("  （文件内容）\n\n");
-        printf("常见用途:\n");
-        printf("  • 查看日志文件的最新内容\n");
-        printf("  • 检查大文件的末尾部分\n");
-        printf("  • 与其他命令配合使用\n\n");
-        printf("对应系统命令: tail\n");
+        fprintf(xio_stdout, "xtail - 显示文件的后 N 行\n\n");
+        fprintf(xio_stdout, "用法:\n");
+        fprintf(xio_stdout, "  xtail [选项] [file]...\n");
+        fprintf(xio_stdout, "  xtail [选项]               # 从标准输入读取\n\n");
+        fprintf(xio_stdout, "说明:\n");
+        fprintf(xio_stdout, "  显示文件的末尾部分（默认后 10 行）。\n");
+        fprintf(xio_stdout, "  Tail - 尾部。\n\n");
+        fprintf(xio_stdout, "参数:\n");
+        fprintf(xio_stdout, "  file      要显示的文件（可以多个）\n");
+        fprintf(xio_stdout, "            不指定文件则从标准输入读取\n");
+        fprintf(xio_stdout, "            使用 - 表示标准输入\n\n");
+        fprintf(xio_stdout, "选项:\n");
+        fprintf(xio_stdout, "  -n N      显示后 N 行（默认 10）\n");
+        fprintf(xio_stdout, "  --help    显示此帮助信息\n\n");
+        fprintf(xio_stdout, "示例:\n");
+        fprintf(xio_stdout, "  xtail file.txt             # 显示后 10 行\n");
+        fprintf(xio_stdout, "  xtail -n 5 file.txt        # 显示后 5 行\n");
+        fprintf(xio_stdout, "  xtail -n 20 log.txt        # 显示日志文件的后 20 行\n");
+        fprintf(xio_stdout, "  xtail -n 20 *.log          # 显示多个日志文件的后 20 行\n");
+        fprintf(xio_stdout, "  xcat file.txt | xtail      # 从管道读取\n");
+        fprintf(xio_stdout, "  xcat file.txt | xtail -n 3 # 显示管道输入的后 3 行\n\n");
+        fprintf(xio_stdout, "多个文件:\n");
+        fprintf(xio_stdout, "  当指定多个文件时，会在每个文件内容前显示文件名：\n");
+        fprintf(xio_stdout, "  ==> file1.txt <==\n");
+        fprintf(xio_stdout, "  （文件内容）\n\n");
+        fprintf(xio_stdout, "  ==> file2.txt <==\n");
+        fprintf(xio_stdout, "  （文件内容）\n\n");
+        fprintf(xio_stdout, "常见用途:\n");
+        fprintf(xio_stdout, "  • 查看日志文件的最新内容\n");
+        fprintf(xio_stdout, "  • 检查大文件的末尾部分\n");
+        fprintf(xio_stdout, "  • 与其他命令配合使用\n\n");
+        fprintf(xio_stdout, "对应系统命令: tail\n");
         return 0;
     }
     
@@ -193,6 +194,16 @@ int cmd_xtail(Command* cmd, ShellContext* ctx) {
             return -1;
         }
         start_index++;
+    } else if (start_index < cmd->arg_count && cmd->args[start_index][0] == '-' &&
+               cmd->args[start_index][1] >= '0' && cmd->args[start_index][1] <= '9') {
+        // 简写形式 -N（等同于 -n N）
+        num_lines = atoi(cmd->args[start_index] + 1);
+        if (num_lines <= 0) {
+            XSHELL_LOG_ERROR(ctx, "xtail: invalid number of lines: '%s'\n",
+                             cmd->args[start_index] + 1);
+            return -1;
+        }
+        start_index++;
     }
     
     // 如果没有指定文件，从标准输入读取
@@ -208,7 +219,7 @@ int cmd_xtail(Command* cmd, ShellContext* ctx) {
         // 多个文件时显示文件名，文件之间空一行
         int show_header = (file_count > 1);
         if (i > start_index && show_header) {
-            printf("\n");
+            fprintf(xio_stdout, "\n");
         }
         
         if (tail_file(cmd->args[i], num_lines, show_header, ctx) != 0) {
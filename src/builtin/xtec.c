@@ -3,6 +3,7 @@
 
 // 引入自定义头文件
 #include "builtin.h"            // 内置命令函数声明
+#include "xio.h"                // 内置命令标准流（xio_stdout 等）
 
 // 引入标准库
 #include <stdio.h>              // 标准输入输出（printf, fopen, fclose, fgetc, putchar）
@@ -34,39 +35,39 @@
 int cmd_xtec(Command *cmd, ShellContext *ctx) {
     // 步骤0：检查是否请求帮助信息
     if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
-        printf("xtec - 从标准输入读取并同时输出到文件和标准输出\n\n");
-        printf("用法:\n");
-        printf("  xtec [选项] <文件名> [文件名2 ...]\n");
-        printf("  命令 | xtec <文件名>\n\n");
-        printf("说明:\n");
-        printf("  从标准输入读取数据，同时写入到：\n");
-        printf("  • 标准输出（屏幕）\n");
-        printf("  • 指定的文件\n");
-        printf("  常用于保存管道中间结果。\n\n");
-        printf("参数:\n");
-        printf("  文件名    要写入的文件（可以指定多个）\n\n");
-        printf("选项:\n");
-        printf("  -a        追加模式（追加到文件末尾，而不是覆盖）\n");
-        printf("  --help    显示此帮助信息\n\n");
-        printf("示例:\n");
-        printf("  xecho \"hello\" | xtec output.txt\n");
-        printf("    输出到屏幕：hello\n");
-        printf("    写入文件：output.txt\n\n");
-        printf("  xls | xtec -a log.txt\n");
-        printf("    列出文件并追加到 log.txt\n\n");
-        printf("  xcat data.txt | xtec copy1.txt copy2.txt\n");
-        printf("    同时写入多个文件\n\n");
-        printf("  xpwd | xtec -a history.log\n");
-        printf("    追加当前目录到历史日志\n\n");
-        printf("特性:\n");
-        printf("  • 支持多个输出文件\n");
-        printf("  • 支持追加模式（-a）\n");
-        printf("  • 从标准输入读取（通常配合管道使用）\n");
-        printf("  • 同时输出到屏幕和文件\n\n");
-        printf("注意:\n");
-        printf("  • 目前 XShell 还不支持管道（|），此命令暂时无法使用\n");
-        printf("  • 需要先实现管道功能才能使用 xtec\n\n");
-        printf("对应系统命令: tee\n");
+        fprintf(xio_stdout, "xtec - 从标准输入读取并同时输出到文件和标准输出\n\n");
+        fprintf(xio_stdout, "用法:\n");
+        fprintf(xio_stdout, "  xtec [选项] <文件名> [文件名2 ...]\n");
+        fprintf(xio_stdout, "  命令 | xtec <文件名>\n\n");
+        fprintf(xio_stdout, "说明:\n");
+        fprintf(xio_stdout, "  从标准输入读取数据，同时写入到：\n");
+        fprintf(xio_stdout, "  • 标准输出（屏幕）\n");
+        fprintf(xio_stdout, "  • 指定的文件\n");
+        fprintf(xio_stdout, "  常用于保存管道中间结果。\n\n");
+        fprintf(xio_stdout, "参数:\n");
+        fprintf(xio_stdout, "  文件名    要写入的文件（可以指定多个）\n\n");
+        fprintf(xio_stdout, "选项:\n");
+        fprintf(xio_stdout, "  -a        追加模式（追加到文件末尾，而不是覆盖）\n");
+        fprintf(xio_stdout, "  --help    显示此帮助信息\n\n");
+        fprintf(xio_stdout, "示例:\n");
+        fprintf(xio_stdout, "  xecho \"hello\" | xtec output.txt\n");
+        fprintf(xio_stdout, "    输出到屏幕：hello\n");
+        fprintf(xio_stdout, "    写入文件：output.txt\n\n");
+        fprintf(xio_stdout, "  xls | xtec -a log.txt\n");
+        fprintf(xio_stdout, "    列出文件并追加到 log.txt\n\n");
+        fprintf(xio_stdout, "  xcat data.txt | xtec copy1.txt copy2.txt\n");
+        fprintf(xio_stdout, "    同时写入多个文件\n\n");
+        fprintf(xio_stdout, "  xpwd | xtec -a history.log\n");
+        fprintf(xio_stdout, "    追加当前目录到历史日志\n\n");
+        fprintf(xio_stdout, "特性:\n");
+        fprintf(xio_stdout, "  • 支持多个输出文件\n");
+        fprintf(xio_stdout, "  • 支持追加模式（-a）\n");
+        fprintf(xio_stdout, "  • 从标准输入读取（通常配合管道使用）\n");
+        fprintf(xio_stdout, "  • 同时输出到屏幕和文件\n\n");
+        fprintf(xio_stdout, "注意:\n");
+        fprintf(xio_stdout, "  • 目前 XShell 还不支持管道（|），此命令暂时无法使用\n");
+        fprintf(xio_stdout, "  • 需要先实现管道功能才能使用 xtec\n\n");
+        fprintf(xio_stdout, "对应系统命令: tee\n");
         return 0;
     }
 
@@ -120,9 +121,9 @@ int cmd_xtec(Command *cmd, ShellContext *ctx) {
     int ch;                                     // 当前读取的字符
     int has_error = 0;                          // 错误标志
 
-    while ((ch = getchar()) != EOF) {
+    while ((ch = xio_getchar()) != EOF) {
         // 4.1：输出到标准输出（屏幕）
-        if (putchar(ch) == EOF) {
+        if (xio_putchar(ch) == EOF) {
             XSHELL_LOG_ERROR(ctx, "xtec: write error to stdout\n");
             has_error = 1;
             break;
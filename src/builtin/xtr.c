@@ -12,6 +12,7 @@
  */
 
 #include "builtin.h"
+#include "xio.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -21,15 +22,15 @@
 
 // 显示帮助信息
 static void show_help(const char *cmd_name) {
-    printf("用法: %s [选项] <字符集1> [字符集2]\n", cmd_name);
-    printf("功能: 转换或删除字符\n");
-    printf("选项:\n");
-    printf("  -d              删除字符集中的字符\n");
-    printf("  -h, --help     显示此帮助信息\n");
-    printf("示例:\n");
-    printf("  %s 'a-z' 'A-Z' < file.txt    # 小写转大写\n", cmd_name);
-    printf("  %s -d '0-9' < file.txt       # 删除数字\n", cmd_name);
-    printf("注意: 简化实现，支持基本字符范围（a-z, A-Z, 0-9）\n");
+    fprintf(xio_stdout, "用法: %s [选项] <字符集1> [字符集2]\n", cmd_name);
+    fprintf(xio_stdout, "功能: 转换或删除字符\n");
+    fprintf(xio_stdout, "选项:\n");
+    fprintf(xio_stdout, "  -d              删除字符集中的字符\n");
+    fprintf(xio_stdout, "  -h, --help     显示此帮助信息\n");
+    fprintf(xio_stdout, "示例:\n");
+    fprintf(xio_stdout, "  %s 'a-z' 'A-Z' < file.txt    # 小写转大写\n", cmd_name);
+    fprintf(xio_stdout, "  %s -d '0-9' < file.txt       # 删除数字\n", cmd_name);
+    fprintf(xio_stdout, "注意: 简化实现，支持基本字符范围（a-z, A-Z, 0-9）\n");
 }
 
 // 检查字符是否在范围内
@@ -97,14 +98,14 @@ static int process_file(FILE *file, int delete_mode, const char *set1, const cha
             // 删除模式：删除 set1 中的字符
             for (size_t i = 0; line[i] != '\0'; i++) {
                 if (!in_range(line[i], set1)) {
-                    putchar(line[i]);
+                    xio_putchar(line[i]);
                 }
             }
         } else {
             // 转换模式：将 set1 转换为 set2
             for (size_t i = 0; line[i] != '\0'; i++) {
                 char c = translate_char(line[i], set1, set2);
-                putchar(c);
+                xio_putchar(c);
             }
         }
     }
@@ -156,7 +157,7 @@ int cmd_xtr(Command *cmd, ShellContext *ctx) {
     }
     
     // 处理标准输入
-    process_file(stdin, delete_mode, set1, set2);
+    process_file(xio_stdin, delete_mode, set1, set2);
     
     return 0;
 }
@@ -9,40 +9,12 @@
 #include "builtin.h"
 #include "executor.h"
 #include "alias.h"
+#include "pathcache.h"
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 #include <stdlib.h>
 
-// 在PATH中搜索命令
-static char* search_in_path(const char *command) {
-    char *path_env = getenv("PATH");
-    if (!path_env) {
-        return NULL;
-    }
-    
-    // 复制PATH环境变量（因为strtok会修改字符串）
-    char *path_copy = strdup(path_env);
-    if (!path_copy) {
-        return NULL;
-    }
-    
-    static char full_path[1024];
-    char *dir = strtok(path_copy, ":");
-    
-    while (dir != NULL) {
-        snprintf(full_path, sizeof(full_path), "%s/%s", dir, command);
-        if (access(full_path, X_OK) == 0) {
-            free(path_copy);
-            return full_path;
-        }
-        dir = strtok(NULL, ":");
-    }
-    
-    free(path_copy);
-    return NULL;
-}
-
 int cmd_xtype(Command *cmd, ShellContext *ctx) {
     // 显示帮助信息
     if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
@@ -81,21 +53,21 @@ int cmd_xtype(Command *cmd, ShellContext *ctx) {
     for (int i = 1; i < cmd->arg_count; i++) {
         const char *command = cmd->args[i];
         
-        // 检查是否是内置命令
-        if (is_builtin(command)) {
-            printf("%s is a shell builtin\n", command);
-            continue;
-        }
-        
-        // 检查是否是别名
+        // 检查是否是别名（执行时别名先于内置命令展开）
         const char *alias_value = alias_get(command);
         if (alias_value) {
             printf("%s is aliased to `%s'\n", command, alias_value);
             continue;
         }
         
-        // 在PATH中搜索
-        char *path = search_in_path(command);
+        // 检查是否是内置命令（查注册表）
+        if (builtin_lookup(command) != NULL) {
+            printf("%s is a shell builtin\n", command);
+            continue;
+        }
+        
+        // 在PATH中搜索（走 PATH 缓存）
+        const char *path = path_cache_lookup(command);
         if (path) {
             printf("%s is %s\n", command, path);
         } else {
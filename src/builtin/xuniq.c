@@ -12,6 +12,7 @@
  */
 
 #include "builtin.h"
+#include "xio.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -34,7 +35,7 @@ static int uniq_file(const char* filename, const UniqOptions* opts, ShellContext
     
     // 打开文件（"-" 表示标准输入）
     if (strcmp(filename, "-") == 0) {
-        file = stdin;
+        file = xio_stdin;
     } else {
         file = fopen(filename, "r");
         if (!file) {
@@ -71,9 +72,9 @@ static int uniq_file(const char* filename, const UniqOptions* opts, ShellContext
             if (should_print) {
                 if (opts->count) {
                     // -c: 显示重复次数
-                    printf("%7d %s", line_count, prev_line);
+                    fprintf(xio_stdout, "%7d %s", line_count, prev_line);
                 } else {
-                    printf("%s", prev_line);
+                    fprintf(xio_stdout, "%s", prev_line);
                 }
             }
             
@@ -97,15 +98,15 @@ static int uniq_file(const char* filename, const UniqOptions* opts, ShellContext
         
         if (should_print) {
             if (opts->count) {
-                printf("%7d %s", line_count, prev_line);
+                fprintf(xio_stdout, "%7d %s", line_count, prev_line);
             } else {
-                printf("%s", prev_line);
+                fprintf(xio_stdout, "%s", prev_line);
             }
         }
     }
     
     // 关闭文件
-    if (file != stdin) {
+    if (file != xio_stdin) {
         fclose(file);
     }
     
@@ -115,54 +116,54 @@ static int uniq_file(const char* filename, const UniqOptions* opts, ShellContext
 int cmd_xuniq(Command* cmd, ShellContext* ctx) {
     // 显示帮助信息
     if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
-        printf("xuniq - 去除文件中的重复行\n\n");
-        printf("用法:\n");
-        printf("  xuniq [选项] [file]\n");
-        printf("  xuniq [选项]               # 从标准输入读取\n\n");
-        printf("说明:\n");
-        printf("  过滤相邻的重复行。\n");
-        printf("  Unique - 唯一。\n\n");
-        printf("重要提示:\n");
-        printf("  xuniq 只会去除**相邻**的重复行。\n");
-        printf("  如果要去除所有重复行，需要先排序：\n");
-        printf("    xsort file.txt | xuniq\n\n");
-        printf("参数:\n");
-        printf("  file      要处理的文件\n");
-        printf("            不指定文件则从标准输入读取\n\n");
-        printf("选项:\n");
-        printf("  -c        在每行前显示该行出现的次数\n");
-        printf("  -d        只显示重复的行（出现 > 1 次）\n");
-        printf("  -u        只显示不重复的行（出现 = 1 次）\n");
-        printf("  --help    显示此帮助信息\n\n");
-        printf("示例:\n");
-        printf("  xuniq file.txt             # 去除相邻重复行\n");
-        printf("  xuniq -c file.txt          # 显示每行出现次数\n");
-        printf("  xuniq -d file.txt          # 只显示重复行\n");
-        printf("  xuniq -u file.txt          # 只显示唯一行\n");
-        printf("  xsort file.txt | xuniq     # 排序后去重（完全去重）\n");
-        printf("  xsort file.txt | xuniq -c  # 统计每行出现次数\n");
-        printf("  xcat *.txt | xsort | xuniq # 合并文件并去重\n\n");
-        printf("工作原理:\n");
-        printf("  输入：    输出（默认）：\n");
-        printf("  aaa       aaa\n");
-        printf("  aaa       bbb\n");
-        printf("  bbb       aaa\n");
-        printf("  aaa       \n");
-        printf("  \n");
-        printf("  注意：第三个 aaa 与前面不相邻，所以会输出。\n\n");
-        printf("  输入：    排序后：  去重后：\n");
-        printf("  aaa       aaa       aaa\n");
-        printf("  aaa       aaa       bbb\n");
-        printf("  bbb       aaa       \n");
-        printf("  aaa       bbb       \n\n");
-        printf("常见用法:\n");
-        printf("  • 统计文件中不同行的数量：\n");
-        printf("    xsort file.txt | xuniq | xwc -l\n");
-        printf("  • 找出重复的行：\n");
-        printf("    xsort file.txt | xuniq -d\n");
-        printf("  • 统计每行出现的次数：\n");
-        printf("    xsort file.txt | xuniq -c | xsort -rn\n\n");
-        printf("对应系统命令: uniq\n");
+        fprintf(xio_stdout, "xuniq - 去除文件中的重复行\n\n");
+        fprintf(xio_stdout, "用法:\n");
+        fprintf(xio_stdout, "  xuniq [选项] [file]\n");
+        fprintf(xio_stdout, "  xuniq [选项]               # 从标准输入读取\n\n");
+        fprintf(xio_stdout, "说明:\n");
+        fprintf(xio_stdout, "  过滤相邻的重复行。\n");
+        fprintf(xio_stdout, "  Unique - 唯一。\n\n");
+        fprintf(xio_stdout, "重要提示:\n");
+        fprintf(xio_stdout, "  xuniq 只会去除**相邻**的重复行。\n");
+        fprintf(xio_stdout, "  如果要去除所有重复行，需要先排序：\n");
+        fprintf(xio_stdout, "    xsort file.txt | xuniq\n\n");
+        fprintf(xio_stdout, "参数:\n");
+        fprintf(xio_stdout, "  file      要处理的文件\n");
+        fprintf(xio_stdout, "            不指定文件则从标准输入读取\n\n");
+        fprintf(xio_stdout, "选项:\n");
+        fprintf(xio_stdout, "  -c        在每行前显示该行出现的次数\n");
+        fprintf(xio_stdout, "  -d        只显示重复的行（出现 > 1 次）\n");
+        fprintf(xio_stdout, "  -u        只显示不重复的行（出现 = 1 次）\n");
+        fprintf(xio_stdout, "  --help    显示此帮助信息\n\n");
+        fprintf(xio_stdout, "示例:\n");
+        fprintf(xio_stdout, "  xuniq file.txt             # 去除相邻重复行\n");
+        fprintf(xio_stdout, "  xuniq -c file.txt          # 显示每行出现次数\n");
+        fprintf(xio_stdout, "  xuniq -d file.txt          # 只显示重复行\n");
+        fprintf(xio_stdout, "  xuniq -u file.txt          # 只显示唯一行\n");
+        fprintf(xio_stdout, "  xsort file.txt | xuniq     # 排序后去重（完全去重）\n");
+        fprintf(xio_stdout, "  xsort file.txt | xuniq -c  # 统计每行出现次数\n");
+        fprintf(xio_stdout, "  xcat *.txt | xsort | xuniq # 合并文件并去重\n\n");
+        fprintf(xio_stdout, "工作原理:\n");
+        fprintf(xio_stdout, "  输入：    输出（默认）：\n");
+        fprintf(xio_stdout, "  aaa       aaa\n");
+        fprintf(xio_stdout, "  aaa       bbb\n");
+        fprintf(xio_stdout, "  bbb       aaa\n");
+        fprintf(xio_stdout, "  aaa       \n");
+        fprintf(xio_stdout, "  \n");
+        fprintf(xio_stdout, "  注意：第三个 aaa 与前面不相邻，所以会输出。\n\n");
+        fprintf(xio_stdout, "  输入：    排序后：  去重后：\n");
+        fprintf(xio_stdout, "  aaa       aaa       aaa\n");
+        fprintf(xio_stdout, "  aaa       aaa       bbb\n");
+        fprintf(xio_stdout, "  bbb       aaa       \n");
+        fprintf(xio_stdout, "  aaa       bbb       \n\n");
+        fprintf(xio_stdout, "常见用法:\n");
+        fprintf(xio_stdout, "  • 统计文件中不同行的数量：\n");
+        fprintf(xio_stdout, "    xsort file.txt | xuniq | xwc -l\n");
+        fprintf(xio_stdout, "  • 找出重复的行：\n");
+        fprintf(xio_stdout, "    xsort file.txt | xuniq -d\n");
+        fprintf(xio_stdout, "  • 统计每行出现的次数：\n");
+        fprintf(xio_stdout, "    xsort file.txt | xuniq -c | xsort -rn\n\n");
+        fprintf(xio_stdout, "对应系统命令: uniq\n");
         return 0;
     }
     
@@ -5,9 +5,9 @@
  * 用法：xunset VAR [VAR2 ...]
  */
 
-#define _POSIX_C_SOURCE 200809L  // 启用 unsetenv
-
 #include "builtin.h"
+#include "pathcache.h"
+#include "vars.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -75,10 +75,11 @@ int cmd_xunset(Command *cmd, ShellContext *ctx) {
             continue;
         }
         
-        // 删除环境变量
-        if (unsetenv(var_name) != 0) {
-            XSHELL_LOG_PERROR(ctx, "xunset");
-            has_error = 1;
+        // 删除变量（导出变量同时从进程环境中删除）
+        vars_unset(&ctx->vars, var_name);
+        if (strcmp(var_name, "PATH") == 0) {
+            // PATH 被删除后，之前缓存的命令路径全部失效
+            path_cache_clear();
         }
     }
     
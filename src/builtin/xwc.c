@@ -12,6 +12,7 @@
  */
 
 #include "builtin.h"
+#include "xio.h"
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
@@ -36,7 +37,8 @@ static int wc_file(const char* filename, const WcOptions* opts, WcStats* stats,
     FILE* file;
     int ch;
     int in_word = 0;
-    (void)opts;
+    // 只有需要输出字数时才逐字符判断单词边界，否则只用 memchr 数换行
+    int need_words = opts->words_only || (!opts->lines_only && !opts->bytes_only);
     
     stats->lines = 0;
     stats->words = 0;
@@ -44,7 +46,7 @@ static int wc_file(const char* filename, const WcOptions* opts, WcStats* stats,
     
     // 打开文件（"-" 表示标准输入）
     if (strcmp(filename, "-") == 0) {
-        file = stdin;
+        file = xio_stdin;
     } else {
         file = fopen(filename, "r");
         if (!file) {
@@ -53,27 +55,43 @@ static int wc_file(const char* filename, const WcOptions* opts, WcStats* stats,
         }
     }
     
-    // 逐字符读取并统计
-    while ((ch = fgetc(file)) != EOF) {
-        stats->bytes++;
+    // 按块读取并统计（比每个字符调用一次 fgetc 少很多函数调用和加锁）
+    unsigned char block[XIO_BLOCK_SIZE];
+    size_t n;
+    while ((n = fread(block, 1, sizeof(block), file)) > 0) {
+        stats->bytes += n;
         
-        if (ch == '\n') {
-            stats->lines++;
+        if (!need_words) {
+            const unsigned char *p = block;
+            const unsigned char *end = block + n;
+            while ((p = memchr(p, '\n', end - p)) != NULL) {
+                stats->lines++;
+                p++;
+            }
+            continue;
         }
         
-        // 统计字数：空白字符分隔
-        if (isspace(ch)) {
-            in_word = 0;
-        } else {
-            if (!in_word) {
-                stats->words++;
-                in_word = 1;
+        for (size_t i = 0; i < n; i++) {
+            ch = block[i];
+            
+            if (ch == '\n') {
+                stats->lines++;
+            }
+            
+            // 统计字数：空白字符分隔
+            if (isspace(ch)) {
+                in_word = 0;
+            } else {
+                if (!in_word) {
+                    stats->words++;
+                    in_word = 1;
+                }
             }
         }
     }
     
     // 关闭文件
-    if (file != stdin) {
+    if (file != xio_stdin) {
         fclose(file);
     }
     
@@ -87,57 +105,57 @@ static void print_stats(const WcStats* stats, const WcOptions* opts,
     int show_all = !opts->lines_only && !opts->words_only && !opts->bytes_only;
     
     if (show_all || opts->lines_only) {
-        printf("%7ld", stats->lines);
+        fprintf(xio_stdout, "%7ld", stats->lines);
     }
     
     if (show_all || opts->words_only) {
-        printf("%7ld", stats->words);
+        fprintf(xio_stdout, "%7ld", stats->words);
     }
     
     if (show_all || opts->bytes_only) {
-        printf("%7ld", stats->bytes);
+        fprintf(xio_stdout, "%7ld", stats->bytes);
     }
     
     if (filename) {
-        printf(" %s", filename);
+        fprintf(xio_stdout, " %s", filename);
     }
     
-    printf("\n");
+    fprintf(xio_stdout, "\n");
 }
 
 int cmd_xwc(Command* cmd, ShellContext* ctx) {
     // 显示帮助信息
     if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
-        printf("xwc - 统计文件的行数、字数和字节数\n\n");
-        printf("用法:\n");
-        printf("  xwc [选项] [file]...\n");
-        printf("  xwc [选项]                 # 从标准输入读取\n\n");
-        printf("说明:\n");
-        printf("  统计文件的行数、字数和字节数。\n");
-        printf("  Word Count - 字数统计。\n\n");
-        printf("参数:\n");
-        printf("  file      要统计的文件（可以多个）\n");
-        printf("            不指定文件则从标准输入读取\n\n");
-        printf("选项:\n");
-        printf("  -l        只显示行数\n");
-        printf("  -w        只显示字数\n");
-        printf("  -c        只显示字节数\n");
-        printf("  --help    显示此帮助信息\n\n");
-        printf("输出格式:\n");
-        printf("  默认格式：行数  字数  字节数  文件名\n");
-        printf("  例如：    100   500   3000  file.txt\n\n");
-        printf("字数定义:\n");
-        printf("  字数是指由空白字符（空格、制表符、换行）分隔的连续字符序列。\n\n");
-        printf("示例:\n");
-        printf("  xwc file.txt               # 统计所有信息\n");
-        printf("  xwc -l file.txt            # 只统计行数\n");
-        printf("  xwc -w file.txt            # 只统计字数\n");
-        printf("  xwc -c file.txt            # 只统计字节数\n");
-        printf("  xwc *.txt                  # 统计多个文件\n");
-        printf("  xwc -l *.c                 # 统计所有C文件的行数\n");
-        printf("  xcat file.txt | xwc        # 从管道读取\n");
-        printf("  xcat file.txt | xwc -l     # 统计管道输入的行数\n\n");
-        printf("对应系统命令: wc\n");
+        fprintf(xio_stdout, "xwc - 统计文件的行数、字数和字节数\n\n");
+        fprintf(xio_stdout, "用法:\n");
+        fprintf(xio_stdout, "  xwc [选项] [file]...\n");
+        fprintf(xio_stdout, "  xwc [选项]                 # 从标准输入读取\n\n");
+        fprintf(xio_stdout, "说明:\n");
+        fprintf(xio_stdout, "  统计文件的行数、字数和字节数。\n");
+        fprintf(xio_stdout, "  Word Count - 字数统计。\n\n");
+        fprintf(xio_stdout, "参数:\n");
+        fprintf(xio_stdout, "  file      要统计的文件（可以多个）\n");
+        fprintf(xio_stdout, "            不指定文件则从标准输入读取\n\n");
+        fprintf(xio_stdout, "选项:\n");
+        fprintf(xio_stdout, "  -l        只显示行数\n");
+        fprintf(xio_stdout, "  -w        只显示字数\n");
+        fprintf(xio_stdout, "  -c        只显示字节数\n");
+        fprintf(xio_stdout, "  --help    显示此帮助信息\n\n");
+        fprintf(xio_stdout, "输出格式:\n");
+        fprintf(xio_stdout, "  默认格式：行数  字数  字节数  文件名\n");
+        fprintf(xio_stdout, "  例如：    100   500   3000  file.txt\n\n");
+        fprintf(xio_stdout, "字数定义:\n");
+        fprintf(xio_stdout, "  字数是指由空白字符（空格、制表符、换行）分隔的连续字符序列。\n\n");
+        fprintf(xio_stdout, "示例:\n");
+        fprintf(xio_stdout, "  xwc file.txt               # 统计所有信息\n");
+        fprintf(xio_stdout, "  xwc -l file.txt            # 只统计行数\n");
+        fprintf(xio_stdout, "  xwc -w file.txt            # 只统计字数\n");
+        fprintf(xio_stdout, "  xwc -c file.txt            # 只统计字节数\n");
+        fprintf(xio_stdout, "  xwc *.txt                  # 统计多个文件\n");
+        fprintf(xio_stdout, "  xwc -l *.c                 # 统计所有C文件的行数\n");
+        fprintf(xio_stdout, "  xcat file.txt | xwc        # 从管道读取\n");
+        fprintf(xio_stdout, "  xcat file.txt | xwc -l     # 统计管道输入的行数\n\n");
+        fprintf(xio_stdout, "对应系统命令: wc\n");
         return 0;
     }
     
@@ -7,40 +7,23 @@
 
 #define _POSIX_C_SOURCE 200809L
 #include "builtin.h"
+#include "pathcache.h"
 #include <stdio.h>
 #include <string.h>
-#include <unistd.h>
-#include <stdlib.h>
 
-// 在PATH中搜索命令
+// 查找命令：内置命令直接说明，外部命令走 PATH 缓存
 static int find_command(const char *command) {
-    char *path_env = getenv("PATH");
-    if (!path_env) {
-        return -1;
+    if (builtin_lookup(command) != NULL) {
+        printf("%s: shell builtin\n", command);
+        return 0;
     }
     
-    // 复制PATH环境变量（因为strtok会修改字符串）
-    char *path_copy = strdup(path_env);
-    if (!path_copy) {
+    const char *path = path_cache_lookup(command);
+    if (path == NULL) {
         return -1;
     }
-    
-    char full_path[1024];
-    char *dir = strtok(path_copy, ":");
-    int found = 0;
-    
-    while (dir != NULL) {
-        snprintf(full_path, sizeof(full_path), "%s/%s", dir, command);
-        if (access(full_path, X_OK) == 0) {
-            printf("%s\n", full_path);
-            found = 1;
-            break;
-        }
-        dir = strtok(NULL, ":");
-    }
-    
-    free(path_copy);
-    return found ? 0 : -1;
+    printf("%s\n", path);
+    return 0;
 }
 
 int cmd_xwhich(Command *cmd, ShellContext *ctx) {
@@ -64,7 +47,7 @@ int cmd_xwhich(Command *cmd, ShellContext *ctx) {
         printf("  • 只搜索PATH环境变量中的目录\n");
         printf("  • 只返回第一个找到的路径\n");
         printf("  • 命令必须有可执行权限\n");
-        printf("  • 不会搜索内置命令和别名\n\n");
+        printf("  • 内置命令显示为 shell builtin，不搜索别名\n\n");
         printf("对应系统命令: which\n");
         return 0;
     }
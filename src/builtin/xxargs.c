@@ -0,0 +1,316 @@
+/*
+ * xxargs.c - 从标准输入构造参数并执行命令
+ *
+ * 功能：从标准输入读取条目（按换行或 NUL 分隔），追加到命令后面批量执行
+ * 用法：xxargs [-0] [-d 分隔符] [-n N] [-P N] [命令 [初始参数...]]
+ *
+ * 实现：
+ *   - 每次执行尽量多放条目：参数总长度不超过 ARG_MAX（减去环境变量和余量），
+ *     或者每次最多 -n 个
+ *   - 外部命令通过执行器的 spawn_external() 启动，-P N 时最多 N 个同时运行
+ *     （进程池见 parallel.c，Ctrl+C 通过 job.c 的 SIGINT 标志取消）
+ *   - 命令是内置命令时直接在当前进程中调用，不 fork
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "builtin.h"
+#include "executor.h"
+#include "parallel.h"
+#include "xio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// 参数总长度的余量（与 GNU xargs 相同）
+#define XXARGS_HEADROOM 2048
+
+// 没有指定命令时执行的命令
+#define XXARGS_DEFAULT_COMMAND "xecho"
+
+// 一批参数
+typedef struct {
+    char **argv;                    // 命令 + 初始参数 + 本批条目（以 NULL 结尾）
+    int fixed;                      // 命令和初始参数的个数（每批都相同）
+    int count;                      // 当前参数个数
+    int capacity;                   // argv 的容量（不含结尾的 NULL）
+    size_t fixed_size;              // 命令和初始参数占用的字节数
+    size_t size;                    // 当前参数占用的字节数（字符串 + 指针）
+    size_t size_limit;              // 参数总长度上限
+    int max_items;                  // 每批最多条目数（-n，0 表示不限）
+    int is_builtin;                 // 命令是否是内置命令
+    int not_found;                  // 命令不存在
+    ParallelPool pool;              // 正在运行的外部命令
+} XargsBatch;
+
+// 计算参数总长度上限：ARG_MAX 减去子进程的环境变量和余量
+static size_t arg_size_limit(ShellContext *ctx) {
+    long arg_max = sysconf(_SC_ARG_MAX);
+    if (arg_max <= 0) {
+        arg_max = 131072;
+    }
+    size_t env_size = 0;
+    char **envp = vars_envp(&ctx->vars);
+    for (char **env = envp; env != NULL && *env != NULL; env++) {
+        env_size += strlen(*env) + 1 + sizeof(char *);
+    }
+    if ((size_t)arg_max <= env_size + 2 * XXARGS_HEADROOM) {
+        return XXARGS_HEADROOM;
+    }
+    return (size_t)arg_max - env_size - XXARGS_HEADROOM;
+}
+
+// 解析 -d 的参数：单个字符，或转义 \n \t \0
+// 返回：0=成功，-1=无效
+static int parse_delimiter(const char *text, char *delim) {
+    if (text[0] == '\\' && text[1] != '\0' && text[2] == '\0') {
+        switch (text[1]) {
+            case 'n':  *delim = '\n'; return 0;
+            case 't':  *delim = '\t'; return 0;
+            case '0':  *delim = '\0'; return 0;
+            case '\\': *delim = '\\'; return 0;
+            default:   return -1;
+        }
+    }
+    if (text[0] == '\0' || text[1] != '\0') {
+        return -1;
+    }
+    *delim = text[0];
+    return 0;
+}
+
+// 解析正整数参数（-n、-P）；allow_zero 表示允许 0
+static int parse_count(const char *text, int allow_zero, int *value) {
+    char *end;
+    long n = strtol(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || n < (allow_zero ? 0 : 1) || n > PARALLEL_MAX_JOBS * 1024L) {
+        return -1;
+    }
+    *value = (int)n;
+    return 0;
+}
+
+// 执行当前这一批，然后清空条目（保留命令和初始参数）
+// 返回：0=继续，-1=停止读取（命令不存在或被 Ctrl+C 取消）
+static int run_batch(XargsBatch *batch, ShellContext *ctx) {
+    if (batch->count == batch->fixed) {
+        return 0;
+    }
+    batch->argv[batch->count] = NULL;
+
+    Command cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.name = batch->argv[0];
+    cmd.args = batch->argv;
+    cmd.arg_count = batch->count;
+
+    int result = 0;
+    if (batch->is_builtin) {
+        // 内置命令：在当前进程中直接调用
+        if (execute_builtin(&cmd, ctx) != 0) {
+            parallel_fail(&batch->pool);
+        }
+    } else if (parallel_wait_slot(&batch->pool) != 0) {
+        result = -1;
+    } else {
+        // 外部命令：标准输入接到 /dev/null，不和 xxargs 抢输入
+        cmd.stdin_file = "/dev/null";
+        fflush(xio_stdout);
+        int error_status;
+        pid_t pid = spawn_external(&cmd, ctx, &error_status);
+        if (pid > 0) {
+            parallel_track(&batch->pool, pid);
+        } else {
+            parallel_fail(&batch->pool);
+            if (error_status == 127) {
+                batch->not_found = 1;
+                result = -1;
+            }
+        }
+    }
+
+    // 启动器在返回前已经把参数复制给子进程，这里可以释放
+    for (int i = batch->fixed; i < batch->count; i++) {
+        free(batch->argv[i]);
+    }
+    batch->count = batch->fixed;
+    batch->size = batch->fixed_size;
+    return result;
+}
+
+// 把一个条目加入当前批次（放不下时先执行当前批次）
+// 返回：0=继续，-1=停止读取
+static int add_item(XargsBatch *batch, const char *item, size_t len, ShellContext *ctx) {
+    size_t item_size = len + 1 + sizeof(char *);
+    if (batch->fixed_size + item_size > batch->size_limit) {
+        XSHELL_LOG_ERROR(ctx, "xxargs: argument too long (%zu bytes), skipped\n", len);
+        parallel_fail(&batch->pool);
+        return 0;
+    }
+    int items = batch->count - batch->fixed;
+    if (items > 0 && (batch->size + item_size > batch->size_limit ||
+                      (batch->max_items > 0 && items >= batch->max_items))) {
+        if (run_batch(batch, ctx) != 0) {
+            return -1;
+        }
+    }
+
+    if (batch->count >= batch->capacity) {
+        int capacity = batch->capacity * 2;
+        char **argv = realloc(batch->argv, (size_t)(capacity + 1) * sizeof(char *));
+        if (argv == NULL) {
+            perror("xxargs");
+            return -1;
+        }
+        batch->argv = argv;
+        batch->capacity = capacity;
+    }
+    char *copy = malloc(len + 1);
+    if (copy == NULL) {
+        perror("xxargs");
+        return -1;
+    }
+    memcpy(copy, item, len);
+    copy[len] = '\0';
+    batch->argv[batch->count++] = copy;
+    batch->size += item_size;
+    return 0;
+}
+
+int cmd_xxargs(Command *cmd, ShellContext *ctx) {
+    // 显示帮助信息
+    if (cmd->arg_count >= 2 && strcmp(cmd->args[1], "--help") == 0) {
+        printf("xxargs - 从标准输入构造参数并执行命令\n\n");
+        printf("用法:\n");
+        printf("  xxargs [选项] [命令 [初始参数...]]\n\n");
+        printf("说明:\n");
+        printf("  从标准输入读取条目（每行一个），追加到命令后面执行。\n");
+        printf("  每次执行尽量放入更多条目（不超过系统的 ARG_MAX 限制）。\n");
+        printf("  eXtended ARGuments - 扩展参数。\n\n");
+        printf("选项:\n");
+        printf("  -0        条目以 NUL 字符分隔（配合 find -print0）\n");
+        printf("  -d C      条目以字符 C 分隔（支持 \\n \\t \\0）\n");
+        printf("  -n N      每次执行最多使用 N 个条目\n");
+        printf("  -P N      最多同时执行 N 个命令（0 表示 CPU 核数，默认 1）\n");
+        printf("  --help    显示此帮助信息\n\n");
+        printf("示例:\n");
+        printf("  xfind . -name '*.c' | xxargs xwc -l       # 统计所有 .c 文件的行数\n");
+        printf("  xls | xxargs -n 1 xecho file:           # 每个条目执行一次\n");
+        printf("  xcat hosts.txt | xxargs -n 1 -P 8 ping -c 1   # 8 个同时执行\n\n");
+        printf("注意:\n");
+        printf("  • 默认命令是 xecho\n");
+        printf("  • 按换行分隔时忽略空行\n");
+        printf("  • 内置命令在 Shell 进程中直接执行（不创建子进程，-P 不起作用）\n");
+        printf("  • 外部命令的标准输入是 /dev/null\n");
+        printf("  • 退出码：全部成功为 0，有命令失败为 123，命令不存在为 127，Ctrl+C 为 130\n\n");
+        printf("对应系统命令: xargs\n");
+        return 0;
+    }
+
+    // 解析选项（遇到第一个非选项参数为止，之后是命令）
+    char delim = '\n';
+    int max_items = 0;
+    int jobs = 1;
+    int i = 1;
+    for (; i < cmd->arg_count && cmd->args[i][0] == '-' && cmd->args[i][1] != '\0'; i++) {
+        const char *opt = cmd->args[i];
+        if (strcmp(opt, "--") == 0) {
+            i++;
+            break;
+        }
+        if (strcmp(opt, "-0") == 0) {
+            delim = '\0';
+            continue;
+        }
+        if (opt[1] != 'd' && opt[1] != 'n' && opt[1] != 'P') {
+            XSHELL_LOG_ERROR(ctx, "xxargs: invalid option '%s'\n", opt);
+            XSHELL_LOG_ERROR(ctx, "Try 'xxargs --help' for more information.\n");
+            return -1;
+        }
+
+        // 选项值可以紧跟（-n5）或作为下一个参数（-n 5）
+        const char *value = opt + 2;
+        if (*value == '\0') {
+            if (i + 1 >= cmd->arg_count) {
+                XSHELL_LOG_ERROR(ctx, "xxargs: option '%s' requires an argument\n", opt);
+                return -1;
+            }
+            value = cmd->args[++i];
+        }
+        int ok;
+        if (opt[1] == 'd') {
+            ok = parse_delimiter(value, &delim);
+        } else if (opt[1] == 'n') {
+            ok = parse_count(value, 0, &max_items);
+        } else {
+            ok = parse_count(value, 1, &jobs);
+        }
+        if (ok != 0) {
+            XSHELL_LOG_ERROR(ctx, "xxargs: invalid argument '%s' for '-%c'\n", value, opt[1]);
+            return -1;
+        }
+    }
+
+    // 命令和初始参数
+    XargsBatch batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.fixed = (i < cmd->arg_count) ? cmd->arg_count - i : 1;
+    batch.capacity = batch.fixed + 64;
+    batch.argv = malloc((size_t)(batch.capacity + 1) * sizeof(char *));
+    if (batch.argv == NULL) {
+        perror("xxargs");
+        return -1;
+    }
+    if (i < cmd->arg_count) {
+        memcpy(batch.argv, cmd->args + i, (size_t)batch.fixed * sizeof(char *));
+    } else {
+        batch.argv[0] = XXARGS_DEFAULT_COMMAND;
+    }
+    batch.count = batch.fixed;
+    for (int k = 0; k < batch.fixed; k++) {
+        batch.fixed_size += strlen(batch.argv[k]) + 1 + sizeof(char *);
+    }
+    batch.size = batch.fixed_size;
+    batch.size_limit = arg_size_limit(ctx);
+    batch.max_items = max_items;
+    batch.is_builtin = is_builtin(batch.argv[0]);
+    if (parallel_init(&batch.pool, jobs) != 0) {
+        free(batch.argv);
+        return -1;
+    }
+
+    // 逐个读取条目
+    char *line = NULL;
+    size_t line_capacity = 0;
+    ssize_t len;
+    int stop = 0;
+    while (!stop && (len = getdelim(&line, &line_capacity, delim, xio_stdin)) != -1) {
+        if (len > 0 && line[len - 1] == delim) {
+            line[--len] = '\0';
+        }
+        if (len == 0 && delim == '\n') {
+            continue;                               // 忽略空行
+        }
+        stop = (add_item(&batch, line, (size_t)len, ctx) != 0);
+    }
+    free(line);
+    if (!stop) {
+        run_batch(&batch, ctx);
+    }
+
+    // 等待所有命令结束
+    int failed = parallel_finish(&batch.pool);
+    for (int k = batch.fixed; k < batch.count; k++) {
+        free(batch.argv[k]);
+    }
+    free(batch.argv);
+    fflush(xio_stdout);
+
+    if (failed == 130) {
+        return 130;
+    }
+    if (batch.not_found) {
+        return 127;
+    }
+    return (failed > 0) ? 123 : 0;
+}
@@ -5,6 +5,7 @@
 // 引入头文件
 #include "completion.h"                                 // Tab 补全功能声明
 #include "utils.h"                                      // 工具函数（normalize_path）
+#include "builtin.h"                                    // 内置命令注册表（命令名和选项）
 #include <stdio.h>                                      // 标准输入输出
 #include <stdlib.h>                                     // 内存管理（malloc, free）
 #include <string.h>                                     // 字符串处理（strcmp, strcpy, strdup 等）
@@ -250,8 +251,12 @@ CompletionType get_completion_type(const char *input, int cursor_pos) {
     }
     
     if (arg_start < len) {
-        // 检查是否以 -- 或 - 开头
-        if (before_cursor[arg_start] == '-' && arg_start + 1 < len && before_cursor[arg_start + 1] == '-') {
+        // 检查当前正在输入的单词是否以 - 开头
+        int word_start = len;
+        while (word_start > arg_start && before_cursor[word_start - 1] != ' ' && before_cursor[word_start - 1] != '\t') {
+            word_start--;
+        }
+        if (word_start < len && before_cursor[word_start] == '-') {
             return COMPLETION_TYPE_OPTION;  // 选项补全
         }
         
@@ -272,31 +277,17 @@ CompletionType get_completion_type(const char *input, int cursor_pos) {
 }
 
 // 获取命令名补全
+// 说明：内置命令列表来自注册表（builtin_table.c），与执行器保持一致
 int get_command_completions(const char *partial, char ***matches) {
-    // 内置命令列表（从 executor.c 中获取）
-    const char *builtins[] = {
-        "xpwd", "xcd", "xls", "xecho", "quit",
-        "xtouch", "xcat", "xrm", "xcp", "xmv",
-        "xhistory", "xtec", "xmkdir", "xrmdir", "xln",
-        "xchmod", "xfind", "xuname", "xhostname", "xwhoami",
-        "xdate", "xuptime", "xps", "xbasename", "xdirname",
-        "xreadlink", "xcut", "xpaste", "xtr", "xcomm",
-        "xstat", "xfile", "xdu", "xdf", "xsplit",
-        "xjoin", "xrealpath", "xmenu",
-        "xdiff", "xgrep", "xwc", "xhead", "xtail",
-        "xsort", "xuniq", "xenv", "xexport", "xunset",
-        "xalias", "xunalias", "xclear", "xhelp", "xtype",
-        "xwhich", "xsleep", "xcalc", "xtree", "xsource",
-        "xtime", "xkill", "xjobs", "xfg", "xbg",
-        NULL
-    };
+    int table_count = 0;
+    const BuiltinEntry *table = builtin_table(&table_count);
     
     int partial_len = strlen(partial);
     int count = 0;
     
     // 第一遍：统计匹配数量
-    for (int i = 0; builtins[i] != NULL; i++) {
-        if (strncmp(builtins[i], partial, partial_len) == 0) {
+    for (int i = 0; i < table_count; i++) {
+        if (strncmp(table[i].name, partial, partial_len) == 0) {
             count++;
         }
     }
@@ -314,9 +305,9 @@ int get_command_completions(const char *partial, char ***matches) {
     
     // 第二遍：收集匹配项
     int index = 0;
-    for (int i = 0; builtins[i] != NULL && index < count; i++) {
-        if (strncmp(builtins[i], partial, partial_len) == 0) {
-            (*matches)[index] = strdup(builtins[i]);
+    for (int i = 0; i < table_count && index < count; i++) {
+        if (strncmp(table[i].name, partial, partial_len) == 0) {
+            (*matches)[index] = strdup(table[i].name);
             index++;
         }
     }
@@ -325,52 +316,24 @@ int get_command_completions(const char *partial, char ***matches) {
 }
 
 // 获取选项补全
+// 说明：内置命令的选项来自注册表的 options 字段（空格分隔），
+//       其他命令只补全通用的 --help
 int get_option_completions(const char *cmd_name, const char *partial, char ***matches) {
-    // 常见选项列表（简化实现，可以根据命令动态生成）
-    const char *common_options[] = {
-        "--help", "-h", "--version", "-v"
-    };
-    
-    // 根据命令名返回特定选项（简化实现）
-    // 实际应该解析命令的帮助信息或定义
-    const char *options[20];
-    int option_count = 0;
-    
-    // 添加通用选项
-    options[option_count++] = "--help";
-    options[option_count++] = "-h";
-    
-    // 根据命令添加特定选项（简化实现）
-    if (strcmp(cmd_name, "xls") == 0) {
-        options[option_count++] = "-l";
-        options[option_count++] = "-a";
-        options[option_count++] = "-h";
-        options[option_count++] = "-R";
-    } else if (strcmp(cmd_name, "xcp") == 0) {
-        options[option_count++] = "-r";
-        options[option_count++] = "-R";
-        options[option_count++] = "--progress";
-    } else if (strcmp(cmd_name, "xcat") == 0) {
-        options[option_count++] = "-n";
-        options[option_count++] = "-b";
-    } else if (strcmp(cmd_name, "xrm") == 0) {
-        options[option_count++] = "-r";
-        options[option_count++] = "-f";
-        options[option_count++] = "-i";
-    } else if (strcmp(cmd_name, "xfind") == 0) {
-        options[option_count++] = "-name";
-        options[option_count++] = "-type";
-        options[option_count++] = "-size";
-    }
+    const BuiltinEntry *entry = builtin_lookup(cmd_name);
+    const char *option_list = (entry != NULL) ? entry->options : "--help";
     
     int partial_len = strlen(partial);
     int count = 0;
     
     // 第一遍：统计匹配数量
-    for (int i = 0; i < option_count; i++) {
-        if (strncmp(options[i], partial, partial_len) == 0) {
+    const char *p = option_list;
+    while (*p != '\0') {
+        size_t len = strcspn(p, " ");
+        if (len > 0 && (int)len >= partial_len && strncmp(p, partial, partial_len) == 0) {
             count++;
         }
+        p += len;
+        while (*p == ' ') p++;
     }
     
     if (count == 0) {
@@ -386,14 +349,18 @@ int get_option_completions(const char *cmd_name, const char *partial, char ***ma
     
     // 第二遍：收集匹配项
     int index = 0;
-    for (int i = 0; i < option_count && index < count; i++) {
-        if (strncmp(options[i], partial, partial_len) == 0) {
-            (*matches)[index] = strdup(options[i]);
+    p = option_list;
+    while (*p != '\0' && index < count) {
+        size_t len = strcspn(p, " ");
+        if (len > 0 && (int)len >= partial_len && strncmp(p, partial, partial_len) == 0) {
+            (*matches)[index] = strndup(p, len);
             index++;
         }
+        p += len;
+        while (*p == ' ') p++;
     }
     
-    return count;
+    return index;
 }
 
 // 获取增强路径补全
@@ -576,9 +543,10 @@ int get_smart_completions(const char *input, int cursor_pos, char ***matches) {
                 cmd_name[cmd_len] = '\0';
             }
             
-            int opt_start = cmd_end;
-            while (opt_start < cursor_pos && (input[opt_start] == ' ' || input[opt_start] == '\t')) {
-                opt_start++;
+            // 当前单词：从光标向前找到空白为止
+            int opt_start = cursor_pos;
+            while (opt_start > cmd_end && input[opt_start - 1] != ' ' && input[opt_start - 1] != '\t') {
+                opt_start--;
             }
             
             int opt_len = cursor_pos - opt_start;
@@ -1,13 +1,20 @@
 // 定义 POSIX 标准版本，启用 strdup 等函数
 #define _POSIX_C_SOURCE 200809L
+// 启用 GNU 扩展：memfd_create（here-document 的匿名内存文件）
+#define _GNU_SOURCE
 
 // 引入自定义头文件
 #include "executor.h"                                           // 命令执行函数声明
-#include "builtin.h"                                            // 内置命令函数声明（cmd_xpwd, cmd_quit等）
-#include "xui.h"                                                 // UI 系统函数声明
-#include "xweb.h"                                                // 网页浏览器函数声明
-#include "xgame.h"                                               // 游戏函数声明
+#include "builtin.h"                                            // 内置命令注册表（builtin_lookup）
 #include "job.h"                                                 // 作业管理函数声明
+#include "launcher.h"                                            // 进程启动器（posix_spawn）
+#include "pathcache.h"                                           // PATH 查找缓存
+#include "xio.h"                                                 // 内置命令标准流、环形缓冲区
+#include "brace.h"                                               // 大括号范围生成器
+#include "vars.h"                                                // Shell 变量表
+#include "alias.h"                                               // 别名展开
+#include "parallel.h"                                            // 并行 for 循环的工作进程池
+#include "wildcard.h"                                            // 通配符展开
 
 // 引入标准库
 #include <stdio.h>                                              // 标准输入输出（fprintf）
@@ -16,219 +23,592 @@
 #include <sys/types.h>                                           // 系统类型（pid_t）
 #include <sys/wait.h>                                           // 进程等待（waitpid）
 #include <sys/stat.h>                                           // 文件状态（stat）
+#include <sys/mman.h>                                           // memfd_create
 #include <fcntl.h>                                              // 文件控制（open, O_CREAT等）
 #include <errno.h>                                              // 错误号（errno, strerror）
 #include <stdlib.h>                                             // 标准库（atoi, malloc, realloc, free）
+#include <limits.h>                                             // INT_MAX
+#include <signal.h>                                             // 信号屏蔽（pthread_sigmask）
+#include <pthread.h>                                            // 管道工作线程
 
-// 大括号展开：展开 {start..end} 表达式
-// 例如：test{1..3}.txt -> test1.txt test2.txt test3.txt
-// 返回：展开后的字符串数组，以 NULL 结尾，调用者负责释放
-char** expand_brace(const char *arg) {
-    if (arg == NULL) {
+// 特殊参数 $? 和 $$ 的文本
+// 说明：展开只在主线程中进行（管道线程启动之前），静态缓冲区即可
+static char g_status_text[16];
+static char g_pid_text[16];
+
+// 特殊参数的值（$? 取 ctx->last_exit_status，$$ 取 Shell 的进程号）
+// 返回：不是特殊参数返回 NULL
+static const char* special_param_value(const char *name, ShellContext *ctx) {
+    if (name[0] == '\0' || name[1] != '\0') {
         return NULL;
     }
-    
-    // 查找大括号 {start..end}
-    const char *open_brace = strchr(arg, '{');
-    if (open_brace == NULL) {
-        // 没有大括号，返回原参数
-        char **result = malloc(2 * sizeof(char*));
-        if (result == NULL) {
-            return NULL;
+    if (name[0] == '?') {
+        // 内置命令出错时返回 -1，按一般错误 1 显示；其他与子进程的退出码一样取低 8 位
+        int status = ctx->last_exit_status;
+        snprintf(g_status_text, sizeof(g_status_text), "%d", (status < 0) ? 1 : (status & 0xFF));
+        return g_status_text;
+    }
+    if (name[0] == '$') {
+        snprintf(g_pid_text, sizeof(g_pid_text), "%d", (int)getpid());
+        return g_pid_text;
+    }
+    return NULL;
+}
+
+// 单词组成部分的值
+// 说明：变量在 Shell 变量表中查找一次，不分配内存
+static const char* word_part_value(const WordPart *part, ShellContext *ctx) {
+    const char *value;
+    switch (part->type) {
+        case WORD_VAR:
+            value = vars_get(&ctx->vars, part->text);
+            if (value == NULL) {
+                value = special_param_value(part->text, ctx);
+            }
+            return (value != NULL) ? value : "";   // 未定义的变量展开为空字符串
+        case WORD_TILDE:
+            value = vars_get(&ctx->vars, "HOME");
+            return (value != NULL) ? value : "/tmp";
+        case WORD_SLOT:
+            return (*part->slot != NULL) ? *part->slot : "";
+        default:
+            return part->text;
+    }
+}
+
+// ============================================
+// 命令替换 $(...)
+// ============================================
+// 按命令的形式选择执行方式：
+//   - 全部是通过 xio 输出的内置命令（包括它们组成的管道）：在 Shell 进程内执行，
+//     xio_stdout 指向内存流（open_memstream），不 fork
+//   - 单个外部命令：由启动器直接启动，标准输出接到管道，读入不断增长的缓冲区
+//   - 其他（xcd 等修改 Shell 状态的命令、for 循环、混合管道等）：
+//     fork 子 Shell 执行，与 sh 一样不影响当前 Shell
+// 输出末尾的换行符全部去掉；命令的退出状态写入 $?
+// ============================================
+
+static int expand_command(Command *cmd, ShellContext *ctx);
+static pid_t launch_external(Command *cmd, ShellContext *ctx, int out_fd, pid_t pgid, int *error_status);
+static size_t assignment_name_len(const Word *word);
+
+// 判断命令替换能否在 Shell 进程内执行
+// 条件：每条命令都是带 BUILTIN_XIO 和 BUILTIN_PIPE_SAFE 标志的内置命令（命令名是纯文本、不是别名），
+//       没有重定向、不在后台执行；管道要求线程阶段可用
+static int subst_in_process(const Command *sub) {
+    for (const Command *list = sub; list != NULL; list = list->chain_next) {
+        if (list->background || (list->pipe_next != NULL && !xio_threads_enabled())) {
+            return 0;
+        }
+        for (const Command *stage = list; stage != NULL; stage = stage->pipe_next) {
+            const char *name = (stage->words != NULL) ? word_literal(stage->words) : NULL;
+            if (stage->loop != NULL || name == NULL || alias_get(name) != NULL ||
+                stage->stdout_word != NULL || stage->stderr_word != NULL || stage->stdin_word != NULL) {
+                return 0;
+            }
+            const BuiltinEntry *entry = builtin_lookup(name);
+            if (entry == NULL || !(entry->flags & BUILTIN_XIO) || !(entry->flags & BUILTIN_PIPE_SAFE)) {
+                return 0;
+            }
         }
-        result[0] = strdup(arg);
-        result[1] = NULL;
-        return result;
     }
-    
-    const char *close_brace = strchr(open_brace, '}');
-    if (close_brace == NULL) {
-        // 没有闭合大括号，返回原参数
-        char **result = malloc(2 * sizeof(char*));
-        if (result == NULL) {
-            return NULL;
+    return 1;
+}
+
+// 判断命令替换是否是单个外部命令（不需要 fork 子 Shell）
+static int subst_is_external(const Command *sub) {
+    const char *name = (sub->words != NULL) ? word_literal(sub->words) : NULL;
+    return sub->chain_next == NULL && sub->pipe_next == NULL && sub->loop == NULL && !sub->background &&
+           name != NULL && alias_get(name) == NULL && builtin_lookup(name) == NULL &&
+           assignment_name_len(sub->words) == 0;
+}
+
+// 读取描述符中的全部内容（直到 EOF）
+// 返回：malloc 分配的缓冲区（不以 '\0' 结尾），len 为长度；内存不足返回 NULL
+static char* read_all(int fd, size_t *len_out) {
+    size_t capacity = 4096;
+    size_t len = 0;
+    char *buffer = malloc(capacity);
+    if (buffer == NULL) {
+        return NULL;
+    }
+    for (;;) {
+        if (len == capacity) {
+            char *bigger = realloc(buffer, capacity * 2);
+            if (bigger == NULL) {
+                free(buffer);
+                return NULL;
+            }
+            buffer = bigger;
+            capacity *= 2;
         }
-        result[0] = strdup(arg);
-        result[1] = NULL;
-        return result;
+        ssize_t n = read(fd, buffer + len, capacity - len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        len += (size_t)n;
     }
-    
-    // 查找 .. 分隔符
-    const char *dots = strstr(open_brace, "..");
-    if (dots == NULL || dots >= close_brace) {
-        // 没有 .. 分隔符，返回原参数
-        char **result = malloc(2 * sizeof(char*));
-        if (result == NULL) {
-            return NULL;
+    *len_out = len;
+    return buffer;
+}
+
+// 等待子进程结束，返回与 $? 相同的退出状态
+static int wait_status(pid_t pid) {
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return -1;
         }
-        result[0] = strdup(arg);
-        result[1] = NULL;
-        return result;
     }
-    
-    // 提取前缀和后缀
-    size_t prefix_len = open_brace - arg;
-    size_t suffix_len = strlen(close_brace + 1);
-    
-    // 提取 start 和 end
-    size_t start_len = dots - (open_brace + 1);
-    size_t end_len = close_brace - (dots + 2);
-    
-    char *start_str = malloc(start_len + 1);
-    char *end_str = malloc(end_len + 1);
-    if (start_str == NULL || end_str == NULL) {
-        free(start_str);
-        free(end_str);
-        return NULL;
+    if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
     }
+    return WEXITSTATUS(status);
+}
+
+// 在 Shell 进程内执行，输出写到内存流
+static int capture_in_process(Command *sub, ShellContext *ctx, char **output, size_t *len) {
+    FILE *memory = open_memstream(output, len);
+    if (memory == NULL) {
+        *output = NULL;
+        return -1;
+    }
+    FILE *saved = xio_cur_out;
+    xio_cur_out = memory;
+    int status = execute_command(sub, ctx);
+    xio_cur_out = saved;
+    fclose(memory);                                             // 关闭后 *output / *len 才是最终结果
+    return status;
+}
+
+// 直接启动外部命令，从管道读取输出
+static int capture_external(Command *sub, ShellContext *ctx, char **output, size_t *len) {
+    int fds[2];
+    *output = NULL;
+    if (expand_command(sub, ctx) != 0 || pipe(fds) != 0) {
+        return -1;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
     
-    strncpy(start_str, open_brace + 1, start_len);
-    start_str[start_len] = '\0';
-    strncpy(end_str, dots + 2, end_len);
-    end_str[end_len] = '\0';
-    
-    // 转换为整数
-    int start = atoi(start_str);
-    int end = atoi(end_str);
-    
-    free(start_str);
-    free(end_str);
-    
-    // 计算范围大小
-    int step = (start <= end) ? 1 : -1;
-    int count = (start <= end) ? (end - start + 1) : (start - end + 1);
+    int status;
+    pid_t pid = launch_external(sub, ctx, fds[1], -1, &status);
+    close(fds[1]);                                              // 子进程退出后读端得到 EOF
+    *output = read_all(fds[0], len);
+    close(fds[0]);
+    return (pid > 0) ? wait_status(pid) : status;
+}
+
+// fork 子 Shell 执行，从管道读取输出
+static int capture_in_subshell(Command *sub, ShellContext *ctx, char **output, size_t *len) {
+    int fds[2];
+    *output = NULL;
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    fflush(stdout);                                             // 避免子进程重复输出未刷新的内容
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        // 子 Shell：标准输出接到管道，Ctrl+C 直接结束
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = SIG_DFL;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGINT, &sa, NULL);
+        close(fds[0]);
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[1]);
+        xio_cur_out = NULL;
+        
+        int status = execute_command(sub, ctx);
+        fflush(stdout);
+        _exit((status < 0) ? 1 : (status & 0xFF));              // 不回退父进程共享的 stdin 读位置
+    }
+    close(fds[1]);
+    *output = read_all(fds[0], len);
+    close(fds[0]);
+    return wait_status(pid);
+}
+
+// 执行命令替换
+// 返回：命令的输出（去掉末尾的换行符），分配在 arena 中；失败返回 NULL
+static char* run_substitution(Command *sub, Arena *arena, ShellContext *ctx) {
+    if (sub == NULL) {
+        ctx->last_exit_status = 0;
+        return "";                                              // 空的 $()
+    }
     
-    // 分配结果数组
-    char **result = malloc((count + 1) * sizeof(char*));
-    if (result == NULL) {
+    char *output;
+    size_t len = 0;
+    int status;
+    if (subst_in_process(sub)) {
+        status = capture_in_process(sub, ctx, &output, &len);
+    } else if (subst_is_external(sub)) {
+        status = capture_external(sub, ctx, &output, &len);
+    } else {
+        status = capture_in_subshell(sub, ctx, &output, &len);
+    }
+    ctx->last_exit_status = status;
+    if (output == NULL) {
+        perror("command substitution");
         return NULL;
     }
     
-    // 构建前缀和后缀字符串
-    char *prefix = malloc(prefix_len + 1);
-    char *suffix = malloc(suffix_len + 1);
-    if (prefix == NULL || suffix == NULL) {
-        free(prefix);
-        free(suffix);
-        free(result);
+    while (len > 0 && output[len - 1] == '\n') {
+        len--;
+    }
+    char *result = arena_strndup(arena, output, len);
+    free(output);
+    return result;
+}
+
+// 计算单词每个组成部分的值（其中的命令替换只执行一次）
+// 说明：变量的值复制一份，$? 的静态缓冲区会被后面的替换改写
+// 返回：与 parts 一一对应的数组（分配在 arena 中），失败返回 NULL
+static const char** word_part_values(const Word *word, Arena *arena, ShellContext *ctx) {
+    int count = 0;
+    for (const WordPart *part = word->parts; part != NULL; part = part->next) {
+        count++;
+    }
+    const char **values = arena_alloc(arena, count * sizeof(char*));
+    if (values == NULL) {
         return NULL;
     }
-    
-    strncpy(prefix, arg, prefix_len);
-    prefix[prefix_len] = '\0';
-    strcpy(suffix, close_brace + 1);
-    
-    // 生成展开后的字符串
-    int idx = 0;
-    for (int i = start; (step > 0) ? (i <= end) : (i >= end); i += step) {
-        // 计算需要的空间：前缀 + 数字字符串 + 后缀 + '\0'
-        int num_digits = (i == 0) ? 1 : 0;
-        int temp = (i < 0) ? -i : i;
-        while (temp > 0) {
-            num_digits++;
-            temp /= 10;
-        }
-        if (i < 0) num_digits++; // 负号
-        
-        size_t total_len = prefix_len + num_digits + suffix_len + 1;
-        result[idx] = malloc(total_len);
-        if (result[idx] == NULL) {
-            // 释放已分配的内存
-            for (int j = 0; j < idx; j++) {
-                free(result[j]);
-            }
-            free(result);
-            free(prefix);
-            free(suffix);
+    int i = 0;
+    for (const WordPart *part = word->parts; part != NULL; part = part->next, i++) {
+        if (part->type == WORD_SUBST || part->type == WORD_SUBST_QUOTED) {
+            values[i] = run_substitution(part->subst, arena, ctx);
+        } else if (part->type == WORD_VAR) {
+            values[i] = arena_strdup(arena, word_part_value(part, ctx));
+        } else {
+            values[i] = word_part_value(part, ctx);
+        }
+        if (values[i] == NULL) {
             return NULL;
         }
-        
-        snprintf(result[idx], total_len, "%s%d%s", prefix, i, suffix);
-        idx++;
     }
-    
-    result[idx] = NULL;
-    free(prefix);
-    free(suffix);
-    
-    return result;
+    return values;
 }
 
-// 展开命令参数中的大括号表达式
-// 返回：新的参数数组，调用者负责释放
-static char** expand_args(char **args, int arg_count) {
-    if (args == NULL || arg_count <= 0) {
+// 展开一个单词（替换 $变量、~ 和命令替换）
+// 返回：展开结果，分配在 arena 中（纯文本单词直接返回原文本，不复制）；失败返回 NULL
+static char* expand_word(const Word *word, Arena *arena, ShellContext *ctx) {
+    const char *literal = word_literal(word);
+    if (literal != NULL) {
+        return (char *)literal;
+    }
+    const char **values = NULL;
+    if (word->has_subst && (values = word_part_values(word, arena, ctx)) == NULL) {
         return NULL;
     }
     
-    // 第一遍：计算展开后的总参数数量
-    int total_count = 0;
-    char ***expanded = malloc(arg_count * sizeof(char**));
-    int *expanded_counts = malloc(arg_count * sizeof(int));
-    
-    if (expanded == NULL || expanded_counts == NULL) {
-        free(expanded);
-        free(expanded_counts);
+    // 第一遍计算长度，第二遍写入
+    size_t len = 0;
+    int i = 0;
+    for (const WordPart *part = word->parts; part != NULL; part = part->next, i++) {
+        len += strlen((values != NULL) ? values[i] : word_part_value(part, ctx));
+    }
+    char *result = arena_alloc(arena, len + 1);
+    if (result == NULL) {
         return NULL;
     }
+    char *pos = result;
+    i = 0;
+    for (const WordPart *part = word->parts; part != NULL; part = part->next, i++) {
+        const char *value = (values != NULL) ? values[i] : word_part_value(part, ctx);
+        size_t value_len = strlen(value);
+        memcpy(pos, value, value_len);
+        pos += value_len;
+    }
+    *pos = '\0';
+    return result;
+}
+
+// 通配符模式中需要转义的字符
+static int is_glob_special(char c) {
+    return c == '*' || c == '?' || c == '[' || c == '\\';
+}
+
+// 通配符展开：把单词转换成模式后在文件系统中匹配
+// 说明：只有未加引号的 * ? [（WORD_GLOB 部分）是通配符，
+//       引号中和变量值中的同样字符加 \ 转义，按普通字符匹配
+// 返回：匹配的个数（不是通配符或没有匹配时为 0），-1=内存不足
+static int expand_glob(const Word *word, Arena *arena, ShellContext *ctx, char ***matches) {
+    *matches = NULL;
+    if (!word->has_glob) {
+        return 0;
+    }
     
-    for (int i = 0; i < arg_count; i++) {
-        expanded[i] = expand_brace(args[i]);
-        if (expanded[i] == NULL) {
-            // 展开失败，使用原参数
-            expanded[i] = malloc(2 * sizeof(char*));
-            if (expanded[i] != NULL) {
-                expanded[i][0] = strdup(args[i]);
-                expanded[i][1] = NULL;
-            }
+    // 第一遍计算长度，第二遍写入
+    size_t len = 0;
+    for (const WordPart *part = word->parts; part != NULL; part = part->next) {
+        const char *value = word_part_value(part, ctx);
+        for (const char *c = value; *c != '\0'; c++) {
+            len += (part->type != WORD_GLOB && is_glob_special(*c)) ? 2 : 1;
         }
-        
-        // 计算展开后的数量
-        int count = 0;
-        if (expanded[i] != NULL) {
-            for (int j = 0; expanded[i][j] != NULL; j++) {
-                count++;
+    }
+    char *pattern = arena_alloc(arena, len + 1);
+    if (pattern == NULL) {
+        return -1;
+    }
+    char *pos = pattern;
+    for (const WordPart *part = word->parts; part != NULL; part = part->next) {
+        const char *value = word_part_value(part, ctx);
+        for (const char *c = value; *c != '\0'; c++) {
+            if (part->type != WORD_GLOB && is_glob_special(*c)) {
+                *pos++ = '\\';
             }
+            *pos++ = *c;
         }
-        expanded_counts[i] = count;
-        total_count += count;
     }
+    *pos = '\0';
     
-    // 第二遍：合并所有展开后的参数
-    char **result = malloc((total_count + 1) * sizeof(char*));
-    if (result == NULL) {
-        // 释放已分配的内存
-        for (int i = 0; i < arg_count; i++) {
-            if (expanded[i] != NULL) {
-                for (int j = 0; expanded[i][j] != NULL; j++) {
-                    free(expanded[i][j]);
+    if (!wildcard_has_magic(pattern)) {
+        return 0;                                               // 如单独的 [
+    }
+    return wildcard_expand(pattern, arena, matches);
+}
+
+// 参数列表（分配在 arena 中，末尾留一个位置给 NULL）
+typedef struct {
+    char **items;
+    int count;
+    int capacity;
+} ArgList;
+
+// 确保还能再放入 n 个参数
+// 返回：0=成功，-1=内存不足或参数太多
+static int arglist_reserve(ArgList *list, Arena *arena, unsigned long n) {
+    if (n > (unsigned long)(INT_MAX / 2 - list->count)) {
+        return -1;
+    }
+    if (list->count + (int)n < list->capacity) {
+        return 0;
+    }
+    int capacity = (list->count + (int)n) * 2;
+    char **items = arena_alloc(arena, capacity * sizeof(char*));
+    if (items == NULL) {
+        return -1;
+    }
+    if (list->count > 0) {
+        memcpy(items, list->items, list->count * sizeof(char*));
+    }
+    list->items = items;
+    list->capacity = capacity;
+    return 0;
+}
+
+// 判断 c 是否是 IFS 中的空白字符
+static int is_ifs_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n';
+}
+
+// 展开含命令替换的单词，把结果作为一个或多个参数追加到 list
+// 字段分割（与 sh 相同）：
+//   - 只分割未加引号的 $(...) 的输出，其他部分（包括 "$(...)"）原样保留
+//   - IFS 中的空白字符连续出现时算一个分隔符，开头和末尾的被忽略；
+//     其他字符（如 :）每个都是一个分隔符，两个之间是空字段
+//   - 没有设置 IFS 时为空格、制表符、换行；IFS 为空时不分割
+// 返回：0=成功，-1=失败
+static int expand_fields(const Word *word, Arena *arena, ShellContext *ctx, ArgList *list) {
+    const char **values = word_part_values(word, arena, ctx);
+    if (values == NULL) {
+        return -1;
+    }
+    const char *ifs = vars_get(&ctx->vars, "IFS");
+    if (ifs == NULL) {
+        ifs = " \t\n";
+    }
+    
+    // 当前字段在 field 中拼接，完成后复制成一个参数
+    size_t total = 0;
+    int i = 0;
+    for (const WordPart *part = word->parts; part != NULL; part = part->next, i++) {
+        total += strlen(values[i]);
+    }
+    char *field = arena_alloc(arena, total + 1);
+    if (field == NULL) {
+        return -1;
+    }
+    size_t len = 0;
+    int have_field = 0;                                         // 当前字段已经开始（可能是空字段，如 ""）
+    int after_space = 0;                                        // 上一个分隔符是空白
+    
+    i = 0;
+    for (const WordPart *part = word->parts; part != NULL; part = part->next, i++) {
+        const char *value = values[i];
+        if (part->type != WORD_SUBST || *ifs == '\0') {
+            size_t value_len = strlen(value);
+            memcpy(field + len, value, value_len);
+            len += value_len;
+            // 空的纯文本部分只来自引号（如 ""），同样产生一个参数
+            have_field |= (value_len > 0 || part->type == WORD_LITERAL || part->type == WORD_SUBST_QUOTED);
+            after_space &= (value_len == 0);
+            continue;
+        }
+        for (const char *c = value; *c != '\0'; c++) {
+            if (strchr(ifs, *c) == NULL) {
+                field[len++] = *c;
+                have_field = 1;
+                after_space = 0;
+                continue;
+            }
+            // 遇到分隔符：结束当前字段
+            int space = is_ifs_space(*c);
+            if (have_field || (!space && !after_space)) {
+                if (arglist_reserve(list, arena, 1) != 0) {
+                    return -1;
                 }
-                free(expanded[i]);
+                char *arg = arena_strndup(arena, field, len);
+                if (arg == NULL) {
+                    return -1;
+                }
+                list->items[list->count++] = arg;
+                len = 0;
+                have_field = 0;
+                after_space = space;
             }
         }
-        free(expanded);
-        free(expanded_counts);
+    }
+    if (have_field) {
+        if (arglist_reserve(list, arena, 1) != 0) {
+            return -1;
+        }
+        field[len] = '\0';
+        list->items[list->count++] = field;
+    }
+    return 0;
+}
+
+// 展开单词链表（变量、波浪号、大括号范围、通配符、命令替换）
+// 返回：以 NULL 结尾的字符串数组（分配在 arena 中），count 为元素个数；失败返回 NULL
+static char** expand_words(const Word *words, int word_count, Arena *arena, ShellContext *ctx, int *count_out) {
+    ArgList list = { NULL, 0, 0 };
+    if (arglist_reserve(&list, arena, word_count) != 0) {
         return NULL;
     }
     
-    int result_idx = 0;
-    for (int i = 0; i < arg_count; i++) {
-        if (expanded[i] != NULL) {
-            for (int j = 0; expanded[i][j] != NULL; j++) {
-                result[result_idx++] = expanded[i][j];
+    for (const Word *word = words; word != NULL; word = word->next) {
+        // 命令替换：输出可能分割成多个参数（不再做大括号和通配符展开）
+        if (word->has_subst) {
+            if (expand_fields(word, arena, ctx, &list) != 0) {
+                return NULL;
             }
-            free(expanded[i]); // 释放数组本身，但保留字符串
+            continue;
+        }
+        
+        char *text = expand_word(word, arena, ctx);
+        if (text == NULL) {
+            return NULL;
+        }
+        // 未加引号且展开为空的单词不产生参数（如未定义的 $VAR）
+        if (*text == '\0' && !word->quoted) {
+            continue;
         }
+        
+        // 大括号展开：一个单词可能变成多个参数（逐个格式化，不生成中间数组）
+        // 通配符展开：没有匹配时保留原单词（大括号范围生成的参数不再做通配符展开）
+        BraceRange range;
+        int is_range = word->has_brace && brace_range_init(&range, text);
+        char **matches = NULL;
+        int match_count = is_range ? 0 : expand_glob(word, arena, ctx, &matches);
+        if (match_count < 0) {
+            return NULL;
+        }
+        unsigned long item_count = is_range ? range.remaining : (match_count > 0) ? (unsigned long)match_count : 1;
+        if (item_count > (unsigned long)(INT_MAX / 2 - list.count)) {
+            fprintf(stderr, "xshell: %s: too many arguments\n", text);
+            return NULL;
+        }
+        if (arglist_reserve(&list, arena, item_count) != 0) {
+            return NULL;
+        }
+        
+        if (match_count > 0) {
+            memcpy(list.items + list.count, matches, match_count * sizeof(char*));
+            list.count += match_count;
+            continue;
+        }
+        if (!is_range) {
+            list.items[list.count++] = text;
+            continue;
+        }
+        size_t item_size = brace_range_max_len(&range);
+        char *item = arena_alloc(arena, item_size);
+        while (item != NULL && brace_range_next(&range, item, item_size)) {
+            list.items[list.count++] = item;
+            item = arena_alloc(arena, item_size);
+        }
+        if (item == NULL) {
+            return NULL;
+        }
+    }
+    list.items[list.count] = NULL;
+    *count_out = list.count;
+    return list.items;
+}
+
+// 展开命令的单词，填写 name / args / 重定向文件名
+// 说明：结果分配在命令的内存池中；每次执行前都重新展开，使用别名和变量的当前值
+// 返回：0=成功，-1=内存不足
+static int expand_command(Command *cmd, ShellContext *ctx) {
+    Arena *arena = cmd->arena;
+    int word_count = cmd->word_count;
+    const Word *words = cmd->words;
+    if (alias_expand(&words, arena, &word_count) != 0) {
+        return -1;
+    }
+    int count = 0;
+    char **args = expand_words(words, word_count, arena, ctx, &count);
+    if (args == NULL) {
+        return -1;
     }
-    result[result_idx] = NULL;
     
-    free(expanded);
-    free(expanded_counts);
+    cmd->args = args;
+    cmd->arg_count = count;
+    cmd->name = (count > 0) ? args[0] : NULL;
     
-    return result;
+    // 重定向文件名（不做大括号展开）
+    cmd->stdout_file = (cmd->stdout_word != NULL) ? expand_word(cmd->stdout_word, arena, ctx) : NULL;
+    cmd->stderr_file = (cmd->stderr_word != NULL) ? expand_word(cmd->stderr_word, arena, ctx) : NULL;
+    char *stdin_value = (cmd->stdin_word != NULL) ? expand_word(cmd->stdin_word, arena, ctx) : NULL;
+    if ((cmd->stdout_word != NULL && cmd->stdout_file == NULL) ||
+        (cmd->stderr_word != NULL && cmd->stderr_file == NULL) ||
+        (cmd->stdin_word != NULL && stdin_value == NULL)) {
+        return -1;
+    }
+    
+    // << / <<< 的内容：here-string 末尾加一个换行（与 sh 相同）
+    cmd->stdin_file = NULL;
+    cmd->stdin_text = NULL;
+    if (stdin_value == NULL || cmd->stdin_here == HERE_NONE) {
+        cmd->stdin_file = stdin_value;
+    } else if (cmd->stdin_here == HERE_STRING) {
+        size_t len = strlen(stdin_value);
+        cmd->stdin_text = arena_alloc(arena, len + 2);
+        if (cmd->stdin_text == NULL) {
+            return -1;
+        }
+        memcpy(cmd->stdin_text, stdin_value, len);
+        memcpy(cmd->stdin_text + len, "\n", 2);
+    } else {
+        cmd->stdin_text = stdin_value;
+    }
+    return 0;
 }
 
-// 在PATH中查找可执行文件（使用手动解析，避免strtok_r问题）
+// 在PATH中查找可执行文件
+// 说明：不含 '/' 的命令名通过 PATH 缓存查找（见 pathcache.c），
+//       只有第一次（或缓存失效后）才会逐个目录调用 access()
+// 返回：malloc 分配的完整路径，调用者负责释放；找不到返回 NULL
 static char* find_executable(const char *cmd_name) {
     if (cmd_name == NULL) {
         return NULL;
@@ -242,321 +622,899 @@ static char* find_executable(const char *cmd_name) {
         return NULL;
     }
     
-    // 从PATH环境变量中查找
-    char *path_env = getenv("PATH");
-    if (path_env == NULL || strlen(path_env) == 0) {
-        return NULL;
+    const char *cached = path_cache_lookup(cmd_name);
+    return (cached != NULL) ? strdup(cached) : NULL;
+}
+
+// 启动外部命令，缓存的路径失效时重新查找一次
+// 说明：缓存命中时不再检查文件是否还存在；如果程序已被删除或移动，
+//       posix_spawn 会返回 ENOENT，此时删除该缓存条目并重新在 PATH 中查找
+// 参数：exec_path - 输入已解析的路径，重新查找后会被替换（调用者负责释放）
+//       envp      - 子进程的环境变量（Shell 变量表中的导出变量）
+//       pgid      - 子进程的进程组（见 launch_process）
+static pid_t launch_with_retry(const char *cmd_name, char **exec_path, char *const argv[],
+                               char *const envp[], const int fds[3], pid_t pgid) {
+    pid_t pid = launch_process(*exec_path, argv, envp, fds, pgid);
+    if (pid >= 0 || errno != ENOENT || strchr(cmd_name, '/') != NULL) {
+        return pid;
     }
     
-    // 手动解析PATH，避免strtok_r在fork后的问题
-    char full_path[1024];
-    const char *p = path_env;
-    
-    while (*p != '\0') {
-        // 找到下一个冒号或字符串结尾
-        const char *end = strchr(p, ':');
-        if (end == NULL) {
-            end = p + strlen(p);
-        }
-        
-        // 提取目录路径
-        size_t dir_len = end - p;
-        if (dir_len > 0 && dir_len < sizeof(full_path) - strlen(cmd_name) - 2) {
-            strncpy(full_path, p, dir_len);
-            full_path[dir_len] = '\0';
-            
-            // 构建完整路径
-            if (full_path[dir_len - 1] != '/') {
-                strcat(full_path, "/");
-            }
-            strcat(full_path, cmd_name);
-            
-            // 检查文件是否存在且可执行
-            if (access(full_path, X_OK) == 0) {
-                return strdup(full_path);
-            }
-        }
-        
-        // 移动到下一个路径
-        if (*end == '\0') {
-            break;
-        }
-        p = end + 1;
+    path_cache_forget(cmd_name);
+    char *retry_path = find_executable(cmd_name);
+    if (retry_path == NULL) {
+        errno = ENOENT;
+        return -1;
     }
-    
-    return NULL;
+    free(*exec_path);
+    *exec_path = retry_path;
+    return launch_process(*exec_path, argv, envp, fds, pgid);
+}
+
+// 检查是否有输入重定向（< 文件、<< here-document 或 <<< here-string）
+static int has_stdin_redirect(Command *cmd) {
+    return cmd->stdin_file != NULL || cmd->stdin_text != NULL;
 }
 
 // 检查是否有任何重定向
 static int has_redirect(Command *cmd) {
-    return (cmd->stdout_file != NULL || cmd->stderr_file != NULL || cmd->stdin_file != NULL);
+    return (cmd->stdout_file != NULL || cmd->stderr_file != NULL || has_stdin_redirect(cmd));
 }
 
-// 设置多重定向
-static int setup_redirect(Command *cmd) {
-    int fd = -1;
+// 不超过这个长度的 here-document 写到管道（一次写入不会阻塞），更长的写到内存文件
+#define HEREDOC_PIPE_MAX PIPE_BUF
+
+// 把 here-document 的内容放到一个可读的描述符中（不创建磁盘上的临时文件）
+// 说明：
+//   - 短内容：写入管道后关闭写端，读端读完得到 EOF
+//   - 长内容：写入 memfd_create 创建的匿名内存文件，再回到开头；
+//     它是普通文件，内置命令可以直接 mmap（见 xio_map）
+// 返回：读端描述符（带 FD_CLOEXEC），失败返回 -1
+static int open_heredoc(const char *text) {
+    size_t len = strlen(text);
+    int fd;
+    if (len <= HEREDOC_PIPE_MAX) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            return -1;
+        }
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        ssize_t written = write(fds[1], text, len);
+        close(fds[1]);
+        if (written != (ssize_t)len) {
+            close(fds[0]);
+            return -1;
+        }
+        return fds[0];
+    }
+    
+    fd = memfd_create("xshell-heredoc", MFD_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    for (size_t done = 0; done < len; ) {
+        ssize_t n = write(fd, text + done, len - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            close(fd);
+            return -1;
+        }
+        done += (size_t)n;
+    }
+    lseek(fd, 0, SEEK_SET);
+    return fd;
+}
+
+// 打开命令的所有重定向文件（在父进程中完成）
+// 功能：按 stdout/stderr/stdin 的顺序打开文件，结果放入 fds[1]/fds[2]/fds[0]
+//       没有重定向的位置为 -1；打开的描述符都带 O_CLOEXEC，不会泄漏给其他子进程
+// 返回：0=成功，-1=失败（已打开的描述符会被关闭）
+static int open_redirects(Command *cmd, int fds[3]) {
+    fds[0] = fds[1] = fds[2] = -1;
     
-    // 设置标准输出重定向
+    // 标准输出重定向
     if (cmd->stdout_file != NULL) {
-        int flags = O_CREAT | O_WRONLY;
+        int flags = O_CREAT | O_WRONLY | O_CLOEXEC;
         flags |= cmd->stdout_append ? O_APPEND : O_TRUNC;
-        
-        fd = open(cmd->stdout_file, flags, 0644);
-        if (fd < 0) {
+        fds[1] = open(cmd->stdout_file, flags, 0644);
+        if (fds[1] < 0) {
             perror("open stdout");
             return -1;
         }
-        
-        if (dup2(fd, STDOUT_FILENO) < 0) {
-            perror("dup2 stdout");
-            close(fd);
-            return -1;
-        }
-        close(fd);
     }
     
-    // 设置错误输出重定向
+    // 错误输出重定向
     if (cmd->stderr_file != NULL) {
-        int flags = O_CREAT | O_WRONLY;
+        int flags = O_CREAT | O_WRONLY | O_CLOEXEC;
         flags |= cmd->stderr_append ? O_APPEND : O_TRUNC;
-        
-        fd = open(cmd->stderr_file, flags, 0644);
-        if (fd < 0) {
+        fds[2] = open(cmd->stderr_file, flags, 0644);
+        if (fds[2] < 0) {
             perror("open stderr");
+            if (fds[1] >= 0) close(fds[1]);
+            fds[1] = -1;
             return -1;
         }
-        
-        if (dup2(fd, STDERR_FILENO) < 0) {
-            perror("dup2 stderr");
-            close(fd);
+    }
+    
+    // 输入重定向
+    if (has_stdin_redirect(cmd)) {
+        if (cmd->stdin_text != NULL) {
+            fds[0] = open_heredoc(cmd->stdin_text);
+        } else {
+            fds[0] = open(cmd->stdin_file, O_RDONLY | O_CLOEXEC);
+        }
+        if (fds[0] < 0) {
+            perror("open stdin");
+            if (fds[1] >= 0) close(fds[1]);
+            if (fds[2] >= 0) close(fds[2]);
+            fds[1] = fds[2] = -1;
             return -1;
         }
-        close(fd);
     }
     
-    // 设置输入重定向
-    if (cmd->stdin_file != NULL) {
-        fd = open(cmd->stdin_file, O_RDONLY);
-        if (fd < 0) {
-            perror("open stdin");
+    return 0;
+}
+
+// 关闭 open_redirects() 打开的描述符
+static void close_redirects(int fds[3]) {
+    for (int i = 0; i < 3; i++) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+            fds[i] = -1;
+        }
+    }
+}
+
+// 内置命令在 Shell 进程内重定向时保存的原始描述符
+typedef struct {
+    int redirected[3];                                          // 0/1/2 是否被重定向
+    int saved[3];                                               // 原始描述符的副本（-1 表示原来就是关闭的）
+    FILE *in;                                                   // 输入重定向时给 xio_stdin 用的新流
+    FILE *prev_in;                                              // 重定向前的 xio_cur_in
+} RedirectSave;
+
+// 恢复 redirect_apply() 之前的 0/1/2
+static void redirect_restore(RedirectSave *save) {
+    // 先把写到重定向文件的内容刷出去，再切换回去
+    fflush(stdout);
+    fflush(stderr);
+    
+    if (save->in != NULL) {
+        fclose(save->in);
+        xio_cur_in = save->prev_in;
+        save->in = NULL;
+    }
+    
+    for (int target = 0; target < 3; target++) {
+        if (!save->redirected[target]) {
+            continue;
+        }
+        if (save->saved[target] >= 0) {
+            dup2(save->saved[target], target);
+            close(save->saved[target]);
+        } else {
+            close(target);                                      // 原来就是关闭的
+        }
+        save->redirected[target] = 0;
+    }
+}
+
+// 在 Shell 进程内应用重定向（不 fork）
+// 步骤：刷新 stdout/stderr -> 用 F_DUPFD_CLOEXEC 备份 0/1/2 -> dup2 重定向文件
+// 说明：stdin 的 FILE 缓冲区里可能还有未执行的脚本内容，
+//       所以输入重定向另外包装成新流，通过 xio_stdin 提供给内置命令
+// 返回：0=成功，-1=失败（已恢复原状）
+static int redirect_apply(Command *cmd, RedirectSave *save) {
+    int fds[3];
+    memset(save, 0, sizeof(*save));
+    if (open_redirects(cmd, fds) != 0) {
+        return -1;
+    }
+    
+    // 切换前把已经缓冲的输出写到原来的目标
+    fflush(stdout);
+    fflush(stderr);
+    
+    for (int target = 0; target < 3; target++) {
+        save->saved[target] = -1;
+        if (fds[target] < 0) {
+            continue;
+        }
+        // 备份到 10 以上的描述符，带 FD_CLOEXEC，不会泄漏给外部命令
+        save->saved[target] = fcntl(target, F_DUPFD_CLOEXEC, 10);
+        if (save->saved[target] < 0 && errno != EBADF) {
+            perror("fcntl");
+            close_redirects(fds);
+            redirect_restore(save);
             return -1;
         }
-        
-        if (dup2(fd, STDIN_FILENO) < 0) {
-            perror("dup2 stdin");
-            close(fd);
+        save->redirected[target] = 1;
+        if (dup2(fds[target], target) < 0) {
+            perror("dup2");
+            close_redirects(fds);
+            redirect_restore(save);
+            return -1;
+        }
+    }
+    
+    if (fds[0] >= 0) {
+        save->in = xio_fdopen(fds[0], "r");                    // 流接管 fds[0]，fclose 时关闭
+        if (save->in != NULL) {
+            fds[0] = -1;
+            save->prev_in = xio_cur_in;
+            xio_cur_in = save->in;
+        }
+    }
+    
+    close_redirects(fds);
+    return 0;
+}
+
+// 设置多重定向（在当前进程中 dup2 到 0/1/2，用于 fork 出来的内置命令子进程）
+static int setup_redirect(Command *cmd) {
+    int fds[3];
+    if (open_redirects(cmd, fds) != 0) {
+        return -1;
+    }
+    
+    for (int target = 0; target < 3; target++) {
+        if (fds[target] >= 0 && dup2(fds[target], target) < 0) {
+            perror("dup2");
+            close_redirects(fds);
             return -1;
         }
-        close(fd);
     }
     
+    close_redirects(fds);
     return 0;
 }
 
+// 把命令参数拼成作业列表里显示的命令字符串（管道的各条命令用 " | " 连接）
+static void build_job_command(Command *cmd, char *cmd_str, size_t size) {
+    cmd_str[0] = '\0';
+    for (Command *stage = cmd; stage != NULL; stage = stage->pipe_next) {
+        if (stage != cmd && strlen(cmd_str) < size - 16) strcat(cmd_str, " | ");
+        for (int i = 0; i < stage->arg_count && strlen(cmd_str) < size - 16; i++) {
+            if (i > 0) strcat(cmd_str, " ");
+            strncat(cmd_str, stage->args[i], size - 16 - strlen(cmd_str));
+        }
+    }
+}
+
+// 启动外部命令（不等待）
+// 参数：out_fd - 子进程的标准输出（-1 表示继承；命令自己的 > 重定向优先）
+//       pgid   - 子进程的进程组（-1 留在 Shell 的进程组，0 新建进程组）
+static pid_t launch_external(Command *cmd, ShellContext *ctx, int out_fd, pid_t pgid, int *error_status) {
+    // 查找可执行文件
+    char *exec_path = find_executable(cmd->name);
+    if (exec_path == NULL) {
+        fprintf(stderr, "%s: command not found\n", cmd->name);
+        // 记录错误到日志
+        log_error(ctx, "Command not found: %s", cmd->name);
+        *error_status = 127;                                    // 与 sh 相同：命令不存在为 127
+        return -1;
+    }
+    
+    // 在父进程中打开重定向文件，由启动器在子进程里 dup2
+    int fds[3];
+    if (open_redirects(cmd, fds) != 0) {
+        free(exec_path);
+        *error_status = 1;
+        return -1;
+    }
+    int launch_fds[3] = { fds[0], (fds[1] >= 0) ? fds[1] : out_fd, fds[2] };
+    
+    // 启动子进程（默认 posix_spawn，不复制父进程页表）
+    pid_t pid = launch_with_retry(cmd->name, &exec_path, cmd->args, vars_envp(&ctx->vars), launch_fds, pgid);
+    int saved_errno = errno;
+    close_redirects(fds);
+    free(exec_path);
+    
+    if (pid < 0) {
+        fprintf(stderr, "%s: %s\n", cmd->name, strerror(saved_errno));
+        // 记录错误到日志
+        log_error(ctx, "launch failed: %s: %s", cmd->name, strerror(saved_errno));
+        *error_status = -1;
+        return -1;
+    }
+    return pid;
+}
+
+pid_t spawn_external(Command *cmd, ShellContext *ctx, int *error_status) {
+    return launch_external(cmd, ctx, -1, -1, error_status);
+}
+
 // 执行外部命令
 static int execute_external(Command *cmd, ShellContext *ctx) {
-    // 避免编译器警告
-    (void)ctx;
+    // 后台命令放到自己的进程组中（xfg / xbg 向整个组发信号）
+    int error_status;
+    pid_t pid = launch_external(cmd, ctx, -1, cmd->background ? 0 : -1, &error_status);
+    if (pid < 0) {
+        return error_status;
+    }
+    
+    // 检查是否后台执行
+    if (cmd->background) {
+        // 后台执行：不等待子进程，添加到作业列表
+        char cmd_str[256];
+        build_job_command(cmd, cmd_str, sizeof(cmd_str));
+        
+        int job_id = job_add(pid, &pid, 1, cmd_str);
+        printf("[%d] %d\n", job_id, pid);
+        return 0;
+    }
+    
+    // 前台执行：等待子进程（被信号终止时为 128 + 信号编号）
+    int status;
+    job_wait_foreground(&pid, 1, &status);
+    return status;
+}
+
+// 管道阶段的运行方式
+typedef enum {
+    STAGE_EXTERNAL,                                             // 外部命令：启动器直接创建子进程
+    STAGE_FORK,                                                 // 内置命令：fork 子进程运行
+    STAGE_THREAD                                                // 内置命令：Shell 进程内的工作线程运行
+} StageKind;
+
+// 管道中的一个阶段
+typedef struct {
+    Command *cmd;                                               // 本阶段的命令
+    ShellContext *ctx;                                          // Shell 上下文
+    StageKind kind;                                             // 运行方式
+    char *exec_path;                                            // 外部命令的完整路径
+    pid_t pid;                                                  // 子进程 pid（0 表示没有启动）
+    pthread_t thread;                                           // 工作线程
+    int thread_started;                                         // 工作线程是否已创建
+    FILE *in;                                                   // 线程阶段的输入流（NULL = Shell 的 stdin）
+    FILE *out;                                                  // 线程阶段的输出流（NULL = Shell 的 stdout）
+    int out_borrowed;                                           // out 属于调用者（命令替换的内存流），只刷新不关闭
+    int status;                                                 // 线程阶段的返回值
+} PipelineStage;
+
+// 判断内置命令阶段能否用线程运行
+// 条件：命令已改造为使用 xio 流、不修改 Shell 状态、没有重定向
+static int can_run_in_thread(Command *cmd) {
+    const BuiltinEntry *entry = builtin_lookup(cmd->name);
+    return entry != NULL && xio_threads_enabled() &&
+           (entry->flags & BUILTIN_XIO) && (entry->flags & BUILTIN_PIPE_SAFE) &&
+           !has_redirect(cmd);
+}
+
+// 工作线程：在 Shell 进程内运行一个内置命令阶段
+static void* pipeline_stage_thread(void *arg) {
+    PipelineStage *stage = arg;
+    
+    // 屏蔽所有异步信号，让它们由主线程处理
+    // 其中 SIGPIPE 被屏蔽后，下游关闭时写入只返回 EPIPE，不会杀死整个 Shell
+    sigset_t all_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_BLOCK, &all_signals, NULL);
+    
+    xio_cur_in = stage->in;
+    xio_cur_out = stage->out;
+    
+    // 本阶段独占自己的输入/输出流，整个运行期间持有流锁：
+    // 之后每次 fgets/fputc 内部加锁只是递归计数，不再有原子操作
+    FILE *in = xio_stdin;
+    FILE *out = xio_stdout;
+    flockfile(in);
+    flockfile(out);
+    stage->status = execute_builtin(stage->cmd, stage->ctx);
+    funlockfile(out);
+    funlockfile(in);
+    
+    // 关闭输出端，下游读完剩余数据后得到 EOF
+    if (stage->out_borrowed) {
+        fflush(stage->out);
+    } else if (stage->out != NULL) {
+        fclose(stage->out);
+    } else {
+        fflush(stdout);
+    }
+    // 关闭输入端，上游再写入会得到 EPIPE 并尽快结束
+    if (stage->in != NULL) {
+        fclose(stage->in);
+    }
+    return NULL;
+}
+
+// 把每个管道阶段的退出状态写入 $PIPESTATUS（空格分隔，如 "1 0"）
+static void set_pipestatus(ShellContext *ctx, const int *statuses, int count) {
+    char small[64];
+    size_t size = (size_t)count * 12 + 1;
+    char *text = (size <= sizeof(small)) ? small : malloc(size);
+    if (text == NULL) {
+        return;
+    }
+    size_t len = 0;
+    text[0] = '\0';
+    for (int i = 0; i < count; i++) {
+        len += (size_t)snprintf(text + len, size - len, (i > 0) ? " %d" : "%d", statuses[i]);
+    }
+    vars_set(&ctx->vars, "PIPESTATUS", text, VAR_KEEP);
+    if (text != small) {
+        free(text);
+    }
+}
+
+// 执行管道命令链
+// 说明：
+//   - 外部命令阶段由父进程通过启动器直接创建（posix_spawn + dup2 file actions）
+//   - 已改造为 xio 的内置命令阶段在 Shell 进程内用线程运行，
+//     相邻两个线程阶段之间用内存环形缓冲区连接，不经过内核管道
+//   - 其他内置命令阶段仍 fork 出子进程运行
+//   - 只有与子进程相邻的地方才创建内核管道
+//   - 阶段数不限，阶段数组按实际数量分配
+//   - 前台管道：所有子进程通过 pidfd 一起等待（job_wait_foreground），
+//     每个阶段的退出状态写入 $PIPESTATUS
+//   - 后台管道（... &）：内置命令阶段都 fork 运行，所有进程放进同一个进程组
+//     （组号为第一个进程的 pid），整条管道作为一个作业加入作业列表
+static int execute_pipeline(Command *cmd, ShellContext *ctx) {
+    int stage_count = 0;
+    for (Command *current = cmd; current != NULL; current = current->pipe_next) {
+        stage_count++;
+    }
+    int background = cmd->background;
+    
+    PipelineStage *stages = calloc((size_t)stage_count, sizeof(PipelineStage));
+    int (*pipes)[2] = malloc((size_t)stage_count * sizeof(*pipes));
+    int (*owned)[2] = malloc((size_t)stage_count * sizeof(*owned));
+    pid_t *pids = malloc((size_t)stage_count * sizeof(pid_t));
+    int *statuses = malloc((size_t)stage_count * sizeof(int));
+    int last_status = -1;
+    if (stages == NULL || pipes == NULL || owned == NULL || pids == NULL || statuses == NULL) {
+        perror("pipeline");
+        goto done;
+    }
+    
+    // 步骤1：决定每个阶段的运行方式
+    PipelineStage *stage_at = stages;
+    for (Command *current = cmd; current != NULL; current = current->pipe_next) {
+        PipelineStage *stage = stage_at++;
+        stage->cmd = current;
+        stage->ctx = ctx;
+        if (!is_builtin(current->name)) {
+            stage->kind = STAGE_EXTERNAL;
+        } else if (!background && can_run_in_thread(current)) {
+            stage->kind = STAGE_THREAD;
+        } else {
+            stage->kind = STAGE_FORK;                           // 后台管道不能在 Shell 进程内运行
+        }
+    }
     
-    // 查找可执行文件
-    char *exec_path = find_executable(cmd->name);
-    if (exec_path == NULL) {
-        fprintf(stderr, "%s: command not found\n", cmd->name);
-        // 记录错误到日志
-        extern void log_error(ShellContext *ctx, const char *format, ...);
-        log_error(ctx, "Command not found: %s", cmd->name);
-        return -1;
+    // 命令替换在进程内执行管道时，最后一个线程阶段直接写到替换的内存流
+    PipelineStage *last = &stages[stage_count - 1];
+    if (last->kind == STAGE_THREAD && xio_cur_out != NULL) {
+        last->out = xio_cur_out;
+        last->out_borrowed = 1;
     }
     
-    // fork子进程
-    pid_t pid = fork();
-    if (pid < 0) {
-        perror("fork");
-        // 记录错误到日志
-        extern void log_error(ShellContext *ctx, const char *format, ...);
-        log_error(ctx, "fork failed: %s", strerror(errno));
-        free(exec_path);
-        return -1;
+    // 步骤2：在启动任何阶段之前，先在父进程中一次性解析所有外部命令的路径
+    // （走 PATH 缓存，子进程中不再做任何查找）
+    for (int i = 0; i < stage_count; i++) {
+        if (stages[i].kind == STAGE_EXTERNAL) {
+            stages[i].exec_path = find_executable(stages[i].cmd->name);
+        }
     }
     
-    if (pid == 0) {
-        // 子进程
-        // 设置重定向
-        if (setup_redirect(cmd) != 0) {
-            free(exec_path);
-            exit(1);
+    // 步骤3：建立阶段之间的连接
+    // pipes[i] 连接第 i 和第 i+1 个阶段；两端都是线程时用环形缓冲区（pipes[i] 为 -1）
+    // 线程阶段使用的管道端会被包装成 FILE*，由线程负责关闭（owned 标记为 1）
+    int setup_failed = 0;
+    for (int i = 0; i < stage_count - 1; i++) {
+        pipes[i][0] = pipes[i][1] = -1;
+        owned[i][0] = owned[i][1] = 0;
+        if (setup_failed) {
+            continue;
         }
         
-        // 验证args数组
-        if (cmd->args == NULL) {
-            fprintf(stderr, "execv: args is NULL\n");
-            free(exec_path);
-            exit(1);
+        if (stages[i].kind == STAGE_THREAD && stages[i + 1].kind == STAGE_THREAD) {
+            if (xio_channel_open(&stages[i + 1].in, &stages[i].out) != 0) {
+                perror("pipeline");
+                setup_failed = 1;
+            }
+            continue;
         }
         
-        // 确保args数组以NULL结尾（parse_command应该已经设置了，这里只是双重检查）
-        // 实际上parse_command已经设置了cmd->args[cmd->arg_count] = NULL
-        
-        // 执行命令
-        execv(exec_path, cmd->args);
+        if (pipe(pipes[i]) < 0) {
+            perror("pipe");
+            pipes[i][0] = pipes[i][1] = -1;
+            setup_failed = 1;
+            continue;
+        }
+        // 所有管道端都带 FD_CLOEXEC：spawn 出来的外部命令只会拿到 dup2 后的 0/1
+        fcntl(pipes[i][0], F_SETFD, FD_CLOEXEC);
+        fcntl(pipes[i][1], F_SETFD, FD_CLOEXEC);
         
-        // 如果execv返回，说明执行失败
-        perror("execv");
-        // 注意：在子进程中无法访问 ctx，所以不记录日志
-        free(exec_path);
-        exit(1);
-    } else {
-        // 父进程
-        free(exec_path);
+        if (stages[i].kind == STAGE_THREAD) {
+            stages[i].out = xio_fdopen(pipes[i][1], "w");
+            owned[i][1] = (stages[i].out != NULL);
+            setup_failed |= (stages[i].out == NULL);
+        }
+        if (stages[i + 1].kind == STAGE_THREAD) {
+            stages[i + 1].in = xio_fdopen(pipes[i][0], "r");
+            owned[i][0] = (stages[i + 1].in != NULL);
+            setup_failed |= (stages[i + 1].in == NULL);
+        }
+    }
+    
+    if (setup_failed) {
+        for (int i = 0; i < stage_count; i++) {
+            if (stages[i].in != NULL) fclose(stages[i].in);
+            if (stages[i].out != NULL && !stages[i].out_borrowed) fclose(stages[i].out);
+            free(stages[i].exec_path);
+        }
+        for (int i = 0; i < stage_count - 1; i++) {
+            for (int j = 0; j < 2; j++) {
+                if (pipes[i][j] >= 0 && !owned[i][j]) close(pipes[i][j]);
+            }
+        }
+        goto done;
+    }
+    
+    // 步骤4：先启动所有子进程，再创建线程
+    // 原因：多线程进程中 fork 时，其他线程可能正持有 malloc/stdio 的锁，子进程会死锁
+    // 后台管道的进程组：第一个启动的进程新建进程组，其余的加入（pgid 为 -1 表示留在 Shell 的进程组）
+    pid_t pgid = background ? 0 : -1;
+    char **envp = vars_envp(&ctx->vars);                        // 所有外部命令阶段共用同一个环境数组
+    fflush(stdout);                                             // 避免子进程继承并重复输出未刷新的内容
+    for (int i = 0; i < stage_count; i++) {
+        PipelineStage *stage = &stages[i];
+        Command *current = stage->cmd;
         
-        // 检查是否后台执行
-        if (cmd->background) {
-            // 后台执行：不等待子进程，添加到作业列表
-            // 重建命令字符串
-            char cmd_str[256] = "";
-            for (int i = 0; i < cmd->arg_count && strlen(cmd_str) < 240; i++) {
-                if (i > 0) strcat(cmd_str, " ");
-                strncat(cmd_str, cmd->args[i], 240 - strlen(cmd_str));
+        if (stage->kind == STAGE_FORK) {
+            // 内置命令阶段：fork 子进程运行
+            pid_t pid = fork();
+            if (pid == 0) {
+                // 子进程
+                if (pgid >= 0) {
+                    setpgid(0, pgid);
+                }
+                
+                // 设置输入管道（不是第一个命令）
+                if (i > 0) {
+                    dup2(pipes[i - 1][0], STDIN_FILENO);
+                }
+                
+                // 设置输出管道（不是最后一个命令）
+                if (i < stage_count - 1) {
+                    dup2(pipes[i][1], STDOUT_FILENO);
+                }
+                
+                // 关闭所有管道（包括线程阶段持有的管道端，否则对端收不到 EOF）
+                for (int j = 0; j < stage_count - 1; j++) {
+                    if (pipes[j][0] >= 0) close(pipes[j][0]);
+                    if (pipes[j][1] >= 0) close(pipes[j][1]);
+                }
+                
+                // 设置本阶段的重定向（优先于管道）
+                if (setup_redirect(current) != 0) {
+                    _exit(1);
+                }
+
+                // 输入已换成管道/文件：不能再用 stdin 的缓冲区
+                // （父进程从脚本读命令时，里面还留着没执行的脚本内容）
+                if (i > 0 || has_stdin_redirect(current)) {
+                    xio_cur_in = xio_fdopen(STDIN_FILENO, "r");
+                }
+
+                int result = execute_builtin(current, ctx);
+                fflush(stdout);
+                // 用 _exit：exit 会把 stdin 的读位置回退到父进程共享的偏移上，
+                // 导致父进程重复执行脚本中已经读过的命令
+                _exit(result);
+            }
+            if (pid < 0) {
+                perror("fork");
+                pid = 0;                                        // 标记为未启动
+            } else if (pgid >= 0) {
+                setpgid(pid, (pgid == 0) ? pid : pgid);         // 父进程也设置，不依赖子进程先运行
+            }
+            stage->pid = pid;
+        } else if (stage->kind == STAGE_EXTERNAL) {
+            // 外部命令阶段：使用预先解析好的路径直接启动
+            if (stage->exec_path == NULL) {
+                fprintf(stderr, "%s: command not found\n", current->name);
+                log_error(ctx, "Command not found: %s", current->name);
+                continue;                                       // pid 保持 0，表示未启动
             }
             
-            int job_id = job_add(pid, cmd_str);
-            printf("[%d] %d\n", job_id, pid);
-            return 0;
-        } else {
-            // 前台执行：等待子进程
-            int status;
-            waitpid(pid, &status, 0);
+            int fds[3] = {-1, -1, -1};
+            int redirect_fds[3];
+            if (open_redirects(current, redirect_fds) != 0) {
+                continue;
+            }
+            if (i > 0) {
+                fds[0] = pipes[i - 1][0];
+            }
+            if (i < stage_count - 1) {
+                fds[1] = pipes[i][1];
+            }
+            // 本阶段的重定向优先于管道
+            for (int j = 0; j < 3; j++) {
+                if (redirect_fds[j] >= 0) {
+                    fds[j] = redirect_fds[j];
+                }
+            }
             
-            if (WIFEXITED(status)) {
-                return WEXITSTATUS(status);
-            } else {
-                return -1;
+            pid_t pid = launch_with_retry(current->name, &stage->exec_path, current->args, envp, fds, pgid);
+            if (pid < 0) {
+                fprintf(stderr, "%s: %s\n", current->name, strerror(errno));
+                pid = 0;
             }
+            close_redirects(redirect_fds);
+            stage->pid = pid;
+        }
+        if (pgid == 0 && stage->pid > 0) {
+            pgid = stage->pid;                                  // 第一个进程是进程组组长
         }
     }
-}
-
-// 执行管道命令链
-static int execute_pipeline(Command *cmd, ShellContext *ctx) {
-    Command *current = cmd;
-    int pipe_count = 0;
     
-    // 计算管道数量
-    while (current != NULL) {
-        pipe_count++;
-        current = current->pipe_next;
+    // 步骤5：父进程关闭不归线程所有的管道端
+    for (int i = 0; i < stage_count - 1; i++) {
+        for (int j = 0; j < 2; j++) {
+            if (pipes[i][j] >= 0 && !owned[i][j]) {
+                close(pipes[i][j]);
+            }
+        }
     }
     
-    if (pipe_count == 0) {
-        return -1;
+    // 步骤6：启动线程阶段
+    for (int i = 0; i < stage_count; i++) {
+        PipelineStage *stage = &stages[i];
+        if (stage->kind != STAGE_THREAD) {
+            continue;
+        }
+        if (pthread_create(&stage->thread, NULL, pipeline_stage_thread, stage) == 0) {
+            stage->thread_started = 1;
+        } else {
+            fprintf(stderr, "%s: cannot create thread\n", stage->cmd->name);
+            stage->status = 1;
+            // 关闭本阶段的两端，让相邻阶段得到 EOF / EPIPE 而不是一直等待
+            if (stage->out != NULL && !stage->out_borrowed) fclose(stage->out);
+            if (stage->in != NULL) fclose(stage->in);
+        }
     }
     
-    if (pipe_count > 100) {
-        fprintf(stderr, "pipeline: too many commands\n");
-        return -1;
+    // 步骤7（后台）：整条管道作为一个作业，不等待
+    int launched = 0;
+    for (int i = 0; i < stage_count; i++) {
+        free(stages[i].exec_path);
+        if (stages[i].kind != STAGE_THREAD && stages[i].pid > 0) {
+            pids[launched++] = stages[i].pid;
+        }
+    }
+    if (background) {
+        if (launched == 0) {
+            last_status = 127;
+            goto done;
+        }
+        char cmd_str[256];
+        build_job_command(cmd, cmd_str, sizeof(cmd_str));
+        int job_id = job_add(pgid, pids, launched, cmd_str);
+        printf("[%d] %d\n", job_id, pgid);
+        last_status = 0;
+        goto done;
     }
     
-    // 创建管道（使用固定大小数组，避免VLA问题）
-    int pipes[100][2];
-    for (int i = 0; i < pipe_count - 1; i++) {
-        if (pipe(pipes[i]) < 0) {
-            perror("pipe");
-            return -1;
+    // 步骤7（前台）：所有子进程一起等待，再等待线程阶段
+    // 管道的退出状态取最后一个阶段，每个阶段的状态写入 $PIPESTATUS
+    for (int i = 0; i < stage_count; i++) {
+        pids[i] = (stages[i].kind == STAGE_THREAD) ? 0 : stages[i].pid;
+    }
+    job_wait_foreground(pids, stage_count, statuses);
+    for (int i = 0; i < stage_count; i++) {
+        PipelineStage *stage = &stages[i];
+        if (stage->kind == STAGE_THREAD) {
+            if (stage->thread_started) {
+                pthread_join(stage->thread, NULL);
+            }
+            statuses[i] = stage->status;
+        } else if (stage->pid <= 0) {
+            statuses[i] = 127;                                  // 该阶段没有启动成功（命令不存在等）
         }
     }
+    last_status = statuses[stage_count - 1];
+    set_pipestatus(ctx, statuses, stage_count);
     
-    // 执行每个命令
-    current = cmd;
-    pid_t pids[100];
-    int cmd_index = 0;
+done:
+    free(stages);
+    free(pipes);
+    free(owned);
+    free(pids);
+    free(statuses);
+    return last_status;
+}
+
+// 以 value 为循环变量执行一次循环体
+// 说明：本次迭代的展开结果在结束后归还内存池，循环次数再多内存也不会增长
+static int run_loop_body(Command *cmd, const char *value, ShellContext *ctx) {
+    ArenaMark mark = arena_mark(cmd->arena);
+    cmd->loop->value = value;
+    int status = execute_command(cmd->loop->body, ctx);
+    arena_release(cmd->arena, mark);
+    return status;
+}
+
+// 执行一次迭代：顺序执行时直接运行循环体，并行执行时交给工作进程池
+// 返回：0=继续，-1=停止循环（并行执行被取消或启动失败）
+static int run_iteration(Command *cmd, const char *value, ParallelPool *pool, ShellContext *ctx, int *status) {
+    if (pool != NULL) {
+        return parallel_submit(pool, cmd->loop, value, ctx);
+    }
+    *status = run_loop_body(cmd, value, ctx);
+    return 0;
+}
+
+// 执行 for 循环
+// 说明：循环体在解析时已经绑定了循环变量，每次迭代只更新 loop->value 再执行；
+//       列表中的大括号范围（如 {1..10000000}）按需逐个生成，不预先展开；
+//       通配符（如 *.log）展开成匹配的文件，$(...) 的输出按 IFS 分割
+//       for -P N：每次迭代在工作进程中执行，退出状态为失败的迭代数（见 parallel.h）
+static int execute_for_loop(Command *cmd, ShellContext *ctx) {
+    ForLoop *loop = cmd->loop;
+    Arena *arena = cmd->arena;
+    int status = 0;
     
-    while (current != NULL) {
-        pid_t pid = fork();
-        if (pid < 0) {
-            perror("fork");
-            // 关闭所有管道
-            for (int i = 0; i < pipe_count - 1; i++) {
-                close(pipes[i][0]);
-                close(pipes[i][1]);
-            }
+    ParallelPool pool;
+    ParallelPool *pp = NULL;
+    if (loop->parallel) {
+        if (parallel_init(&pool, loop->jobs) != 0) {
             return -1;
         }
-        
-        if (pid == 0) {
-            // 子进程
-            // 设置输入管道（不是第一个命令）
-            if (cmd_index > 0) {
-                dup2(pipes[cmd_index - 1][0], STDIN_FILENO);
+        pp = &pool;
+    }
+    
+    int stop = 0;
+    for (const Word *word = loop->words; word != NULL && ctx->running && !stop; word = word->next) {
+        // 命令替换：输出分割后的每个字段执行一次
+        if (word->has_subst) {
+            ArgList fields = { NULL, 0, 0 };
+            if (expand_fields(word, arena, ctx, &fields) != 0) {
+                perror("expand_fields");
+                status = -1;
+                break;
             }
-            
-            // 设置输出管道（不是最后一个命令）
-            if (cmd_index < pipe_count - 1) {
-                dup2(pipes[cmd_index][1], STDOUT_FILENO);
+            for (int i = 0; i < fields.count && ctx->running && !stop; i++) {
+                stop = run_iteration(cmd, fields.items[i], pp, ctx, &status);
             }
-            
-            // 关闭所有管道
-            for (int i = 0; i < pipe_count - 1; i++) {
-                close(pipes[i][0]);
-                close(pipes[i][1]);
+            continue;
+        }
+        
+        char *text = expand_word(word, arena, ctx);
+        if (text == NULL) {
+            perror("expand_word");
+            status = -1;
+            break;
+        }
+        if (*text == '\0' && !word->quoted) {
+            continue;   // 未定义的 $VAR 不产生元素
+        }
+        
+        BraceRange range;
+        if (!word->has_brace || !brace_range_init(&range, text)) {
+            // 通配符：逐个文件执行（没有匹配时使用原单词）
+            char **matches;
+            int match_count = expand_glob(word, arena, ctx, &matches);
+            if (match_count < 0) {
+                perror("expand_glob");
+                status = -1;
+                break;
             }
-            
-            // 设置重定向（最后一个命令可能有重定向）
-            if (cmd_index == pipe_count - 1) {
-                setup_redirect(current);
+            for (int i = 0; i < match_count && ctx->running && !stop; i++) {
+                stop = run_iteration(cmd, matches[i], pp, ctx, &status);
             }
-            
-            // 执行命令
-            int result;
-            if (is_builtin(current->name)) {
-                result = execute_builtin(current, ctx);
-                exit(result);
-            } else {
-                char *exec_path = find_executable(current->name);
-                if (exec_path == NULL) {
-                    fprintf(stderr, "%s: command not found\n", current->name);
-                    exit(1);
-                }
-                execv(exec_path, current->args);
-                perror("execv");
-                free(exec_path);
-                exit(1);
+            if (match_count == 0) {
+                stop = run_iteration(cmd, text, pp, ctx, &status);
             }
-        } else {
-            // 父进程
-            pids[cmd_index] = pid;
+            continue;
         }
         
-        current = current->pipe_next;
-        cmd_index++;
+        // 范围中的每个值都写到同一个缓冲区（工作进程在 fork 时得到自己的副本）
+        size_t size = brace_range_max_len(&range);
+        char *value = arena_alloc(arena, size);
+        if (value == NULL) {
+            perror("arena_alloc");
+            status = -1;
+            break;
+        }
+        while (ctx->running && !stop && brace_range_next(&range, value, size)) {
+            stop = run_iteration(cmd, value, pp, ctx, &status);
+        }
     }
+    loop->value = NULL;
     
-    // 关闭所有管道（父进程）
-    for (int i = 0; i < pipe_count - 1; i++) {
-        close(pipes[i][0]);
-        close(pipes[i][1]);
+    if (pp != NULL) {
+        int parallel_status = parallel_finish(pp);
+        status = (status < 0) ? status : parallel_status;
     }
-    
-    // 等待所有子进程
-    int last_status = 0;
-    for (int i = 0; i < pipe_count; i++) {
-        int status;
-        waitpid(pids[i], &status, 0);
-        if (i == pipe_count - 1) {
-            if (WIFEXITED(status)) {
-                last_status = WEXITSTATUS(status);
-            } else {
-                last_status = -1;
-            }
+    return status;
+}
+
+// 判断单词是否是变量赋值 NAME=value（NAME 必须是未加引号的普通文本）
+// 返回：NAME 的长度，不是赋值返回 0
+static size_t assignment_name_len(const Word *word) {
+    const WordPart *part = word->parts;
+    if (part == NULL || part->type != WORD_LITERAL) {
+        return 0;
+    }
+    const char *eq = strchr(part->text, '=');
+    if (eq == NULL || !vars_valid_name(part->text, (size_t)(eq - part->text))) {
+        return 0;
+    }
+    return (size_t)(eq - part->text);
+}
+
+// 整条命令都是 NAME=value 时，设置 Shell 变量
+// 说明：新变量不导出（不会传给子进程），已导出的变量更新后仍然导出
+// 返回：1=已作为赋值执行（status 为结果），0=不是赋值命令
+static int try_assignments(Command *cmd, ShellContext *ctx, int *status) {
+    if (cmd->words == NULL || cmd->pipe_next != NULL || cmd->background ||
+        cmd->stdout_word != NULL || cmd->stderr_word != NULL || cmd->stdin_word != NULL) {
+        return 0;
+    }
+    for (const Word *word = cmd->words; word != NULL; word = word->next) {
+        if (assignment_name_len(word) == 0) {
+            return 0;
         }
     }
     
-    return last_status;
+    *status = 0;
+    for (const Word *word = cmd->words; word != NULL; word = word->next) {
+        size_t name_len = assignment_name_len(word);
+        char *text = expand_word(word, cmd->arena, ctx);
+        char *name = arena_alloc(cmd->arena, name_len + 1);
+        if (text == NULL || name == NULL) {
+            perror("xshell");
+            *status = 1;
+            return 1;
+        }
+        if (word->has_subst) {
+            *status = ctx->last_exit_status;                    // x=$(cmd) 的结果是 cmd 的退出状态
+        }
+        memcpy(name, text, name_len);
+        name[name_len] = '\0';
+        if (vars_set(&ctx->vars, name, text + name_len + 1, VAR_KEEP) != 0) {
+            perror("xshell");
+            *status = 1;
+            return 1;
+        }
+        if (strcmp(name, "PATH") == 0) {
+            path_cache_clear();                                 // PATH 改变后缓存的路径不再可信
+        }
+    }
+    return 1;
 }
 
 // 执行单个命令（不处理命令链）
 static int execute_single_command(Command *cmd, ShellContext *ctx) {
-    // 步骤1：参数有效性检查
-    if (cmd == NULL || cmd->name == NULL) {
+    // 步骤1：展开管道中每条命令的单词
+    // 说明：必须在启动管道线程之前完成（内存池不能被多个线程同时使用）
+    if (cmd == NULL) {
+        return -1;
+    }
+    if (cmd->loop != NULL) {
+        return execute_for_loop(cmd, ctx);
+    }
+    int status;
+    if (try_assignments(cmd, ctx, &status)) {
+        return status;
+    }
+    for (Command *stage = cmd; stage != NULL; stage = stage->pipe_next) {
+        if (expand_command(stage, ctx) != 0) {
+            perror("expand_command");
+            return -1;
+        }
+    }
+    if (cmd->name == NULL) {
+        // 只有重定向（如 "> file"）：与 sh 一样只创建/截断文件
+        int fds[3];
+        if (cmd->pipe_next == NULL && has_redirect(cmd) && open_redirects(cmd, fds) == 0) {
+            close_redirects(fds);
+            return 0;
+        }
         return -1;
     }
 
@@ -565,572 +1523,128 @@ static int execute_single_command(Command *cmd, ShellContext *ctx) {
         return cmd_quit(cmd, ctx);
     }
 
-    // 步骤2.5：展开大括号表达式（仅对参数展开，不包括命令名）
-    char **expanded_args = NULL;
-    int expanded_arg_count = 0;
-    Command expanded_cmd = *cmd; // 复制命令结构体
-    
-    if (cmd->arg_count > 1) {
-        // 展开参数（跳过命令名，从 args[1] 开始）
-        char **args_to_expand = cmd->args + 1; // 跳过命令名
-        int args_to_expand_count = cmd->arg_count - 1;
-        
-        expanded_args = expand_args(args_to_expand, args_to_expand_count);
-        if (expanded_args != NULL) {
-            // 计算展开后的参数数量
-            expanded_arg_count = 0;
-            while (expanded_args[expanded_arg_count] != NULL) {
-                expanded_arg_count++;
-            }
-            
-            // 构建新的参数数组（命令名 + 展开后的参数）
-            char **new_args = malloc((expanded_arg_count + 2) * sizeof(char*));
-            if (new_args != NULL) {
-                new_args[0] = cmd->name; // 命令名
-                for (int i = 0; i < expanded_arg_count; i++) {
-                    new_args[i + 1] = expanded_args[i];
-                }
-                new_args[expanded_arg_count + 1] = NULL;
-                
-                expanded_cmd.args = new_args;
-                expanded_cmd.arg_count = expanded_arg_count + 1;
-                cmd = &expanded_cmd; // 使用展开后的命令
-            } else {
-                // 内存分配失败，释放已展开的参数，使用原命令
-                for (int i = 0; expanded_args[i] != NULL; i++) {
-                    free(expanded_args[i]);
-                }
-                free(expanded_args);
-                expanded_args = NULL;
-            }
-        }
-    }
-
     // 步骤3：检查是否有管道
     if (cmd->pipe_next != NULL) {
-        int result = execute_pipeline(cmd, ctx);
-        // 清理展开的参数
-        if (expanded_args != NULL) {
-            if (expanded_cmd.args != NULL && expanded_cmd.args != cmd->args) {
-                free(expanded_cmd.args);
-            }
-            for (int i = 0; expanded_args[i] != NULL; i++) {
-                free(expanded_args[i]);
-            }
-            free(expanded_args);
-        }
-        return result;
+        return execute_pipeline(cmd, ctx);
     }
 
     // 步骤4：检查是否为内置命令
-    if (is_builtin(cmd->name)) {
-        // 内置命令需要处理重定向
-        if (has_redirect(cmd)) {
-            // 对于内置命令，我们需要在子进程中执行以支持重定向
+    const BuiltinEntry *builtin = builtin_lookup(cmd->name);
+    if (builtin != NULL && cmd->background && (builtin->flags & BUILTIN_INTERACTIVE)) {
+        // 交互式程序需要独占终端，放到后台会和 Shell 争抢输入
+        fprintf(stderr, "%s: interactive command cannot run in background\n", cmd->name);
+        log_error(ctx, "interactive builtin in background: %s", cmd->name);
+        return 1;
+    }
+    if (builtin != NULL) {
+        int result;
+        if (cmd->background) {
+            // 后台执行：fork 子进程执行内置命令（重定向在子进程中设置）
+            fflush(stdout);                                     // 避免子进程重复输出未刷新的内容
             pid_t pid = fork();
             if (pid < 0) {
                 perror("fork");
-                // 清理展开的参数
-                if (expanded_args != NULL) {
-                    if (expanded_cmd.args != NULL && expanded_cmd.args != cmd->args) {
-                        free(expanded_cmd.args);
-                    }
-                    for (int i = 0; expanded_args[i] != NULL; i++) {
-                        free(expanded_args[i]);
-                    }
-                    free(expanded_args);
-                }
-                return -1;
-            }
-            
-            if (pid == 0) {
-                // 子进程：设置重定向并执行
+                result = -1;
+            } else if (pid == 0) {
+                // 子进程：放到自己的进程组中，设置重定向并执行内置命令
+                setpgid(0, 0);
                 if (setup_redirect(cmd) != 0) {
-                    exit(1);
+                    _exit(1);
                 }
-                int result = execute_builtin(cmd, ctx);
-                // 子进程退出前清理内存（虽然进程退出会自动释放，但为了代码一致性）
-                if (expanded_args != NULL) {
-                    if (expanded_cmd.args != NULL && expanded_cmd.args != cmd->args) {
-                        free(expanded_cmd.args);
-                    }
-                    for (int i = 0; expanded_args[i] != NULL; i++) {
-                        free(expanded_args[i]);
-                    }
-                    free(expanded_args);
+                if (has_stdin_redirect(cmd)) {
+                    xio_cur_in = xio_fdopen(STDIN_FILENO, "r");  // 不读 stdin 中残留的脚本内容
                 }
-                exit(result);
+                result = execute_builtin(cmd, ctx);
+                fflush(stdout);
+                _exit(result);                                  // 不回退父进程共享的 stdin 读位置
             } else {
-                // 父进程：等待子进程
-                int status;
-                waitpid(pid, &status, 0);
-                // 清理展开的参数
-                if (expanded_args != NULL) {
-                    if (expanded_cmd.args != NULL && expanded_cmd.args != cmd->args) {
-                        free(expanded_cmd.args);
-                    }
-                    for (int i = 0; expanded_args[i] != NULL; i++) {
-                        free(expanded_args[i]);
-                    }
-                    free(expanded_args);
-                }
-                if (WIFEXITED(status)) {
-                    return WEXITSTATUS(status);
-                } else {
-                    return -1;
-                }
-            }
-        } else {
-            // 检查是否后台执行内置命令
-            if (cmd->background) {
-                // 后台执行：fork 子进程执行内置命令
-                pid_t pid = fork();
-                if (pid < 0) {
-                    perror("fork");
-                    // 清理展开的参数
-                    if (expanded_args != NULL) {
-                        if (expanded_cmd.args != NULL && expanded_cmd.args != cmd->args) {
-                            free(expanded_cmd.args);
-                        }
-                        for (int i = 0; expanded_args[i] != NULL; i++) {
-                            free(expanded_args[i]);
-                        }
-                        free(expanded_args);
-                    }
-                    return -1;
-                }
+                // 父进程：添加到作业列表
+                setpgid(pid, pid);
+                char cmd_str[256];
+                build_job_command(cmd, cmd_str, sizeof(cmd_str));
                 
-                if (pid == 0) {
-                    // 子进程：执行内置命令并退出
-                    int result = execute_builtin(cmd, ctx);
-                    // 清理展开的参数
-                    if (expanded_args != NULL) {
-                        if (expanded_cmd.args != NULL && expanded_cmd.args != cmd->args) {
-                            free(expanded_cmd.args);
-                        }
-                        for (int i = 0; expanded_args[i] != NULL; i++) {
-                            free(expanded_args[i]);
-                        }
-                        free(expanded_args);
-                    }
-                    exit(result);
-                } else {
-                    // 父进程：添加到作业列表
-                    char cmd_str[256] = "";
-                    for (int i = 0; i < cmd->arg_count && strlen(cmd_str) < 240; i++) {
-                        if (i > 0) strcat(cmd_str, " ");
-                        strncat(cmd_str, cmd->args[i], 240 - strlen(cmd_str));
-                    }
-                    
-                    int job_id = job_add(pid, cmd_str);
-                    printf("[%d] %d\n", job_id, pid);
-                    
-                    // 清理展开的参数
-                    if (expanded_args != NULL) {
-                        if (expanded_cmd.args != NULL && expanded_cmd.args != cmd->args) {
-                            free(expanded_cmd.args);
-                        }
-                        for (int i = 0; expanded_args[i] != NULL; i++) {
-                            free(expanded_args[i]);
-                        }
-                        free(expanded_args);
-                    }
-                    return 0;
-                }
+                int job_id = job_add(pid, &pid, 1, cmd_str);
+                printf("[%d] %d\n", job_id, pid);
+                result = 0;
+            }
+        } else if (has_redirect(cmd)) {
+            // 前台带重定向：在 Shell 进程内临时切换 0/1/2，执行完再恢复
+            // 好处：不用 fork；xcd、xexport 等修改 Shell 状态的命令带重定向也能生效
+            RedirectSave save;
+            if (redirect_apply(cmd, &save) != 0) {
+                result = 1;
             } else {
-                int result = execute_builtin(cmd, ctx);
-                // 清理展开的参数
-                if (expanded_args != NULL) {
-                    if (expanded_cmd.args != NULL && expanded_cmd.args != cmd->args) {
-                        free(expanded_cmd.args);
-                    }
-                    for (int i = 0; expanded_args[i] != NULL; i++) {
-                        free(expanded_args[i]);
-                    }
-                    free(expanded_args);
-                }
-                return result;
+                result = execute_builtin(cmd, ctx);
+                redirect_restore(&save);
             }
+        } else {
+            result = execute_builtin(cmd, ctx);
         }
+        
+        return result;
     }
     
     // 步骤5：执行外部命令
     int result = execute_external(cmd, ctx);
-    // 清理展开的参数
-    if (expanded_args != NULL) {
-        if (expanded_cmd.args != NULL && expanded_cmd.args != cmd->args) {
-            free(expanded_cmd.args);
-        }
-        for (int i = 0; expanded_args[i] != NULL; i++) {
-            free(expanded_args[i]);
-        }
-        free(expanded_args);
-    }
     return result;
 }
 
 // 命令执行主函数
 // 功能：这是命令执行的总入口，负责分发命令到不同的处理函数
-// 支持重定向、管道、外部命令执行和命令链（&& 和 ||）
+// 支持重定向、管道、外部命令执行和命令列表（&& || ; &）
+// 说明：与 sh 相同，&& / || 只看前一条已执行命令的状态，
+//       例如 "false && a || b" 跳过 a、执行 b；返回最后一条已执行命令的状态
 int execute_command(Command *cmd, ShellContext *ctx) {
     if (cmd == NULL) {
         return -1;
     }
     
     int last_status = 0;
-    Command *current = cmd;
+    int run = 1;
     
-    while (current != NULL) {
-        // 执行当前命令
-        int status = execute_single_command(current, ctx);
-        
-        // 检查是否有命令链
-        if (current->chain_next != NULL) {
-            // 根据链类型决定是否执行下一个命令
-            if (current->chain_type == 1) {
-                // &&：只有当前命令成功（status == 0）时才执行下一个
-                if (status != 0) {
-                    // 命令失败，不执行后续命令
-                    break;
-                }
-            } else if (current->chain_type == 2) {
-                // ||：只有当前命令失败（status != 0）时才执行下一个
-                if (status == 0) {
-                    // 命令成功，不执行后续命令
-                    break;
-                }
+    for (Command *current = cmd; current != NULL && ctx->running; current = current->chain_next) {
+        // 执行当前管道（被 && / || 跳过的不执行）
+        if (run) {
+            last_status = execute_single_command(current, ctx);
+            ctx->last_exit_status = last_status;
+            if (current->pipe_next == NULL || current->background) {
+                set_pipestatus(ctx, &last_status, 1);           // 前台管道在 execute_pipeline 中设置
             }
         }
         
-        last_status = status;
-        current = current->chain_next;
+        // 根据分隔符决定是否执行下一条
+        if (current->chain_type == CHAIN_AND) {
+            run = (last_status == 0);
+        } else if (current->chain_type == CHAIN_OR) {
+            run = (last_status != 0);
+        } else {
+            run = 1;
+        }
     }
     
     return last_status;
 }
 
 // 内置命令判断函数
-// 功能：检查给定的命令名是否在内置命令列表中
-// 用途：在执行命令前，需要先判断是调用内置函数还是fork + exec 外部程序
+// 功能：检查给定的命令名是否在内置命令注册表中（见 builtin_table.c）
+// 用途：在执行命令前，需要先判断是调用内置函数还是启动外部程序
 int is_builtin(const char *cmd_name) {
-    // 步骤1：参数检查：防止空指针访问
-    if(cmd_name == NULL) {                                      // 如果命令名为空
-        return 0;                                               // 返回0表示不是内置命令    
-    }
-
-    // 步骤2：定义内置命令列表（字符串数组）
-    // 注意：所有内置命令都要加 x 前缀（除了quit）
-    const char *builtins[] = {
-        "xpwd",                                                 // 显示当前工作目录（对应系统的pwd）
-        "xcd",                                                  // 切换工作目录（对应系统的cd）
-        "xls",                                                  // 列出文件和目录（对应系统的ls）
-        "xecho",                                                // 输出字符串（对应系统的echo）
-        "xtouch",                                               // 创建文件或更新时间戳（对应系统的touch）
-        "xcat",                                                 // 显示文件内容（对应系统的cat）
-        "xrm",                                                  // 删除文件或目录（对应系统的rm）
-        "xcp",                                                  // 复制文件或目录（对应系统的cp）
-        "xmv",                                                  // 移动或重命名文件/目录（对应系统的mv）
-        "xhistory",                                             // 显示命令历史记录（对应系统的history）
-        "xtec",                                                 // 从标准输入读取并输出到文件和标准输出（对应系统的tee）
-        "xmkdir",                                               // 创建目录（对应系统的mkdir）
-        "xrmdir",                                               // 删除空目录（对应系统的rmdir）
-        "xln",                                                  // 创建链接（对应系统的ln）
-        "xchmod",                                               // 修改文件权限（对应系统的chmod）
-        "xchown",                                               // 修改文件所有者（对应系统的chown）
-        "xfind",                                                // 查找文件（对应系统的find）
-        "xuname",                                               // 显示系统信息（对应系统的uname）
-        "xhostname",                                            // 显示主机名（对应系统的hostname）
-        "xwhoami",                                              // 显示当前用户（对应系统的whoami）
-        "xdate",                                                // 显示日期时间（对应系统的date）
-        "xuptime",                                              // 显示系统运行时间（对应系统的uptime）
-        "xps",                                                  // 显示进程信息（对应系统的ps）
-        "xbasename",                                            // 提取文件名（对应系统的basename）
-        "xdirname",                                             // 提取目录名（对应系统的dirname）
-        "xreadlink",                                            // 读取符号链接（对应系统的readlink）
-        "xcut",                                                 // 提取列（对应系统的cut）
-        "xpaste",                                               // 合并文件行（对应系统的paste）
-        "xtr",                                                  // 字符转换（对应系统的tr）
-        "xcomm",                                                // 比较排序文件（对应系统的comm）
-        "xstat",                                                // 显示文件详细信息（对应系统的stat）
-        "xfile",                                                // 显示文件类型（对应系统的file）
-        "xdu",                                                  // 显示目录大小（对应系统的du）
-        "xdf",                                                  // 显示磁盘空间（对应系统的df）
-        "xsplit",                                               // 分割文件（对应系统的split）
-        "xjoin",                                                // 连接文件（对应系统的join）
-        "xrealpath",                                            // 显示绝对路径（对应系统的realpath）
-        "xmenu",                                                // 交互式菜单系统（XShell 特有功能）
-        "xdiff",                                                // 比较文件差异（对应系统的diff）
-        "xgrep",                                                // 在文件中搜索文本（对应系统的grep）
-        "xwc",                                                  // 统计行数/字数/字节数（对应系统的wc）
-        "xhead",                                                // 显示文件前N行（对应系统的head）
-        "xtail",                                                // 显示文件后N行（对应系统的tail）
-        "xsort",                                                // 排序文件内容（对应系统的sort）
-        "xuniq",                                                // 去除重复行（对应系统的uniq）
-        "xenv",                                                 // 显示所有环境变量（对应系统的env）
-        "xexport",                                              // 设置环境变量（对应系统的export）
-        "xunset",                                               // 删除环境变量（对应系统的unset）
-        "xalias",                                               // 设置命令别名（对应系统的alias）
-        "xunalias",                                             // 删除命令别名（对应系统的unalias）
-        "xclear",                                               // 清屏（对应系统的clear）
-        "xhelp",                                                // 显示帮助信息（对应系统的help）
-        "xtype",                                                // 显示命令类型（对应系统的type）
-        "xwhich",                                               // 显示命令路径（对应系统的which）
-        "xsleep",                                               // 休眠指定秒数（对应系统的sleep）
-        "xcalc",                                                // 简单计算器（对应系统的bc/expr）
-        "xtree",                                                // 树形显示目录结构（对应系统的tree）
-        "xsource",                                              // 执行脚本文件（对应系统的source）
-        "xtime",                                                // 测量命令执行时间（对应系统的time）
-        "xkill",                                                // 终止进程（对应系统的kill）
-        "xjobs",                                                // 显示后台任务（对应系统的jobs）
-        "xfg",                                                  // 将后台任务调到前台（对应系统的fg）
-        "xbg",                                                  // 将任务放到后台（对应系统的bg）
-        "xui",                                                  // 终端 UI 界面（XShell 特有功能）
-        "xweb",                                                 // 网页浏览器（XShell 特有功能）
-        "xsnake",                                               // 贪吃蛇游戏（XShell 特有功能）
-        "xtetris",                                              // 俄罗斯方块（XShell 特有功能）
-        "x2048",                                                // 2048游戏（XShell 特有功能）
-        "xsysmon",                                              // 系统监控（XShell 特有功能）
-        "quit",                                                 // 退出Shell（Shell 专有命令，不加x）
-        NULL                                                    // 数组结束标记（用于判断遍历结束）
-    };
-
-    // 步骤3：遍历内置命令列表，查找匹配项
-    for (int i = 0; builtins[i] != NULL; i++) {                 // 循环知道遇到NULL
-        // 使用strcmp 比较字符串（相等返回0）
-        if (strcmp(cmd_name, builtins[i]) == 0) {               // 找到匹配的命令
-            return 1;                                           // 返回1表示是内置命令    
-        }    
-    }
-
-    // 步骤4：未找到匹配：说明不是内置命令
-    return 0;                                                   // 返回 0 表示不是内置命令（可能是外部命令）
+    return builtin_lookup(cmd_name) != NULL;
 }
 
 // 内置命令执行函数
-// 功能：根据命令名称，分发到对应的内置命令处理函数
-// 设计模式：简单的if-else练（命令少时够用，命令多时改用函数指标表）
+// 功能：在注册表中查找命令并调用对应的处理函数（二分查找，不再逐个 strcmp）
 int execute_builtin(Command *cmd, ShellContext *ctx) {
     // 步骤1：参数检查：确保命令对象有效
-    if (cmd == NULL || cmd->name == NULL) {                     // 空指针检查
-        return -1;                                              // 无效参数，返回失败
+    if (cmd == NULL || cmd->name == NULL) {
+        return -1;
     }
 
-    // 步骤2：命令发放：根据命令名称调用相应的处理函数
-    // 使用if-else 链进行字符串匹配（简单直观）
-
-    if (strcmp(cmd->name, "xpwd") == 0) {                       // 匹配 xpwd 命令
-        return cmd_xpwd(cmd, ctx);                              // 调用 xpwd 处理函数（显示当前目录）
-    }
-    else if (strcmp(cmd->name, "xcd") == 0) {                   // 匹配 xcd 命令
-        return cmd_xcd(cmd, ctx);                               // 调用 xcd 处理函数（切换目录）
-    }
-    else if (strcmp(cmd->name, "xls") == 0) {                   // 匹配 xls 命令
-        return cmd_xls(cmd, ctx);                               // 调用 xls 处理函数（列出文件）
-    }
-    else if (strcmp(cmd->name, "xecho") == 0) {                 // 匹配 xecho 命令
-        return cmd_xecho(cmd, ctx);                             // 调用 xecho 处理函数（输出字符串）
-    }
-    else if (strcmp(cmd->name, "xtouch") == 0) {                // 匹配 xtouch 命令
-        return cmd_xtouch(cmd, ctx);                            // 调用 xtouch 处理函数（创建文件或更新时间戳）
-    }
-    else if (strcmp(cmd->name, "xcat") == 0) {                  // 匹配 xcat 命令
-        return cmd_xcat(cmd, ctx);                              // 调用 xcat 处理函数（显示文件内容）
-    }
-    else if (strcmp(cmd->name, "xrm") == 0) {                   // 匹配 xrm 命令
-        return cmd_xrm(cmd, ctx);                               // 调用 xrm 处理函数（删除文件或目录）
-    }
-    else if (strcmp(cmd->name, "xcp") == 0) {                   // 匹配 xcp 命令
-        return cmd_xcp(cmd, ctx);                               // 调用 xcp 处理函数（复制文件或目录）
-    }
-    else if (strcmp(cmd->name, "xmv") == 0) {                   // 匹配 xmv 命令
-        return cmd_xmv(cmd, ctx);                               // 调用 xmv 处理函数（移动或重命名文件/目录）
-    }
-    else if (strcmp(cmd->name, "xhistory") == 0) {              // 匹配 xhistory 命令
-        return cmd_xhistory(cmd, ctx);                          // 调用 xhistory 处理函数（显示命令历史）
-    }
-    else if (strcmp(cmd->name, "xtec") == 0) {                  // 匹配 xtec 命令
-        return cmd_xtec(cmd, ctx);                              // 调用 xtec 处理函数（tee 功能）
-    }
-    else if (strcmp(cmd->name, "xmkdir") == 0) {                // 匹配 xmkdir 命令
-        return cmd_xmkdir(cmd, ctx);                            // 调用 xmkdir 处理函数（创建目录）
-    }
-    else if (strcmp(cmd->name, "xrmdir") == 0) {                // 匹配 xrmdir 命令
-        return cmd_xrmdir(cmd, ctx);                            // 调用 xrmdir 处理函数（删除空目录）
-    }
-    else if (strcmp(cmd->name, "xln") == 0) {                   // 匹配 xln 命令
-        return cmd_xln(cmd, ctx);                               // 调用 xln 处理函数（创建链接）
-    }
-    else if (strcmp(cmd->name, "xchmod") == 0) {                // 匹配 xchmod 命令
-        return cmd_xchmod(cmd, ctx);                            // 调用 xchmod 处理函数（修改权限）
-    }
-    else if (strcmp(cmd->name, "xchown") == 0) {                // 匹配 xchown 命令
-        return cmd_xchown(cmd, ctx);                            // 调用 xchown 处理函数（修改所有者）
-    }
-    else if (strcmp(cmd->name, "xfind") == 0) {                 // 匹配 xfind 命令
-        return cmd_xfind(cmd, ctx);                             // 调用 xfind 处理函数（查找文件）
-    }
-    else if (strcmp(cmd->name, "xuname") == 0) {                // 匹配 xuname 命令
-        return cmd_xuname(cmd, ctx);                            // 调用 xuname 处理函数（显示系统信息）
-    }
-    else if (strcmp(cmd->name, "xhostname") == 0) {             // 匹配 xhostname 命令
-        return cmd_xhostname(cmd, ctx);                         // 调用 xhostname 处理函数（显示主机名）
-    }
-    else if (strcmp(cmd->name, "xwhoami") == 0) {               // 匹配 xwhoami 命令
-        return cmd_xwhoami(cmd, ctx);                           // 调用 xwhoami 处理函数（显示当前用户）
-    }
-    else if (strcmp(cmd->name, "xdate") == 0) {                 // 匹配 xdate 命令
-        return cmd_xdate(cmd, ctx);                             // 调用 xdate 处理函数（显示日期时间）
-    }
-    else if (strcmp(cmd->name, "xuptime") == 0) {               // 匹配 xuptime 命令
-        return cmd_xuptime(cmd, ctx);                           // 调用 xuptime 处理函数（显示系统运行时间）
-    }
-    else if (strcmp(cmd->name, "xps") == 0) {                   // 匹配 xps 命令
-        return cmd_xps(cmd, ctx);                               // 调用 xps 处理函数（显示进程信息）
-    }
-    else if (strcmp(cmd->name, "xbasename") == 0) {            // 匹配 xbasename 命令
-        return cmd_xbasename(cmd, ctx);                         // 调用 xbasename 处理函数（提取文件名）
-    }
-    else if (strcmp(cmd->name, "xdirname") == 0) {             // 匹配 xdirname 命令
-        return cmd_xdirname(cmd, ctx);                          // 调用 xdirname 处理函数（提取目录名）
-    }
-    else if (strcmp(cmd->name, "xreadlink") == 0) {             // 匹配 xreadlink 命令
-        return cmd_xreadlink(cmd, ctx);                         // 调用 xreadlink 处理函数（读取符号链接）
-    }
-    else if (strcmp(cmd->name, "xcut") == 0) {                  // 匹配 xcut 命令
-        return cmd_xcut(cmd, ctx);                              // 调用 xcut 处理函数（提取列）
-    }
-    else if (strcmp(cmd->name, "xpaste") == 0) {                // 匹配 xpaste 命令
-        return cmd_xpaste(cmd, ctx);                            // 调用 xpaste 处理函数（合并文件行）
-    }
-    else if (strcmp(cmd->name, "xtr") == 0) {                   // 匹配 xtr 命令
-        return cmd_xtr(cmd, ctx);                               // 调用 xtr 处理函数（字符转换）
-    }
-    else if (strcmp(cmd->name, "xcomm") == 0) {                 // 匹配 xcomm 命令
-        return cmd_xcomm(cmd, ctx);                             // 调用 xcomm 处理函数（比较排序文件）
-    }
-    else if (strcmp(cmd->name, "xstat") == 0) {                 // 匹配 xstat 命令
-        return cmd_xstat(cmd, ctx);                             // 调用 xstat 处理函数（显示文件详细信息）
-    }
-    else if (strcmp(cmd->name, "xfile") == 0) {                 // 匹配 xfile 命令
-        return cmd_xfile(cmd, ctx);                             // 调用 xfile 处理函数（显示文件类型）
-    }
-    else if (strcmp(cmd->name, "xdu") == 0) {                   // 匹配 xdu 命令
-        return cmd_xdu(cmd, ctx);                               // 调用 xdu 处理函数（显示目录大小）
-    }
-    else if (strcmp(cmd->name, "xdf") == 0) {                   // 匹配 xdf 命令
-        return cmd_xdf(cmd, ctx);                               // 调用 xdf 处理函数（显示磁盘空间）
-    }
-    else if (strcmp(cmd->name, "xsplit") == 0) {                // 匹配 xsplit 命令
-        return cmd_xsplit(cmd, ctx);                            // 调用 xsplit 处理函数（分割文件）
-    }
-    else if (strcmp(cmd->name, "xjoin") == 0) {                 // 匹配 xjoin 命令
-        return cmd_xjoin(cmd, ctx);                             // 调用 xjoin 处理函数（连接文件）
-    }
-    else if (strcmp(cmd->name, "xrealpath") == 0) {            // 匹配 xrealpath 命令
-        return cmd_xrealpath(cmd, ctx);                         // 调用 xrealpath 处理函数（显示绝对路径）
-    }
-    else if (strcmp(cmd->name, "xmenu") == 0) {                // 匹配 xmenu 命令
-        return cmd_xmenu(cmd, ctx);                             // 调用 xmenu 处理函数（交互式菜单）
-    }
-    else if (strcmp(cmd->name, "xdiff") == 0) {                // 匹配 xdiff 命令
-        return cmd_xdiff(cmd, ctx);                             // 调用 xdiff 处理函数（比较文件差异）
-    }
-    else if (strcmp(cmd->name, "xgrep") == 0) {                 // 匹配 xgrep 命令
-        return cmd_xgrep(cmd, ctx);                             // 调用 xgrep 处理函数（在文件中搜索文本）
-    }
-    else if (strcmp(cmd->name, "xwc") == 0) {                   // 匹配 xwc 命令
-        return cmd_xwc(cmd, ctx);                               // 调用 xwc 处理函数（统计行数/字数/字节数）
-    }
-    else if (strcmp(cmd->name, "xhead") == 0) {                 // 匹配 xhead 命令
-        return cmd_xhead(cmd, ctx);                             // 调用 xhead 处理函数（显示文件前N行）
-    }
-    else if (strcmp(cmd->name, "xtail") == 0) {                 // 匹配 xtail 命令
-        return cmd_xtail(cmd, ctx);                             // 调用 xtail 处理函数（显示文件后N行）
-    }
-    else if (strcmp(cmd->name, "xsort") == 0) {                 // 匹配 xsort 命令
-        return cmd_xsort(cmd, ctx);                             // 调用 xsort 处理函数（排序文件内容）
-    }
-    else if (strcmp(cmd->name, "xuniq") == 0) {                 // 匹配 xuniq 命令
-        return cmd_xuniq(cmd, ctx);                             // 调用 xuniq 处理函数（去除重复行）
-    }
-    else if (strcmp(cmd->name, "xenv") == 0) {                  // 匹配 xenv 命令
-        return cmd_xenv(cmd, ctx);                              // 调用 xenv 处理函数（显示所有环境变量）
-    }
-    else if (strcmp(cmd->name, "xexport") == 0) {               // 匹配 xexport 命令
-        return cmd_xexport(cmd, ctx);                           // 调用 xexport 处理函数（设置环境变量）
-    }
-    else if (strcmp(cmd->name, "xunset") == 0) {                // 匹配 xunset 命令
-        return cmd_xunset(cmd, ctx);                            // 调用 xunset 处理函数（删除环境变量）
-    }
-    else if (strcmp(cmd->name, "xalias") == 0) {                // 匹配 xalias 命令
-        return cmd_xalias(cmd, ctx);                            // 调用 xalias 处理函数（设置/显示别名）
-    }
-    else if (strcmp(cmd->name, "xunalias") == 0) {              // 匹配 xunalias 命令
-        return cmd_xunalias(cmd, ctx);                          // 调用 xunalias 处理函数（删除别名）
-    }
-    else if (strcmp(cmd->name, "xclear") == 0) {                // 匹配 xclear 命令
-        return cmd_xclear(cmd, ctx);                            // 调用 xclear 处理函数（清屏）
-    }
-    else if (strcmp(cmd->name, "xhelp") == 0) {                 // 匹配 xhelp 命令
-        return cmd_xhelp(cmd, ctx);                             // 调用 xhelp 处理函数（显示帮助信息）
-    }
-    else if (strcmp(cmd->name, "xtype") == 0) {                 // 匹配 xtype 命令
-        return cmd_xtype(cmd, ctx);                             // 调用 xtype 处理函数（显示命令类型）
-    }
-    else if (strcmp(cmd->name, "xwhich") == 0) {                // 匹配 xwhich 命令
-        return cmd_xwhich(cmd, ctx);                            // 调用 xwhich 处理函数（显示命令路径）
-    }
-    else if (strcmp(cmd->name, "xsleep") == 0) {                // 匹配 xsleep 命令
-        return cmd_xsleep(cmd, ctx);                            // 调用 xsleep 处理函数（休眠）
-    }
-    else if (strcmp(cmd->name, "xcalc") == 0) {                 // 匹配 xcalc 命令
-        return cmd_xcalc(cmd, ctx);                             // 调用 xcalc 处理函数（计算器）
-    }
-    else if (strcmp(cmd->name, "xtree") == 0) {                 // 匹配 xtree 命令
-        return cmd_xtree(cmd, ctx);                             // 调用 xtree 处理函数（树形显示目录）
-    }
-    else if (strcmp(cmd->name, "xsource") == 0) {              // 匹配 xsource 命令
-        return cmd_xsource(cmd, ctx);                          // 调用 xsource 处理函数（执行脚本文件）
-    }
-    else if (strcmp(cmd->name, "xtime") == 0) {                 // 匹配 xtime 命令
-        return cmd_xtime(cmd, ctx);                            // 调用 xtime 处理函数（测量执行时间）
-    }
-    else if (strcmp(cmd->name, "xkill") == 0) {                // 匹配 xkill 命令
-        return cmd_xkill(cmd, ctx);                            // 调用 xkill 处理函数（终止进程）
-    }
-    else if (strcmp(cmd->name, "xjobs") == 0) {                // 匹配 xjobs 命令
-        return cmd_xjobs(cmd, ctx);                            // 调用 xjobs 处理函数（显示后台任务）
-    }
-    else if (strcmp(cmd->name, "xfg") == 0) {                  // 匹配 xfg 命令
-        return cmd_xfg(cmd, ctx);                              // 调用 xfg 处理函数（将任务调到前台）
-    }
-    else if (strcmp(cmd->name, "xbg") == 0) {                  // 匹配 xbg 命令
-        return cmd_xbg(cmd, ctx);                              // 调用 xbg 处理函数（将任务放到后台）
-    }
-    else if (strcmp(cmd->name, "xui") == 0) {                  // 匹配 xui 命令
-        return cmd_xui(cmd, ctx);                              // 调用 xui 处理函数（终端 UI）
-    }
-    else if (strcmp(cmd->name, "xweb") == 0) {                 // 匹配 xweb 命令
-        return cmd_xweb(cmd, ctx);                             // 调用 xweb 处理函数（网页浏览器）
-    }
-    else if (strcmp(cmd->name, "xsnake") == 0) {               // 匹配 xsnake 命令
-        return cmd_xsnake(cmd, ctx);                           // 调用 xsnake 处理函数（贪吃蛇游戏）
-    }
-    else if (strcmp(cmd->name, "xtetris") == 0) {
-        return cmd_xtetris(cmd, ctx);
-    }
-    else if (strcmp(cmd->name, "x2048") == 0) {
-        return cmd_x2048(cmd, ctx);
-    }
-    else if (strcmp(cmd->name, "xsysmon") == 0) {
-        return cmd_xsysmon(cmd, ctx);
-    }
-    else if (strcmp(cmd->name, "quit") == 0) {                  // 匹配 quit 命令
-        return cmd_quit(cmd, ctx);                              // 调用 quit 处理函数（设置退出标志）
+    // 步骤2：查表并分发
+    const BuiltinEntry *entry = builtin_lookup(cmd->name);
+    if (entry == NULL || entry->handler == NULL) {
+        fprintf(stderr, "%s: builtin command not implemented\n", cmd->name);
+        return -1;
     }
-
-    // 步骤3：命令未实现：如果到这里，说明命令在列表中但为未实现
-    // 这种情况通常是开发中途（已加入builtins[] 但未写处理函数）
-    fprintf(stderr, "%s: builtin command not implemented\n", cmd->name);
-    return -1;                                                  // 返回失败状态
+    return entry->handler(cmd, ctx);
 }
@@ -0,0 +1,549 @@
+// 特性测试宏：启用 POSIX 标准函数（strdup, getline）
+#define _POSIX_C_SOURCE 200809L
+
+// 引入自定义头文件
+#include "frecency.h"                       // 函数声明
+#include "history.h"                        // history_loaded_next
+
+// 引入标准库
+#include <stdio.h>                          // fopen, fprintf, snprintf
+#include <stdlib.h>                         // malloc, realloc, free, strtod
+#include <string.h>                         // strlen, memcpy, strcmp
+#include <strings.h>                        // strncasecmp
+#include <stdint.h>                         // uint32_t
+#include <ctype.h>                          // tolower
+#include <unistd.h>                         // getpid, unlink
+#include <linux/limits.h>                   // PATH_MAX
+#include <sys/stat.h>                       // stat
+
+// 表示“没有”的编号
+#define NONE UINT32_MAX
+
+// ============================================
+// 数据结构
+// ============================================
+
+// 一条记录（一条命令或一个目录）
+typedef struct {
+    uint32_t text;                          // 文本在 texts 中的偏移
+    uint32_t len;
+    double score;                           // 得分（见头文件）
+    time_t last;                            // 最近一次使用的时间
+    uint32_t dir;                           // 命令：最近一次使用时所在的目录（目录记录编号 + 1）
+    double dir_score;                       // 命令：在这个目录中使用的得分
+} Record;
+
+// 压缩前缀树的节点（0 号是根节点）
+typedef struct {
+    uint32_t label;                         // 边上的文本在 texts 中的偏移
+    uint32_t label_len;
+    uint32_t child;                         // 第一个子节点（0 表示没有）
+    uint32_t sibling;                       // 下一个兄弟节点（0 表示没有）
+    uint32_t record;                        // 在这里结束的记录编号 + 1（0 表示没有）
+    uint32_t top[FRECENCY_TOP];             // 子树中得分最高的记录编号 + 1，按得分降序
+} Node;
+
+// 一个模型
+typedef struct {
+    Node *nodes;
+    uint32_t node_count;
+    uint32_t node_capacity;
+    Record *records;
+    uint32_t record_count;
+    uint32_t record_capacity;
+    char *texts;                            // 所有记录的文本，以 '\0' 分隔
+    size_t texts_len;
+    size_t texts_capacity;
+} Model;
+
+static Model g_commands;                    // 命令
+static Model g_dirs;                        // 目录
+static int g_ready = 0;                     // 已初始化
+static time_t g_epoch;                      // 模型创建时间（得分的基准）
+static uint32_t g_current_dir = 0;          // 当前目录（目录记录编号 + 1）
+static int g_history_done = 0;              // 启动时加载的历史已全部加入
+static char *g_dirs_file = NULL;            // 目录得分文件
+
+// 使用一次的权重：2^((when - 模型创建时间) / 半衰期)
+// 说明：用分段线性近似 2^x（单调，不依赖数学库）
+static double weight(time_t when) {
+    double x = (double)(when - g_epoch) / FRECENCY_HALF_LIFE;
+    if (x < -60) {
+        x = -60;
+    } else if (x > 60) {
+        x = 60;
+    }
+    int k = (int)x;
+    if (x < k) {
+        k--;                                // 向下取整
+    }
+    double power = (k >= 0) ? (double)(1ULL << k) : 1.0 / (double)(1ULL << -k);
+    return power * (1.0 + (x - k));
+}
+
+// ============================================
+// 压缩前缀树
+// ============================================
+
+// 新建一个节点
+// 返回：节点编号，内存不足返回 NONE
+static uint32_t node_new(Model *m, uint32_t label, uint32_t label_len) {
+    if (m->node_count == m->node_capacity) {
+        uint32_t capacity = (m->node_capacity == 0) ? 256 : m->node_capacity * 2;
+        Node *nodes = realloc(m->nodes, capacity * sizeof(Node));
+        if (nodes == NULL) {
+            return NONE;
+        }
+        m->nodes = nodes;
+        m->node_capacity = capacity;
+    }
+    Node *node = &m->nodes[m->node_count];
+    memset(node, 0, sizeof(Node));
+    node->label = label;
+    node->label_len = label_len;
+    return m->node_count++;
+}
+
+// 新建一条记录（保存文本）
+// 返回：记录编号，内存不足返回 NONE
+static uint32_t record_new(Model *m, const char *text, size_t len) {
+    if (m->texts_len + len + 1 > m->texts_capacity) {
+        size_t capacity = (m->texts_capacity == 0) ? 4096 : m->texts_capacity * 2;
+        while (m->texts_len + len + 1 > capacity) {
+            capacity *= 2;
+        }
+        if (capacity > UINT32_MAX) {
+            return NONE;
+        }
+        char *texts = realloc(m->texts, capacity);
+        if (texts == NULL) {
+            return NONE;
+        }
+        m->texts = texts;
+        m->texts_capacity = capacity;
+    }
+    if (m->record_count == m->record_capacity) {
+        uint32_t capacity = (m->record_capacity == 0) ? 128 : m->record_capacity * 2;
+        Record *records = realloc(m->records, capacity * sizeof(Record));
+        if (records == NULL) {
+            return NONE;
+        }
+        m->records = records;
+        m->record_capacity = capacity;
+    }
+    Record *record = &m->records[m->record_count];
+    memset(record, 0, sizeof(Record));
+    record->text = (uint32_t)m->texts_len;
+    record->len = (uint32_t)len;
+    memcpy(m->texts + m->texts_len, text, len);
+    m->texts[m->texts_len + len] = '\0';
+    m->texts_len += len + 1;
+    return m->record_count++;
+}
+
+// 查找第一个字节为 byte 的子节点
+// 返回：节点编号，没有返回 0
+static uint32_t find_child(const Model *m, uint32_t node, char byte) {
+    for (uint32_t c = m->nodes[node].child; c != 0; c = m->nodes[c].sibling) {
+        if (m->texts[m->nodes[c].label] == byte) {
+            return c;
+        }
+    }
+    return 0;
+}
+
+// 查找或创建文本对应的记录
+// 返回：记录编号，内存不足返回 NONE
+static uint32_t model_insert(Model *m, const char *text, size_t len) {
+    if (m->node_count == 0 && node_new(m, 0, 0) == NONE) {
+        return NONE;                        // 根节点
+    }
+    uint32_t node = 0;
+    size_t pos = 0;
+    while (pos < len) {
+        uint32_t c = find_child(m, node, text[pos]);
+        if (c == 0) {
+            // 没有这个分支：新建一个叶子，边上的文本就是记录文本的剩余部分
+            uint32_t r = record_new(m, text, len);
+            if (r == NONE) {
+                return NONE;
+            }
+            uint32_t leaf = node_new(m, m->records[r].text + (uint32_t)pos, (uint32_t)(len - pos));
+            if (leaf == NONE) {
+                return NONE;
+            }
+            m->nodes[leaf].record = r + 1;
+            m->nodes[leaf].sibling = m->nodes[node].child;
+            m->nodes[node].child = leaf;
+            return r;
+        }
+
+        const char *label = m->texts + m->nodes[c].label;
+        uint32_t label_len = m->nodes[c].label_len;
+        uint32_t common = 0;
+        while (common < label_len && pos + common < len && label[common] == text[pos + common]) {
+            common++;
+        }
+        if (common < label_len) {
+            // 只有边的前一部分相同：拆成两段，中间插入一个节点
+            uint32_t mid = node_new(m, m->nodes[c].label, common);
+            if (mid == NONE) {
+                return NONE;
+            }
+            Node *parent = &m->nodes[node];
+            Node *split = &m->nodes[mid];
+            Node *old = &m->nodes[c];
+            split->child = c;
+            split->sibling = old->sibling;
+            memcpy(split->top, old->top, sizeof(split->top));  // 子树相同
+            uint32_t *link = &parent->child;
+            while (*link != c) {
+                link = &m->nodes[*link].sibling;
+            }
+            *link = mid;
+            old->label += common;
+            old->label_len -= common;
+            old->sibling = 0;
+            c = mid;
+        }
+        node = c;
+        pos += common;
+    }
+
+    if (m->nodes[node].record == 0) {
+        uint32_t r = record_new(m, text, len);
+        if (r == NONE) {
+            return NONE;
+        }
+        m->nodes[node].record = r + 1;
+    }
+    return m->nodes[node].record - 1;
+}
+
+// 记录的得分增加后更新节点缓存的最高得分记录
+// 说明：得分只会增加，所以记录只会在列表中上移或新进入列表
+static void top_update(Model *m, uint32_t node, uint32_t record) {
+    uint32_t *top = m->nodes[node].top;
+    double score = m->records[record].score;
+    int i = 0;
+    while (i < FRECENCY_TOP && top[i] != 0 && top[i] != record + 1) {
+        i++;
+    }
+    if (i == FRECENCY_TOP) {
+        if (score <= m->records[top[FRECENCY_TOP - 1] - 1].score) {
+            return;                         // 没有进入前几名
+        }
+        i = FRECENCY_TOP - 1;               // 替换最后一名
+    }
+    while (i > 0 && m->records[top[i - 1] - 1].score < score) {
+        top[i] = top[i - 1];
+        i--;
+    }
+    top[i] = record + 1;
+}
+
+// 使用一次：增加记录的得分，并沿路径更新缓存
+// 参数：amount - 增加的得分；dir - 所在目录（0 表示不记录）
+// 返回：记录编号，失败返回 NONE
+static uint32_t model_add(Model *m, const char *text, double amount, time_t when, uint32_t dir) {
+    size_t len = strlen(text);
+    if (len == 0 || len >= UINT32_MAX || strchr(text, '\n') != NULL) {
+        return NONE;                        // 多行的命令不作为建议
+    }
+    uint32_t r = model_insert(m, text, len);
+    if (r == NONE) {
+        return NONE;
+    }
+    Record *record = &m->records[r];
+    record->score += amount;
+    if (when > record->last) {
+        record->last = when;
+    }
+    if (dir != 0) {
+        if (record->dir != dir) {
+            record->dir = dir;
+            record->dir_score = 0;
+        }
+        record->dir_score += amount;
+    }
+
+    uint32_t node = 0;
+    size_t pos = 0;
+    top_update(m, node, r);
+    while (pos < len) {
+        node = find_child(m, node, text[pos]);
+        pos += m->nodes[node].label_len;
+        top_update(m, node, r);
+    }
+    return r;
+}
+
+static void model_free(Model *m) {
+    free(m->nodes);
+    free(m->records);
+    free(m->texts);
+    memset(m, 0, sizeof(Model));
+}
+
+// ============================================
+// 目录得分文件（每行：得分<TAB>最近使用时间<TAB>路径）
+// ============================================
+// 说明：保存的得分换算到最近使用的时刻，加载时再换算回当前模型的基准
+
+static void dirs_load(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return;
+    }
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t len;
+    while ((len = getline(&line, &capacity, fp)) != -1) {
+        if (len > 0 && line[len - 1] == '\n') {
+            line[--len] = '\0';
+        }
+        char *end;
+        double rank = strtod(line, &end);
+        if (*end != '\t' || rank <= 0) {
+            continue;
+        }
+        time_t last = (time_t)strtoll(end + 1, &end, 10);
+        if (*end != '\t' || end[1] != '/') {
+            continue;
+        }
+        model_add(&g_dirs, end + 1, rank * weight(last), last, 0);
+    }
+    free(line);
+    fclose(fp);
+}
+
+static int compare_scores(const void *a, const void *b) {
+    double x = g_dirs.records[*(const uint32_t *)a].score;
+    double y = g_dirs.records[*(const uint32_t *)b].score;
+    return (x < y) ? 1 : (x > y) ? -1 : 0;
+}
+
+// 保存得分最高的 FRECENCY_MAX_DIRS 个目录（写临时文件再 rename）
+static void dirs_save(const char *path) {
+    uint32_t count = g_dirs.record_count;
+    uint32_t *order = malloc((count + 1) * sizeof(uint32_t));
+    if (order == NULL) {
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    qsort(order, count, sizeof(uint32_t), compare_scores);
+    if (count > FRECENCY_MAX_DIRS) {
+        count = FRECENCY_MAX_DIRS;
+    }
+
+    char temp[PATH_MAX + 32];
+    snprintf(temp, sizeof(temp), "%s.%ld.tmp", path, (long)getpid());
+    FILE *fp = fopen(temp, "w");
+    if (fp != NULL) {
+        for (uint32_t i = 0; i < count; i++) {
+            const Record *record = &g_dirs.records[order[i]];
+            fprintf(fp, "%.6g\t%lld\t%s\n", record->score / weight(record->last),
+                    (long long)record->last, g_dirs.texts + record->text);
+        }
+        if (fclose(fp) != 0 || rename(temp, path) != 0) {
+            unlink(temp);
+        }
+    }
+    free(order);
+}
+
+// ============================================
+// 对外接口
+// ============================================
+
+void frecency_init(const char *dirs_file) {
+    g_epoch = time(NULL);
+    g_ready = 1;
+    g_history_done = 0;
+    g_current_dir = 0;
+    if (dirs_file != NULL) {
+        g_dirs_file = strdup(dirs_file);
+        dirs_load(dirs_file);
+    }
+}
+
+void frecency_add_command(const char *line) {
+    if (g_ready) {
+        time_t now = time(NULL);
+        model_add(&g_commands, line, weight(now), now, g_current_dir);
+    }
+}
+
+void frecency_visit_dir(const char *path) {
+    if (g_ready) {
+        time_t now = time(NULL);
+        uint32_t r = model_add(&g_dirs, path, weight(now), now, 0);
+        g_current_dir = (r == NONE) ? 0 : r + 1;
+    }
+}
+
+// 从新到旧加入一批启动时加载的历史（每 64 条检查一次是否用完时间）
+static void feed_history(void) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; !g_history_done; i++) {
+        if (i % 64 == 63) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            long elapsed_us = (long)(now.tv_sec - start.tv_sec) * 1000000 +
+                              (now.tv_nsec - start.tv_nsec) / 1000;
+            if (elapsed_us >= FRECENCY_FEED_BUDGET_US) {
+                break;
+            }
+        }
+        time_t when;
+        const char *text = history_loaded_next(&when);
+        if (text == NULL) {
+            g_history_done = 1;
+            break;
+        }
+        if (when <= 0) {
+            when = g_epoch - 8 * FRECENCY_HALF_LIFE;  // 旧格式的行没有时间：当作很久以前
+        }
+        model_add(&g_commands, text, weight(when), when, 0);
+    }
+}
+
+const char* frecency_suggest(const char *prefix) {
+    if (!g_ready) {
+        return NULL;
+    }
+    feed_history();
+
+    // 步骤1：沿前缀走到节点（前缀可以在一条边的中间结束）
+    const Model *m = &g_commands;
+    size_t len = strlen(prefix);
+    if (m->node_count == 0 || len == 0) {
+        return NULL;
+    }
+    uint32_t node = 0;
+    size_t pos = 0;
+    while (pos < len) {
+        node = find_child(m, node, prefix[pos]);
+        if (node == 0) {
+            return NULL;
+        }
+        size_t n = m->nodes[node].label_len;
+        if (n > len - pos) {
+            n = len - pos;
+        }
+        if (memcmp(m->texts + m->nodes[node].label, prefix + pos, n) != 0) {
+            return NULL;
+        }
+        pos += m->nodes[node].label_len;
+    }
+
+    // 步骤2：在缓存的几条记录中选择（在当前目录中使用过的加分）
+    const Record *best = NULL;
+    double best_score = 0;
+    for (int i = 0; i < FRECENCY_TOP && m->nodes[node].top[i] != 0; i++) {
+        const Record *record = &m->records[m->nodes[node].top[i] - 1];
+        if (record->len <= len) {
+            continue;                       // 与输入完全相同
+        }
+        double score = record->score;
+        if (g_current_dir != 0 && record->dir == g_current_dir) {
+            score += record->dir_score;
+        }
+        if (best == NULL || score > best_score) {
+            best = record;
+            best_score = score;
+        }
+    }
+    return (best != NULL) ? m->texts + best->text : NULL;
+}
+
+// 在 text 的 [start, end) 中查找 word（不区分大小写）
+// 返回：找到的位置，没有返回 NULL
+static const char* find_word(const char *start, const char *end, const char *word) {
+    size_t len = strlen(word);
+    for (const char *p = start; p + len <= end; p++) {
+        if (strncasecmp(p, word, len) == 0) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+// 关键字按顺序出现在路径中，最后一个出现在最后一级目录名中
+static int dir_matches(const char *path, char **keywords, int count) {
+    const char *end = path + strlen(path);
+    const char *last = strrchr(path, '/');
+    last = (last != NULL) ? last + 1 : path;
+    const char *p = path;
+    for (int i = 0; i < count; i++) {
+        const char *found = find_word((i == count - 1 && p < last) ? last : p, end, keywords[i]);
+        if (found == NULL) {
+            return 0;
+        }
+        p = found + strlen(keywords[i]);
+    }
+    return 1;
+}
+
+// 模糊匹配：所有关键字的字符按顺序出现在最后一级目录名中
+static int dir_fuzzy(const char *path, char **keywords, int count) {
+    const char *p = strrchr(path, '/');
+    p = (p != NULL) ? p + 1 : path;
+    for (int i = 0; i < count; i++) {
+        for (const char *k = keywords[i]; *k != '\0'; k++) {
+            while (*p != '\0' && tolower((unsigned char)*p) != tolower((unsigned char)*k)) {
+                p++;
+            }
+            if (*p == '\0') {
+                return 0;
+            }
+            p++;
+        }
+    }
+    return 1;
+}
+
+const char* frecency_find_dir(char **keywords, int count, const char *exclude) {
+    if (!g_ready || count <= 0) {
+        return NULL;
+    }
+    for (int fuzzy = 0; fuzzy <= 1; fuzzy++) {
+        const Record *best = NULL;
+        for (uint32_t i = 0; i < g_dirs.record_count; i++) {
+            const Record *record = &g_dirs.records[i];
+            const char *path = g_dirs.texts + record->text;
+            if ((best != NULL && record->score <= best->score) ||
+                (exclude != NULL && strcmp(path, exclude) == 0)) {
+                continue;
+            }
+            if (!(fuzzy ? dir_fuzzy(path, keywords, count) : dir_matches(path, keywords, count))) {
+                continue;
+            }
+            struct stat st;
+            if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+                best = record;              // 已经删除的目录跳过
+            }
+        }
+        if (best != NULL) {
+            return g_dirs.texts + best->text;
+        }
+    }
+    return NULL;
+}
+
+void frecency_cleanup(void) {
+    if (!g_ready) {
+        return;
+    }
+    if (g_dirs_file != NULL) {
+        dirs_save(g_dirs_file);
+        free(g_dirs_file);
+        g_dirs_file = NULL;
+    }
+    model_free(&g_commands);
+    model_free(&g_dirs);
+    g_ready = 0;
+}
@@ -1,21 +1,624 @@
-// 特性测试宏：启用 POSIX 标准函数（strdup）
+// 特性测试宏：启用 POSIX 标准函数（strdup）和 flock
 #define _POSIX_C_SOURCE 200809L     // POSIX.1-2008 标准
+#define _DEFAULT_SOURCE             // flock
 
 // 引入自定义头文件
 #include "history.h"                // 历史记录模块声明
+#include "arena.h"                  // 命令字符串所在的内存池
 
 // 引入标准库
-#include <stdio.h>                  // 标准输入输出（printf, fopen, fclose）
+#include <stdio.h>                  // 标准输入输出（printf, snprintf）
 #include <stdlib.h>                 // 标准库（malloc, free）
+#include <stdint.h>                 // uint32_t
 #include <string.h>                 // 字符串处理（strdup, strcmp, strlen）
-#include <unistd.h>                 // UNIX 标准函数（getenv）
+#include <unistd.h>                 // UNIX 标准函数（getenv, write, fsync）
+#include <errno.h>                  // errno, EINTR
+#include <fcntl.h>                  // open, O_APPEND
+#include <time.h>                   // time, clock_gettime
+#include <sys/file.h>               // flock
+#include <sys/mman.h>               // mmap
+#include <sys/stat.h>               // fstat
+
+// 内存池的内存块大小
+#define HISTORY_ARENA_BLOCK_SIZE 65536
+
+// 哈希表的初始桶数量（必须是 2 的幂）
+#define HISTORY_INITIAL_BUCKETS 256
+
+// 环形缓冲区的初始容量
+#define HISTORY_INITIAL_SLOTS 64
+
+// 行偏移数组的初始容量
+#define HISTORY_INITIAL_LINES 1024
+
+// 三字母索引的初始桶数量（必须是 2 的幂）
+#define HISTORY_INITIAL_TRIGRAMS 4096
 
 // ============================================
 // 历史记录数据结构
 // ============================================
-static char *history[MAX_HISTORY];  // 历史记录数组（存储命令字符串指针）
-static int history_count_value = 0; // 当前历史记录数量
+
+// 一条驻留的命令字符串（位于内存池中，相同的命令共用一份）
+typedef struct HistString {
+    struct HistString *next;        // 哈希桶中的下一个
+    struct HistString *moved;       // 重建内存池时指向新的副本
+    size_t hash;                    // 字符串哈希
+    size_t refs;                    // 环形缓冲区中引用它的位置数
+    size_t seq;                     // 最近一次加入时的序号（erasedups 用来找到旧位置）
+    size_t size;                    // 占用的字节数（重建内存池时统计）
+    char text[];                    // 命令文本
+} HistString;
+
+static HistString **ring = NULL;    // 环形缓冲区（NULL 表示已删除的位置）
+static uint32_t *ring_stamps = NULL;  // 每个位置的编号（与 ring 对应，见下面的三字母索引）
+static size_t ring_allocated = 0;   // 缓冲区当前大小（按需翻倍，最多 ring_limit）
+static size_t ring_limit = HISTORY_DEFAULT_SIZE;  // 最多保存的条数（XHISTSIZE）
+static size_t ring_head = 0;        // 最旧一条所在的位置
+static size_t ring_used = 0;        // 已使用的位置数（包括已删除的位置）
+static size_t ring_erased = 0;      // 已删除的位置数
+static size_t first_seq = 0;        // 最旧一条的序号（序号 = first_seq + 在缓冲区中的偏移）
+static int erase_dups = 0;          // XHISTCONTROL=erasedups
+
+static HistString **buckets = NULL; // 哈希表（链地址法）
+static size_t bucket_count = 0;     // 桶数量
+static size_t string_count = 0;     // 驻留的字符串数
+
+static Arena strings;               // 字符串内存池
+static size_t live_bytes = 0;       // 存活的字符串占用的字节数
+static size_t dead_bytes = 0;       // 已淘汰（不再引用）的字符串占用的字节数
+
 static char history_file[256];      // 历史文件路径
+static int log_fd = -1;             // 追加历史文件的描述符（O_APPEND，只在交互模式下打开）
+static size_t file_limit = 0;       // 历史文件最多的行数（XHISTFILESIZE），超过时压缩
+static size_t file_appended = 0;    // 本会话追加的行数
+
+// 启动时映射的历史文件（最旧的历史在前，本会话新增的在环形缓冲区中）
+static char *file_map = NULL;       // 文件内容（MAP_PRIVATE 可写映射，读取时就地截断行尾）
+static size_t file_map_len = 0;     // 映射长度
+static size_t *file_lines = NULL;   // 每一行的起始偏移
+static size_t file_count = 0;       // 行数（不含空行和最后不完整的一行）
+static size_t file_first = 0;       // 第一条有效的行（之前的已被淘汰）
+
+// 三字母（trigram）索引：Ctrl+R 搜索用
+// 说明：每条历史有一个递增的编号（历史文件的第 n 行编号为 n，之后加入的依次递增），
+//       编号在淘汰和压缩时不变；每个三字母组合记录包含它的历史的编号（从小到大）
+typedef struct {
+    uint32_t key;                   // 三个字节 + 1（0 表示空桶）
+    uint32_t count;                 // 编号个数
+    uint32_t capacity;
+    uint32_t *stamps;               // 包含这个组合的历史编号（升序）
+} Trigram;
+
+static uint32_t next_stamp = 0;     // 下一条历史的编号
+static uint32_t loaded_cursor = 0;  // history_loaded_next 下一次返回的编号 + 1
+static Trigram *trigrams = NULL;    // 开放寻址哈希表（第一次搜索时才建立）
+static size_t trigram_buckets = 0;
+static size_t trigram_used = 0;
+static size_t indexed_entries = 0;  // 建立索引以来加入的条数（包括已淘汰的）
+
+// 已加入历史、还没有写入文件的命令（执行完后 history_finish 写入）
+static char *pending = NULL;
+static time_t pending_time;         // 开始时间
+static struct timespec pending_start;  // 开始时间（计算耗时）
+
+// FNV-1a 字符串哈希
+static size_t hash_text(const char *text) {
+    size_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)text; *p != '\0'; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// 第 offset 条（从最旧开始）在缓冲区中的位置
+static size_t ring_slot(size_t offset) {
+    return (ring_head + offset) % ring_allocated;
+}
+
+// ============================================
+// 历史文件的行
+// ============================================
+
+// 跳过扩展格式的字段 ": 开始时间:耗时:退出状态;"，返回命令文本
+static const char* skip_fields(const char *line) {
+    if (line[0] != ':' || line[1] != ' ') {
+        return line;                        // 普通行
+    }
+    const char *p = line + 2;
+    for (int field = 0; field < 3; field++) {
+        if (field == 2 && *p == '-') {
+            p++;                            // 退出状态可以是负数
+        }
+        if (*p < '0' || *p > '9') {
+            return line;
+        }
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+        if (*p != ((field == 2) ? ';' : ':')) {
+            return line;
+        }
+        p++;
+    }
+    return p;
+}
+
+// 建立行偏移索引（跳过空行；最后一行没有换行符说明写入不完整，忽略）
+// 参数：complete - 返回最后一个完整行结束后的位置
+// 返回：行数，内存不足返回 (size_t)-1
+static size_t index_lines(const char *data, size_t len, size_t **offsets, size_t *complete) {
+    size_t capacity = HISTORY_INITIAL_LINES;
+    size_t count = 0;
+    size_t *lines = malloc(capacity * sizeof(size_t));
+    if (lines == NULL) {
+        return (size_t)-1;
+    }
+    size_t pos = 0;
+    while (pos < len) {
+        const char *newline = memchr(data + pos, '\n', len - pos);
+        if (newline == NULL) {
+            break;
+        }
+        size_t end = (size_t)(newline - data);
+        if (end > pos) {
+            if (count == capacity) {
+                size_t *grown = realloc(lines, capacity * 2 * sizeof(size_t));
+                if (grown == NULL) {
+                    free(lines);
+                    return (size_t)-1;
+                }
+                lines = grown;
+                capacity *= 2;
+            }
+            lines[count++] = pos;
+        }
+        pos = end + 1;
+    }
+    *offsets = lines;
+    *complete = pos;
+    return count;
+}
+
+// 取映射中第 line 行的命令文本（第一次读取时把行尾的换行符改为 '\0'）
+static const char* file_entry(size_t line) {
+    char *start = file_map + file_lines[line];
+    start[strcspn(start, "\n")] = '\0';   // 行都以换行符结尾，不会越过映射
+    return skip_fields(start);
+}
+
+// 映射中还有效的行数
+static size_t file_live(void) {
+    return file_count - file_first;
+}
+
+// ============================================
+// 字符串驻留
+// ============================================
+
+// 扩容：字符串数超过桶数时桶数翻倍
+static void grow_buckets(void) {
+    size_t new_count = (bucket_count == 0) ? HISTORY_INITIAL_BUCKETS : bucket_count * 2;
+    HistString **new_buckets = calloc(new_count, sizeof(HistString *));
+    if (new_buckets == NULL) {
+        return;                             // 扩容失败不影响正确性，只是链变长
+    }
+    for (size_t i = 0; i < bucket_count; i++) {
+        HistString *entry = buckets[i];
+        while (entry != NULL) {
+            HistString *next = entry->next;
+            size_t idx = entry->hash & (new_count - 1);
+            entry->next = new_buckets[idx];
+            new_buckets[idx] = entry;
+            entry = next;
+        }
+    }
+    free(buckets);
+    buckets = new_buckets;
+    bucket_count = new_count;
+}
+
+// 查找已驻留的字符串
+static HistString* intern_find(const char *text, size_t hash) {
+    if (bucket_count == 0) {
+        return NULL;
+    }
+    for (HistString *entry = buckets[hash & (bucket_count - 1)]; entry != NULL; entry = entry->next) {
+        if (entry->hash == hash && strcmp(entry->text, text) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// 驻留一个新字符串（调用前已确认不存在）
+static HistString* intern_add(const char *text, size_t hash) {
+    if (string_count >= bucket_count) {
+        grow_buckets();
+        if (bucket_count == 0) {
+            return NULL;
+        }
+    }
+    size_t len = strlen(text);
+    size_t size = sizeof(HistString) + len + 1;
+    HistString *entry = arena_alloc(&strings, size);
+    if (entry == NULL) {
+        return NULL;
+    }
+    memcpy(entry->text, text, len + 1);
+    entry->hash = hash;
+    entry->refs = 0;
+    entry->seq = 0;
+    entry->size = size;
+    entry->moved = NULL;
+    size_t idx = hash & (bucket_count - 1);
+    entry->next = buckets[idx];
+    buckets[idx] = entry;
+    string_count++;
+    live_bytes += size;
+    return entry;
+}
+
+// 字符串不再被引用：从哈希表中删除（内存留在内存池中，重建时回收）
+static void intern_drop(HistString *entry) {
+    for (HistString **link = &buckets[entry->hash & (bucket_count - 1)]; *link != NULL; link = &(*link)->next) {
+        if (*link == entry) {
+            *link = entry->next;
+            string_count--;
+            live_bytes -= entry->size;
+            dead_bytes += entry->size;
+            return;
+        }
+    }
+}
+
+// 重建内存池：只复制存活的字符串，释放旧的内存块
+// 说明：淘汰的字符串超过存活的字符串时才重建，分摊到每次添加是 O(1)
+static void rebuild_strings(void) {
+    Arena fresh;
+    arena_init(&fresh, HISTORY_ARENA_BLOCK_SIZE);
+
+    // 第一遍：复制每个字符串，旧副本的 moved 指向新副本
+    for (size_t i = 0; i < bucket_count; i++) {
+        for (HistString *entry = buckets[i]; entry != NULL; entry = entry->next) {
+            entry->moved = arena_alloc(&fresh, entry->size);
+            if (entry->moved == NULL) {
+                arena_destroy(&fresh);      // 内存不足：放弃重建，旧内存池继续使用
+                for (size_t j = 0; j < bucket_count; j++) {
+                    for (HistString *e = buckets[j]; e != NULL; e = e->next) {
+                        e->moved = NULL;
+                    }
+                }
+                return;
+            }
+            memcpy(entry->moved, entry, entry->size);
+        }
+    }
+
+    // 第二遍：环形缓冲区和哈希链都改为指向新副本
+    for (size_t i = 0; i < ring_used; i++) {
+        size_t slot = ring_slot(i);
+        if (ring[slot] != NULL) {
+            ring[slot] = ring[slot]->moved;
+        }
+    }
+    for (size_t i = 0; i < bucket_count; i++) {
+        HistString **link = &buckets[i];
+        while (*link != NULL) {
+            HistString *copy = (*link)->moved;
+            copy->moved = NULL;
+            *link = copy;
+            link = &copy->next;             // copy->next 仍指向旧副本，下一轮替换
+        }
+    }
+
+    arena_destroy(&strings);
+    strings = fresh;
+    dead_bytes = 0;
+}
+
+// ============================================
+// 环形缓冲区
+// ============================================
+
+// 压缩：去掉已删除的位置，保持顺序（erasedups 产生的空位）
+static void ring_compact(void) {
+    if (ring_erased == 0) {
+        return;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < ring_used; i++) {
+        HistString *entry = ring[ring_slot(i)];
+        if (entry != NULL) {
+            ring_stamps[ring_slot(kept)] = ring_stamps[ring_slot(i)];
+            ring[ring_slot(kept)] = entry;
+            entry->seq = first_seq + kept;
+            kept++;
+        }
+    }
+    ring_used = kept;
+    ring_erased = 0;
+}
+
+// 删除最旧的一条
+static void ring_evict(void) {
+    HistString *entry = ring[ring_head];
+    if (entry == NULL) {
+        ring_erased--;
+    } else if (--entry->refs == 0) {
+        intern_drop(entry);
+    }
+    ring_head = (ring_head + 1) % ring_allocated;
+    ring_used--;
+    first_seq++;
+}
+
+// 缓冲区翻倍（不超过 ring_limit），内容重新排列到从 0 开始
+// 返回：0=成功，-1=内存不足
+static int ring_grow(void) {
+    size_t new_size = (ring_allocated == 0) ? HISTORY_INITIAL_SLOTS : ring_allocated * 2;
+    if (new_size > ring_limit) {
+        new_size = ring_limit;
+    }
+    HistString **new_ring = malloc(new_size * sizeof(HistString *));
+    uint32_t *new_stamps = malloc(new_size * sizeof(uint32_t));
+    if (new_ring == NULL || new_stamps == NULL) {
+        free(new_ring);
+        free(new_stamps);
+        return -1;
+    }
+    for (size_t i = 0; i < ring_used; i++) {
+        new_ring[i] = ring[ring_slot(i)];
+        new_stamps[i] = ring_stamps[ring_slot(i)];
+    }
+    free(ring);
+    free(ring_stamps);
+    ring = new_ring;
+    ring_stamps = new_stamps;
+    ring_allocated = new_size;
+    ring_head = 0;
+    return 0;
+}
+
+// ============================================
+// 三字母索引
+// ============================================
+
+// 查找三字母组合所在的桶（不存在时返回空桶）
+static Trigram* trigram_slot(uint32_t key) {
+    size_t idx = (key * 2654435761u) & (trigram_buckets - 1);
+    while (trigrams[idx].key != 0 && trigrams[idx].key != key) {
+        idx = (idx + 1) & (trigram_buckets - 1);
+    }
+    return &trigrams[idx];
+}
+
+// 扩容：使用的桶超过一半时翻倍
+// 返回：0=成功，-1=内存不足
+static int trigram_grow(void) {
+    size_t old_buckets = trigram_buckets;
+    Trigram *old = trigrams;
+    size_t new_buckets = (old_buckets == 0) ? HISTORY_INITIAL_TRIGRAMS : old_buckets * 2;
+    Trigram *fresh = calloc(new_buckets, sizeof(Trigram));
+    if (fresh == NULL) {
+        return -1;
+    }
+    trigrams = fresh;
+    trigram_buckets = new_buckets;
+    for (size_t i = 0; i < old_buckets; i++) {
+        if (old[i].key != 0) {
+            *trigram_slot(old[i].key) = old[i];
+        }
+    }
+    free(old);
+    return 0;
+}
+
+// 三个字节组成的键
+static uint32_t trigram_key(const char *p) {
+    const unsigned char *u = (const unsigned char *)p;
+    return (((uint32_t)u[0] << 16) | ((uint32_t)u[1] << 8) | u[2]) + 1;
+}
+
+// 释放索引（下一次搜索时重新建立）
+static void trigram_free(void) {
+    for (size_t i = 0; i < trigram_buckets; i++) {
+        free(trigrams[i].stamps);
+    }
+    free(trigrams);
+    trigrams = NULL;
+    trigram_buckets = trigram_used = indexed_entries = 0;
+}
+
+// 把一条历史的所有三字母组合加入索引
+// 返回：0=成功，-1=内存不足
+static int trigram_add(uint32_t stamp, const char *text) {
+    size_t len = strlen(text);
+    for (size_t i = 0; i + 3 <= len; i++) {
+        if ((trigram_used + 1) * 2 > trigram_buckets && trigram_grow() != 0) {
+            return -1;
+        }
+        uint32_t key = trigram_key(text + i);
+        Trigram *t = trigram_slot(key);
+        if (t->key == 0) {
+            t->key = key;
+            trigram_used++;
+        }
+        if (t->count > 0 && t->stamps[t->count - 1] == stamp) {
+            continue;                           // 同一条命令中重复的组合
+        }
+        if (t->count == t->capacity) {
+            uint32_t capacity = (t->capacity == 0) ? 4 : t->capacity * 2;
+            uint32_t *stamps = realloc(t->stamps, capacity * sizeof(uint32_t));
+            if (stamps == NULL) {
+                return -1;
+            }
+            t->stamps = stamps;
+            t->capacity = capacity;
+        }
+        t->stamps[t->count++] = stamp;
+    }
+    indexed_entries++;
+    return 0;
+}
+
+// 为所有现有的历史建立索引
+// 返回：0=成功，-1=内存不足
+static int trigram_build(void) {
+    if (trigram_grow() != 0) {
+        return -1;
+    }
+    for (size_t line = file_first; line < file_count; line++) {
+        if (trigram_add((uint32_t)line, file_entry(line)) != 0) {
+            trigram_free();
+            return -1;
+        }
+    }
+    for (size_t i = 0; i < ring_used; i++) {
+        size_t slot = ring_slot(i);
+        if (ring[slot] != NULL && trigram_add(ring_stamps[slot], ring[slot]->text) != 0) {
+            trigram_free();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 编号对应的历史索引（调用前已压缩环形缓冲区）
+// 返回：历史索引，已淘汰或已删除（erasedups）返回 -1
+static long stamp_index(uint32_t stamp) {
+    if (file_map != NULL && stamp < file_count) {  // 历史文件中的行
+        return (stamp >= file_first) ? (long)(stamp - file_first) : -1;
+    }
+    size_t low = 0;                             // 环形缓冲区中的编号是升序的：二分查找
+    size_t high = ring_used;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        uint32_t value = ring_stamps[ring_slot(mid)];
+        if (value == stamp) {
+            return (long)(file_live() + mid);
+        }
+        if (value < stamp) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return -1;
+}
+
+// 历史索引对应的编号（index 等于总条数时返回下一个编号）
+static uint32_t index_stamp(size_t index) {
+    if (index < file_live()) {
+        return (uint32_t)(file_first + index);
+    }
+    index -= file_live();
+    return (index < ring_used) ? ring_stamps[ring_slot(index)] : next_stamp;
+}
+
+// 把一条命令加入历史
+// 参数：skip_repeat - 与上一条相同时不加入（默认模式下交互输入使用）
+// 返回：1=已加入，0=没有加入（重复或内存不足）
+static int history_append(const char *text, int skip_repeat) {
+    size_t hash = hash_text(text);
+    HistString *entry = intern_find(text, hash);
+
+    if (skip_repeat && ring_used == 0 && file_live() > 0 && strcmp(file_entry(file_count - 1), text) == 0) {
+        return 0;                               // 与上一条（历史文件的最后一条）相同
+    }
+    if (entry != NULL && entry->refs > 0) {
+        if (erase_dups) {
+            // 删除旧位置（只标记，读取前再压缩）
+            ring[ring_slot(entry->seq - first_seq)] = NULL;
+            ring_erased++;
+            entry->refs--;
+        } else if (skip_repeat && ring_used > 0 && ring[ring_slot(ring_used - 1)] == entry) {
+            return 0;                           // 与上一条相同
+        }
+    }
+    if (entry == NULL && (entry = intern_add(text, hash)) == NULL) {
+        return 0;                               // 内存不足：不记录
+    }
+
+    // 已满：先回收删除的位置，仍然满时淘汰最旧的一条（先淘汰历史文件中的）
+    if (file_live() + ring_used == ring_limit) {
+        ring_compact();
+    }
+    if (file_live() + ring_used == ring_limit) {
+        if (file_live() > 0) {
+            file_first++;
+        } else {
+            ring_evict();
+        }
+    }
+    if (ring_used == ring_allocated && ring_grow() != 0) {
+        if (entry->refs == 0) {
+            intern_drop(entry);
+        }
+        return 0;
+    }
+
+    uint32_t stamp = next_stamp++;
+    ring[ring_slot(ring_used)] = entry;
+    ring_stamps[ring_slot(ring_used)] = stamp;
+    entry->refs++;
+    entry->seq = first_seq + ring_used;
+    ring_used++;
+
+    // 已经建立了索引：增量更新；淘汰的条数超过存活的条数时丢弃，下一次搜索时重建
+    if (trigrams != NULL) {
+        if (indexed_entries > 2 * (file_live() + ring_used) + HISTORY_INITIAL_TRIGRAMS ||
+            trigram_add(stamp, entry->text) != 0) {
+            trigram_free();
+        }
+    }
+
+    if (dead_bytes > live_bytes && dead_bytes > HISTORY_ARENA_BLOCK_SIZE) {
+        rebuild_strings();
+    }
+    return 1;
+}
+
+// ============================================
+// 追加到历史文件
+// ============================================
+
+// 打开历史文件用于追加
+static int open_log(void) {
+    return open(history_file, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+}
+
+// 加锁（被信号打断时重试）
+static int lock_file(int fd, int operation) {
+    while (flock(fd, operation) != 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 把一行追加到历史文件（一次 write）
+// 说明：持有共享锁写入，不会和压缩（排他锁）同时进行；
+//       压缩用 rename 替换文件，旧文件的链接数变为 0，此时重新打开新文件再写
+static void append_log(const char *text, size_t len) {
+    for (int attempt = 0; log_fd >= 0 && attempt < 3; attempt++) {
+        if (lock_file(log_fd, LOCK_SH) != 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(log_fd, &st) == 0 && st.st_nlink == 0) {
+            close(log_fd);                      // 关闭同时释放锁
+            log_fd = open_log();
+            continue;
+        }
+        if (write(log_fd, text, len) == (ssize_t)len) {
+            file_appended++;
+        }
+        flock(log_fd, LOCK_UN);
+        return;
+    }
+}
 
 // ============================================
 // 初始化历史记录系统
@@ -30,14 +633,39 @@ int history_init(void) {
         snprintf(history_file, sizeof(history_file), ".xshell_history");
     }
 
-    // 步骤2：初始化历史记录数组
-    for (int i = 0; i < MAX_HISTORY; i++) {
-        history[i] = NULL;                      // 初始化为 NULL
+    // 步骤2：读取配置（XHISTSIZE、XHISTCONTROL）
+    ring_limit = HISTORY_DEFAULT_SIZE;
+    const char *size_env = getenv("XHISTSIZE");
+    if (size_env != NULL && *size_env != '\0') {
+        char *end;
+        long size = strtol(size_env, &end, 10);
+        if (*end == '\0' && size > 0) {
+            ring_limit = (size > HISTORY_MAX_SIZE) ? HISTORY_MAX_SIZE : (size_t)size;
+        }
+    }
+    file_limit = (ring_limit > HISTORY_MAX_SIZE / 2) ? HISTORY_MAX_SIZE : ring_limit * 2;
+    const char *file_env = getenv("XHISTFILESIZE");
+    if (file_env != NULL && *file_env != '\0') {
+        char *end;
+        long size = strtol(file_env, &end, 10);
+        if (*end == '\0' && size > 0) {
+            file_limit = (size_t)size;
+        }
     }
+    const char *control = getenv("XHISTCONTROL");
+    erase_dups = (control != NULL && strstr(control, "erasedups") != NULL);
+    arena_init(&strings, HISTORY_ARENA_BLOCK_SIZE);
 
     // 步骤3：从文件加载历史记录
     history_load();                             // 加载之前保存的历史
 
+    // 步骤4：文件太大时先压缩，再打开用于追加
+    if (file_count > file_limit) {
+        history_save();
+    }
+    file_appended = 0;
+    log_fd = open_log();
+
     return 0;                                   // 返回成功
 }
 
@@ -51,46 +679,63 @@ void history_add(const char *line) {
     }
 
     // 步骤2：跳过只包含空白字符的命令
-    int has_content = 0;
-    for (size_t i = 0; i < strlen(line); i++) {
-        if (line[i] != ' ' && line[i] != '\t' && line[i] != '\n') {
-            has_content = 1;
-            break;
-        }
-    }
-    if (!has_content) {                         // 只有空白字符，不记录
+    if (line[strspn(line, " \t\n")] == '\0') {  // 只有空白字符，不记录
         return;
     }
 
     // 步骤3：去掉末尾的换行符
-    char *line_copy = strdup(line);             // 复制字符串
+    char *line_copy = strdup(line);             // 复制字符串（执行完后写入历史文件）
     if (line_copy == NULL) {                    // 内存分配失败
         return;
     }
     size_t len = strlen(line_copy);
-    if (len > 0 && line_copy[len - 1] == '\n') {
+    if (line_copy[len - 1] == '\n') {
         line_copy[len - 1] = '\0';              // 去掉换行符
     }
 
-    // 步骤4：检查是否与上一条命令重复
-    if (history_count_value > 0 && 
-        strcmp(history[history_count_value - 1], line_copy) == 0) {
-        free(line_copy);                        // 重复命令不记录
+    // 步骤4：加入历史（与上一条相同的不记录；erasedups 时删除所有旧的相同命令）
+    free(pending);
+    pending = NULL;
+    if (!history_append(line_copy, 1)) {
+        free(line_copy);
         return;
     }
 
-    // 步骤5：添加到历史记录
-    if (history_count_value < MAX_HISTORY) {    // 未满
-        history[history_count_value] = line_copy;
-        history_count_value++;
-    } else {                                    // 已满，删除最旧的
-        free(history[0]);                       // 释放最旧的记录
-        // 所有记录向前移动一位
-        for (int i = 0; i < MAX_HISTORY - 1; i++) {
-            history[i] = history[i + 1];
+    // 步骤5：记录开始时间，执行完后由 history_finish 写入文件
+    pending = line_copy;
+    pending_time = time(NULL);
+    clock_gettime(CLOCK_MONOTONIC, &pending_start);
+}
+
+// ============================================
+// 命令执行完毕：追加到历史文件
+// ============================================
+void history_finish(int status) {
+    if (pending == NULL) {
+        return;
+    }
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long duration_ms = (long)(end.tv_sec - pending_start.tv_sec) * 1000 +
+                       (end.tv_nsec - pending_start.tv_nsec) / 1000000;
+
+    // 整行先拼好，一次 write 写入
+    char small[1024];
+    size_t size = strlen(pending) + 64;
+    char *entry = (size <= sizeof(small)) ? small : malloc(size);
+    if (entry != NULL) {
+        int len = snprintf(entry, size, ": %lld:%ld:%d;%s\n",
+                           (long long)pending_time, duration_ms, status, pending);
+        if (len > 0 && (size_t)len < size) {
+            append_log(entry, (size_t)len);
+        }
+        if (entry != small) {
+            free(entry);
         }
-        history[MAX_HISTORY - 1] = line_copy;   // 添加新记录到末尾
     }
+    free(pending);
+    pending = NULL;
 }
 
 // ============================================
@@ -98,8 +743,9 @@ void history_add(const char *line) {
 // ============================================
 void history_show(void) {
     // 遍历所有历史记录并打印
-    for (int i = 0; i < history_count_value; i++) {
-        printf("%5d  %s\n", i + 1, history[i]); // 打印序号和命令
+    int count = history_count();
+    for (int i = 0; i < count; i++) {
+        printf("%5d  %s\n", i + 1, history_get(i));  // 打印序号和命令
     }
 }
 
@@ -107,7 +753,8 @@ void history_show(void) {
 // 获取历史记录数量
 // ============================================
 int history_count(void) {
-    return history_count_value;                 // 返回当前记录数量
+    ring_compact();
+    return (int)(file_live() + ring_used);      // 返回当前记录数量（历史文件 + 本会话）
 }
 
 // ============================================
@@ -115,10 +762,96 @@ int history_count(void) {
 // ============================================
 const char* history_get(int index) {
     // 参数检查：索引是否有效
-    if (index < 0 || index >= history_count_value) {
+    ring_compact();
+    if (index < 0 || (size_t)index >= file_live() + ring_used) {
         return NULL;                            // 无效索引
     }
-    return history[index];                      // 返回指定索引的历史记录
+    if ((size_t)index < file_live()) {          // 启动时从文件映射的历史
+        return file_entry(file_first + (size_t)index);
+    }
+    return ring[ring_slot((size_t)index - file_live())]->text;  // 本会话添加的历史
+}
+
+// ============================================
+// 反向搜索历史（Ctrl+R）
+// ============================================
+int history_search(const char *query, int before) {
+    // 步骤1：确定搜索范围
+    int count = history_count();                // 同时压缩环形缓冲区
+    if (before < 0 || before > count) {
+        before = count;
+    }
+    if (query == NULL) {
+        return -1;
+    }
+
+    // 步骤2：少于 3 个字符无法使用索引，直接从新到旧扫描（短查询通常很快匹配）
+    size_t len = strlen(query);
+    if (len < 3 || (trigrams == NULL && trigram_build() != 0)) {
+        for (int i = before - 1; i >= 0; i--) {
+            if (strstr(history_get(i), query) != NULL) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // 步骤3：选出查询中包含它的历史最少的三字母组合
+    const Trigram *rarest = NULL;
+    for (size_t i = 0; i + 3 <= len; i++) {
+        const Trigram *t = trigram_slot(trigram_key(query + i));
+        if (t->key == 0) {
+            return -1;                          // 没有任何历史包含这个组合
+        }
+        if (rarest == NULL || t->count < rarest->count) {
+            rarest = t;
+        }
+    }
+
+    // 步骤4：从编号小于 before 的最新候选开始向旧查找，逐个确认
+    uint32_t bound = index_stamp((size_t)before);
+    uint32_t oldest = index_stamp(0);
+    size_t low = 0;
+    size_t high = rarest->count;
+    while (low < high) {                        // 第一个 >= bound 的位置
+        size_t mid = low + (high - low) / 2;
+        if (rarest->stamps[mid] < bound) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    for (size_t k = low; k > 0 && rarest->stamps[k - 1] >= oldest; k--) {
+        long index = stamp_index(rarest->stamps[k - 1]);
+        if (index >= 0 && strstr(history_get((int)index), query) != NULL) {
+            return (int)index;
+        }
+    }
+    return -1;
+}
+
+// ============================================
+// 逐条取出启动时加载的历史
+// ============================================
+const char* history_loaded_next(time_t *when) {
+    ring_compact();
+    uint32_t oldest = index_stamp(0);
+    while (loaded_cursor > oldest) {
+        uint32_t stamp = --loaded_cursor;
+        long index = stamp_index(stamp);
+        if (index < 0) {
+            continue;                           // erasedups 已删除
+        }
+        *when = 0;
+        if (file_map != NULL && stamp < file_count) {
+            const char *line = file_map + file_lines[stamp];
+            if (line[0] == ':' && line[1] == ' ') {
+                *when = (time_t)strtoll(line + 2, NULL, 10);
+            }
+        }
+        return history_get((int)index);
+    }
+    return NULL;
 }
 
 // ============================================
@@ -129,18 +862,18 @@ const char* history_prev(int *current_index) {
     if (current_index == NULL) {
         return NULL;
     }
-    
+
     // 步骤2：初始化索引（第一次调用时）
     if (*current_index == -1) {                 // 尚未开始浏览
-        *current_index = history_count_value;   // 从最新位置开始
+        *current_index = history_count();       // 从最新位置开始
     }
-    
+
     // 步骤3：向上移动（更旧的命令）
     if (*current_index > 0) {                   // 还有更旧的命令
         (*current_index)--;                     // 索引减1
-        return history[*current_index];         // 返回历史记录
+        return history_get(*current_index);     // 返回历史记录
     }
-    
+
     // 步骤4：已到最旧，无法继续向上
     return NULL;
 }
@@ -153,68 +886,164 @@ const char* history_next(int *current_index) {
     if (current_index == NULL || *current_index == -1) {
         return NULL;                            // 无效状态
     }
-    
+
     // 步骤2：向下移动（更新的命令）
-    if (*current_index < history_count_value - 1) {  // 还有更新的命令
+    int count = history_count();
+    if (*current_index < count - 1) {           // 还有更新的命令
         (*current_index)++;                     // 索引加1
-        return history[*current_index];         // 返回历史记录
+        return history_get(*current_index);     // 返回历史记录
     }
-    
+
     // 步骤3：已到最新，返回空字符串（清空输入）
-    *current_index = history_count_value;       // 设置为"最新"位置
+    *current_index = count;                     // 设置为"最新"位置
     return "";                                  // 返回空字符串
 }
 
 // ============================================
-// 保存历史记录到文件
+// 压缩历史文件
 // ============================================
-int history_save(void) {
-    // 步骤1：打开历史文件（写模式）
-    FILE *fp = fopen(history_file, "w");
-    if (fp == NULL) {                           // 打开失败
-        return -1;                              // 返回失败（不是致命错误）
+
+// 把 data 的 len 个字节全部写入
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
     }
+    return 0;
+}
 
-    // 步骤2：写入所有历史记录
-    for (int i = 0; i < history_count_value; i++) {
-        fprintf(fp, "%s\n", history[i]);        // 每条命令一行
+// 在持有排他锁的情况下压缩：最新的 XHISTSIZE 行写到临时文件，再 rename 替换
+static int compact_locked(int fd, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+    size_t *offsets;
+    size_t complete;
+    size_t count = index_lines(data, size, &offsets, &complete);
+    if (count == (size_t)-1) {
+        munmap(data, size);
+        return -1;
     }
 
-    // 步骤3：关闭文件
-    fclose(fp);
-    return 0;                                   // 返回成功
+    int result = 0;
+    if (count > ring_limit) {
+        // 保留的行在文件中是连续的一段，一次写入
+        size_t start = offsets[count - ring_limit];
+        char temp[sizeof(history_file) + 32];
+        snprintf(temp, sizeof(temp), "%s.%ld.tmp", history_file, (long)getpid());
+        int out = open(temp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (out < 0) {
+            result = -1;
+        } else {
+            if (write_all(out, data + start, complete - start) != 0 || fsync(out) != 0) {
+                result = -1;
+            }
+            if (close(out) != 0) {
+                result = -1;
+            }
+            if (result == 0 && rename(temp, history_file) != 0) {
+                result = -1;
+            }
+            if (result != 0) {
+                unlink(temp);
+            }
+        }
+    }
+    free(offsets);
+    munmap(data, size);
+    return result;
+}
+
+int history_save(void) {
+    // 步骤1：打开历史文件并加排他锁（等待其他会话写完当前这一行）
+    // 说明：加锁期间文件可能被另一个会话压缩替换，此时重新打开
+    for (int attempt = 0; attempt < 3; attempt++) {
+        int fd = open(history_file, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return -1;                          // 文件不存在：不需要压缩
+        }
+        struct stat st;
+        if (lock_file(fd, LOCK_EX) != 0 || fstat(fd, &st) != 0) {
+            close(fd);
+            return -1;
+        }
+        if (st.st_nlink == 0) {
+            close(fd);
+            continue;
+        }
+
+        // 步骤2：压缩（关闭描述符同时释放锁）
+        int result = compact_locked(fd, (size_t)st.st_size);
+        close(fd);
+        return result;
+    }
+    return -1;
 }
 
 // ============================================
 // 从文件加载历史记录
 // ============================================
 int history_load(void) {
-    // 步骤1：打开历史文件（读模式）
-    FILE *fp = fopen(history_file, "r");
-    if (fp == NULL) {                           // 文件不存在或无法打开
+    // 步骤1：打开并映射历史文件
+    int fd = open(history_file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {                               // 文件不存在或无法打开
         return 0;                               // 不是错误（首次运行）
     }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+    size_t size = (size_t)st.st_size;
+    char *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);                                  // 映射不依赖描述符
+    if (data == MAP_FAILED) {
+        return -1;
+    }
 
-    // 步骤2：逐行读取历史记录
-    char line[1024];                            // 行缓冲区
-    while (fgets(line, sizeof(line), fp) != NULL && history_count_value < MAX_HISTORY) {
-        // 去掉换行符
-        size_t len = strlen(line);
-        if (len > 0 && line[len - 1] == '\n') {
-            line[len - 1] = '\0';
-        }
+    // 步骤2：建立行偏移索引
+    size_t *offsets;
+    size_t complete;
+    size_t count = index_lines(data, size, &offsets, &complete);
+    if (count == (size_t)-1) {
+        munmap(data, size);
+        return -1;
+    }
 
-        // 添加到历史记录（不检查重复，因为是从文件加载）
-        if (strlen(line) > 0) {
-            history[history_count_value] = strdup(line);
-            if (history[history_count_value] != NULL) {
-                history_count_value++;
-            }
+    // 步骤3：erasedups 需要去重，逐条加入环形缓冲区后不再保留映射
+    if (erase_dups) {
+        for (size_t i = 0; i < count; i++) {
+            char *line = data + offsets[i];
+            line[strcspn(line, "\n")] = '\0';
+            history_append(skip_fields(line), 0);
         }
+        free(offsets);
+        munmap(data, size);
+        file_count = count;                     // 只用于判断是否需要压缩
+        file_first = count;
+        loaded_cursor = next_stamp;
+        return 0;
     }
 
-    // 步骤3：关闭文件
-    fclose(fp);
+    // 步骤4：保留映射（超过 XHISTSIZE 时只使用最新的部分）
+    file_map = data;
+    file_map_len = size;
+    file_lines = offsets;
+    file_count = count;
+    file_first = (count > ring_limit) ? count - ring_limit : 0;
+    next_stamp = (uint32_t)count;               // 第 n 行的编号为 n
+    loaded_cursor = next_stamp;
     return 0;                                   // 返回成功
 }
 
@@ -222,18 +1051,37 @@ int history_load(void) {
 // 清理历史记录系统
 // ============================================
 void history_cleanup(void) {
-    // 步骤1：保存历史记录到文件
-    history_save();
+    // 步骤1：写入还没有写入的命令，文件太大时压缩
+    // 说明：命令已经逐条追加到文件中，不需要再整体保存
+    history_finish(0);
+    if (log_fd >= 0) {
+        if (file_count + file_appended > file_limit) {
+            history_save();
+        }
+        close(log_fd);
+        log_fd = -1;
+    }
 
     // 步骤2：释放所有历史记录内存
-    for (int i = 0; i < history_count_value; i++) {
-        if (history[i] != NULL) {
-            free(history[i]);                   // 释放字符串内存
-            history[i] = NULL;
-        }
+    if (file_map != NULL) {
+        munmap(file_map, file_map_len);
     }
+    free(file_lines);
+    file_map = NULL;
+    file_lines = NULL;
+    trigram_free();
+    free(ring);
+    free(ring_stamps);
+    free(buckets);
+    arena_destroy(&strings);
+    ring = NULL;
+    ring_stamps = NULL;
+    buckets = NULL;
 
     // 步骤3：重置计数
-    history_count_value = 0;
+    ring_allocated = ring_head = ring_used = ring_erased = first_seq = 0;
+    bucket_count = string_count = 0;
+    live_bytes = dead_bytes = 0;
+    file_map_len = file_count = file_first = file_appended = 0;
+    next_stamp = loaded_cursor = 0;
 }
-
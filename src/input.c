@@ -2,11 +2,14 @@
 #include "input.h"                                      // 输入处理函数声明
 #include "completion.h"                                 // Tab 补全功能
 #include "history.h"                                    // 历史记录功能
+#include "frecency.h"                                   // 行内建议（frecency_suggest）
 #include <stdio.h>                                      // 标准输入输出（printf, getchar）
 #include <stdlib.h>                                     // 标准库（malloc, free）
 #include <string.h>                                     // 字符串处理（strcmp, strcpy, strlen）
 #include <unistd.h>                                     // UNIX 标准（read, write）
 #include <termios.h>                                    // 终端控制（termios 结构体）
+#include <sys/ioctl.h>                                  // ioctl, TIOCGWINSZ（终端宽度）
+#include <errno.h>                                      // errno, EINTR
 
 // 特殊按键 ASCII 码定义
 #define KEY_TAB 9                                       // Tab 键（水平制表符）
@@ -23,97 +26,377 @@
 #define KEY_CTRL_R 18                                   // Ctrl+R（反向搜索历史）
 
 // ============================================
-// 辅助函数：从历史中反向查找包含 query 的最近一条
+// 辅助函数：从历史中反向查找包含 query 的一条
 // ============================================
-// 返回：匹配到的历史命令字符串指针（由 history 模块持有），找不到返回 NULL
-static const char *history_reverse_search(const char *query) {
-    if (query == NULL) {
-        return NULL;
+// 参数：before - 只查找索引小于它的历史；skip - 跳过与它相同的命令（继续查找时用）
+// 返回：匹配到的历史索引，找不到返回 -1
+// 说明：查找由 history 模块的三字母索引完成，不再逐条 strstr
+static int history_reverse_search(const char *query, int before, const char *skip) {
+    int index = history_search(query, before);
+    while (index >= 0 && skip != NULL && strcmp(history_get(index), skip) == 0) {
+        index = history_search(query, index);
     }
+    return index;
+}
+
+// ============================================
+// 行的显示（支持 UTF-8、宽字符和自动换行，每次更新只 write 一次）
+// ============================================
+// 说明：
+//   - 屏幕上的位置用“从提示符开头数起的第几格”表示：第 n 格在第 n / cols 行、第 n % cols 列
+//     （宽字符占两格，在行末放不下时移到下一行开头）
+//   - 每次按键只修改 buffer 和光标位置，最后由 refresh_line 比较新内容和屏幕上显示的内容，
+//     只重画从第一个不同的字符开始的部分；光标移动使用 ESC[nA / ESC[nB（上下移动 n 行）
+//     和 ESC[nG（移到第 n 列），Ctrl+A / Ctrl+E 等不再逐个字符输出 \b
+//   - 要输出的内容先拼接在 out 中，最后用一次 write() 写出，终端不会显示到一半的画面
+
+// 行编辑器的显示状态
+typedef struct {
+    int cols;                                           // 终端宽度（列数）
+    int prompt_end;                                     // 提示符结束的位置
+    int cursor;                                         // 光标的位置
+    int end;                                            // 显示的内容结束的位置
+    char *shown;                                        // 屏幕上显示的输入 + 行内建议
+    size_t shown_input;                                 // 其中输入部分的长度（之后是建议）
+    size_t shown_len;
+    size_t shown_capacity;
+    char *out;                                          // 等待写出的内容
+    size_t out_len;
+    size_t out_capacity;
+} LineView;
+
+// 零宽字符（组合用的附加符号等）和宽字符（中日韩文字、全角符号、表情）的范围
+typedef struct {
+    unsigned int first;
+    unsigned int last;
+} CharRange;
+
+static const CharRange g_zero_width[] = {
+    { 0x0300, 0x036F }, { 0x1AB0, 0x1AFF }, { 0x1DC0, 0x1DFF }, { 0x200B, 0x200F },
+    { 0x20D0, 0x20FF }, { 0xFE00, 0xFE0F }, { 0xFE20, 0xFE2F },
+};
 
-    int count = history_count();
-    if (count <= 0) {
-        return NULL;
+static const CharRange g_double_width[] = {
+    { 0x1100, 0x115F }, { 0x2E80, 0x303E }, { 0x3041, 0x33FF }, { 0x3400, 0x4DBF },
+    { 0x4E00, 0x9FFF }, { 0xA000, 0xA4CF }, { 0xAC00, 0xD7A3 }, { 0xF900, 0xFAFF },
+    { 0xFE30, 0xFE4F }, { 0xFF00, 0xFF60 }, { 0xFFE0, 0xFFE6 }, { 0x1F300, 0x1F64F },
+    { 0x1F900, 0x1F9FF }, { 0x20000, 0x3FFFD },
+};
+
+static int in_ranges(unsigned int cp, const CharRange *ranges, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (cp >= ranges[i].first && cp <= ranges[i].last) {
+            return 1;
+        }
     }
+    return 0;
+}
 
-    if (query[0] == '\0') {
-        // 空查询：返回最近一条
-        return history_get(count - 1);
+// 字符在终端上占的格数（0、1 或 2）
+static int char_width(unsigned int cp) {
+    if (cp < 0x300) {
+        return 1;                                       // ASCII 和拉丁字母（最常见，直接返回）
+    }
+    if (in_ranges(cp, g_zero_width, sizeof(g_zero_width) / sizeof(g_zero_width[0]))) {
+        return 0;
     }
+    if (in_ranges(cp, g_double_width, sizeof(g_double_width) / sizeof(g_double_width[0]))) {
+        return 2;
+    }
+    return 1;
+}
 
-    for (int i = count - 1; i >= 0; i--) {
-        const char *item = history_get(i);
-        if (item != NULL && strstr(item, query) != NULL) {
-            return item;
+// 解码 text 开头的一个 UTF-8 字符
+// 返回：字符占的字节数；不完整或不合法的字节按一个字节、一格宽处理
+static int utf8_decode(const char *text, size_t len, unsigned int *cp) {
+    unsigned char c = (unsigned char)text[0];
+    int n;
+    unsigned int value;
+    if (c < 0x80) {
+        *cp = c;
+        return 1;
+    } else if ((c & 0xE0) == 0xC0) {
+        n = 2;
+        value = c & 0x1F;
+    } else if ((c & 0xF0) == 0xE0) {
+        n = 3;
+        value = c & 0x0F;
+    } else if ((c & 0xF8) == 0xF0) {
+        n = 4;
+        value = c & 0x07;
+    } else {
+        *cp = 0xFFFD;
+        return 1;
+    }
+    if ((size_t)n > len) {
+        *cp = 0xFFFD;
+        return 1;
+    }
+    for (int i = 1; i < n; i++) {
+        unsigned char b = (unsigned char)text[i];
+        if ((b & 0xC0) != 0x80) {
+            *cp = 0xFFFD;
+            return 1;
         }
+        value = (value << 6) | (b & 0x3F);
     }
-    return NULL;
+    *cp = value;
+    return n;
 }
 
-// ============================================
-// 辅助函数：清空当前行并重新显示（带提示符）
-// ============================================
-// 功能：清除当前行显示的内容，然后重新显示提示符和新内容
-// 用途：用于历史浏览、光标移动等场景
-// 参数：
-//   - buffer: 新的行内容
-//   - pos: 当前光标位置
-//   - old_len: 旧内容的长度
-//   - prompt_callback: 提示符显示回调函数
-static void refresh_line(const char *buffer, int pos, int old_len, PromptCallback prompt_callback) {
-    // 步骤1：移动光标到行首
-    printf("\r");                                       // 回车符，移到行首
-    
-    // 步骤2：使用 ANSI 转义序列清空从光标到行尾的内容
-    // ESC[K 清除从光标到行尾的内容（不换行）
-    printf("\033[K");                                   // 清空从光标到行尾
-    
-    // 步骤3：重新显示提示符
-    if (prompt_callback != NULL) {
-        prompt_callback();                              // 调用回调显示提示符
+// 位置 at 处显示一个宽度为 width 的字符之后的位置
+static int advance(const LineView *view, int at, int width) {
+    if (width == 2 && at % view->cols == view->cols - 1) {
+        at++;                                           // 行末只剩一格：宽字符移到下一行
     }
-    
-    // 步骤4：打印新内容
-    printf("%s", buffer);
-    
-    // 步骤5：将光标移到正确位置
-    // 如果光标不在末尾，需要向左移动
-    int new_len = strlen(buffer);
-    if (pos < new_len) {
-        // 向左移动到正确位置
-        for (int i = 0; i < new_len - pos; i++) {
-            printf("\b");                               // 向左移动一格
+    return at + width;
+}
+
+// 从位置 at 开始显示 text 的前 len 个字节之后的位置
+static int position_after(const LineView *view, int at, const char *text, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        unsigned int cp;
+        i += utf8_decode(text + i, len - i, &cp);
+        at = advance(view, at, char_width(cp));
+    }
+    return at;
+}
+
+// 光标左移：退到前一个字符的开头（跳过零宽字符，和前面的字符一起移动）
+static int prev_char(const char *buffer, int pos) {
+    while (pos > 0) {
+        do {
+            pos--;
+        } while (pos > 0 && ((unsigned char)buffer[pos] & 0xC0) == 0x80);
+        unsigned int cp;
+        utf8_decode(buffer + pos, strlen(buffer + pos), &cp);
+        if (char_width(cp) != 0) {
+            break;
         }
     }
-    
-    // 步骤6：刷新输出缓冲区
-    fflush(stdout);
+    return pos;
+}
+
+// 光标右移：移到下一个字符的开头（跳过后面的零宽字符）
+static int next_char(const char *buffer, int pos) {
+    size_t len = strlen(buffer);
+    unsigned int cp;
+    if ((size_t)pos < len) {
+        pos += utf8_decode(buffer + pos, len - pos, &cp);
+    }
+    while ((size_t)pos < len) {
+        int n = utf8_decode(buffer + pos, len - pos, &cp);
+        if (char_width(cp) != 0) {
+            break;
+        }
+        pos += n;
+    }
+    return pos;
+}
+
+// 把 len 字节添加到待写出的内容（内存不足时丢弃）
+static void view_append(LineView *view, const char *text, size_t len) {
+    if (view->out_len + len > view->out_capacity) {
+        size_t capacity = (view->out_capacity == 0) ? 1024 : view->out_capacity * 2;
+        while (capacity < view->out_len + len) {
+            capacity *= 2;
+        }
+        char *out = realloc(view->out, capacity);
+        if (out == NULL) {
+            return;
+        }
+        view->out = out;
+        view->out_capacity = capacity;
+    }
+    memcpy(view->out + view->out_len, text, len);
+    view->out_len += len;
+}
+
+// 添加一个转义序列 ESC [ n code
+static void view_escape(LineView *view, int n, char code) {
+    char seq[32];
+    int len = snprintf(seq, sizeof(seq), "\033[%d%c", n, code);
+    view_append(view, seq, len);
+}
+
+// 一次写出所有待写出的内容
+static void view_flush(LineView *view) {
+    fflush(stdout);                                     // 先写出 printf 的内容，保持顺序
+    size_t done = 0;
+    while (done < view->out_len) {
+        ssize_t n = write(STDOUT_FILENO, view->out + done, view->out_len - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        done += n;
+    }
+    view->out_len = 0;
+}
+
+// 光标从位置 from 移到位置 to（两个位置都在已经显示的行中）
+static void view_move(LineView *view, int from, int to) {
+    int rows = to / view->cols - from / view->cols;
+    if (rows < 0) {
+        view_escape(view, -rows, 'A');                  // 上移
+    } else if (rows > 0) {
+        view_escape(view, rows, 'B');                   // 下移
+    }
+    if (to % view->cols != from % view->cols) {
+        view_escape(view, to % view->cols + 1, 'G');    // 移到第几列（从 1 开始）
+    }
+}
+
+// 写到位置 at 之后光标正好在行末时，终端要等到下一个字符才换行：主动换到下一行开头，
+// 之后的光标移动才能按 at 计算
+static void view_wrap(LineView *view, int at) {
+    if (at > 0 && at % view->cols == 0) {
+        view_append(view, "\r\n", 2);
+    }
+}
+
+// 从位置 at 开始输出 text 的前 len 个字节
+// 返回：输出之后的位置
+static int view_text(LineView *view, int at, const char *text, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        unsigned int cp;
+        int n = utf8_decode(text + i, len - i, &cp);
+        int next = advance(view, at, char_width(cp));
+        if (next - at > 2) {
+            view_append(view, " ", 1);                  // 宽字符换行时填上行末的一格
+        }
+        view_append(view, text + i, n);
+        at = next;
+        i += n;
+    }
+    return at;
+}
+
+// 开始显示一行：在当前行的开头输出提示符
+static void view_begin(LineView *view, const char *prompt) {
+    struct winsize ws;
+    view->cols = 80;                                    // 取不到终端宽度时按 80 列
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 1) {
+        view->cols = ws.ws_col;
+    }
+    view->prompt_end = view_text(view, 0, prompt, strlen(prompt));
+    view_wrap(view, view->prompt_end);
+    view->cursor = view->prompt_end;
+    view->end = view->prompt_end;
+    view->shown_input = 0;
+    view->shown_len = 0;
+}
+
+// 擦除整个显示（提示符、输入和建议），换成新的提示符
+static void view_restart(LineView *view, const char *prompt) {
+    view_move(view, view->cursor, 0);
+    view_append(view, "\033[J", 3);                     // 清除光标之后的内容（包括下面几行）
+    view_begin(view, prompt);
+}
+
+// 结束显示：擦除建议，光标移到输入后面，再输出 suffix 并换行
+static void view_leave(LineView *view, const char *suffix) {
+    int input_end = position_after(view, view->prompt_end, view->shown, view->shown_input);
+    view_move(view, view->cursor, input_end);
+    view_append(view, "\033[J", 3);
+    int at = view_text(view, input_end, suffix, strlen(suffix));
+    if (at == 0 || at % view->cols != 0 || at > input_end) {
+        view_append(view, "\r\n", 2);               // 输入正好占满一行时已经在下一行开头
+    }
+    view_flush(view);
+    view->shown_input = 0;
+    view->shown_len = 0;
+}
+
+// 保存屏幕上显示的内容（用于下次比较）
+static void view_remember(LineView *view, const char *buffer, size_t len, const char *hint, size_t hint_len) {
+    if (len + hint_len + 1 > view->shown_capacity) {
+        size_t capacity = len + hint_len + 1024;
+        char *shown = realloc(view->shown, capacity);
+        if (shown == NULL) {
+            view->shown_input = 0;                      // 内存不足：下次全部重画
+            view->shown_len = 0;
+            return;
+        }
+        view->shown = shown;
+        view->shown_capacity = capacity;
+    }
+    memcpy(view->shown, buffer, len);
+    memcpy(view->shown + len, hint, hint_len);
+    view->shown_input = len;
+    view->shown_len = len + hint_len;
+}
+
+static void view_free(LineView *view) {
+    free(view->shown);
+    free(view->out);
 }
 
 // ============================================
-// 辅助函数：清空当前输入并替换为新内容
+// 辅助函数：更新显示的内容
 // ============================================
-// 功能：用于历史浏览时替换当前输入
-// 参数：
-//   - buffer: 输入缓冲区
-//   - size: 缓冲区大小
-//   - new_text: 新文本内容
-//   - prompt_callback: 提示符显示回调函数
-// 返回值：新内容的长度
-static int replace_line(char *buffer, size_t size, const char *new_text, PromptCallback prompt_callback) {
-    // 步骤1：保存旧内容长度
-    int old_len = strlen(buffer);
-    
-    // 步骤2：复制新内容
-    strncpy(buffer, new_text, size - 1);
-    buffer[size - 1] = '\0';
-    
-    // 步骤3：刷新显示（带提示符）
-    int new_len = strlen(buffer);
-    refresh_line(buffer, new_len, old_len, prompt_callback);
-    
-    // 步骤4：返回新长度
-    return new_len;
+// 功能：让屏幕显示“提示符 + buffer + 暗色的 hint（行内建议）”，光标在 buffer 的第 pos 个字节
+// 说明：只重画从第一个不同的字符开始的部分，最后用一次 write() 写出
+static void refresh_line(LineView *view, const char *buffer, int pos, const char *hint) {
+    size_t len = strlen(buffer);
+    size_t hint_len = strlen(hint);
+
+    // 步骤1：找到第一个不同的字节
+    size_t same = 0;
+    size_t shown_input = (view->shown != NULL) ? view->shown_input : 0;
+    while (same < len && same < shown_input && buffer[same] == view->shown[same]) {
+        same++;
+    }
+    int changed = 1;
+    if (view->shown != NULL && same == len && len == shown_input && hint_len == view->shown_len - shown_input &&
+        memcmp(hint, view->shown + len, hint_len) == 0) {
+        changed = 0;                                    // 内容没有变化，只移动光标
+    }
+
+    // 步骤2：从这个字符的开头重画（零宽字符要和前面的字符一起重画）
+    while (same > 0 && same < len && ((unsigned char)buffer[same] & 0xC0) == 0x80) {
+        same--;
+    }
+    if (same > 0 && same < len) {
+        unsigned int cp;
+        utf8_decode(buffer + same, len - same, &cp);
+        if (char_width(cp) == 0) {
+            same = prev_char(buffer, same);
+        }
+    }
+
+    // 步骤3：输出改变的部分，清除多出来的旧内容
+    int at = view->cursor;
+    if (changed) {
+        int start = position_after(view, view->prompt_end, buffer, same);
+        view_move(view, view->cursor, start);
+        at = view_text(view, start, buffer + same, len - same);
+        if (hint_len > 0) {
+            view_append(view, "\033[2m", 4);            // 暗色显示建议
+            at = view_text(view, at, hint, hint_len);
+            view_append(view, "\033[0m", 4);
+        }
+        if (at > start) {
+            view_wrap(view, at);
+        }
+        if (view->end > at) {
+            view_append(view, "\033[J", 3);
+        }
+        view->end = at;
+        view_remember(view, buffer, len, hint, hint_len);
+    }
+
+    // 步骤4：光标移到 pos，一次写出
+    int cursor = position_after(view, view->prompt_end, buffer, pos);
+    view_move(view, at, cursor);
+    view->cursor = cursor;
+    if (view->out_len > 0) {
+        view_flush(view);
+    }
 }
 
 // 计算多个字符串的公共前缀
@@ -170,30 +453,36 @@ static int get_common_prefix(char **matches, int count, char *common, size_t max
 //   1. 原始终端模式（逐字符读取，不等待回车）
 //   2. 第一次 Tab：补全公共前缀或响铃
 //   3. 第二次 Tab：显示所有匹配选项
-//   4. 退格键删除字符
+//   4. 退格键删除字符（UTF-8 字符整个删除）
 //   5. Ctrl+D 退出
-char* read_line_with_completion(char *buffer, size_t size, PromptCallback prompt_callback) {
+// 说明：各按键只修改 buffer 和 pos，显示统一在循环末尾由 refresh_line 更新
+char* read_line_with_completion(char *buffer, size_t size, const char *prompt) {
     // 步骤1：参数有效性检查
     if (buffer == NULL || size == 0) {                  // 检查无效参数
         return NULL;                                    // 返回 NULL 表示失败
     }
-    
+    if (prompt == NULL) {
+        prompt = "";
+    }
+
     // 步骤2：初始化输入缓冲区
-    int pos = 0;                                        // 当前输入位置（光标位置）
+    int pos = 0;                                        // 当前输入位置（光标位置，字节）
     buffer[0] = '\0';                                   // 初始化为空字符串
-    
+
     // 步骤3：实现双击 Tab 的状态变量（使用 static 在函数调用间保持状态）
     static int last_was_tab = 0;                        // 上次按键是否为 Tab（0=否，1=是）
     static char last_input[4096];                       // 上次 Tab 时的输入内容
-    
+
     // 步骤3.5：历史浏览状态变量
     int history_index = -1;                             // 当前浏览的历史索引（-1 表示未浏览）
-    
+    char suggestion[4096];                              // 正在显示的行内建议（剩余部分）
+    suggestion[0] = '\0';
+
     // 步骤4：保存原始终端设置（以便恢复）
     struct termios old_term, new_term;                  // 终端设置结构体
     tcgetattr(STDIN_FILENO, &old_term);                 // 获取当前终端设置
     new_term = old_term;                                // 复制到 new_term
-    
+
     // 步骤5：设置终端为原始模式
     // 原始模式特点：
     //   - ICANON：关闭规范模式（不等待回车，逐字符读取）
@@ -201,86 +490,65 @@ char* read_line_with_completion(char *buffer, size_t size, PromptCallback prompt
     //   - ISIG：关闭信号生成（Ctrl+C 不会发送 SIGINT，可以自己处理）
     new_term.c_lflag &= ~(ICANON | ECHO | ISIG);        // 清除这三个标志位
     tcsetattr(STDIN_FILENO, TCSANOW, &new_term);        // 立即应用新设置
-    
+
+    // 步骤5.5：显示提示符
+    LineView view;
+    memset(&view, 0, sizeof(view));
+    view_begin(&view, prompt);
+    view_flush(&view);
+
     // 步骤6：主输入循环
     int ch;                                             // 当前读取的字符
     while (1) {                                         // 无限循环，直到用户按回车或 Ctrl+D
         ch = getchar();                                 // 读取一个字符
-        
+        int len = strlen(buffer);                       // 当前输入的长度（字节）
+
         // 处理 Ctrl+D 或 EOF
         if (ch == EOF || ch == KEY_CTRL_D) {
             // Ctrl+D（文件结束信号）或真正的 EOF
-            if (pos == 0) {                             // 如果输入为空
+            if (len == 0) {                             // 如果输入为空
+                view_free(&view);
                 tcsetattr(STDIN_FILENO, TCSANOW, &old_term); // 恢复终端设置
                 return NULL;                            // 返回 NULL 表示用户想退出
             }
+            view_leave(&view, "");
             break;                                      // 如果有输入，结束输入循环
         }
-        
+
         // 处理 Ctrl+C（取消当前输入）
         else if (ch == KEY_CTRL_C) {
-            printf("^C\n");                             // 显示 ^C 并换行
+            view_leave(&view, "^C");                    // 显示 ^C 并换行
+            view_free(&view);
             buffer[0] = '\0';                           // 清空缓冲区
-            pos = 0;                                    // 重置位置
-            history_index = -1;                         // 重置历史索引
             tcsetattr(STDIN_FILENO, TCSANOW, &old_term); // 恢复终端设置
             return buffer;                              // 返回空字符串
         }
-        
+
         // 处理 Ctrl+A（移到行首）
         else if (ch == KEY_CTRL_A) {
-            // 将光标移到行首
-            while (pos > 0) {
-                printf("\b");                           // 向左移动
-                pos--;
-            }
-            fflush(stdout);
+            pos = 0;
             last_was_tab = 0;
         }
-        
+
         // 处理 Ctrl+E（移到行尾）
         else if (ch == KEY_CTRL_E) {
-            // 将光标移到行尾
-            int len = strlen(buffer);
-            while (pos < len) {
-                putchar(buffer[pos]);                   // 打印字符并移动光标
-                pos++;
-            }
-            fflush(stdout);
+            pos = len;
             last_was_tab = 0;
         }
-        
+
         // 处理 Ctrl+L（清屏并重新显示当前行）
         else if (ch == KEY_CTRL_L) {
-            // 使用 ANSI 转义序列清屏
-            printf("\033[H\033[2J");                    // \033[H 移动光标到左上角, \033[2J 清屏
-            fflush(stdout);
-            // 重新显示提示符和当前输入
-            if (prompt_callback != NULL) {
-                prompt_callback();
-            }
-            printf("%s", buffer);
-            // 将光标移到正确位置
-            int len = strlen(buffer);
-            for (int i = len; i > pos; i--) {
-                printf("\b");
-            }
-            fflush(stdout);
+            // 使用 ANSI 转义序列清屏：\033[H 移动光标到左上角, \033[2J 清屏
+            view_append(&view, "\033[H\033[2J", 7);
+            view_begin(&view, prompt);                  // 重新显示提示符，当前输入在循环末尾显示
             last_was_tab = 0;
         }
-        
+
         // 处理 Ctrl+U（清除从行首到光标的内容）
         else if (ch == KEY_CTRL_U) {
-            if (pos > 0) {
-                int old_len = strlen(buffer);
-                // 将光标后的内容移到行首
-                int chars_to_remove = pos;
-                int remaining = old_len - pos;
-                memmove(buffer, buffer + pos, remaining + 1);  // +1 包含 '\0'
-                pos = 0;
-                // 刷新显示
-                refresh_line(buffer, pos, old_len, prompt_callback);
-            }
+            // 将光标后的内容移到行首（+1 包含 '\0'）
+            memmove(buffer, buffer + pos, len - pos + 1);
+            pos = 0;
             last_was_tab = 0;
         }
 
@@ -297,33 +565,32 @@ char* read_line_with_completion(char *buffer, size_t size, PromptCallback prompt
             query[0] = '\0';
             int qlen = 0;
 
-            const char *match = history_reverse_search(query);
+            int match_index = history_reverse_search(query, history_count(), NULL);
+            const char *match = (match_index >= 0) ? history_get(match_index) : NULL;
 
             // 交互循环：直到 Enter 接受 / ESC 取消
             while (1) {
-                // 刷新整行显示为搜索提示
-                printf("\r\033[K");
-                printf("(reverse-i-search)`%s`: %s", query, (match != NULL) ? match : "");
-                fflush(stdout);
+                // 整个显示换成搜索提示和匹配的命令
+                char search_prompt[300];
+                snprintf(search_prompt, sizeof(search_prompt), "(reverse-i-search)`%s`: ", query);
+                view_restart(&view, search_prompt);
+                refresh_line(&view, (match != NULL) ? match : "", (match != NULL) ? (int)strlen(match) : 0, "");
 
                 int sch = getchar();
 
-                // ESC：取消搜索，恢复原输入
-                if (sch == KEY_ESC) {
-                    int old_len = strlen(buffer);
+                // ESC（或输入结束）：取消搜索，恢复原输入
+                if (sch == KEY_ESC || sch == EOF) {
                     strncpy(buffer, saved_buffer, size - 1);
                     buffer[size - 1] = '\0';
                     pos = (saved_pos <= (int)strlen(buffer)) ? saved_pos : (int)strlen(buffer);
-                    refresh_line(buffer, pos, old_len, prompt_callback);
                     break;
                 }
 
                 // Ctrl+C：取消搜索并清空输入（与主循环 Ctrl+C 行为一致）
                 if (sch == KEY_CTRL_C) {
-                    printf("^C\n");
+                    view_leave(&view, "^C");
+                    view_free(&view);
                     buffer[0] = '\0';
-                    pos = 0;
-                    history_index = -1;
                     // 恢复终端设置并返回空行
                     tcsetattr(STDIN_FILENO, TCSANOW, &old_term);
                     return buffer;
@@ -331,7 +598,6 @@ char* read_line_with_completion(char *buffer, size_t size, PromptCallback prompt
 
                 // Enter：接受匹配（或空）填充到 buffer
                 if (sch == KEY_NEWLINE || sch == KEY_RETURN) {
-                    int old_len = strlen(buffer);
                     if (match != NULL) {
                         strncpy(buffer, match, size - 1);
                         buffer[size - 1] = '\0';
@@ -340,26 +606,41 @@ char* read_line_with_completion(char *buffer, size_t size, PromptCallback prompt
                     }
                     pos = strlen(buffer);
                     history_index = -1;
-                    refresh_line(buffer, pos, old_len, prompt_callback);
                     break;
                 }
 
-                // Backspace：删除 query 最后一个字符
+                // 再按 Ctrl+R：继续查找更旧的匹配（跳过相同的命令，没有更旧的时保持当前匹配）
+                if (sch == KEY_CTRL_R) {
+                    if (match_index >= 0) {
+                        int older = history_reverse_search(query, match_index, match);
+                        if (older >= 0) {
+                            match_index = older;
+                            match = history_get(match_index);
+                        }
+                    }
+                    continue;
+                }
+
+                // Backspace：删除 query 最后一个字符（重新从最新的开始查找）
                 if (sch == KEY_BACKSPACE || sch == 8) {
                     if (qlen > 0) {
-                        qlen--;
+                        qlen = prev_char(query, qlen);
                         query[qlen] = '\0';
-                        match = history_reverse_search(query);
+                        match_index = history_reverse_search(query, history_count(), NULL);
+                        match = (match_index >= 0) ? history_get(match_index) : NULL;
                     }
                     continue;
                 }
 
-                // 可打印字符：追加到 query
-                if (sch >= 32 && sch < 127) {
+                // 可打印字符（包括 UTF-8 字符的各个字节）：追加到 query
+                // 说明：新的匹配一定也包含原来的查询，从当前匹配开始（含）向旧查找即可
+                if (sch >= 32 && sch != 127) {
                     if (qlen < (int)sizeof(query) - 1) {
                         query[qlen++] = (char)sch;
                         query[qlen] = '\0';
-                        match = history_reverse_search(query);
+                        int before = (match_index >= 0) ? match_index + 1 : 0;
+                        match_index = history_reverse_search(query, before, NULL);
+                        match = (match_index >= 0) ? history_get(match_index) : NULL;
                     }
                     continue;
                 }
@@ -367,314 +648,283 @@ char* read_line_with_completion(char *buffer, size_t size, PromptCallback prompt
                 // 其他控制字符忽略
             }
 
+            // 恢复提示符，编辑的内容在循环末尾显示
+            view_restart(&view, prompt);
             last_was_tab = 0;
         }
-        
+
         // 处理转义序列（箭头键等）
         else if (ch == KEY_ESC) {
             // 读取转义序列的后续字符
             int ch2 = getchar();
             if (ch2 == '[') {                           // CSI 序列（Control Sequence Introducer）
                 int ch3 = getchar();
-                
+
                 // 上箭头：ESC [ A
                 if (ch3 == 'A') {
                     const char* prev = history_prev(&history_index);
                     if (prev != NULL) {
-                        pos = replace_line(buffer, size, prev, prompt_callback);
+                        snprintf(buffer, size, "%s", prev);
+                        pos = strlen(buffer);
                     }
-                    last_was_tab = 0;
                 }
-                
+
                 // 下箭头：ESC [ B
                 else if (ch3 == 'B') {
                     const char* next = history_next(&history_index);
                     if (next != NULL) {
-                        pos = replace_line(buffer, size, next, prompt_callback);
+                        snprintf(buffer, size, "%s", next);
                     } else {
                         // 已到最新，清空输入
-                        pos = replace_line(buffer, size, "", prompt_callback);
+                        buffer[0] = '\0';
                         history_index = -1;
                     }
-                    last_was_tab = 0;
+                    pos = strlen(buffer);
                 }
-                
+
                 // 右箭头：ESC [ C
                 else if (ch3 == 'C') {
-                    if (pos < (int)strlen(buffer)) {
-                        putchar(buffer[pos]);           // 打印字符
-                        pos++;                          // 光标右移
-                        fflush(stdout);
+                    if (pos < len) {
+                        pos = next_char(buffer, pos);   // 光标右移一个字符
+                    } else if (suggestion[0] != '\0' && pos + strlen(suggestion) < size) {
+                        // 光标在行尾：接受行内建议
+                        strcpy(buffer + pos, suggestion);
+                        pos += strlen(suggestion);
                     }
-                    last_was_tab = 0;
                 }
-                
+
                 // 左箭头：ESC [ D
                 else if (ch3 == 'D') {
-                    if (pos > 0) {
-                        printf("\b");                   // 光标左移
-                        pos--;
-                        fflush(stdout);
-                    }
-                    last_was_tab = 0;
+                    pos = prev_char(buffer, pos);       // 光标左移一个字符
                 }
-                
-                // Home 键：ESC [ H 或 ESC [ 1 ~（移到行首）
+
+                // Home 键：ESC [ H（移到行首）
                 else if (ch3 == 'H') {
-                    // 将光标移到行首
-                    while (pos > 0) {
-                        printf("\b");                   // 向左移动
-                        pos--;
-                    }
-                    fflush(stdout);
-                    last_was_tab = 0;
+                    pos = 0;
                 }
-                
-                // End 键：ESC [ F 或 ESC [ 4 ~（移到行尾）
+
+                // End 键：ESC [ F（移到行尾）
                 else if (ch3 == 'F') {
-                    // 将光标移到行尾
-                    int len = strlen(buffer);
-                    while (pos < len) {
-                        putchar(buffer[pos]);           // 打印字符并移动光标
-                        pos++;
-                    }
-                    fflush(stdout);
-                    last_was_tab = 0;
+                    pos = len;
                 }
-                
+
                 // 处理 ESC [ 数字 ~ 格式的键（Home=1~, End=4~, 等）
                 else if (ch3 >= '0' && ch3 <= '9') {
                     int ch4 = getchar();                // 读取 ~
                     if (ch4 == '~') {
                         if (ch3 == '1') {               // Home 键：ESC [ 1 ~
-                            while (pos > 0) {
-                                printf("\b");
-                                pos--;
-                            }
-                            fflush(stdout);
+                            pos = 0;
                         }
                         else if (ch3 == '4') {          // End 键：ESC [ 4 ~
-                            int len = strlen(buffer);
-                            while (pos < len) {
-                                putchar(buffer[pos]);
-                                pos++;
-                            }
-                            fflush(stdout);
+                            pos = len;
                         }
                     }
-                    last_was_tab = 0;
                 }
+                last_was_tab = 0;
             }
         }
-        
+
         // 处理回车键
         else if (ch == KEY_NEWLINE || ch == KEY_RETURN) {
             // 回车键 - 完成输入
-            printf("\n");                               // 打印换行符（移动到下一行）
-            buffer[pos] = '\0';                         // 添加字符串结束符
+            view_leave(&view, "");                      // 擦除建议并换行
             last_was_tab = 0;                           // 重置 Tab 状态
             break;                                      // 跳出循环，返回输入的字符串
         }
-        
+
         // 处理退格键
         else if (ch == KEY_BACKSPACE || ch == 8) {
-            // 退格键（ASCII 127 或 8）
+            // 退格键（ASCII 127 或 8）：删除光标前的一个字符（可能有多个字节）
             if (pos > 0) {                              // 如果有字符可以删除
-                int old_len = strlen(buffer);
-                pos--;                                  // 光标位置后退
-                
-                // 如果光标不在末尾，需要将后面的字符向前移动
-                if (pos < old_len - 1) {
-                    // 将光标后面的字符向前移动一位
-                    for (int i = pos; i < old_len; i++) {
-                        buffer[i] = buffer[i + 1];
-                    }
-                } else {
-                    // 光标在末尾，直接截断
-                    buffer[pos] = '\0';
-                }
-                
-                // 重新显示整行（使用 refresh_line 确保显示正确）
-                int new_len = strlen(buffer);
-                refresh_line(buffer, pos, old_len, prompt_callback);
+                int start = prev_char(buffer, pos);
+                memmove(buffer + start, buffer + pos, len - pos + 1);  // 后面的内容前移（含 '\0'）
+                pos = start;
             }
             last_was_tab = 0;                           // 重置 Tab 状态（输入改变了）
         }
-        
+
         // 处理 Tab 键（核心补全逻辑）
         else if (ch == KEY_TAB) {
-            // Tab 键 - 执行补全
-            buffer[pos] = '\0';                         // 确保字符串以 \0 结尾
-            
             // 步骤1：检查是否为双击 Tab
             // 条件：上次按键也是 Tab，且输入内容没有变化
             int is_double_tab = (last_was_tab && strcmp(buffer, last_input) == 0);
-            
+
             // 步骤2：保存当前输入状态（用于下次判断是否为双击）
             strcpy(last_input, buffer);                 // 保存当前输入
             last_was_tab = 1;                           // 标记本次按键为 Tab
-            
+
             // 步骤3：获取补全建议（使用智能补全）
             char **matches = NULL;                      // 匹配项数组指针
             int count = get_smart_completions(buffer, pos, &matches); // 调用智能补全函数
-            
+
+            // 需要在光标处插入的补全内容
+            const char *to_add = NULL;
+            char common[4096];                          // 公共前缀缓冲区
+
             // 情况1：没有匹配项
             if (count == 0) {
                 // 没有匹配项 - 响铃提示用户
-                printf("\a");                           // \a 是响铃字符（BEL）
-                fflush(stdout);                         // 刷新输出
+                view_append(&view, "\a", 1);            // \a 是响铃字符（BEL）
             }
-            
+
             // 情况2：只有一个匹配 - 直接补全
             else if (count == 1) {
-                // 只有一个匹配 - 自动补全
                 char prefix[4096];                      // 目录前缀
                 char partial[4096];                     // 部分文件名
                 extract_path_to_complete(buffer, pos, prefix, partial); // 提取路径部分
-                
-                // 计算需要补全的部分（去掉已输入的部分）
+
+                // 需要补全的部分（去掉已输入的部分）
+                snprintf(common, sizeof(common), "%s", matches[0] + strlen(partial));
+                to_add = common;
+            }
+
+            // 情况3：多个匹配，第一次 Tab：尝试补全公共前缀
+            else if (!is_double_tab) {
+                char prefix[4096];                      // 目录前缀
+                char partial[4096];                     // 部分文件名
+                extract_path_to_complete(buffer, pos, prefix, partial);
+
+                // 计算所有匹配项的公共前缀
+                get_common_prefix(matches, count, common, sizeof(common));
+
                 int partial_len = strlen(partial);      // 已输入的长度
-                const char *to_add = matches[0] + partial_len; // 需要添加的部分
-                int add_len = strlen(to_add);           // 需要添加的长度
-                
-                // 检查缓冲区空间是否足够
-                if (pos + add_len < (int)size - 1) {    // 确保不溢出
-                    // 添加补全部分到缓冲区
-                    strcpy(buffer + pos, to_add);       // 追加到 buffer 末尾
-                    pos += add_len;                     // 更新光标位置
-                    
-                    // 在终端上显示补全的部分
-                    printf("%s", to_add);               // 打印补全内容
-                    fflush(stdout);                     // 刷新输出
-                    
-                    // 更新 last_input（因为内容变了）
-                    strcpy(last_input, buffer);         // 保存新的输入内容
+                if ((int)strlen(common) > partial_len) {
+                    to_add = common + partial_len;      // 有更长的公共前缀可以补全
+                } else {
+                    // 没有更多公共前缀可以补全
+                    // 响铃提示用户再按一次 Tab 查看所有选项
+                    view_append(&view, "\a", 1);
                 }
-                
-                free_completions(matches, count);       // 释放匹配项内存
             }
-            
-            // 情况3：多个匹配
+
+            // 情况4：多个匹配，第二次 Tab：在输入下面显示所有匹配选项
             else {
-                // 有多个匹配项
-                
-                // 第一次 Tab：尝试补全公共前缀
-                if (!is_double_tab) {
-                    // 不是双击 Tab，尝试补全公共前缀
-                    char prefix[4096];                  // 目录前缀
-                    char partial[4096];                 // 部分文件名
-                    extract_path_to_complete(buffer, pos, prefix, partial);
-                    
-                    // 计算所有匹配项的公共前缀
-                    char common[4096];                  // 公共前缀缓冲区
-                    get_common_prefix(matches, count, common, sizeof(common));
-                    
-                    int partial_len = strlen(partial);  // 已输入的长度
-                    int common_len = strlen(common);    // 公共前缀长度
-                    
-                    if (common_len > partial_len) {
-                        // 有更长的公共前缀可以补全
-                        const char *to_add = common + partial_len; // 需要添加的部分
-                        int add_len = strlen(to_add);   // 添加的长度
-                        
-                        if (pos + add_len < (int)size - 1) { // 检查缓冲区空间
-                            strcpy(buffer + pos, to_add); // 追加到 buffer
-                            pos += add_len;             // 更新光标位置
-                            printf("%s", to_add);       // 显示补全内容
-                            fflush(stdout);             // 刷新输出
-                            strcpy(last_input, buffer); // 更新 last_input
-                        }
-                    } else {
-                        // 没有更多公共前缀可以补全
-                        // 响铃提示用户再按一次 Tab 查看所有选项
-                        printf("\a");                   // 响铃
-                        fflush(stdout);                 // 刷新输出
+                view_leave(&view, "");                  // 换行（开始显示列表）
+
+                // 打印所有匹配项（每行显示 5 个）
+                for (int i = 0; i < count; i++) {
+                    printf("%s  ", matches[i]);         // 打印匹配项，两个空格分隔
+                    if ((i + 1) % 5 == 0) {             // 每显示 5 个换行
+                        printf("\n");                   // 换行
                     }
-                    
-                    free_completions(matches, count);   // 释放内存
                 }
-                
-                // 第二次 Tab：显示所有匹配选项
-                else {
-                    // 是双击 Tab，显示所有匹配项
-                    printf("\n");                       // 换行（开始显示列表）
-                    
-                    // 打印所有匹配项（每行显示 5 个）
-                    for (int i = 0; i < count; i++) {
-                        printf("%s  ", matches[i]);     // 打印匹配项，两个空格分隔
-                        if ((i + 1) % 5 == 0) {         // 每显示 5 个换行
-                            printf("\n");               // 换行
-                        }
-                    }
-                    if (count % 5 != 0) {               // 如果最后一行不满 5 个
-                        printf("\n");                   // 补充换行
-                    }
-                    
-                    // 重新显示提示符和当前输入
-                    if (prompt_callback != NULL) {      // 如果有提示符回调函数
-                        prompt_callback();              // 调用回调显示提示符
-                    }
-                    printf("%s", buffer);               // 重新显示当前输入
-                    fflush(stdout);                     // 刷新输出
-                    
-                    free_completions(matches, count);   // 释放内存
-                    last_was_tab = 0;                   // 重置状态（避免第三次 Tab 再次显示）
+                if (count % 5 != 0) {                   // 如果最后一行不满 5 个
+                    printf("\n");                       // 补充换行
                 }
+
+                // 重新显示提示符，当前输入在循环末尾显示
+                view_begin(&view, prompt);
+                last_was_tab = 0;                       // 重置状态（避免第三次 Tab 再次显示）
             }
+
+            // 在光标处插入补全的内容（检查缓冲区空间是否足够）
+            if (to_add != NULL) {
+                int add_len = strlen(to_add);
+                if (len + add_len < (int)size - 1) {
+                    memmove(buffer + pos + add_len, buffer + pos, len - pos + 1);
+                    memcpy(buffer + pos, to_add, add_len);
+                    pos += add_len;
+                    strcpy(last_input, buffer);         // 更新 last_input（因为内容变了）
+                }
+            }
+
+            free_completions(matches, count);           // 释放匹配项内存
         }
-        
-        // 处理可打印字符
-        else if (ch >= 32 && ch < 127) {
-            // 可打印字符（ASCII 32-126，即空格到 ~）
-            int old_len = strlen(buffer);
-            if (pos < (int)size - 1) {                  // 检查缓冲区是否还有空间
-                // 如果光标不在末尾，需要将后面的字符向后移动
-                if (pos < old_len) {
-                    // 将光标位置及后面的字符向后移动一位
-                    // 注意：需要移动包括 '\0' 在内的所有字符
-                    // 从后往前移动，避免覆盖
-                    for (int i = old_len; i >= pos; i--) {
-                        if (i + 1 < (int)size) {  // 确保不越界
-                            buffer[i + 1] = buffer[i];
-                        }
-                    }
-                    // 在光标位置插入新字符
-                    buffer[pos] = ch;
-                    pos++;                              // 光标位置前进
-                    // 确保字符串以 \0 结尾（移动时已经保留了，但再次确认）
-                    if (pos < (int)size) {
-                        // 不需要设置，因为移动时已经保留了 '\0'
-                    }
-                    
-                    // 光标在中间位置，需要重新显示整行
-                    // 确保缓冲区以 \0 结尾
-                    if (pos < (int)size) {
-                        buffer[pos] = '\0';
-                    } else {
-                        buffer[size - 1] = '\0';
-                    }
-                    int new_len = strlen(buffer);
-                    refresh_line(buffer, pos, old_len, prompt_callback);
-                } else {
-                    // 光标在末尾，直接追加（不需要刷新整行，直接打印即可）
-                    buffer[pos] = ch;
-                    pos++;                              // 光标位置前进
-                    if (pos < (int)size) {
-                        buffer[pos] = '\0';             // 确保字符串以 \0 结尾
-                    }
-                    // 直接打印字符，不需要刷新整行
-                    printf("%c", ch);
-                    fflush(stdout);
+
+        // 处理可打印字符（ASCII 32-126，以及 UTF-8 编码的多字节字符）
+        else if (ch >= 32 && ch != 127) {
+            // 多字节字符：由第一个字节得到总字节数，再读取后面的字节
+            char bytes[4];
+            int n = (ch < 0x80) ? 1 : (ch >= 0xF8) ? 0 : (ch >= 0xF0) ? 4 :
+                    (ch >= 0xE0) ? 3 : (ch >= 0xC0) ? 2 : 0;
+            bytes[0] = (char)ch;
+            for (int i = 1; i < n; i++) {
+                int next = getchar();
+                if (next == EOF || (next & 0xC0) != 0x80) {
+                    n = 0;                              // 不完整的字符丢弃
+                    break;
                 }
+                bytes[i] = (char)next;
+            }
+
+            // 在光标处插入（光标后的内容连同 '\0' 向后移动）
+            if (n > 0 && len + n < (int)size) {
+                memmove(buffer + pos + n, buffer + pos, len - pos + 1);
+                memcpy(buffer + pos, bytes, n);
+                pos += n;
             }
             last_was_tab = 0;                           // 重置 Tab 状态（输入改变了）
         }
-        // 忽略其他控制字符（如方向键等）
+        // 忽略其他控制字符
+
+        // 根据新的输入确定行内建议（光标在行尾时），然后更新显示
+        suggestion[0] = '\0';
+        len = strlen(buffer);
+        if (pos == len && len > 0) {
+            const char *match = frecency_suggest(buffer);
+            if (match != NULL) {
+                snprintf(suggestion, sizeof(suggestion), "%s", match + len);
+            }
+        }
+        refresh_line(&view, buffer, pos, suggestion);
     }
-    
+
     // 步骤7：恢复终端设置
+    view_free(&view);
     tcsetattr(STDIN_FILENO, TCSANOW, &old_term);        // 恢复为原始终端设置
-    
+
     // 步骤8：返回读取的字符串
     return buffer;                                      // 返回 buffer 指针
 }
+
+// ============================================
+// 非交互输入
+// ============================================
+void input_use_block_buffer(FILE *stream) {
+    setvbuf(stream, NULL, _IOFBF, INPUT_BLOCK_SIZE);
+}
+
+char* read_line_plain(FILE *stream, char **buffer, size_t *capacity) {
+    if (*capacity < INPUT_LINE_INITIAL) {
+        char *bigger = realloc(*buffer, INPUT_LINE_INITIAL);
+        if (bigger == NULL) {
+            perror("xshell");
+            return NULL;
+        }
+        *buffer = bigger;
+        *capacity = INPUT_LINE_INITIAL;
+    }
+    
+    size_t len = 0;
+    for (;;) {
+        if (fgets(*buffer + len, (int)(*capacity - len), stream) == NULL) {
+            // 被信号（如 Ctrl+C）打断时继续读取，真正的 EOF / 错误才返回
+            if (ferror(stream) && errno == EINTR) {
+                clearerr(stream);
+                continue;
+            }
+            if (len == 0) {
+                return NULL;
+            }
+            break;                                      // 最后一行没有换行符
+        }
+        len += strlen(*buffer + len);
+        if (len > 0 && (*buffer)[len - 1] == '\n') {
+            (*buffer)[--len] = '\0';
+            break;
+        }
+        if (len + 1 < *capacity) {
+            break;                                      // 读到 EOF（或行中有 NUL 字节）
+        }
+        
+        // 行比缓冲区长：扩大一倍后继续读这一行
+        char *bigger = realloc(*buffer, *capacity * 2);
+        if (bigger == NULL) {
+            perror("xshell");
+            return NULL;
+        }
+        *buffer = bigger;
+        *capacity *= 2;
+    }
+    return *buffer;
+}
@@ -4,18 +4,43 @@
  */
 
 #define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE                 // syscall, wait4
 #include "job.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <signal.h>
+#include <poll.h>
 #include <sys/wait.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
-// 全局作业列表
-static Job g_jobs[MAX_JOBS];
+// 作业列表的初始容量
+#define JOB_INITIAL_CAPACITY 16
+
+// pid 哈希表的初始桶数量（必须是 2 的幂）
+#define PID_INITIAL_BUCKETS 64
+
+// 全局作业列表（按作业 ID 从小到大排列，每个作业单独分配，指针在作业移除前一直有效）
+static Job **g_jobs = NULL;
+static int g_job_count = 0;
+static int g_job_capacity = 0;
 static int g_next_job_id = 1;
 static volatile sig_atomic_t g_sigchld_received = 0;
+static struct timespec g_sigchld_time;      // 最近一次 SIGCHLD 的时间（后台作业的结束时间）
+
+// pid -> 作业进程（链地址法）
+typedef struct PidEntry {
+    pid_t pid;
+    Job *job;                               // 所属作业
+    JobProcess *proc;                       // 作业中的进程
+    struct PidEntry *next;                  // 同一个桶中的下一个条目
+} PidEntry;
+
+static PidEntry **g_pid_buckets = NULL;     // 桶数组
+static size_t g_pid_bucket_count = 0;       // 桶数量
+static size_t g_pid_count = 0;              // 条目数量
 
 // 颜色定义
 #define C_RESET   "\033[0m"
@@ -27,52 +52,228 @@ static volatile sig_atomic_t g_sigchld_received = 0;
 
 // 初始化作业管理
 void job_init(void) {
-    memset(g_jobs, 0, sizeof(g_jobs));
+    g_job_count = 0;
     g_next_job_id = 1;
 }
 
+// ============================================
+// pid 哈希表
+// ============================================
+
+// pid 哈希（乘法散列，相邻的 pid 分散到不同的桶）
+static size_t hash_pid(pid_t pid) {
+    return ((size_t)pid * 2654435761u) & (g_pid_bucket_count - 1);
+}
+
+// 扩容：条目数超过桶数时桶数翻倍
+static void pid_table_grow(void) {
+    size_t new_count = (g_pid_bucket_count == 0) ? PID_INITIAL_BUCKETS : g_pid_bucket_count * 2;
+    PidEntry **new_buckets = calloc(new_count, sizeof(PidEntry *));
+    if (new_buckets == NULL) {
+        return;                             // 扩容失败不影响正确性，只是链变长
+    }
+    
+    size_t old_count = g_pid_bucket_count;
+    PidEntry **old_buckets = g_pid_buckets;
+    g_pid_buckets = new_buckets;
+    g_pid_bucket_count = new_count;
+    for (size_t i = 0; i < old_count; i++) {
+        PidEntry *entry = old_buckets[i];
+        while (entry != NULL) {
+            PidEntry *next = entry->next;
+            size_t idx = hash_pid(entry->pid);
+            entry->next = g_pid_buckets[idx];
+            g_pid_buckets[idx] = entry;
+            entry = next;
+        }
+    }
+    free(old_buckets);
+}
+
+// 查找 pid 对应的条目
+static PidEntry* pid_table_find(pid_t pid) {
+    if (g_pid_bucket_count == 0) {
+        return NULL;
+    }
+    for (PidEntry *entry = g_pid_buckets[hash_pid(pid)]; entry != NULL; entry = entry->next) {
+        if (entry->pid == pid) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// 登记作业中的一个进程
+// 返回：0=成功，-1=内存不足
+static int pid_table_add(Job *job, JobProcess *proc) {
+    if (g_pid_count >= g_pid_bucket_count) {
+        pid_table_grow();
+        if (g_pid_bucket_count == 0) {
+            return -1;
+        }
+    }
+    PidEntry *entry = malloc(sizeof(PidEntry));
+    if (entry == NULL) {
+        return -1;
+    }
+    size_t idx = hash_pid(proc->pid);
+    entry->pid = proc->pid;
+    entry->job = job;
+    entry->proc = proc;
+    entry->next = g_pid_buckets[idx];
+    g_pid_buckets[idx] = entry;
+    g_pid_count++;
+    return 0;
+}
+
+// 删除进程的条目
+static void pid_table_remove(pid_t pid) {
+    if (g_pid_bucket_count == 0) {
+        return;
+    }
+    for (PidEntry **link = &g_pid_buckets[hash_pid(pid)]; *link != NULL; link = &(*link)->next) {
+        if ((*link)->pid == pid) {
+            PidEntry *entry = *link;
+            *link = entry->next;
+            free(entry);
+            g_pid_count--;
+            return;
+        }
+    }
+}
+
+// ============================================
+// 作业列表
+// ============================================
+
+// 打开进程的 pidfd（进程结束后可读）
+// 返回：描述符（带 close-on-exec），内核不支持时返回 -1
+static int open_pidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+// 把 waitpid 得到的状态转换成 $? 的值
+int job_exit_status(int wait_status) {
+    if (WIFEXITED(wait_status)) {
+        return WEXITSTATUS(wait_status);
+    }
+    if (WIFSIGNALED(wait_status)) {
+        return 128 + WTERMSIG(wait_status);
+    }
+    return 128 + WSTOPSIG(wait_status);
+}
+
+// 释放作业占用的资源
+static void job_free(Job *job) {
+    for (int i = 0; i < job->proc_count; i++) {
+        pid_table_remove(job->procs[i].pid);
+        if (job->procs[i].pidfd >= 0) {
+            close(job->procs[i].pidfd);
+        }
+    }
+    free(job->procs);
+    free(job);
+}
+
+// 从列表中删除第 index 个作业（后面的作业前移，保持按 ID 排序）
+static void job_delete_at(int index) {
+    job_free(g_jobs[index]);
+    memmove(&g_jobs[index], &g_jobs[index + 1], (size_t)(g_job_count - index - 1) * sizeof(Job *));
+    g_job_count--;
+}
+
 // 添加作业
-int job_add(pid_t pid, const char *command) {
-    // 找一个空槽位
-    for (int i = 0; i < MAX_JOBS; i++) {
-        if (g_jobs[i].pid == 0) {
-            g_jobs[i].id = g_next_job_id++;
-            g_jobs[i].pid = pid;
-            g_jobs[i].status = JOB_RUNNING;
-            g_jobs[i].notified = false;
-            strncpy(g_jobs[i].command, command, sizeof(g_jobs[i].command) - 1);
-            g_jobs[i].command[sizeof(g_jobs[i].command) - 1] = '\0';
-            return g_jobs[i].id;
+int job_add(pid_t pgid, const pid_t *pids, int count, const char *command) {
+    if (g_job_count == g_job_capacity) {
+        int capacity = (g_job_capacity == 0) ? JOB_INITIAL_CAPACITY : g_job_capacity * 2;
+        Job **jobs = realloc(g_jobs, (size_t)capacity * sizeof(Job *));
+        if (jobs == NULL) {
+            return -1;
+        }
+        g_jobs = jobs;
+        g_job_capacity = capacity;
+    }
+    
+    Job *job = calloc(1, sizeof(Job));
+    if (job == NULL) {
+        return -1;
+    }
+    job->procs = calloc((size_t)count, sizeof(JobProcess));
+    if (job->procs == NULL) {
+        free(job);
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        job->procs[i].pid = pids[i];
+        job->procs[i].pidfd = open_pidfd(pids[i]);
+        job->proc_count++;
+        if (pid_table_add(job, &job->procs[i]) != 0) {
+            job_free(job);
+            return -1;
+        }
+    }
+    job->id = g_next_job_id++;
+    job->pgid = pgid;
+    job->live = count;
+    job->status = JOB_RUNNING;
+    job->notified = false;
+    strncpy(job->command, command, sizeof(job->command) - 1);
+    job->command[sizeof(job->command) - 1] = '\0';
+    clock_gettime(CLOCK_MONOTONIC, &job->started);
+    
+    g_jobs[g_job_count++] = job;                // ID 递增，追加到末尾仍然有序
+    return job->id;
+}
+
+// 按作业 ID 二分查找在列表中的位置，找不到返回 -1
+static int job_index(int job_id) {
+    int low = 0;
+    int high = g_job_count - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        if (g_jobs[mid]->id == job_id) {
+            return mid;
+        }
+        if (g_jobs[mid]->id < job_id) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
         }
     }
-    return -1;  // 没有空槽位
+    return -1;
 }
 
 // 移除作业
 void job_remove(int job_id) {
-    for (int i = 0; i < MAX_JOBS; i++) {
-        if (g_jobs[i].id == job_id) {
-            memset(&g_jobs[i], 0, sizeof(Job));
-            return;
-        }
+    int index = job_index(job_id);
+    if (index >= 0) {
+        job_delete_at(index);
     }
 }
 
 // 根据作业 ID 获取作业
 Job* job_get(int job_id) {
-    for (int i = 0; i < MAX_JOBS; i++) {
-        if (g_jobs[i].id == job_id && g_jobs[i].pid != 0) {
-            return &g_jobs[i];
-        }
-    }
-    return NULL;
+    int index = job_index(job_id);
+    return (index >= 0) ? g_jobs[index] : NULL;
 }
 
-// 根据 PID 获取作业
+// 根据 PID 获取作业（管道中任意一个进程）
 Job* job_get_by_pid(pid_t pid) {
-    for (int i = 0; i < MAX_JOBS; i++) {
-        if (g_jobs[i].pid == pid) {
-            return &g_jobs[i];
+    PidEntry *entry = pid_table_find(pid);
+    return (entry != NULL) ? entry->job : NULL;
+}
+
+// 获取最后一个处于指定状态的作业
+Job* job_latest(JobStatus status) {
+    for (int i = g_job_count - 1; i >= 0; i--) {
+        if (g_jobs[i]->status == status) {
+            return g_jobs[i];
         }
     }
     return NULL;
@@ -80,36 +281,244 @@ Job* job_get_by_pid(pid_t pid) {
 
 // 获取作业数量
 int job_count(void) {
-    int count = 0;
-    for (int i = 0; i < MAX_JOBS; i++) {
-        if (g_jobs[i].pid != 0) {
-            count++;
+    return g_job_count;
+}
+
+// ============================================
+// 回收子进程
+// ============================================
+
+// 累加一个进程的资源使用（最大内存取最大值）
+static void usage_add(struct rusage *total, const struct rusage *usage) {
+    total->ru_utime.tv_sec += usage->ru_utime.tv_sec;
+    total->ru_utime.tv_usec += usage->ru_utime.tv_usec;
+    total->ru_stime.tv_sec += usage->ru_stime.tv_sec;
+    total->ru_stime.tv_usec += usage->ru_stime.tv_usec;
+    total->ru_utime.tv_sec += total->ru_utime.tv_usec / 1000000;
+    total->ru_utime.tv_usec %= 1000000;
+    total->ru_stime.tv_sec += total->ru_stime.tv_usec / 1000000;
+    total->ru_stime.tv_usec %= 1000000;
+    if (usage->ru_maxrss > total->ru_maxrss) {
+        total->ru_maxrss = usage->ru_maxrss;
+    }
+    total->ru_nvcsw += usage->ru_nvcsw;
+    total->ru_nivcsw += usage->ru_nivcsw;
+    total->ru_inblock += usage->ru_inblock;
+    total->ru_oublock += usage->ru_oublock;
+}
+
+// 进程已结束：记录退出状态，关闭 pidfd，最后一个进程结束时作业完成
+// 参数：when - 结束时间，NULL 表示现在
+static void proc_finish(Job *job, JobProcess *proc, int status, const struct timespec *when) {
+    proc->done = true;
+    proc->status = status;
+    if (proc->pidfd >= 0) {
+        close(proc->pidfd);
+        proc->pidfd = -1;
+    }
+    if (--job->live == 0) {
+        job->status = JOB_DONE;
+        if (when != NULL) {
+            job->finished = *when;
+        } else {
+            clock_gettime(CLOCK_MONOTONIC, &job->finished);
+        }
+    }
+}
+
+// 用 wait4 回收作业中的一个进程并更新作业状态
+// 参数：options - 0 表示阻塞等待，WNOHANG 表示不阻塞
+//       when    - 进程的结束时间，NULL 表示现在
+// 返回：1=进程状态有变化，0=没有变化
+static int proc_reap(Job *job, JobProcess *proc, int options, const struct timespec *when) {
+    int status;
+    struct rusage usage;
+    pid_t result;
+    do {
+        result = wait4(proc->pid, &status, options | WUNTRACED | WCONTINUED, &usage);
+    } while (result < 0 && errno == EINTR);
+    
+    if (result == proc->pid) {
+        if (WIFSTOPPED(status)) {
+            job->status = JOB_STOPPED;
+        } else if (WIFCONTINUED(status)) {
+            job->status = JOB_RUNNING;
+        } else {
+            usage_add(&job->usage, &usage);
+            proc_finish(job, proc, job_exit_status(status), when);
+        }
+        return 1;
+    }
+    if (result < 0) {
+        proc_finish(job, proc, 0, when);        // 已被别处回收：状态未知，按成功处理
+        return 1;
+    }
+    return 0;
+}
+
+// 逐个检查作业中还没有结束的进程（不阻塞）
+static void job_update(Job *job, const struct timespec *when) {
+    for (int i = 0; i < job->proc_count; i++) {
+        if (!job->procs[i].done) {
+            proc_reap(job, &job->procs[i], WNOHANG, when);
         }
     }
-    return count;
 }
 
 // 更新所有作业状态
+// 说明：没有收到过 SIGCHLD 时子进程状态不会变化，直接返回；
+//       先清除标志再检查，检查期间到达的 SIGCHLD 留给下一次
+//       用 waitid(WNOWAIT) 查看下一个有变化的子进程（不回收），在哈希表中找到它所属的作业再回收，
+//       只处理有变化的进程；遇到不属于作业的子进程（由别处负责等待）时才退回逐个检查
+//       作业的结束时间取最近一次 SIGCHLD 的时间（进程可能早就结束了，只是现在才回收）
 void job_update_status(void) {
-    for (int i = 0; i < MAX_JOBS; i++) {
-        if (g_jobs[i].pid != 0 && g_jobs[i].status != JOB_DONE) {
-            int status;
-            pid_t result = waitpid(g_jobs[i].pid, &status, WNOHANG | WUNTRACED | WCONTINUED);
-            
-            if (result == g_jobs[i].pid) {
-                if (WIFEXITED(status) || WIFSIGNALED(status)) {
-                    g_jobs[i].status = JOB_DONE;
-                } else if (WIFSTOPPED(status)) {
-                    g_jobs[i].status = JOB_STOPPED;
-                } else if (WIFCONTINUED(status)) {
-                    g_jobs[i].status = JOB_RUNNING;
+    if (!g_sigchld_received) {
+        return;
+    }
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &block, &old);
+    g_sigchld_received = 0;
+    struct timespec when = g_sigchld_time;
+    sigprocmask(SIG_SETMASK, &old, NULL);
+    
+    for (;;) {
+        siginfo_t info;
+        info.si_pid = 0;
+        if (waitid(P_ALL, 0, &info, WEXITED | WSTOPPED | WCONTINUED | WNOHANG | WNOWAIT) != 0 ||
+            info.si_pid == 0) {
+            return;                             // 没有子进程状态变化
+        }
+        PidEntry *entry = pid_table_find(info.si_pid);
+        if (entry == NULL || entry->proc->done) {
+            break;
+        }
+        if (!proc_reap(entry->job, entry->proc, WNOHANG, &when)) {
+            return;
+        }
+    }
+    
+    for (int i = 0; i < g_job_count; i++) {
+        if (g_jobs[i]->status != JOB_DONE) {
+            job_update(g_jobs[i], &when);
+        }
+    }
+}
+
+// 阻塞等待作业：所有进程结束，或其中一个停止
+bool job_wait(Job *job) {
+    for (int i = 0; i < job->proc_count; i++) {
+        JobProcess *proc = &job->procs[i];
+        while (!proc->done) {
+            proc_reap(job, proc, 0, NULL);
+            if (job->status == JOB_STOPPED) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// 阻塞等待一个子进程结束并回收
+static int wait_child(pid_t pid) {
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return 0;                                   // 已被回收：状态未知，按成功处理
+        }
+    }
+    return job_exit_status(status);
+}
+
+// poll 中的一项：前台进程（index >= 0）或后台作业的进程
+typedef struct {
+    int index;                                          // 前台进程在 pids 中的位置，-1 表示后台
+    Job *job;                                           // 后台进程所属的作业
+    JobProcess *proc;                                   // 后台进程
+} WaitEntry;
+
+// 等待前台子进程全部结束
+void job_wait_foreground(const pid_t *pids, int count, int *statuses) {
+    int capacity = count;
+    for (int i = 0; i < g_job_count; i++) {
+        capacity += g_jobs[i]->live;
+    }
+    struct pollfd *fds = malloc((size_t)capacity * sizeof(struct pollfd));
+    WaitEntry *entries = malloc((size_t)capacity * sizeof(WaitEntry));
+    
+    // 前台进程：打开 pidfd（任何一个失败就退回按顺序 waitpid）
+    int n = 0;
+    int remaining = 0;
+    int use_poll = (fds != NULL && entries != NULL);
+    for (int i = 0; i < count; i++) {
+        statuses[i] = 0;
+        if (pids[i] <= 0 || !use_poll) {
+            continue;
+        }
+        int fd = open_pidfd(pids[i]);
+        if (fd < 0) {
+            use_poll = 0;
+            continue;
+        }
+        fds[n] = (struct pollfd){ fd, POLLIN, 0 };
+        entries[n++] = (WaitEntry){ i, NULL, NULL };
+        remaining++;
+    }
+    
+    if (use_poll) {
+        // 后台作业中还在运行的进程：结束时顺便回收
+        for (int i = 0; i < g_job_count; i++) {
+            for (int j = 0; j < g_jobs[i]->proc_count; j++) {
+                JobProcess *proc = &g_jobs[i]->procs[j];
+                if (!proc->done && proc->pidfd >= 0) {
+                    fds[n] = (struct pollfd){ proc->pidfd, POLLIN, 0 };
+                    entries[n++] = (WaitEntry){ -1, g_jobs[i], proc };
+                }
+            }
+        }
+        
+        while (remaining > 0) {
+            if (poll(fds, (nfds_t)n, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;                           // Ctrl+C 等信号：子进程同样收到，继续等待
+                }
+                break;
+            }
+            for (int k = 0; k < n; k++) {
+                if (fds[k].fd < 0 || fds[k].revents == 0) {
+                    continue;
                 }
-            } else if (result == -1) {
-                // 进程不存在了
-                g_jobs[i].status = JOB_DONE;
+                if (entries[k].index >= 0) {
+                    statuses[entries[k].index] = wait_child(pids[entries[k].index]);
+                    close(fds[k].fd);
+                    remaining--;
+                } else {
+                    proc_reap(entries[k].job, entries[k].proc, WNOHANG, NULL);   // 结束后关闭它的 pidfd
+                }
+                fds[k].fd = -1;                         // 负数的描述符 poll 会跳过
+            }
+        }
+    }
+    
+    // 剩下的前台进程（没有 pidfd 或 poll 出错）：按顺序等待
+    for (int k = 0; k < n; k++) {
+        if (entries[k].index >= 0 && fds[k].fd >= 0) {
+            if (use_poll) {
+                statuses[entries[k].index] = wait_child(pids[entries[k].index]);
             }
+            close(fds[k].fd);
         }
     }
+    if (!use_poll) {
+        for (int i = 0; i < count; i++) {
+            if (pids[i] > 0) {
+                statuses[i] = wait_child(pids[i]);
+            }
+        }
+    }
+    free(fds);
+    free(entries);
 }
 
 // 获取状态字符串
@@ -132,52 +541,95 @@ static const char* job_status_color(JobStatus status) {
     }
 }
 
+// 作业已运行的时间（秒）：结束的作业到结束为止
+static double job_wall_seconds(const Job *job) {
+    struct timespec end = job->finished;
+    if (job->status != JOB_DONE) {
+        clock_gettime(CLOCK_MONOTONIC, &end);
+    }
+    return (double)(end.tv_sec - job->started.tv_sec) +
+           (double)(end.tv_nsec - job->started.tv_nsec) / 1e9;
+}
+
+// 把 KB 格式化为易读的大小（如 "824 KB"、"12.5 MB"）
+static void format_kb(long kb, char *buffer, size_t size) {
+    if (kb >= 1024) {
+        snprintf(buffer, size, "%.1f MB", (double)kb / 1024.0);
+    } else {
+        snprintf(buffer, size, "%ld KB", kb);
+    }
+}
+
+// 打印作业的进程号和资源使用（xjobs -l）
+// 说明：CPU 时间、内存等只统计已经结束的进程（运行中的进程回收后才能得到）
+static void job_print_usage(const Job *job) {
+    const struct rusage *usage = &job->usage;
+    char rss[32];
+    format_kb(usage->ru_maxrss, rss, sizeof(rss));
+    
+    printf("      pgid %d  pids", (int)job->pgid);
+    for (int i = 0; i < job->proc_count; i++) {
+        printf(" %d", (int)job->procs[i].pid);
+    }
+    printf("\n");
+    printf("      user %ld.%02lds  sys %ld.%02lds  wall %.2fs  maxrss %s\n",
+           (long)usage->ru_utime.tv_sec, (long)usage->ru_utime.tv_usec / 10000,
+           (long)usage->ru_stime.tv_sec, (long)usage->ru_stime.tv_usec / 10000,
+           job_wall_seconds(job), rss);
+    printf("      ctxsw %ld voluntary / %ld involuntary  io %ld in / %ld out blocks\n",
+           usage->ru_nvcsw, usage->ru_nivcsw, usage->ru_inblock, usage->ru_oublock);
+}
+
 // 打印所有作业
-void job_print_all(void) {
+void job_print_all(bool verbose) {
     job_update_status();
     
-    int printed = 0;
-    for (int i = 0; i < MAX_JOBS; i++) {
-        if (g_jobs[i].pid != 0) {
-            printf("[%d] %s%-8s%s  %s%s%s &\n",
-                   g_jobs[i].id,
-                   job_status_color(g_jobs[i].status),
-                   job_status_str(g_jobs[i].status),
-                   C_RESET,
-                   C_BOLD,
-                   g_jobs[i].command,
-                   C_RESET);
-            printed++;
-            
-            // 如果已完成且未通知，标记为已通知
-            if (g_jobs[i].status == JOB_DONE) {
-                g_jobs[i].notified = true;
-            }
+    for (int i = 0; i < g_job_count; i++) {
+        Job *job = g_jobs[i];
+        printf("[%d] %s%-8s%s  %s%s%s &\n",
+               job->id,
+               job_status_color(job->status),
+               job_status_str(job->status),
+               C_RESET,
+               C_BOLD,
+               job->command,
+               C_RESET);
+        if (verbose) {
+            job_print_usage(job);
+        }
+        
+        // 如果已完成且未通知，标记为已通知
+        if (job->status == JOB_DONE) {
+            job->notified = true;
         }
     }
     
-    if (printed == 0) {
+    if (g_job_count == 0) {
         printf("当前没有后台任务。\n");
     }
 }
 
 // 清理已完成的作业
 void job_cleanup_done(void) {
-    for (int i = 0; i < MAX_JOBS; i++) {
-        if (g_jobs[i].pid != 0 && g_jobs[i].status == JOB_DONE && g_jobs[i].notified) {
-            memset(&g_jobs[i], 0, sizeof(Job));
+    for (int i = g_job_count - 1; i >= 0; i--) {
+        if (g_jobs[i]->status == JOB_DONE && g_jobs[i]->notified) {
+            job_delete_at(i);
         }
     }
 }
 
-// 检查并报告已完成的作业
+// 检查并报告已完成的作业（附带运行时间和最大内存）
 void job_check_done(void) {
     job_update_status();
     
-    for (int i = 0; i < MAX_JOBS; i++) {
-        if (g_jobs[i].pid != 0 && g_jobs[i].status == JOB_DONE && !g_jobs[i].notified) {
-            printf("\n[%d]  Done                    %s\n", g_jobs[i].id, g_jobs[i].command);
-            g_jobs[i].notified = true;
+    for (int i = 0; i < g_job_count; i++) {
+        Job *job = g_jobs[i];
+        if (job->status == JOB_DONE && !job->notified) {
+            char rss[32];
+            format_kb(job->usage.ru_maxrss, rss, sizeof(rss));
+            printf("\n[%d]  Done                    %s  (%.2fs, %s)\n",
+                   job->id, job->command, job_wall_seconds(job), rss);
+            job->notified = true;
         }
     }
     
@@ -185,23 +637,12 @@ void job_check_done(void) {
 }
 
 // 信号处理器
+// 说明：只设置标志。回收子进程、修改作业列表都在主循环中进行
+//       （job_update_status / job_wait_foreground），信号处理器中不访问作业列表
 void job_sigchld_handler(int sig) {
     (void)sig;
+    clock_gettime(CLOCK_MONOTONIC, &g_sigchld_time);   // 异步信号安全
     g_sigchld_received = 1;
-    
-    // 收集所有已终止的子进程
-    pid_t pid;
-    int status;
-    while ((pid = waitpid(-1, &status, WNOHANG | WUNTRACED)) > 0) {
-        Job *job = job_get_by_pid(pid);
-        if (job) {
-            if (WIFEXITED(status) || WIFSIGNALED(status)) {
-                job->status = JOB_DONE;
-            } else if (WIFSTOPPED(status)) {
-                job->status = JOB_STOPPED;
-            }
-        }
-    }
 }
 
 // 全局变量：标记是否收到 SIGINT
@@ -239,7 +680,7 @@ void job_install_signal_handler(void) {
     // 安装 SIGCHLD 处理器（子进程状态变化）
     sa.sa_handler = job_sigchld_handler;
     sigemptyset(&sa.sa_mask);
-    sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sa.sa_flags = SA_RESTART;
     sigaction(SIGCHLD, &sa, NULL);
     
     // 安装 SIGINT 处理器（Ctrl+C）
@@ -0,0 +1,175 @@
+// 定义 POSIX 标准版本，启用 posix_spawn 等函数
+#define _POSIX_C_SOURCE 200809L
+
+// 引入自定义头文件
+#include "launcher.h"                       // 启动器函数声明
+
+// 引入标准库
+#include <spawn.h>                          // posix_spawn, file actions
+#include <signal.h>                         // sigset_t, sigaction
+#include <stdio.h>                          // perror
+#include <stdlib.h>                         // getenv, _exit
+#include <string.h>                         // strcmp
+#include <unistd.h>                         // fork, execve, dup2
+#include <errno.h>                          // errno
+
+extern char **environ;                      // 当前进程环境变量
+
+// 当前启动方式（默认 posix_spawn）
+static LaunchMode g_launch_mode = LAUNCH_SPAWN;
+
+// 子进程需要恢复为默认处理的信号
+// 说明：Shell 自己忽略或捕获了这些信号，外部命令不应继承这种设置
+static const int g_default_signals[] = {
+    SIGINT, SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU, SIGCHLD, SIGPIPE
+};
+
+#define DEFAULT_SIGNAL_COUNT (int)(sizeof(g_default_signals) / sizeof(g_default_signals[0]))
+
+// ============================================
+// 初始化启动器
+// ============================================
+void launcher_init(void) {
+    const char *mode = getenv("XSHELL_LAUNCHER");
+    if (mode != NULL && strcmp(mode, "fork") == 0) {
+        g_launch_mode = LAUNCH_FORK;
+    } else {
+        g_launch_mode = LAUNCH_SPAWN;
+    }
+}
+
+void launcher_set_mode(LaunchMode mode) {
+    g_launch_mode = mode;
+}
+
+LaunchMode launcher_get_mode(void) {
+    return g_launch_mode;
+}
+
+// ============================================
+// posix_spawn 路径
+// ============================================
+static pid_t launch_with_spawn(const char *path, char *const argv[], char *const envp[], const int fds[3],
+                               pid_t pgid) {
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t default_set, empty_set;
+    pid_t pid = -1;
+    int err;
+
+    if ((err = posix_spawn_file_actions_init(&actions)) != 0) {
+        errno = err;
+        return -1;
+    }
+    if ((err = posix_spawnattr_init(&attr)) != 0) {
+        posix_spawn_file_actions_destroy(&actions);
+        errno = err;
+        return -1;
+    }
+
+    // 步骤1：把 fds 安装到 0/1/2（重定向和管道都在这里完成）
+    for (int target = 0; target < 3 && err == 0; target++) {
+        if (fds != NULL && fds[target] >= 0 && fds[target] != target) {
+            err = posix_spawn_file_actions_adddup2(&actions, fds[target], target);
+        }
+    }
+
+    // 步骤2：恢复信号默认处理，清空信号屏蔽字
+    if (err == 0) {
+        sigemptyset(&default_set);
+        for (int i = 0; i < DEFAULT_SIGNAL_COUNT; i++) {
+            sigaddset(&default_set, g_default_signals[i]);
+        }
+        sigemptyset(&empty_set);
+        err = posix_spawnattr_setsigdefault(&attr, &default_set);
+    }
+    if (err == 0) {
+        err = posix_spawnattr_setsigmask(&attr, &empty_set);
+    }
+    short flags = POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK;
+    if (err == 0 && pgid >= 0) {
+        err = posix_spawnattr_setpgroup(&attr, pgid);
+        flags |= POSIX_SPAWN_SETPGROUP;
+    }
+    if (err == 0) {
+        err = posix_spawnattr_setflags(&attr, flags);
+    }
+
+    // 步骤3：启动（exec 失败时 posix_spawn 直接返回错误码）
+    if (err == 0) {
+        err = posix_spawn(&pid, path, &actions, &attr, argv, envp);
+    }
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (err != 0) {
+        errno = err;
+        return -1;
+    }
+    return pid;
+}
+
+// ============================================
+// fork + execve 路径（对照组）
+// ============================================
+static pid_t launch_with_fork(const char *path, char *const argv[], char *const envp[], const int fds[3],
+                              pid_t pgid) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;                         // 父进程（或 fork 失败返回 -1）
+    }
+
+    // 子进程：加入进程组
+    if (pgid >= 0) {
+        setpgid(0, pgid);
+    }
+
+    // 子进程：安装描述符
+    for (int target = 0; target < 3; target++) {
+        if (fds != NULL && fds[target] >= 0 && fds[target] != target) {
+            if (dup2(fds[target], target) < 0) {
+                perror("dup2");
+                _exit(1);
+            }
+        }
+    }
+
+    // 恢复信号默认处理
+    struct sigaction sa;
+    sa.sa_handler = SIG_DFL;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;
+    for (int i = 0; i < DEFAULT_SIGNAL_COUNT; i++) {
+        sigaction(g_default_signals[i], &sa, NULL);
+    }
+    sigset_t empty_set;
+    sigemptyset(&empty_set);
+    sigprocmask(SIG_SETMASK, &empty_set, NULL);
+
+    execve(path, argv, envp);
+    perror("execve");
+    _exit(1);
+}
+
+// ============================================
+// 启动外部程序
+// ============================================
+pid_t launch_process(const char *path, char *const argv[], char *const envp[], const int fds[3], pid_t pgid) {
+    if (path == NULL || argv == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (envp == NULL) {
+        envp = environ;
+    }
+
+    pid_t pid = (g_launch_mode == LAUNCH_FORK) ? launch_with_fork(path, argv, envp, fds, pgid)
+                                               : launch_with_spawn(path, argv, envp, fds, pgid);
+
+    // 父进程中也设置一次进程组：fork 路径下不必等子进程先运行（失败说明子进程已自己设置过）
+    if (pid > 0 && pgid >= 0) {
+        setpgid(pid, (pgid == 0) ? pid : pgid);
+    }
+    return pid;
+}
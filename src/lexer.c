@@ -0,0 +1,580 @@
+// 引入自定义头文件
+#include "lexer.h"                                  // 记号、单词结构体定义
+
+// 引入标准库
+#include <string.h>                                 // strlen, memcpy
+#include <ctype.h>                                  // isalpha, isalnum
+
+// 字符分类表：单词内的普通字符可以成段复制，不必逐个判断
+#define CH_PLAIN   0                                // 普通字符
+#define CH_END     1                                // 单词结束：空白、行尾和操作符
+#define CH_SPECIAL 2                                // 需要单独处理：引号、反斜杠、$、~、{、通配符、`
+
+static const unsigned char g_char_class[256] = {
+    ['\0'] = CH_END, [' '] = CH_END, ['\t'] = CH_END, ['\n'] = CH_END,
+    ['|'] = CH_END, ['&'] = CH_END, [';'] = CH_END, ['<'] = CH_END, ['>'] = CH_END,
+    ['\''] = CH_SPECIAL, ['"'] = CH_SPECIAL, ['\\'] = CH_SPECIAL,
+    ['$'] = CH_SPECIAL, ['~'] = CH_SPECIAL, ['{'] = CH_SPECIAL,
+    ['*'] = CH_SPECIAL, ['?'] = CH_SPECIAL, ['['] = CH_SPECIAL, ['`'] = CH_SPECIAL,
+};
+
+static int is_word_end(char c) {
+    return g_char_class[(unsigned char)c] == CH_END;
+}
+
+// 变量名字符
+static int is_name_start(char c) {
+    return isalpha((unsigned char)c) || c == '_';
+}
+
+static int is_name_char(char c) {
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+// ============================================
+// 单词构建
+// ============================================
+// 普通文本先拼到 lexer->scratch 中，遇到 $变量 / ~ 或单词结束时
+// 才复制成一个 WORD_LITERAL 部分，整行只扫描一遍
+typedef struct {
+    Lexer *lexer;
+    WordPart **tail;                                // 新部分的挂接位置
+    size_t len;                                     // scratch 中待输出的文本长度
+} WordBuilder;
+
+// 添加一个单词部分，返回 0=成功，-1=内存不足
+// 说明：文本紧跟在结构体后面，一次分配
+static int add_part(WordBuilder *wb, WordPartType type, const char *text, size_t len) {
+    WordPart *part = arena_alloc(wb->lexer->arena, sizeof(WordPart) + len + 1);
+    if (part == NULL) {
+        return -1;
+    }
+    part->type = type;
+    part->text = (char *)(part + 1);
+    memcpy(part->text, text, len);
+    part->text[len] = '\0';
+    part->slot = NULL;
+    part->subst = NULL;
+    part->next = NULL;
+    *wb->tail = part;
+    wb->tail = &part->next;
+    return 0;
+}
+
+// 把 scratch 中积累的文本输出为一个 WORD_LITERAL 部分
+static int flush_literal(WordBuilder *wb) {
+    if (wb->len == 0) {
+        return 0;
+    }
+    int ret = add_part(wb, WORD_LITERAL, wb->lexer->scratch, wb->len);
+    wb->len = 0;
+    return ret;
+}
+
+// 特殊参数：$?（上一条命令的退出状态）、$$（Shell 的进程号）
+static int is_special_param(char c) {
+    return c == '?' || c == '$';
+}
+
+// 解析 $NAME、${NAME} 或特殊参数（p 指向 $）
+// 返回：$ 之后的新位置；不是变量引用时返回 NULL（$ 按普通字符处理）
+static const char* lex_variable(WordBuilder *wb, const char *p) {
+    const char *name = p + 1;
+    const char *end;
+    const char *next;
+
+    if (*name == '{') {
+        name++;
+        end = name;
+        if (is_special_param(*end)) {
+            end++;
+        } else {
+            while (is_name_char(*end)) {
+                end++;
+            }
+        }
+        if (*end != '}' || end == name) {
+            return NULL;
+        }
+        next = end + 1;
+    } else if (is_special_param(*name)) {
+        end = name + 1;
+        next = end;
+    } else if (is_name_start(*name)) {
+        end = name;
+        while (is_name_char(*end)) {
+            end++;
+        }
+        next = end;
+    } else {
+        return NULL;
+    }
+
+    if (flush_literal(wb) != 0 || add_part(wb, WORD_VAR, name, end - name) != 0) {
+        wb->lexer->error = "out of memory";
+        return NULL;
+    }
+    return next;
+}
+
+// 查找 $( 对应的 )（p 指向 $( 之后）
+// 说明：跳过引号和转义中的括号，嵌套的 $(...) 和 (...) 按层数计数
+// 返回：) 的位置，没有找到返回 NULL
+static const char* find_subst_end(const char *p) {
+    int depth = 1;
+    for (; *p != '\0'; p++) {
+        if (*p == '\\' && p[1] != '\0') {
+            p++;
+        } else if (*p == '\'') {
+            p = strchr(p + 1, '\'');
+            if (p == NULL) {
+                return NULL;
+            }
+        } else if (*p == '"') {
+            for (p++; *p != '"'; p++) {
+                if (*p == '\0') {
+                    return NULL;
+                }
+                if (*p == '\\' && p[1] != '\0') {
+                    p++;
+                }
+            }
+        } else if (*p == '(') {
+            depth++;
+        } else if (*p == ')' && --depth == 0) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+// 解析命令替换 $(...) 或 `...`（p 指向 $ 或 `）
+// 说明：只记录括号中的命令文本，由语法分析器解析（见 parser.c）
+// 返回：替换之后的位置，出错返回 NULL（lexer->error 已设置）
+static const char* lex_subst(WordBuilder *wb, Word *word, const char *p, int quoted) {
+    Lexer *lexer = wb->lexer;
+    WordPartType type = quoted ? WORD_SUBST_QUOTED : WORD_SUBST;
+    const char *next;
+
+    if (flush_literal(wb) != 0) {
+        lexer->error = "out of memory";
+        return NULL;
+    }
+    if (*p == '$') {
+        const char *end = find_subst_end(p + 2);
+        if (end == NULL) {
+            lexer->error = "unterminated command substitution";
+            return NULL;
+        }
+        if (add_part(wb, type, p + 2, (size_t)(end - p - 2)) != 0) {
+            lexer->error = "out of memory";
+            return NULL;
+        }
+        next = end + 1;
+    } else {
+        // 反引号：其中的 \` \\ \$ 去掉反斜杠（借用 scratch 拼接文本）
+        size_t len = 0;
+        for (p++; *p != '`'; p++) {
+            if (*p == '\0') {
+                lexer->error = "unterminated command substitution";
+                return NULL;
+            }
+            if (*p == '\\' && (p[1] == '`' || p[1] == '\\' || p[1] == '$')) {
+                p++;
+            }
+            lexer->scratch[len++] = *p;
+        }
+        if (add_part(wb, type, lexer->scratch, len) != 0) {
+            lexer->error = "out of memory";
+            return NULL;
+        }
+        next = p + 1;
+    }
+    word->has_subst = 1;
+    return next;
+}
+
+// 创建一个空单词，内存不足时返回 NULL（lexer->error 已设置）
+static Word* new_word(Lexer *lexer) {
+    Word *word = arena_alloc(lexer->arena, sizeof(Word));
+    if (word == NULL) {
+        lexer->error = "out of memory";
+        return NULL;
+    }
+    word->parts = NULL;
+    word->quoted = 0;
+    word->has_brace = 0;
+    word->has_glob = 0;
+    word->has_subst = 0;
+    word->next = NULL;
+    return word;
+}
+
+// 读取一个单词（p 指向单词的第一个字符）
+// 返回：0=成功，-1=错误（lexer->error 已设置）
+static int lex_word(Lexer *lexer, Token *token) {
+    Word *word = new_word(lexer);
+    if (word == NULL) {
+        return -1;
+    }
+
+    WordBuilder wb = { lexer, &word->parts, 0 };
+    const char *p = lexer->p;
+    const char *start = p;
+
+    while (!is_word_end(*p)) {
+        // 连续的普通字符（最常见的情况）整段复制
+        const char *run = p;
+        while (g_char_class[(unsigned char)*p] == CH_PLAIN) {
+            p++;
+        }
+        if (p > run) {
+            memcpy(lexer->scratch + wb.len, run, p - run);
+            wb.len += p - run;
+            continue;
+        }
+
+        char c = *p;
+        if (c == '\'') {
+            // 单引号：直到下一个单引号，内容原样保留
+            const char *close = strchr(p + 1, '\'');
+            if (close == NULL) {
+                lexer->error = "unterminated quote";
+                return -1;
+            }
+            memcpy(lexer->scratch + wb.len, p + 1, close - p - 1);
+            wb.len += close - p - 1;
+            word->quoted = 1;
+            p = close + 1;
+        } else if (c == '"') {
+            // 双引号：展开变量，反斜杠只转义 $ " \ `
+            p++;
+            while (*p != '"') {
+                if (*p == '\0') {
+                    lexer->error = "unterminated quote";
+                    return -1;
+                }
+                if (*p == '\\' && (p[1] == '$' || p[1] == '"' || p[1] == '\\' || p[1] == '`')) {
+                    lexer->scratch[wb.len++] = p[1];
+                    p += 2;
+                } else if ((*p == '$' && p[1] == '(') || *p == '`') {
+                    p = lex_subst(&wb, word, p, 1);
+                    if (p == NULL) {
+                        return -1;
+                    }
+                } else if (*p == '$') {
+                    const char *next = lex_variable(&wb, p);
+                    if (next == NULL && lexer->error != NULL) {
+                        return -1;
+                    }
+                    if (next == NULL) {
+                        lexer->scratch[wb.len++] = *p++;
+                    } else {
+                        p = next;
+                    }
+                } else {
+                    lexer->scratch[wb.len++] = *p++;
+                }
+            }
+            word->quoted = 1;
+            p++;
+        } else if (c == '\\') {
+            // 引号外的反斜杠：下一个字符按普通字符处理
+            if (p[1] == '\0') {
+                lexer->scratch[wb.len++] = '\\';
+                p++;
+            } else {
+                lexer->scratch[wb.len++] = p[1];
+                p += 2;
+            }
+            word->quoted = 1;
+        } else if ((c == '$' && p[1] == '(') || c == '`') {
+            // 命令替换
+            p = lex_subst(&wb, word, p, 0);
+            if (p == NULL) {
+                return -1;
+            }
+        } else if (c == '$') {
+            const char *next = lex_variable(&wb, p);
+            if (next == NULL && lexer->error != NULL) {
+                return -1;
+            }
+            if (next == NULL) {
+                lexer->scratch[wb.len++] = *p++;
+            } else {
+                p = next;
+            }
+        } else if (c == '~' &&
+                   (p == start || p[-1] == '=' || p[-1] == ':') &&
+                   (p[1] == '/' || p[1] == ':' || is_word_end(p[1]))) {
+            // 波浪号展开：单词开头，或赋值 = 和路径列表 : 之后
+            if (flush_literal(&wb) != 0 || add_part(&wb, WORD_TILDE, "", 0) != 0) {
+                lexer->error = "out of memory";
+                return -1;
+            }
+            p++;
+        } else if (c == '*' || c == '?' || c == '[') {
+            // 通配符：单独作为一个部分，展开时与引号中的同样字符区分开
+            if (flush_literal(&wb) != 0 || add_part(&wb, WORD_GLOB, p, 1) != 0) {
+                lexer->error = "out of memory";
+                return -1;
+            }
+            word->has_glob = 1;
+            p++;
+        } else {
+            if (c == '{') {
+                word->has_brace = 1;
+            }
+            lexer->scratch[wb.len++] = c;
+            p++;
+        }
+    }
+
+    // 空字符串（如 ""）也要保留一个空文本部分
+    if (flush_literal(&wb) != 0 || (word->parts == NULL && add_part(&wb, WORD_LITERAL, "", 0) != 0)) {
+        lexer->error = "out of memory";
+        return -1;
+    }
+
+    lexer->p = p;
+    token->type = TOKEN_WORD;
+    token->word = word;
+    return 0;
+}
+
+// ============================================
+// 对外接口
+// ============================================
+int lexer_init(Lexer *lexer, const char *line, Arena *arena) {
+    lexer->p = line;
+    lexer->arena = arena;
+    lexer->error = NULL;
+    // 去掉引号和转义后的文本不会比原行更长，一个缓冲区即可容纳任何单词
+    lexer->scratch = arena_alloc(arena, strlen(line) + 1);
+    return (lexer->scratch != NULL) ? 0 : -1;
+}
+
+void lexer_next(Lexer *lexer, Token *token) {
+    const char *p = lexer->p;
+
+    token->word = NULL;
+    token->fd = -1;
+
+    // 跳过空白
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+
+    // 注释：单词开头的 # 直到行尾
+    if (*p == '#') {
+        while (*p != '\0' && *p != '\n') {
+            p++;
+        }
+    }
+
+    lexer->p = p + 1;                               // 单字符操作符的默认前进距离
+    switch (*p) {
+        case '\0':
+            lexer->p = p;
+            token->type = TOKEN_EOF;
+            return;
+        case '\n':
+        case ';':
+            token->type = TOKEN_SEMI;
+            return;
+        case '|':
+            if (p[1] == '|') {
+                lexer->p = p + 2;
+                token->type = TOKEN_OR_IF;
+            } else {
+                token->type = TOKEN_PIPE;
+            }
+            return;
+        case '&':
+            if (p[1] == '&') {
+                lexer->p = p + 2;
+                token->type = TOKEN_AND_IF;
+            } else {
+                token->type = TOKEN_AMP;
+            }
+            return;
+        case '<':
+            if (p[1] == '<' && p[2] == '<') {
+                lexer->p = p + 3;
+                token->type = TOKEN_TLESS;
+            } else if (p[1] == '<' && p[2] == '-') {
+                lexer->p = p + 3;
+                token->type = TOKEN_DLESSDASH;
+            } else if (p[1] == '<') {
+                lexer->p = p + 2;
+                token->type = TOKEN_DLESS;
+            } else {
+                token->type = TOKEN_LESS;
+            }
+            token->fd = 0;
+            return;
+        case '>':
+            if (p[1] == '>') {
+                lexer->p = p + 2;
+                token->type = TOKEN_DGREAT;
+            } else {
+                token->type = TOKEN_GREAT;
+            }
+            token->fd = 1;
+            return;
+        default:
+            break;
+    }
+
+    // 带文件描述符的重定向：0< 1> 2> 2>>（数字必须紧挨着操作符）
+    if (*p >= '0' && *p <= '2' && (p[1] == '<' || p[1] == '>')) {
+        int fd = *p - '0';
+        if (p[1] == '<') {
+            lexer->p = p + 2;
+            token->type = TOKEN_LESS;
+        } else if (p[2] == '>') {
+            lexer->p = p + 3;
+            token->type = TOKEN_DGREAT;
+        } else {
+            lexer->p = p + 2;
+            token->type = TOKEN_GREAT;
+        }
+        token->fd = fd;
+        return;
+    }
+
+    // 单词
+    lexer->p = p;
+    if (lex_word(lexer, token) != 0) {
+        token->type = TOKEN_ERROR;
+    }
+}
+
+// 把 here-document 的内容分解成单词部分（与双引号中相同，但 " 是普通字符）
+static int lex_heredoc_text(Lexer *lexer, Word *word, const char *p) {
+    WordBuilder wb = { lexer, &word->parts, 0 };
+    while (*p != '\0') {
+        if (*p == '\\' && p[1] == '\n') {
+            p += 2;                                 // 续行
+        } else if (*p == '\\' && (p[1] == '$' || p[1] == '\\' || p[1] == '`')) {
+            lexer->scratch[wb.len++] = p[1];
+            p += 2;
+        } else if ((*p == '$' && p[1] == '(') || *p == '`') {
+            p = lex_subst(&wb, word, p, 1);
+            if (p == NULL) {
+                return -1;
+            }
+        } else if (*p == '$') {
+            const char *next = lex_variable(&wb, p);
+            if (next == NULL && lexer->error != NULL) {
+                return -1;
+            }
+            if (next == NULL) {
+                lexer->scratch[wb.len++] = *p++;
+            } else {
+                p = next;
+            }
+        } else {
+            lexer->scratch[wb.len++] = *p++;
+        }
+    }
+    if (flush_literal(&wb) != 0 || (word->parts == NULL && add_part(&wb, WORD_LITERAL, "", 0) != 0)) {
+        lexer->error = "out of memory";
+        return -1;
+    }
+    return 0;
+}
+
+int lexer_read_heredoc(Lexer *lexer, const char *delim, int strip_tabs, int expand, Word **body) {
+    size_t delim_len = strlen(delim);
+    const char *p = lexer->p;
+    
+    // 第一遍：找到结束标记行，同时计算内容长度
+    size_t len = 0;
+    const char *after;                              // 结束标记行之后的位置
+    for (;;) {
+        if (*p == '\0') {
+            return 1;
+        }
+        const char *line = p;
+        while (strip_tabs && *line == '\t') {
+            line++;
+        }
+        const char *end = strchr(line, '\n');
+        size_t line_len = (end != NULL) ? (size_t)(end - line) : strlen(line);
+        if (line_len == delim_len && memcmp(line, delim, delim_len) == 0) {
+            after = line + line_len + (end != NULL);
+            break;
+        }
+        len += line_len + 1;                        // 每行都以换行结尾
+        if (end == NULL) {
+            return 1;
+        }
+        p = end + 1;
+    }
+    
+    // 第二遍：复制内容（<<- 去掉制表符）
+    char *text = arena_alloc(lexer->arena, len + 1);
+    if (text == NULL) {
+        lexer->error = "out of memory";
+        return -1;
+    }
+    size_t pos = 0;
+    for (const char *q = lexer->p; q < p; ) {
+        while (strip_tabs && *q == '\t') {
+            q++;
+        }
+        const char *nl = strchr(q, '\n');
+        memcpy(text + pos, q, (size_t)(nl - q) + 1);
+        pos += (size_t)(nl - q) + 1;
+        q = nl + 1;
+    }
+    text[pos] = '\0';
+    
+    Word *word = new_word(lexer);
+    if (word == NULL) {
+        return -1;
+    }
+    word->quoted = 1;                               // 空内容也是一个（空的）输入
+    if (expand) {
+        if (lex_heredoc_text(lexer, word, text) != 0) {
+            return -1;
+        }
+    } else {
+        WordBuilder wb = { lexer, &word->parts, 0 };
+        if (add_part(&wb, WORD_LITERAL, text, pos) != 0) {
+            lexer->error = "out of memory";
+            return -1;
+        }
+    }
+    
+    lexer->p = after;
+    *body = word;
+    return 0;
+}
+
+const char* token_name(TokenType type) {
+    switch (type) {
+        case TOKEN_EOF:    return "end of line";
+        case TOKEN_WORD:   return "word";
+        case TOKEN_PIPE:   return "|";
+        case TOKEN_AND_IF: return "&&";
+        case TOKEN_OR_IF:  return "||";
+        case TOKEN_SEMI:   return ";";
+        case TOKEN_AMP:    return "&";
+        case TOKEN_LESS:   return "<";
+        case TOKEN_GREAT:  return ">";
+        case TOKEN_DGREAT: return ">>";
+        case TOKEN_DLESS:  return "<<";
+        case TOKEN_DLESSDASH: return "<<-";
+        case TOKEN_TLESS:  return "<<<";
+        default:           return "?";
+    }
+}
+
+const char* word_literal(const Word *word) {
+    if (word->parts != NULL && word->parts->next == NULL && word->parts->type == WORD_LITERAL) {
+        return word->parts->text;
+    }
+    return NULL;
+}
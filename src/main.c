@@ -1,12 +1,54 @@
 #include "xshell.h"
 #include <stdio.h>
 
+// 打印命令行用法
+static void print_usage(const char *prog) {
+    fprintf(stderr, "用法: %s [-s] [-c 命令] [脚本文件]\n", prog);
+    fprintf(stderr, "  （无参数）   标准输入是终端时进入交互模式，否则逐行执行标准输入\n");
+    fprintf(stderr, "  -s           强制非交互模式，从标准输入读取命令\n");
+    fprintf(stderr, "  -c 命令      执行一条命令行后退出\n");
+    fprintf(stderr, "  脚本文件     逐行执行脚本文件后退出\n");
+}
+
+// 退出码：与子进程一样只取低 8 位，内部错误 -1 按一般错误 1 处理
+static int exit_code(int status) {
+    return (status < 0) ? 1 : (status & 0xFF);
+}
+
 // 程序入口函数
+// 用法：
+//   xshell                交互模式（标准输入不是终端时自动切换为非交互模式）
+//   xshell -s             非交互模式，从标准输入读取命令
+//   xshell -c 'cmds'      执行 cmds 后退出
+//   xshell script.xsh     执行脚本文件后退出
+// 非交互模式不显示欢迎信息和提示符，也不读写历史记录，退出码为最后一条命令的状态
 int main(int argc, char *argv[])
 {
-    // 因为这个不需要参数，所以将两个参数忽略
-    (void)argc;
-    (void)argv;
+    const char *command = NULL;             // -c 的命令行
+    const char *script = NULL;              // 脚本文件路径
+    int force_stdin = 0;                    // -s
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%s: -c: option requires an argument\n", argv[0]);
+                return 2;
+            }
+            command = argv[++i];
+        } else if (strcmp(argv[i], "-s") == 0) {
+            force_stdin = 1;
+        } else if (strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            fprintf(stderr, "%s: %s: invalid option\n", argv[0], argv[i]);
+            print_usage(argv[0]);
+            return 2;
+        } else {
+            script = argv[i];
+            break;                          // 后面的参数属于脚本
+        }
+    }
 
     // 初始化Shell上下文
     ShellContext ctx;
@@ -15,11 +57,27 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    // 进入交互模式（主循环）
-    shell_loop(&ctx);
+    int status;
+    if (command != NULL) {
+        // 执行一条命令行
+        ctx.interactive = 0;
+        execute_command_line(command, &ctx);
+        status = exit_code(ctx.last_exit_status);
+    } else if (script != NULL && !force_stdin) {
+        // 执行脚本文件
+        status = exit_code(shell_run_file(&ctx, script));
+    } else {
+        // 从标准输入读取（终端上进入交互模式）
+        if (force_stdin) {
+            ctx.interactive = 0;
+        }
+        shell_loop(&ctx);
+        status = ctx.interactive ? 0 : exit_code(ctx.last_exit_status);
+    }
+    fflush(stdout);
 
     // 清理资源
     cleanup_shell(&ctx);
 
-    return 0;
-}
\ No newline at end of file
+    return status;
+}
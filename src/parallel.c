@@ -0,0 +1,253 @@
+// 定义 POSIX 标准版本，启用 sigaction、mkstemp、ftruncate
+#define _POSIX_C_SOURCE 200809L
+
+// 引入自定义头文件
+#include "parallel.h"                       // 函数声明
+#include "executor.h"                       // execute_command
+#include "job.h"                            // job_sigint_received
+
+// 引入标准库
+#include <stdio.h>                          // perror, fflush
+#include <stdlib.h>                         // calloc, free, getenv
+#include <string.h>                         // snprintf
+#include <errno.h>                          // errno, EINTR
+#include <fcntl.h>                          // fcntl, FD_CLOEXEC
+#include <signal.h>                         // sigprocmask, sigsuspend, kill
+#include <unistd.h>                         // fork, read, write, lseek, ftruncate
+#include <sys/wait.h>                       // waitpid
+
+// 失败次数作为退出码时的上限（与 GNU parallel 类似）
+#define PARALLEL_MAX_FAILED 100
+
+// 创建一个临时文件（创建后立即删除，关闭时自动释放）
+// 返回：文件描述符，失败返回 -1
+static int open_temp_file(void) {
+    const char *dir = getenv("TMPDIR");
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/xshell-parallel-XXXXXX", (dir != NULL && *dir != '\0') ? dir : "/tmp");
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return -1;
+    }
+    unlink(path);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);             // 不传给循环体中启动的命令
+    return fd;
+}
+
+// 把临时文件的内容写到 target，然后清空，供下一次迭代使用
+static void flush_temp_file(int fd, int target) {
+    char buffer[8192];
+    ssize_t n;
+
+    lseek(fd, 0, SEEK_SET);
+    while ((n = read(fd, buffer, sizeof(buffer))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (ssize_t written = 0; written < n; ) {
+            ssize_t w = write(target, buffer + written, (size_t)(n - written));
+            if (w < 0 && errno == EINTR) {
+                continue;
+            }
+            if (w < 0) {
+                break;                          // 输出端已关闭：丢弃剩余输出
+            }
+            written += w;
+        }
+    }
+    if (ftruncate(fd, 0) != 0) {
+        perror("ftruncate");
+    }
+    lseek(fd, 0, SEEK_SET);
+}
+
+// 初始化工作进程池
+int parallel_init(ParallelPool *pool, int jobs) {
+    if (jobs <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = (cpus > 0) ? (int)cpus : 1;
+    }
+    if (jobs > PARALLEL_MAX_JOBS) {
+        jobs = PARALLEL_MAX_JOBS;
+    }
+
+    pool->slots = calloc((size_t)jobs, sizeof(ParallelSlot));
+    if (pool->slots == NULL) {
+        perror("calloc");
+        return -1;
+    }
+    pool->jobs = jobs;
+    pool->running = 0;
+    pool->failed = 0;
+    pool->cancelled = 0;
+    for (int i = 0; i < jobs; i++) {
+        pool->slots[i].out_fd = -1;
+        pool->slots[i].err_fd = -1;
+    }
+
+    job_sigint_received();                      // 丢弃之前残留的 Ctrl+C 标志
+    return 0;
+}
+
+// 工作进程结束：输出它的结果，记录退出状态
+static void finish_slot(ParallelPool *pool, ParallelSlot *slot, int wait_status) {
+    if (slot->captured) {
+        fflush(stdout);
+        flush_temp_file(slot->out_fd, STDOUT_FILENO);
+        flush_temp_file(slot->err_fd, STDERR_FILENO);
+    }
+
+    if (!WIFEXITED(wait_status) || WEXITSTATUS(wait_status) != 0) {
+        pool->failed++;
+    }
+    slot->pid = 0;
+    pool->running--;
+}
+
+// Ctrl+C：终止所有正在运行的工作进程（它们通常已经被终端的 SIGINT 结束）
+static void cancel_all(ParallelPool *pool) {
+    pool->cancelled = 1;
+    for (int i = 0; i < pool->jobs; i++) {
+        if (pool->slots[i].pid > 0) {
+            kill(pool->slots[i].pid, SIGTERM);
+        }
+    }
+}
+
+// 等待至少一个工作进程结束
+// 说明：先屏蔽 SIGCHLD 和 SIGINT 再检查，sigsuspend 原子地解除屏蔽并等待，
+//       检查之后、等待之前到达的信号不会丢失
+static void wait_any(ParallelPool *pool) {
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGCHLD);
+    sigaddset(&block, SIGINT);
+    sigprocmask(SIG_BLOCK, &block, &old);
+
+    for (;;) {
+        int finished = 0;
+        for (int i = 0; i < pool->jobs; i++) {
+            ParallelSlot *slot = &pool->slots[i];
+            int wait_status;
+            if (slot->pid > 0 && waitpid(slot->pid, &wait_status, WNOHANG) == slot->pid) {
+                finish_slot(pool, slot, wait_status);
+                finished = 1;
+            }
+        }
+        if (finished || pool->running == 0) {
+            break;
+        }
+        if (!pool->cancelled && job_sigint_received()) {
+            cancel_all(pool);
+        }
+        sigsuspend(&old);
+    }
+
+    sigprocmask(SIG_SETMASK, &old, NULL);
+    if (!pool->cancelled && job_sigint_received()) {
+        cancel_all(pool);
+    }
+}
+
+// 等待直到有空闲位置
+int parallel_wait_slot(ParallelPool *pool) {
+    while (!pool->cancelled && pool->running == pool->jobs) {
+        wait_any(pool);
+    }
+    return pool->cancelled ? -1 : 0;
+}
+
+// 找一个空闲位置（调用前已确认 running < jobs）
+static ParallelSlot* free_slot(ParallelPool *pool) {
+    for (int i = 0; i < pool->jobs; i++) {
+        if (pool->slots[i].pid == 0) {
+            return &pool->slots[i];
+        }
+    }
+    return NULL;
+}
+
+// 登记一个调用者启动的子进程
+void parallel_track(ParallelPool *pool, pid_t pid) {
+    ParallelSlot *slot = free_slot(pool);
+    slot->pid = pid;
+    slot->captured = 0;
+    pool->running++;
+}
+
+// 记录一次没有启动成功的执行
+void parallel_fail(ParallelPool *pool) {
+    pool->failed++;
+}
+
+// 启动一次迭代
+int parallel_submit(ParallelPool *pool, ForLoop *loop, const char *value, ShellContext *ctx) {
+    if (parallel_wait_slot(pool) != 0) {
+        return -1;
+    }
+
+    // 临时文件在第一次使用时创建，之后反复使用
+    ParallelSlot *slot = free_slot(pool);
+    if (slot->out_fd < 0 && (slot->out_fd = open_temp_file()) < 0) {
+        perror("parallel: mkstemp");
+        return -1;
+    }
+    if (slot->err_fd < 0 && (slot->err_fd = open_temp_file()) < 0) {
+        perror("parallel: mkstemp");
+        return -1;
+    }
+
+    fflush(stdout);                             // 避免缓冲区中的内容在子进程中再输出一次
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return -1;
+    }
+    if (pid == 0) {
+        // 工作进程：Ctrl+C 直接结束；输出写到临时文件
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = SIG_DFL;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGINT, &sa, NULL);
+        dup2(slot->out_fd, STDOUT_FILENO);
+        dup2(slot->err_fd, STDERR_FILENO);
+
+        loop->value = value;
+        int status = execute_command(loop->body, ctx);
+        fflush(stdout);
+        fflush(stderr);
+        _exit((status < 0) ? 1 : (status & 0xFF));
+    }
+
+    slot->pid = pid;
+    slot->captured = 1;
+    pool->running++;
+    return 0;
+}
+
+// 等待所有工作进程结束并释放资源
+int parallel_finish(ParallelPool *pool) {
+    while (pool->running > 0) {
+        wait_any(pool);
+    }
+    for (int i = 0; i < pool->jobs; i++) {
+        if (pool->slots[i].out_fd >= 0) {
+            close(pool->slots[i].out_fd);
+        }
+        if (pool->slots[i].err_fd >= 0) {
+            close(pool->slots[i].err_fd);
+        }
+    }
+    free(pool->slots);
+    pool->slots = NULL;
+
+    if (pool->cancelled) {
+        return 130;                             // 与 sh 相同：128 + SIGINT
+    }
+    return (pool->failed > PARALLEL_MAX_FAILED) ? PARALLEL_MAX_FAILED : pool->failed;
+}
@@ -1,583 +1,636 @@
-// 定义 POSIX 标准版本，启用strdup等函数
-#define _POSIX_C_SOURCE 200809L
-
 // 引入头文件
 #include "parser.h"                                 // Command 结构体定义，函数声明
-#include "utils.h"                                  // 工具函数（trim,is_empty_line等）
+#include "parallel.h"                               // PARALLEL_MAX_JOBS
 #include <stdio.h>                                  // 标准输入输出（perror）
 #include <stdlib.h>                                 // 内存管理
-#include <string.h>                                 // 字符串处理（strlen、strdup、strtok）
-#include <ctype.h>                                  // 字符类型（isspace等）
-#include <unistd.h>                                 // getenv
+#include <string.h>                                 // strlen, strcmp
+#include <ctype.h>                                  // isalpha, isalnum, isdigit
+#include <stdarg.h>                                 // va_list（错误信息）
 
-// 常量定义
-#define MAX_TOKENS 256                               // 单条命令最大token数量（防止数组越界）
+// ============================================
+// 语法分析（递归下降，每个语法规则一个函数）
+// ============================================
+// 语法：
+//   list      := and_or ((';' | '&') and_or)* [';' | '&']
+//   and_or    := pipeline (('&&' | '||') pipeline)*
+//   pipeline  := for_loop | command ('|' command)*
+//   for_loop  := 'for' ['-P' N] NAME 'in' WORD* ';' 'do' list 'done'
+//   command   := (WORD | redirect)+
+//   redirect  := ('<' | '>' | '>>' | '2>' | '2>>' | '<<' | '<<-' | '<<<') WORD
+//   单词中的命令替换 $(list) / `list` 在所在的循环作用域中解析
+//   << 的内容从所在行的下一行开始，读到换行记号时再读取（同一行可以有多个 <<）
+// 词法分析器按需产生记号，整行只扫描一遍
+// ============================================
 
-// 检查是否是重定向符号
-static int is_redirect(const char *token) {
-    return (strcmp(token, ">") == 0 || 
-            strcmp(token, ">>") == 0 || 
-            strcmp(token, "2>") == 0 ||
-            strcmp(token, "<") == 0);
-}
+// for 循环的变量作用域（嵌套循环时内层优先）
+typedef struct LoopScope {
+    ForLoop *loop;
+    struct LoopScope *outer;
+} LoopScope;
+
+// 已经读到 <<、等待读取内容的 here-document
+typedef struct {
+    Command *cmd;                                   // 所属命令（NULL 表示已被后面的输入重定向覆盖）
+    const char *delim;                              // 结束标记
+    int strip_tabs;                                 // <<-
+    int expand;                                     // 结束标记没有加引号：展开内容
+    LoopScope *scope;                               // << 所在的循环作用域
+} PendingHeredoc;
+
+// 一行中最多的 here-document 数
+#define MAX_PENDING_HEREDOCS 16
 
-// 检查是否是管道符号
-static int is_pipe(const char *token) {
-    return strcmp(token, "|") == 0;
+// 语法分析器状态
+typedef struct {
+    Lexer lexer;
+    Token tok;                                      // 当前（向前看一个）记号
+    Arena *arena;
+    int error;                                      // 是否已报告过错误
+    int quiet;                                      // 不输出错误信息（parse_is_incomplete 使用）
+    char *error_buf;                                // 非 NULL 时错误信息写到这里而不是 stderr
+    size_t error_size;
+    int incomplete;                                 // 错误原因是输入还没写完（PARSE_MORE_*）
+    int loop_depth;                                 // 正在解析的 for 循环层数
+    LoopScope *scope;                               // 当前所在循环体的变量作用域
+    PendingHeredoc heredocs[MAX_PENDING_HEREDOCS];  // 本行中等待读取内容的 here-document
+    int heredoc_count;
+} Parser;
+
+static Command* parse_list(Parser *ps);
+static void read_heredocs(Parser *ps);
+
+// 读取下一个记号
+// 说明：读到换行（或输入结束）时，先读取本行 << 的内容
+static void advance(Parser *ps) {
+    lexer_next(&ps->lexer, &ps->tok);
+    if (ps->heredoc_count > 0 &&
+        (ps->tok.type == TOKEN_EOF || (ps->tok.type == TOKEN_SEMI && ps->lexer.p[-1] == '\n'))) {
+        read_heredocs(ps);
+    }
 }
 
-// 将重定向符号转换为类型
-static RedirectType get_redirect_type(const char *token) {
-    if (strcmp(token, ">") == 0) return REDIRECT_OUT;
-    if (strcmp(token, ">>") == 0) return REDIRECT_APPEND;
-    if (strcmp(token, "2>") == 0) return REDIRECT_ERR;
-    if (strcmp(token, "<") == 0) return REDIRECT_IN;
-    return REDIRECT_NONE;
+// 输出错误信息：默认写到 stderr，设置了 error_buf 时保存下来由调用者报告
+static void report_error(Parser *ps, const char *format, ...) {
+    if (ps->quiet) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    if (ps->error_buf != NULL) {
+        vsnprintf(ps->error_buf, ps->error_size, format, args);
+    } else {
+        vfprintf(stderr, format, args);
+        fputc('\n', stderr);
+    }
+    va_end(args);
 }
 
-// 跳过空白字符
-static char* skip_whitespace(char *p) {
-    while (*p == ' ' || *p == '\t') {
-        p++;
+// 报告语法错误（只报告第一个）
+static void syntax_error(Parser *ps) {
+    if (ps->error) {
+        return;
+    }
+    ps->error = 1;
+    ps->incomplete = (ps->tok.type == TOKEN_EOF && ps->loop_depth > 0) ? PARSE_MORE_LOOP : PARSE_COMPLETE;
+    if (ps->tok.type == TOKEN_ERROR) {
+        report_error(ps, "parse error: %s", ps->lexer.error);
+    } else if (ps->tok.type == TOKEN_WORD && word_literal(ps->tok.word) != NULL) {
+        report_error(ps, "parse error near `%s'", word_literal(ps->tok.word));
+    } else {
+        report_error(ps, "parse error near `%s'", token_name(ps->tok.type));
     }
-    return p;
 }
 
-// 变量展开函数
-static char* expand_variables(const char *input) {
-    if (input == NULL) {
-        return NULL;
+// 判断当前记号是否是关键字（未加引号的单词，如 for / do / done）
+static int at_keyword(Parser *ps, const char *keyword) {
+    if (ps->tok.type != TOKEN_WORD || ps->tok.word->quoted) {
+        return 0;
     }
-    
-    size_t input_len = strlen(input);
-    size_t output_capacity = input_len * 2; // 初始容量
-    char *output = malloc(output_capacity);
-    if (output == NULL) {
-        return NULL;
+    const char *text = word_literal(ps->tok.word);
+    return text != NULL && strcmp(text, keyword) == 0;
+}
+
+// 把单词中对循环变量的引用绑定到所在循环（$NAME -> 循环变量的当前值）
+static void bind_loop_vars(Parser *ps, Word *word) {
+    if (ps->scope == NULL) {
+        return;
     }
-    
-    size_t output_pos = 0;
-    const char *p = input;
-    
-    // 检查是否是 VAR="value" 格式，如果是，去除引号
-    char *equals = strchr(input, '=');
-    if (equals != NULL) {
-        // 检查等号后是否有引号包围
-        const char *after_equals = equals + 1;
-        size_t value_len = strlen(after_equals);
-        if (value_len >= 2 && 
-            ((after_equals[0] == '"' && after_equals[value_len-1] == '"') ||
-             (after_equals[0] == '\'' && after_equals[value_len-1] == '\''))) {
-            // 创建去掉引号的版本
-            size_t new_len = input_len - 2; // 去掉两个引号
-            char *unquoted_input = malloc(new_len + 1);
-            if (unquoted_input != NULL) {
-                // 复制 VAR= 部分
-                size_t prefix_len = equals - input + 1;
-                strncpy(unquoted_input, input, prefix_len);
-                // 复制去掉引号的值部分
-                strncpy(unquoted_input + prefix_len, after_equals + 1, value_len - 2);
-                unquoted_input[new_len] = '\0';
-                
-                // 递归处理去掉引号的版本
-                char *result = expand_variables(unquoted_input);
-                free(unquoted_input);
-                free(output);
-                return result;
+    for (WordPart *part = word->parts; part != NULL; part = part->next) {
+        if (part->type != WORD_VAR) {
+            continue;
+        }
+        for (LoopScope *scope = ps->scope; scope != NULL; scope = scope->outer) {
+            if (strcmp(part->text, scope->loop->var_name) == 0) {
+                part->type = WORD_SLOT;
+                part->slot = &scope->loop->value;
+                break;
             }
         }
     }
-    
-    while (*p != '\0') {
-        if (*p == '$' && (isalnum(p[1]) || p[1] == '_')) {
-            // 找到变量名
-            p++; // 跳过 $
-            const char *var_start = p;
-            while (isalnum(*p) || *p == '_') {
-                p++;
-            }
-            
-            // 提取变量名
-            size_t var_len = p - var_start;
-            char *var_name = malloc(var_len + 1);
-            if (var_name == NULL) {
-                free(output);
-                return NULL;
-            }
-            strncpy(var_name, var_start, var_len);
-            var_name[var_len] = '\0';
-            
-            // 获取环境变量值
-            const char *var_value = getenv(var_name);
-            if (var_value == NULL) {
-                var_value = ""; // 未定义的变量展开为空字符串
-            }
-            
-            // Debug: 记录变量展开信息
-            // fprintf(stderr, "DEBUG: Expanding $%s to '%s'\n", var_name, var_value);
-            
-            // 确保输出缓冲区足够大
-            size_t var_value_len = strlen(var_value);
-            while (output_pos + var_value_len >= output_capacity) {
-                output_capacity *= 2;
-                char *new_output = realloc(output, output_capacity);
-                if (new_output == NULL) {
-                    free(var_name);
-                    free(output);
-                    return NULL;
-                }
-                output = new_output;
-            }
-            
-            // 复制变量值到输出
-            strcpy(output + output_pos, var_value);
-            output_pos += var_value_len;
-            
-            free(var_name);
-        } else if (*p == '~' && (p == input || p[-1] == ':' || p[-1] == '=' || isspace(p[-1]) || p[-1] == '"' || p[-1] == '\'')) {
-            // 波浪号展开（在字符串开头或在 : = 空格后）
-            const char *home_dir = getenv("HOME");
-            if (home_dir == NULL) {
-                home_dir = "/tmp"; // 默认目录
-            }
-            
-            // 确保输出缓冲区足够大
-            size_t home_len = strlen(home_dir);
-            while (output_pos + home_len >= output_capacity) {
-                output_capacity *= 2;
-                char *new_output = realloc(output, output_capacity);
-                if (new_output == NULL) {
-                    free(output);
-                    return NULL;
-                }
-                output = new_output;
-            }
-            
-            // 复制主目录路径
-            strcpy(output + output_pos, home_dir);
-            output_pos += home_len;
-            p++; // 跳过 ~
-        } else {
-            // 普通字符，直接复制
-            if (output_pos + 1 >= output_capacity) {
-                output_capacity *= 2;
-                char *new_output = realloc(output, output_capacity);
-                if (new_output == NULL) {
-                    free(output);
-                    return NULL;
-                }
-                output = new_output;
+}
+
+// 解析单词中的命令替换 $(...)（在当前循环作用域中解析，其中的循环变量同样被绑定）
+// 返回：0=成功，-1=语法错误（已报告）
+static int parse_substitutions(Parser *ps, Word *word) {
+    if (!word->has_subst) {
+        return 0;
+    }
+    for (WordPart *part = word->parts; part != NULL; part = part->next) {
+        if (part->type != WORD_SUBST && part->type != WORD_SUBST_QUOTED) {
+            continue;
+        }
+        Parser sub;
+        memset(&sub, 0, sizeof(sub));
+        sub.arena = ps->arena;
+        sub.quiet = ps->quiet;
+        sub.error_buf = ps->error_buf;
+        sub.error_size = ps->error_size;
+        sub.scope = ps->scope;
+        if (lexer_init(&sub.lexer, part->text, ps->arena) != 0) {
+            perror("arena_alloc");
+            ps->error = 1;
+            return -1;
+        }
+        advance(&sub);
+        part->subst = parse_list(&sub);             // 空的 $() 为 NULL
+        if (!sub.error && sub.tok.type != TOKEN_EOF) {
+            syntax_error(&sub);
+        }
+        if (sub.error) {
+            ps->error = 1;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 处理刚读到的单词：绑定循环变量、解析命令替换
+// 返回：0=成功，-1=语法错误
+static int prepare_word(Parser *ps, Word *word) {
+    bind_loop_vars(ps, word);
+    return parse_substitutions(ps, word);
+}
+
+// 读取本行所有 here-document 的内容（按 << 出现的顺序）
+static void read_heredocs(Parser *ps) {
+    int count = ps->heredoc_count;
+    ps->heredoc_count = 0;
+    for (int i = 0; i < count; i++) {
+        PendingHeredoc *heredoc = &ps->heredocs[i];
+        Word *body;
+        int ret = lexer_read_heredoc(&ps->lexer, heredoc->delim, heredoc->strip_tabs, heredoc->expand, &body);
+        if (ret != 0) {
+            if (!ps->error && ret > 0) {
+                report_error(ps, "parse error: here-document `%s' is not terminated", heredoc->delim);
+                ps->incomplete = PARSE_MORE_HEREDOC;
+            } else if (!ps->error) {
+                report_error(ps, "parse error: %s", ps->lexer.error);
             }
-            output[output_pos++] = *p++;
+            ps->error = 1;
+            ps->lexer.p += strlen(ps->lexer.p);     // 不再解析后面的内容
+            return;
+        }
+        if (heredoc->cmd == NULL) {
+            continue;
         }
+        // 内容中的 $NAME 和命令替换属于 << 所在的循环作用域
+        LoopScope *scope = ps->scope;
+        ps->scope = heredoc->scope;
+        int failed = prepare_word(ps, body);
+        ps->scope = scope;
+        if (failed) {
+            ps->lexer.p += strlen(ps->lexer.p);
+            return;
+        }
+        heredoc->cmd->stdin_word = body;
     }
-    
-    output[output_pos] = '\0';
-    return output;
 }
 
-// 解析单个命令（不包含管道）
-static Command* parse_single_command(char *line_start, char *line_end) {
-    if (line_start >= line_end) {
-        return NULL;
+// 同一条命令后面的输入重定向覆盖前面的 here-document（与 sh 相同，最后一个生效）
+static void cancel_heredocs(Parser *ps, Command *cmd) {
+    for (int i = 0; i < ps->heredoc_count; i++) {
+        if (ps->heredocs[i].cmd == cmd) {
+            ps->heredocs[i].cmd = NULL;
+        }
     }
-    
-    // 分配Command对象
-    Command *cmd = (Command*)calloc(1, sizeof(Command));
-    if (cmd == NULL) {
-        perror("calloc");
-        return NULL;
+}
+
+// 记录一个 here-document，内容在本行结束后读取
+// 参数：delim_word - 结束标记（不展开；加了引号时内容也不展开）
+// 返回：0=成功，-1=失败
+static int add_heredoc(Parser *ps, Command *cmd, Word *delim_word, int strip_tabs) {
+    const char *delim = word_literal(delim_word);
+    if (delim == NULL || ps->heredoc_count == MAX_PENDING_HEREDOCS) {
+        if (!ps->error) {
+            report_error(ps, (delim == NULL) ? "parse error: bad here-document delimiter"
+                                             : "parse error: too many here-documents");
+        }
+        ps->error = 1;
+        return -1;
     }
-    
-    // 初始化
-    cmd->redirect_type = REDIRECT_NONE;
-    cmd->redirect_file = NULL;
-    cmd->pipe_next = NULL;
-    
-    // 初始化多重定向字段
-    cmd->stdout_file = NULL;
-    cmd->stderr_file = NULL;
-    cmd->stdin_file = NULL;
-    cmd->stdout_append = 0;
-    cmd->stderr_append = 0;
-    cmd->args = (char**)calloc(MAX_TOKENS, sizeof(char*));
-    if (cmd->args == NULL) {
-        perror("calloc");
-        free(cmd);
-        return NULL;
+    cancel_heredocs(ps, cmd);
+    PendingHeredoc *heredoc = &ps->heredocs[ps->heredoc_count++];
+    heredoc->cmd = cmd;
+    heredoc->delim = delim;
+    heredoc->strip_tabs = strip_tabs;
+    heredoc->expand = !delim_word->quoted;
+    heredoc->scope = ps->scope;
+    cmd->stdin_word = NULL;
+    cmd->stdin_here = HERE_DOC;
+    return 0;
+}
+
+// 判断记号是否是重定向操作符
+static int is_redirect(TokenType type) {
+    return type == TOKEN_LESS || type == TOKEN_GREAT || type == TOKEN_DGREAT ||
+           type == TOKEN_DLESS || type == TOKEN_DLESSDASH || type == TOKEN_TLESS;
+}
+
+// 解析一个重定向（当前记号是 < > >> << <<- <<<）
+// 返回：0=成功，-1=失败
+static int parse_redirect(Parser *ps, Command *cmd) {
+    TokenType type = ps->tok.type;
+    int fd = ps->tok.fd;
+    
+    advance(ps);
+    if (ps->tok.type != TOKEN_WORD) {
+        syntax_error(ps);
+        return -1;
     }
     
-    cmd->arg_count = 0;
+    if (type == TOKEN_DLESS || type == TOKEN_DLESSDASH) {
+        if (add_heredoc(ps, cmd, ps->tok.word, type == TOKEN_DLESSDASH) != 0) {
+            return -1;
+        }
+        advance(ps);
+        return 0;
+    }
+    if (prepare_word(ps, ps->tok.word) != 0) {
+        return -1;
+    }
+    if ((type == TOKEN_LESS && fd == 0) || type == TOKEN_TLESS) {
+        cancel_heredocs(ps, cmd);
+        cmd->stdin_word = ps->tok.word;
+        cmd->stdin_here = (type == TOKEN_TLESS) ? HERE_STRING : HERE_NONE;
+    } else if (type != TOKEN_LESS && fd == 1) {
+        cmd->stdout_word = ps->tok.word;
+        cmd->stdout_append = (type == TOKEN_DGREAT);
+    } else if (type != TOKEN_LESS && fd == 2) {
+        cmd->stderr_word = ps->tok.word;
+        cmd->stderr_append = (type == TOKEN_DGREAT);
+    } else {
+        if (!ps->error) {
+            report_error(ps, "parse error: unsupported redirection %d%s", fd, token_name(type));
+        }
+        ps->error = 1;
+        return -1;
+    }
     
-    // 复制字符串
-    size_t len = line_end - line_start;
-    char *line = (char*)malloc(len + 1);
-    if (line == NULL) {
-        perror("malloc");
-        free(cmd->args);
-        free(cmd);
+    advance(ps);
+    return 0;
+}
+
+// 解析简单命令：单词和重定向可以任意交错（如 > out.txt xecho hi）
+static Command* parse_simple_command(Parser *ps) {
+    // 分配Command对象（来自内存池，随整行命令一起释放）
+    Command *cmd = (Command*)arena_calloc(ps->arena, 1, sizeof(Command));
+    if (cmd == NULL) {
+        perror("arena_calloc");
+        ps->error = 1;
         return NULL;
     }
-    strncpy(line, line_start, len);
-    line[len] = '\0';
-    
-    // 手动解析（支持多字符重定向符号）
-    char *p = line;
-    p = skip_whitespace(p);
+    cmd->arena = ps->arena;
     
-    int expecting_redirect_file = 0;
-    RedirectType current_redirect = REDIRECT_NONE;
+    Word **tail = &cmd->words;
+    int redirect_count = 0;
     
-    while (*p != '\0' && cmd->arg_count < MAX_TOKENS - 1) {
-        p = skip_whitespace(p);
-        if (*p == '\0') break;
-        
-        // 检查重定向符号
-        if (strncmp(p, "2>>", 3) == 0) {
-            // 错误追加（虽然不常用，但支持）
-            current_redirect = REDIRECT_ERR;
-            expecting_redirect_file = 1;
-            p += 3;
-            continue;
-        } else if (strncmp(p, "2>", 2) == 0) {
-            current_redirect = REDIRECT_ERR;
-            expecting_redirect_file = 1;
-            p += 2;
-            continue;
-        } else if (strncmp(p, ">>", 2) == 0) {
-            current_redirect = REDIRECT_APPEND;
-            expecting_redirect_file = 1;
-            p += 2;
-            continue;
-        } else if (*p == '>') {
-            current_redirect = REDIRECT_OUT;
-            expecting_redirect_file = 1;
-            p += 1;
-            continue;
-        } else if (*p == '<') {
-            current_redirect = REDIRECT_IN;
-            expecting_redirect_file = 1;
-            p += 1;
-            continue;
-        }
-        
-        // 提取token（支持引号）
-        char *token_start = p;
-        char quote_char = 0;
-        
-        // 检查是否以引号开始
-        if (*p == '"' || *p == '\'') {
-            quote_char = *p;
-            p++; // 跳过开始引号
-            token_start = p; // 引号内容的开始
-            
-            // 找到匹配的结束引号
-            while (*p != '\0' && *p != quote_char) {
-                p++;
-            }
-            
-            if (*p == quote_char) {
-                // 找到了结束引号，不包含在 token 中
-                // p 指向结束引号，token_len 将是引号内容的长度
-            } else {
-                // 没有找到结束引号，将整个剩余部分作为 token
-            }
-        } else {
-            // 普通 token，按空格和特殊字符分割
-            while (*p != '\0' && *p != ' ' && *p != '\t' && 
-                   *p != '>' && *p != '<' && *p != '|') {
-                // 如果遇到引号，检查是否是 VAR="value" 格式
-                if (*p == '"' || *p == '\'') {
-                    // 检查是否在等号后面，如果是，则包含引号内容
-                    char *equals = strchr(token_start, '=');
-                    if (equals != NULL && p > equals) {
-                        // 这是 VAR="value" 格式，包含引号内容
-                        quote_char = *p;
-                        p++; // 跳过开始引号
-                        
-                        // 找到结束引号，包含在同一个token中
-                        while (*p != '\0' && *p != quote_char) {
-                            p++;
-                        }
-                        
-                        if (*p == quote_char) {
-                            p++; // 跳过结束引号
-                        }
-                    } else {
-                        // 普通情况，遇到引号就停止
-                        break;
-                    }
-                } else {
-                    // 检查是否是"2>"的一部分
-                    if (*p == '2' && (p[1] == '>' || (p[1] == '>' && p[2] == '>'))) {
-                        break;
-                    }
-                    p++;
-                }
-            }
-        }
-        
-        if (p > token_start || quote_char != 0) {
-            size_t token_len = p - token_start;
-            char *token = (char*)malloc(token_len + 1);
-            if (token == NULL) {
-                perror("malloc");
-                free(line);
-                free_command(cmd);
+    for (;;) {
+        if (ps->tok.type == TOKEN_WORD) {
+            if (prepare_word(ps, ps->tok.word) != 0) {
                 return NULL;
             }
-            strncpy(token, token_start, token_len);
-            token[token_len] = '\0';
-            
-            // 如果是引号 token，跳过结束引号
-            if (quote_char != 0 && *p == quote_char) {
-                p++;
-            }
-            
-            // 展开变量
-            char *expanded_token = expand_variables(token);
-            if (expanded_token != NULL) {
-                free(token);
-                token = expanded_token;
-            }
-            
-            if (expecting_redirect_file) {
-                // 这是重定向文件名，根据类型设置相应字段
-                switch (current_redirect) {
-                    case REDIRECT_OUT:
-                        cmd->stdout_file = token;
-                        cmd->stdout_append = 0;
-                        break;
-                    case REDIRECT_APPEND:
-                        cmd->stdout_file = token;
-                        cmd->stdout_append = 1;
-                        break;
-                    case REDIRECT_ERR:
-                        cmd->stderr_file = token;
-                        cmd->stderr_append = 0;
-                        break;
-                    case REDIRECT_IN:
-                        cmd->stdin_file = token;
-                        break;
-                    default:
-                        free(token);
-                        break;
-                }
-                
-                // 兼容性：设置第一个重定向为主重定向
-                if (cmd->redirect_type == REDIRECT_NONE) {
-                    cmd->redirect_type = current_redirect;
-                    cmd->redirect_file = token;
-                }
-                
-                expecting_redirect_file = 0;
-            } else {
-                // 这是命令参数
-                cmd->args[cmd->arg_count] = token;
-                cmd->arg_count++;
+            *tail = ps->tok.word;
+            tail = &ps->tok.word->next;
+            cmd->word_count++;
+            advance(ps);
+        } else if (is_redirect(ps->tok.type)) {
+            if (parse_redirect(ps, cmd) != 0) {
+                return NULL;
             }
+            redirect_count++;
+        } else {
+            break;
         }
     }
     
-    free(line);
-    
-    // 检查是否有未完成的重定向
-    if (expecting_redirect_file) {
-        fprintf(stderr, "parse error: missing redirect file\n");
-        free_command(cmd);
+    // 既没有单词也没有重定向：语法错误（如 "| xwc" 或 "a && && b"）
+    if (cmd->word_count == 0 && redirect_count == 0) {
+        syntax_error(ps);
         return NULL;
     }
-    
-    // 设置命令名
-    if (cmd->arg_count > 0) {
-        cmd->name = cmd->args[0];
-    } else {
-        cmd->name = NULL;
-    }
-    
-    // 参数数组以NULL结尾
-    cmd->args[cmd->arg_count] = NULL;
-    
-    // Debug: 打印解析结果
-    // fprintf(stderr, "DEBUG: Parsed command: '%s', args: %d, redirect: %d, file: '%s'\n", 
-    //         cmd->name ? cmd->name : "(null)", 
-    //         cmd->arg_count, 
-    //         cmd->redirect_type, 
-    //         cmd->redirect_file ? cmd->redirect_file : "(null)");
-    
     return cmd;
 }
 
-// 命令解析函数
-// 功能：将用户输入的命令行字符解析为 Command 结构体
-// 支持重定向和管道
-Command* parse_command(const char *line) {
-    // 步骤1：参数检查
-    if (line == NULL || strlen(line) == 0) {
-        return NULL;
+// 变量名：字母或下划线开头，由字母、数字、下划线组成
+static int is_valid_name(const char *name) {
+    if (name == NULL || !(isalpha((unsigned char)*name) || *name == '_')) {
+        return 0;
     }
-    
-    // 步骤2：处理注释并复制命令行字符串
-    char *line_copy = strdup(line);
-    if (line_copy == NULL) {
-        perror("strdup");
+    for (name++; *name != '\0'; name++) {
+        if (!(isalnum((unsigned char)*name) || *name == '_')) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// 判断当前记号是否是以 option 开头的未加引号的单词（如 -P、-P8）
+static int at_option(Parser *ps, const char *option) {
+    if (ps->tok.type != TOKEN_WORD || ps->tok.word->quoted) {
+        return 0;
+    }
+    const char *text = word_literal(ps->tok.word);
+    return text != NULL && strncmp(text, option, strlen(option)) == 0;
+}
+
+// 解析 -P 后面的进程数（0 ~ PARALLEL_MAX_JOBS 的整数）
+// 返回：0=成功，-1=不是合法的数字
+static int parse_jobs(const char *text, int *jobs) {
+    if (text == NULL || *text == '\0') {
+        return -1;
+    }
+    int value = 0;
+    for (const char *p = text; *p != '\0'; p++) {
+        if (!isdigit((unsigned char)*p)) {
+            return -1;
+        }
+        value = value * 10 + (*p - '0');
+        if (value > PARALLEL_MAX_JOBS) {
+            return -1;
+        }
+    }
+    *jobs = value;
+    return 0;
+}
+
+// 跳过分隔符（多行输入拼接成一行时，do 后面可能跟着 ;）
+static void skip_separators(Parser *ps) {
+    while (ps->tok.type == TOKEN_SEMI) {
+        advance(ps);
+    }
+}
+
+// 解析 for 循环（当前记号是 for）
+static Command* parse_for(Parser *ps) {
+    ForLoop *loop = arena_calloc(ps->arena, 1, sizeof(ForLoop));
+    Command *cmd = arena_calloc(ps->arena, 1, sizeof(Command));
+    if (loop == NULL || cmd == NULL) {
+        perror("arena_calloc");
+        ps->error = 1;
         return NULL;
     }
-    
-    // 移除注释：找到第一个不在引号内的 # 字符，截断字符串
-    char *comment_pos = NULL;
-    int in_single_quote = 0;
-    int in_double_quote = 0;
-    
-    for (char *p = line_copy; *p != '\0'; p++) {
-        if (*p == '\'' && !in_double_quote) {
-            in_single_quote = !in_single_quote;
-        } else if (*p == '"' && !in_single_quote) {
-            in_double_quote = !in_double_quote;
-        } else if (*p == '#' && !in_single_quote && !in_double_quote) {
-            comment_pos = p;
-            break;
+    cmd->arena = ps->arena;
+    cmd->loop = loop;
+    
+    ps->loop_depth++;
+    advance(ps);
+    
+    // 并行选项：-P N 或 -PN
+    if (at_option(ps, "-P")) {
+        const char *text = word_literal(ps->tok.word) + 2;
+        if (*text == '\0') {
+            advance(ps);
+            text = (ps->tok.type == TOKEN_WORD) ? word_literal(ps->tok.word) : NULL;
+        }
+        if (parse_jobs(text, &loop->jobs) != 0) {
+            syntax_error(ps);
+            return NULL;
         }
+        loop->parallel = 1;
+        advance(ps);
     }
     
-    // 如果找到注释，截断字符串
-    if (comment_pos != NULL) {
-        *comment_pos = '\0';
+    // 循环变量名
+    if (ps->tok.type != TOKEN_WORD || ps->tok.word->quoted || !is_valid_name(word_literal(ps->tok.word))) {
+        syntax_error(ps);
+        return NULL;
     }
+    loop->var_name = (char *)word_literal(ps->tok.word);
+    advance(ps);
     
-    // 如果处理注释后字符串为空或只有空白，返回NULL
-    char *trimmed = line_copy;
-    while (*trimmed == ' ' || *trimmed == '\t') {
-        trimmed++;
+    // in 后面的单词列表（直到 ; 或 do），其中的变量属于外层作用域
+    if (!at_keyword(ps, "in")) {
+        syntax_error(ps);
+        return NULL;
     }
-    if (*trimmed == '\0') {
-        free(line_copy);
+    advance(ps);
+    Word **tail = &loop->words;
+    while (ps->tok.type == TOKEN_WORD && !at_keyword(ps, "do")) {
+        if (prepare_word(ps, ps->tok.word) != 0) {
+            return NULL;
+        }
+        *tail = ps->tok.word;
+        tail = &ps->tok.word->next;
+        advance(ps);
+    }
+    skip_separators(ps);
+    if (!at_keyword(ps, "do")) {
+        syntax_error(ps);
         return NULL;
     }
-    
-    // 步骤3：检测后台执行符号 &
-    int run_background = 0;
-    size_t line_len = strlen(line_copy);
-    
-    // 从末尾向前找，跳过空白
-    char *end_ptr = line_copy + line_len - 1;
-    while (end_ptr > line_copy && (*end_ptr == ' ' || *end_ptr == '\t')) {
-        end_ptr--;
+    advance(ps);
+    skip_separators(ps);
+    
+    // 循环体：在本循环的作用域中解析，直到 done
+    // （作用域分配在内存池中：循环体里的 here-document 可能在 done 之后才读取内容）
+    LoopScope *scope = arena_alloc(ps->arena, sizeof(LoopScope));
+    if (scope == NULL) {
+        perror("arena_alloc");
+        ps->error = 1;
+        return NULL;
     }
-    
-    // 检查最后一个非空白字符是否是 &（但不是 &&）
-    if (end_ptr > line_copy && *end_ptr == '&' && *(end_ptr - 1) != '&') {
-        run_background = 1;
-        *end_ptr = '\0';  // 移除 &
-        // 再次修剪尾部空白
-        end_ptr--;
-        while (end_ptr > line_copy && (*end_ptr == ' ' || *end_ptr == '\t')) {
-            *end_ptr = '\0';
-            end_ptr--;
+    scope->loop = loop;
+    scope->outer = ps->scope;
+    ps->scope = scope;
+    loop->body = parse_list(ps);
+    ps->scope = scope->outer;
+    if (loop->body == NULL || !at_keyword(ps, "done")) {
+        syntax_error(ps);
+        return NULL;
+    }
+    advance(ps);
+    ps->loop_depth--;
+    return cmd;
+}
+
+// 解析管道：for_loop | command ('|' command)*
+static Command* parse_pipeline(Parser *ps) {
+    if (at_keyword(ps, "for")) {
+        Command *loop = parse_for(ps);
+        if (loop != NULL && ps->tok.type == TOKEN_PIPE) {
+            // for 循环不能作为管道的一部分
+            syntax_error(ps);
+            return NULL;
         }
+        return loop;
     }
     
-    // 步骤4：查找管道符号，分割命令链
-    char *pipe_pos = strchr(line_copy, '|');
+    Command *first = parse_simple_command(ps);
+    Command *prev = first;
     
-    if (pipe_pos == NULL) {
-        // 没有管道，解析单个命令
-        char *end = line_copy + strlen(line_copy);
-        Command *cmd = parse_single_command(line_copy, end);
-        if (cmd != NULL) {
-            cmd->background = run_background;
+    while (prev != NULL && ps->tok.type == TOKEN_PIPE) {
+        advance(ps);
+        Command *cmd = parse_simple_command(ps);
+        if (cmd == NULL) {
+            return NULL;
         }
-        free(line_copy);
-        return cmd;
-    } else {
-        // 有管道，需要解析命令链
-        Command *first_cmd = NULL;
-        Command *prev_cmd = NULL;
-        char *start = line_copy;
+        prev->pipe_next = cmd;
+        prev = cmd;
+    }
+    return first;
+}
+
+// 解析命令列表：把 && || ; & 连接的管道串成 chain_next 链表
+static Command* parse_list(Parser *ps) {
+    Command *first = NULL;
+    Command *prev = NULL;
+    
+    // 遇到 done 结束（循环体的结尾由 parse_for 检查，顶层的 done 是语法错误）
+    while (ps->tok.type != TOKEN_EOF && !at_keyword(ps, "done")) {
+        Command *pipeline = parse_pipeline(ps);
+        if (pipeline == NULL) {
+            return NULL;
+        }
+        if (first == NULL) {
+            first = pipeline;
+        } else {
+            prev->chain_next = pipeline;
+        }
+        prev = pipeline;
         
-        while (start != NULL) {
-            // 找到下一个管道符号或字符串结尾
-            char *pipe = strchr(start, '|');
-            char *end = (pipe != NULL) ? pipe : (start + strlen(start));
-            
-            // 解析当前命令
-            Command *cmd = parse_single_command(start, end);
-            if (cmd == NULL) {
-                // 解析失败，释放已解析的命令
-                if (first_cmd != NULL) {
-                    free_command(first_cmd);
+        // 管道后面的分隔符决定下一条管道的执行条件
+        switch (ps->tok.type) {
+            case TOKEN_AND_IF:
+            case TOKEN_OR_IF:
+                pipeline->chain_type = (ps->tok.type == TOKEN_AND_IF) ? CHAIN_AND : CHAIN_OR;
+                advance(ps);
+                // && 和 || 后面必须还有命令（允许换行）
+                while (ps->tok.type == TOKEN_SEMI && ps->lexer.p[-1] == '\n') {
+                    advance(ps);
                 }
-                free(line_copy);
-                return NULL;
-            }
-            
-            // 链接命令
-            if (first_cmd == NULL) {
-                first_cmd = cmd;
-            } else {
-                prev_cmd->pipe_next = cmd;
-            }
-            prev_cmd = cmd;
-            
-            // 移动到下一个命令
-            if (pipe != NULL) {
-                start = pipe + 1;
-                // 跳过空格
-                while (*start == ' ' || *start == '\t') {
-                    start++;
-                }
-                if (*start == '\0') {
-                    break;
+                if (ps->tok.type == TOKEN_EOF || at_keyword(ps, "done")) {
+                    syntax_error(ps);
+                    return NULL;
                 }
-            } else {
                 break;
-            }
+            case TOKEN_AMP:
+                pipeline->background = 1;
+                /* fall through */
+            case TOKEN_SEMI:
+                pipeline->chain_type = CHAIN_SEQ;
+                advance(ps);
+                break;
+            case TOKEN_EOF:
+                break;
+            default:
+                syntax_error(ps);
+                return NULL;
         }
-        
-        free(line_copy);
-        return first_cmd;
     }
+    
+    // 末尾的 ; 或 & 后面没有命令
+    if (prev != NULL && prev->chain_next == NULL) {
+        prev->chain_type = CHAIN_NONE;
+    }
+    return first;
 }
 
-// 内存释放函数
-// 功能：释放 Command 对象及其内部所有动态分配的内存
-// 注意：必须按照"从内到外" 的释放顺序，避免内存泄漏
-void free_command(Command *cmd) {
-    if (cmd == NULL) {
-        return;
+// 命令解析函数
+// 功能：将用户输入的命令行字符解析为 Command 语法树
+// 支持引号、重定向、管道和命令列表（&& || ; &）
+Command* parse_command(const char *line) {
+    if (line == NULL || strlen(line) == 0) {
+        return NULL;
     }
     
-    // 递归释放管道中的下一个命令
-    if (cmd->pipe_next != NULL) {
-        free_command(cmd->pipe_next);
+    // 创建本命令专用的内存池，free_command 时整体释放
+    Arena *arena = arena_create(0);
+    if (arena == NULL) {
+        perror("arena_create");
+        return NULL;
     }
     
-    // 释放重定向文件名
-    if (cmd->redirect_file != NULL) {
-        free(cmd->redirect_file);
+    Command *cmd = parse_command_arena(line, arena);
+    if (cmd == NULL) {
+        arena_destroy(arena);
+        return NULL;
+    }
+    cmd->owns_arena = 1;
+    return cmd;
+}
+
+// 在指定内存池中解析命令
+// 说明：所有内存（语法树、单词）都来自 arena，不需要 free_command
+Command* parse_command_arena(const char *line, Arena *arena) {
+    return parse_command_quiet(line, arena, NULL, 0);
+}
+
+// 在指定内存池中解析命令，错误信息写到 error 而不是 stderr
+Command* parse_command_quiet(const char *line, Arena *arena, char *error, size_t error_size) {
+    if (error != NULL && error_size > 0) {
+        error[0] = '\0';
+    }
+    if (line == NULL) {
+        return NULL;
     }
     
-    // 释放多重定向文件名
-    if (cmd->stdout_file != NULL && cmd->stdout_file != cmd->redirect_file) {
-        free(cmd->stdout_file);
+    Parser ps;
+    memset(&ps, 0, sizeof(ps));
+    ps.arena = arena;
+    ps.error_buf = error;
+    ps.error_size = error_size;
+    if (lexer_init(&ps.lexer, line, arena) != 0) {
+        perror("arena_alloc");
+        return NULL;
     }
-    if (cmd->stderr_file != NULL && cmd->stderr_file != cmd->redirect_file) {
-        free(cmd->stderr_file);
+    
+    advance(&ps);
+    Command *cmd = parse_list(&ps);
+    if (!ps.error && ps.tok.type != TOKEN_EOF) {
+        syntax_error(&ps);                          // 多余的 done
     }
-    if (cmd->stdin_file != NULL && cmd->stdin_file != cmd->redirect_file) {
-        free(cmd->stdin_file);
+    return ps.error ? NULL : cmd;
+}
+
+// 判断命令行是否还没有写完（for 循环缺少 do / done，或 here-document 没有结束标记）
+int parse_is_incomplete(const char *line) {
+    Arena arena;
+    arena_init(&arena, 0);
+    
+    Parser ps;
+    memset(&ps, 0, sizeof(ps));
+    ps.arena = &arena;
+    ps.quiet = 1;
+    if (lexer_init(&ps.lexer, line, &arena) == 0) {
+        advance(&ps);
+        parse_list(&ps);
     }
     
-    // 释放参数数组中的每个字符串
-    if (cmd->args != NULL) {
-        for (int i = 0; i < cmd->arg_count; i++) {
-            if (cmd->args[i] != NULL) {
-                free(cmd->args[i]);
-            }
-        }
-        free(cmd->args);
+    arena_destroy(&arena);
+    return ps.incomplete;
+}
+
+// 内存释放函数
+// 功能：释放 parse_command() 返回的 Command 对象
+// 说明：整条命令（包括管道中的后续命令、所有参数字符串）都分配在同一个内存池中，
+//       销毁内存池即可一次性释放，不再需要“从内到外”逐个 free
+void free_command(Command *cmd) {
+    if (cmd == NULL) {
+        return;
     }
     
-    // 释放Command本身
-    free(cmd);
+    // parse_command_arena() 解析的命令由调用者回退内存池，这里什么都不做
+    if (cmd->owns_arena) {
+        arena_destroy(cmd->arena);
+    }
 }
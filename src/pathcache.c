@@ -0,0 +1,244 @@
+// 定义 POSIX 标准版本，启用 strdup 等函数
+#define _POSIX_C_SOURCE 200809L
+
+// 引入自定义头文件
+#include "pathcache.h"                      // PATH 缓存函数声明
+
+// 引入标准库
+#include <stdio.h>                          // printf
+#include <stdlib.h>                         // malloc, calloc, free, getenv
+#include <string.h>                         // strcmp, strdup, strlen
+#include <time.h>                           // time
+#include <unistd.h>                         // access
+
+// 初始桶数量（必须是 2 的幂）
+#define PATH_CACHE_INITIAL_BUCKETS 64
+
+// 拼接路径缓冲区大小
+#define PATH_CACHE_MAX_PATH 1024
+
+// 缓存条目（链地址法）
+typedef struct PathEntry {
+    char *name;                             // 命令名
+    char *path;                             // 完整路径；NULL 表示负缓存（找不到）
+    time_t created;                         // 条目创建时间（负缓存过期判断）
+    unsigned long hits;                     // 命中次数
+    struct PathEntry *next;                 // 同一个桶中的下一个条目
+} PathEntry;
+
+// 哈希表
+static PathEntry **g_buckets = NULL;        // 桶数组
+static size_t g_bucket_count = 0;           // 桶数量
+static int g_entry_count = 0;               // 条目数量
+
+// FNV-1a 字符串哈希
+static size_t hash_name(const char *name) {
+    size_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)name; *p != '\0'; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// 释放单个条目
+static void free_entry(PathEntry *entry) {
+    free(entry->name);
+    free(entry->path);
+    free(entry);
+}
+
+// 扩容：条目数超过桶数时桶数翻倍
+static void grow_table(void) {
+    size_t new_count = (g_bucket_count == 0) ? PATH_CACHE_INITIAL_BUCKETS : g_bucket_count * 2;
+    PathEntry **new_buckets = calloc(new_count, sizeof(PathEntry *));
+    if (new_buckets == NULL) {
+        return;                             // 扩容失败不影响正确性，只是链变长
+    }
+
+    for (size_t i = 0; i < g_bucket_count; i++) {
+        PathEntry *entry = g_buckets[i];
+        while (entry != NULL) {
+            PathEntry *next = entry->next;
+            size_t idx = hash_name(entry->name) & (new_count - 1);
+            entry->next = new_buckets[idx];
+            new_buckets[idx] = entry;
+            entry = next;
+        }
+    }
+
+    free(g_buckets);
+    g_buckets = new_buckets;
+    g_bucket_count = new_count;
+}
+
+// 在 PATH 中搜索命令（不使用缓存）
+// 返回：malloc 分配的完整路径，找不到返回 NULL
+static char* search_path(const char *name) {
+    const char *path_env = getenv("PATH");
+    if (path_env == NULL || *path_env == '\0') {
+        return NULL;
+    }
+
+    char full_path[PATH_CACHE_MAX_PATH];
+    size_t name_len = strlen(name);
+    const char *p = path_env;
+
+    while (1) {
+        const char *end = strchr(p, ':');
+        if (end == NULL) {
+            end = p + strlen(p);
+        }
+
+        size_t dir_len = end - p;
+        if (dir_len > 0 && dir_len + name_len + 2 < sizeof(full_path)) {
+            memcpy(full_path, p, dir_len);
+            if (full_path[dir_len - 1] != '/') {
+                full_path[dir_len++] = '/';
+            }
+            memcpy(full_path + dir_len, name, name_len + 1);
+
+            if (access(full_path, X_OK) == 0) {
+                return strdup(full_path);
+            }
+        }
+
+        if (*end == '\0') {
+            break;
+        }
+        p = end + 1;
+    }
+
+    return NULL;
+}
+
+// ============================================
+// 查找命令路径
+// ============================================
+const char* path_cache_lookup(const char *name) {
+    if (name == NULL || *name == '\0') {
+        return NULL;
+    }
+
+    if (g_bucket_count == 0) {
+        grow_table();
+        if (g_bucket_count == 0) {
+            return NULL;
+        }
+    }
+
+    // 步骤1：查缓存
+    size_t idx = hash_name(name) & (g_bucket_count - 1);
+    PathEntry **link = &g_buckets[idx];
+    while (*link != NULL) {
+        PathEntry *entry = *link;
+        if (strcmp(entry->name, name) == 0) {
+            if (entry->path != NULL) {
+                entry->hits++;
+                return entry->path;
+            }
+            // 负缓存：未过期直接返回“找不到”，过期则删除后重新搜索
+            if (time(NULL) - entry->created < PATH_CACHE_NEGATIVE_TTL) {
+                entry->hits++;
+                return NULL;
+            }
+            *link = entry->next;
+            free_entry(entry);
+            g_entry_count--;
+            break;
+        }
+        link = &entry->next;
+    }
+
+    // 步骤2：缓存未命中，搜索 PATH
+    PathEntry *entry = malloc(sizeof(PathEntry));
+    if (entry == NULL) {
+        return NULL;
+    }
+    entry->name = strdup(name);
+    entry->path = search_path(name);
+    entry->created = time(NULL);
+    entry->hits = 1;
+    if (entry->name == NULL) {
+        free(entry->path);
+        free(entry);
+        return NULL;
+    }
+
+    // 步骤3：插入缓存（负结果也插入）
+    if ((size_t)g_entry_count >= g_bucket_count) {
+        grow_table();
+    }
+    idx = hash_name(name) & (g_bucket_count - 1);
+    entry->next = g_buckets[idx];
+    g_buckets[idx] = entry;
+    g_entry_count++;
+
+    return entry->path;
+}
+
+// ============================================
+// 删除单条缓存
+// ============================================
+int path_cache_forget(const char *name) {
+    if (name == NULL || g_bucket_count == 0) {
+        return -1;
+    }
+
+    size_t idx = hash_name(name) & (g_bucket_count - 1);
+    PathEntry **link = &g_buckets[idx];
+    while (*link != NULL) {
+        PathEntry *entry = *link;
+        if (strcmp(entry->name, name) == 0) {
+            *link = entry->next;
+            free_entry(entry);
+            g_entry_count--;
+            return 0;
+        }
+        link = &entry->next;
+    }
+    return -1;
+}
+
+// ============================================
+// 清空缓存
+// ============================================
+void path_cache_clear(void) {
+    for (size_t i = 0; i < g_bucket_count; i++) {
+        PathEntry *entry = g_buckets[i];
+        while (entry != NULL) {
+            PathEntry *next = entry->next;
+            free_entry(entry);
+            entry = next;
+        }
+        g_buckets[i] = NULL;
+    }
+    g_entry_count = 0;
+}
+
+// ============================================
+// 显示缓存内容
+// ============================================
+void path_cache_print(void) {
+    int printed = 0;
+    for (size_t i = 0; i < g_bucket_count; i++) {
+        for (PathEntry *entry = g_buckets[i]; entry != NULL; entry = entry->next) {
+            if (entry->path == NULL) {
+                continue;                   // 负缓存条目不显示
+            }
+            if (printed == 0) {
+                printf("hits\tcommand\n");
+            }
+            printf("%4lu\t%s\n", entry->hits, entry->path);
+            printed++;
+        }
+    }
+
+    if (printed == 0) {
+        printf("xhash: hash table empty\n");
+    }
+}
+
+int path_cache_count(void) {
+    return g_entry_count;
+}
@@ -0,0 +1,378 @@
+// 定义 POSIX 标准版本，启用 struct stat 的 st_mtim
+#define _POSIX_C_SOURCE 200809L
+
+// 引入自定义头文件
+#include "script.h"                         // 函数声明
+#include "parser.h"                         // parse_command_quiet, parse_is_incomplete
+#include "executor.h"                       // execute_command
+#include "arena.h"                          // 内存池
+#include "wildcard.h"                       // wildcard_cache_clear
+
+// 引入标准库
+#include <stdio.h>                          // fprintf
+#include <stdlib.h>                         // malloc, realloc, free
+#include <string.h>                         // memcpy, strchr
+#include <errno.h>                          // errno, EISDIR
+#include <fcntl.h>                          // open
+#include <unistd.h>                         // read, close
+#include <sys/stat.h>                       // fstat
+
+// 语法错误信息的最大长度
+#define SCRIPT_ERROR_SIZE 256
+
+// 脚本中的一条命令（for 循环可以跨多行）
+typedef struct ScriptStep {
+    int line;                               // 起始行号（从 1 开始）
+    Command *cmd;                           // 语法树；NULL 表示有语法错误
+    char *error;                            // 语法错误信息
+    struct ScriptStep *next;
+} ScriptStep;
+
+// 编译后的脚本
+typedef struct Script {
+    Arena *arena;                           // 语法树所在的内存池（执行时的展开结果也从这里分配）
+    dev_t dev;                              // 文件标识：设备号 + inode
+    ino_t ino;
+    struct timespec mtime;                  // 编译时文件的修改时间和大小，变化后需要重新编译
+    off_t size;
+    ScriptStep *steps;                      // 命令链表（按文件中的顺序）
+    int running;                            // 正在执行的层数
+    int cached;                             // 是否还在缓存链表中
+    struct Script *next;                    // 缓存链表中的下一个（最近使用的在前）
+} Script;
+
+// 缓存链表
+static Script *g_cache = NULL;
+static int g_cache_count = 0;
+
+// 当前嵌套执行的层数
+static int g_depth = 0;
+
+// 释放不再使用的脚本（已移出缓存且没有在执行）
+static void script_release(Script *script) {
+    if (!script->cached && script->running == 0) {
+        arena_destroy(script->arena);
+    }
+}
+
+// 从缓存链表中移除（prev 为前一个条目，NULL 表示链表头）
+static void cache_unlink(Script *prev, Script *script) {
+    if (prev == NULL) {
+        g_cache = script->next;
+    } else {
+        prev->next = script->next;
+    }
+    script->cached = 0;
+    g_cache_count--;
+    script_release(script);             // 正在执行的脚本等执行完再释放
+}
+
+// 查找文件对应的编译结果
+// 说明：找到后移到链表头；文件已经修改过的旧结果直接丢弃
+static Script* cache_lookup(const struct stat *st) {
+    Script *prev = NULL;
+    for (Script *script = g_cache; script != NULL; prev = script, script = script->next) {
+        if (script->dev != st->st_dev || script->ino != st->st_ino) {
+            continue;
+        }
+        if (script->size != st->st_size ||
+            script->mtime.tv_sec != st->st_mtim.tv_sec ||
+            script->mtime.tv_nsec != st->st_mtim.tv_nsec) {
+            cache_unlink(prev, script);
+            return NULL;
+        }
+        if (prev != NULL) {
+            prev->next = script->next;
+            script->next = g_cache;
+            g_cache = script;
+        }
+        return script;
+    }
+    return NULL;
+}
+
+// 加入缓存；超过上限时淘汰最久未使用的（链表尾部）
+static void cache_insert(Script *script) {
+    script->cached = 1;
+    script->next = g_cache;
+    g_cache = script;
+    g_cache_count++;
+
+    if (g_cache_count > SCRIPT_CACHE_MAX) {
+        Script *prev = g_cache;
+        while (prev->next->next != NULL) {
+            prev = prev->next;
+        }
+        cache_unlink(prev, prev->next);
+    }
+}
+
+// 读取整个文件（以 '\0' 结尾）
+// 返回：malloc 分配的内容，失败返回 NULL
+static char* read_file(int fd, off_t size_hint) {
+    size_t capacity = (size_hint > 0) ? (size_t)size_hint + 1 : 4096;
+    size_t len = 0;
+    char *text = malloc(capacity);
+    if (text == NULL) {
+        return NULL;
+    }
+
+    for (;;) {
+        if (len + 1 >= capacity) {
+            char *bigger = realloc(text, capacity * 2);
+            if (bigger == NULL) {
+                free(text);
+                return NULL;
+            }
+            text = bigger;
+            capacity *= 2;
+        }
+        ssize_t n = read(fd, text + len, capacity - len - 1);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            free(text);
+            return NULL;
+        }
+        if (n == 0) {
+            break;
+        }
+        len += (size_t)n;
+    }
+    text[len] = '\0';
+    return text;
+}
+
+// 取出下一行（不含换行符），*p 前进到再下一行的开头
+static const char* next_line(const char **p, size_t *len) {
+    const char *line = *p;
+    const char *end = strchr(line, '\n');
+    *len = (end != NULL) ? (size_t)(end - line) : strlen(line);
+    *p = (end != NULL) ? end + 1 : line + *len;
+    return line;
+}
+
+// 判断一行是否是空行或注释行（这些行不产生命令）
+static int is_blank_line(const char *line) {
+    while (*line == ' ' || *line == '\t' || *line == '\r') {
+        line++;
+    }
+    return *line == '\0' || *line == '\n' || *line == '#';
+}
+
+// 命令文本缓冲区（多行命令拼接用）
+typedef struct {
+    char *text;
+    size_t len;
+    size_t capacity;
+} LineBuffer;
+
+// 向缓冲区追加 len 个字节
+static int buffer_append(LineBuffer *buffer, const char *text, size_t len) {
+    if (buffer->len + len + 1 > buffer->capacity) {
+        size_t capacity = (buffer->capacity == 0) ? 256 : buffer->capacity;
+        while (buffer->len + len + 1 > capacity) {
+            capacity *= 2;
+        }
+        char *bigger = realloc(buffer->text, capacity);
+        if (bigger == NULL) {
+            return -1;
+        }
+        buffer->text = bigger;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->text + buffer->len, text, len);
+    buffer->len += len;
+    buffer->text[buffer->len] = '\0';
+    return 0;
+}
+
+// 把脚本文本编译成命令链表
+// 说明：一行一条命令；for 循环没写完（缺少 do / done）或 here-document 没有结束标记时继续拼接后面的行，
+//       行与行之间保留换行符（解析器把换行当作 ; 处理）
+// 返回：0=成功，-1=内存不足
+static int compile_script(Script *script, const char *text) {
+    ScriptStep **tail = &script->steps;
+    LineBuffer buffer = { NULL, 0, 0 };
+    const char *p = text;
+    int line_no = 0;
+    int result = 0;
+
+    while (*p != '\0') {
+        size_t len;
+        const char *line = next_line(&p, &len);
+        line_no++;
+        if (is_blank_line(line)) {
+            continue;
+        }
+
+        // 多行命令：记录起始行号，拼接到完整为止
+        int start_line = line_no;
+        buffer.len = 0;
+        if (buffer_append(&buffer, line, len) != 0) {
+            result = -1;
+            break;
+        }
+        int more;
+        while (*p != '\0' && (more = parse_is_incomplete(buffer.text)) != PARSE_COMPLETE) {
+            line = next_line(&p, &len);
+            line_no++;
+            if (more != PARSE_MORE_HEREDOC && is_blank_line(line)) {
+                continue;                       // here-document 中的空行要保留
+            }
+            if (buffer_append(&buffer, "\n", 1) != 0 || buffer_append(&buffer, line, len) != 0) {
+                result = -1;
+                break;
+            }
+        }
+        if (result != 0) {
+            break;
+        }
+
+        ScriptStep *step = arena_calloc(script->arena, 1, sizeof(ScriptStep));
+        if (step == NULL) {
+            result = -1;
+            break;
+        }
+        char error[SCRIPT_ERROR_SIZE];
+        step->line = start_line;
+        step->cmd = parse_command_quiet(buffer.text, script->arena, error, sizeof(error));
+        if (step->cmd == NULL) {
+            if (error[0] == '\0') {
+                result = -1;                    // 没有错误信息：内存不足
+                break;
+            }
+            step->error = arena_strdup(script->arena, error);
+            if (step->error == NULL) {
+                result = -1;
+                break;
+            }
+        }
+        *tail = step;
+        tail = &step->next;
+    }
+
+    free(buffer.text);
+    if (result != 0) {
+        errno = ENOMEM;
+    }
+    return result;
+}
+
+// 读取并编译脚本文件
+// 返回：编译结果（还没有加入缓存），失败返回 NULL（errno 有效）
+static Script* load_script(int fd, const struct stat *st) {
+    char *text = read_file(fd, st->st_size);
+    if (text == NULL) {
+        return NULL;
+    }
+
+    // 语法树大约是文本长度的几倍，一个内存块通常就够
+    Arena *arena = arena_create(4 * strlen(text) + ARENA_DEFAULT_BLOCK_SIZE);
+    Script *script = (arena != NULL) ? arena_calloc(arena, 1, sizeof(Script)) : NULL;
+    if (script == NULL) {
+        if (arena != NULL) {
+            arena_destroy(arena);
+        }
+        free(text);
+        errno = ENOMEM;
+        return NULL;
+    }
+    script->arena = arena;
+    script->dev = st->st_dev;
+    script->ino = st->st_ino;
+    script->mtime = st->st_mtim;
+    script->size = st->st_size;
+
+    int result = compile_script(script, text);
+    free(text);
+    if (result != 0) {
+        arena_destroy(arena);
+        return NULL;
+    }
+    return script;
+}
+
+// 按顺序执行编译好的命令
+// 返回：出错的命令数
+static int run_script(ShellContext *ctx, Script *script, const char *path, const char *who) {
+    int error_count = 0;
+
+    script->running++;
+    for (ScriptStep *step = script->steps; step != NULL && ctx->running; step = step->next) {
+        if (step->cmd == NULL) {
+            XSHELL_LOG_ERROR(ctx, "%s: %s:%d: %s\n", who, path, step->line, step->error);
+            error_count++;
+            continue;
+        }
+
+        // 本条命令的展开结果执行完就归还，反复执行内存也不会增长
+        ArenaMark mark = arena_mark(script->arena);
+        int status = execute_command(step->cmd, ctx);
+        arena_release(script->arena, mark);
+        wildcard_cache_clear();
+        ctx->last_exit_status = status;
+        if (status != 0) {
+            XSHELL_LOG_ERROR(ctx, "%s: %s:%d: command failed\n", who, path, step->line);
+            error_count++;
+        }
+    }
+    script->running--;
+    return error_count;
+}
+
+// 执行脚本文件（优先使用缓存的编译结果）
+int script_source(ShellContext *ctx, const char *path, const char *who) {
+    if (g_depth >= SCRIPT_MAX_DEPTH) {
+        XSHELL_LOG_ERROR(ctx, "%s: %s: maximum nesting depth (%d) exceeded\n", who, path, SCRIPT_MAX_DEPTH);
+        return 1;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int saved_errno = errno;
+        close(fd);
+        errno = saved_errno;
+        return -1;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        close(fd);
+        errno = EISDIR;
+        return -1;
+    }
+
+    Script *script = cache_lookup(&st);
+    if (script == NULL || script->running > 0) {
+        // 没有缓存，或者脚本正在执行（脚本 xsource 了自己）：
+        // 编译一份新的，后者不放入缓存，执行完就释放
+        int nested = (script != NULL);
+        script = load_script(fd, &st);
+        if (script == NULL) {
+            int saved_errno = errno;
+            close(fd);
+            errno = saved_errno;
+            return -1;
+        }
+        if (!nested) {
+            cache_insert(script);
+        }
+    }
+    close(fd);
+
+    g_depth++;
+    int error_count = run_script(ctx, script, path, who);
+    g_depth--;
+    script_release(script);
+    return error_count;
+}
+
+// 清空脚本缓存
+void script_cache_clear(void) {
+    while (g_cache != NULL) {
+        cache_unlink(NULL, g_cache);
+    }
+}
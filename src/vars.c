@@ -0,0 +1,251 @@
+// 定义 POSIX 标准版本，启用 setenv、unsetenv
+#define _POSIX_C_SOURCE 200809L
+
+// 引入自定义头文件
+#include "vars.h"                           // 变量表结构体和函数声明
+
+// 引入标准库
+#include <stdlib.h>                         // malloc, calloc, free, setenv, unsetenv
+#include <string.h>                         // strlen, strchr, memcpy, strncmp
+#include <ctype.h>                          // isalpha, isalnum
+
+// 初始桶数量（必须是 2 的幂）
+#define VARS_INITIAL_BUCKETS 64
+
+// FNV-1a 字符串哈希（名字不一定以 '\0' 结尾，所以带长度）
+static size_t hash_name(const char *name, size_t len) {
+    size_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// 导出变量有变化：丢弃缓存的环境数组
+static void invalidate_envp(VarTable *table) {
+    free(table->envp);
+    table->envp = NULL;
+}
+
+// 扩容：变量数超过桶数时桶数翻倍
+static void grow_table(VarTable *table) {
+    size_t new_count = (table->bucket_count == 0) ? VARS_INITIAL_BUCKETS : table->bucket_count * 2;
+    Var **new_buckets = calloc(new_count, sizeof(Var *));
+    if (new_buckets == NULL) {
+        return;                             // 扩容失败不影响正确性，只是链变长
+    }
+
+    for (size_t i = 0; i < table->bucket_count; i++) {
+        Var *var = table->buckets[i];
+        while (var != NULL) {
+            Var *next = var->next;
+            size_t idx = hash_name(var->entry, var->name_len) & (new_count - 1);
+            var->next = new_buckets[idx];
+            new_buckets[idx] = var;
+            var = next;
+        }
+    }
+
+    free(table->buckets);
+    table->buckets = new_buckets;
+    table->bucket_count = new_count;
+}
+
+// 查找变量，pprev 返回指向它的指针（用于删除）
+static Var* find_var(const VarTable *table, const char *name, size_t len, Var ***pprev) {
+    if (table->bucket_count == 0) {
+        return NULL;
+    }
+    Var **link = &table->buckets[hash_name(name, len) & (table->bucket_count - 1)];
+    for (Var *var = *link; var != NULL; link = &var->next, var = var->next) {
+        if (var->name_len == len && strncmp(var->entry, name, len) == 0) {
+            if (pprev != NULL) {
+                *pprev = link;
+            }
+            return var;
+        }
+    }
+    return NULL;
+}
+
+// 拼接 "NAME=value"
+static char* make_entry(const char *name, size_t name_len, const char *value) {
+    size_t value_len = strlen(value);
+    char *entry = malloc(name_len + value_len + 2);
+    if (entry == NULL) {
+        return NULL;
+    }
+    memcpy(entry, name, name_len);
+    entry[name_len] = '=';
+    memcpy(entry + name_len + 1, value, value_len + 1);
+    return entry;
+}
+
+// 设置变量的核心实现（name 长度为 name_len）
+static int set_var(VarTable *table, const char *name, size_t name_len,
+                   const char *value, int export_flag) {
+    char *entry = make_entry(name, name_len, value);
+    if (entry == NULL) {
+        return -1;
+    }
+
+    Var *var = find_var(table, name, name_len, NULL);
+    if (var != NULL) {
+        free(var->entry);
+        var->entry = entry;
+        if (export_flag == VAR_EXPORT && !var->exported) {
+            var->exported = 1;
+            table->exported_count++;
+        }
+        if (var->exported) {
+            invalidate_envp(table);
+        }
+        return 0;
+    }
+
+    if (table->count >= table->bucket_count) {
+        grow_table(table);
+        if (table->bucket_count == 0) {
+            free(entry);
+            return -1;
+        }
+    }
+
+    var = malloc(sizeof(Var));
+    if (var == NULL) {
+        free(entry);
+        return -1;
+    }
+    size_t idx = hash_name(name, name_len) & (table->bucket_count - 1);
+    var->entry = entry;
+    var->name_len = name_len;
+    var->exported = (export_flag == VAR_EXPORT);
+    var->next = table->buckets[idx];
+    table->buckets[idx] = var;
+    table->count++;
+    if (var->exported) {
+        table->exported_count++;
+        invalidate_envp(table);
+    }
+    return 0;
+}
+
+void vars_init(VarTable *table) {
+    table->buckets = NULL;
+    table->bucket_count = 0;
+    table->count = 0;
+    table->exported_count = 0;
+    table->envp = NULL;
+}
+
+void vars_import(VarTable *table, char **env) {
+    if (env == NULL) {
+        return;
+    }
+    for (char **p = env; *p != NULL; p++) {
+        const char *eq = strchr(*p, '=');
+        if (eq != NULL && eq > *p) {
+            set_var(table, *p, (size_t)(eq - *p), eq + 1, VAR_EXPORT);
+        }
+    }
+}
+
+void vars_destroy(VarTable *table) {
+    for (size_t i = 0; i < table->bucket_count; i++) {
+        Var *var = table->buckets[i];
+        while (var != NULL) {
+            Var *next = var->next;
+            free(var->entry);
+            free(var);
+            var = next;
+        }
+    }
+    free(table->buckets);
+    free(table->envp);
+    vars_init(table);
+}
+
+const char* vars_get(const VarTable *table, const char *name) {
+    size_t len = strlen(name);
+    Var *var = find_var(table, name, len, NULL);
+    return (var != NULL) ? var->entry + len + 1 : NULL;
+}
+
+int vars_set(VarTable *table, const char *name, const char *value, int export_flag) {
+    if (set_var(table, name, strlen(name), value, export_flag) != 0) {
+        return -1;
+    }
+    // 导出变量写回进程环境，getenv() 的使用者才能看到
+    Var *var = find_var(table, name, strlen(name), NULL);
+    if (var->exported) {
+        setenv(name, value, 1);
+    }
+    return 0;
+}
+
+int vars_export(VarTable *table, const char *name) {
+    Var *var = find_var(table, name, strlen(name), NULL);
+    if (var == NULL) {
+        return -1;
+    }
+    if (!var->exported) {
+        var->exported = 1;
+        table->exported_count++;
+        invalidate_envp(table);
+        setenv(name, var->entry + var->name_len + 1, 1);
+    }
+    return 0;
+}
+
+int vars_unset(VarTable *table, const char *name) {
+    Var **link;
+    Var *var = find_var(table, name, strlen(name), &link);
+    if (var == NULL) {
+        return 0;
+    }
+    *link = var->next;
+    table->count--;
+    if (var->exported) {
+        table->exported_count--;
+        invalidate_envp(table);
+        unsetenv(name);
+    }
+    free(var->entry);
+    free(var);
+    return 1;
+}
+
+int vars_valid_name(const char *name, size_t len) {
+    if (len == 0 || !(isalpha((unsigned char)name[0]) || name[0] == '_')) {
+        return 0;
+    }
+    for (size_t i = 1; i < len; i++) {
+        if (!(isalnum((unsigned char)name[i]) || name[i] == '_')) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+char** vars_envp(VarTable *table) {
+    if (table->envp != NULL) {
+        return table->envp;
+    }
+    // 数组只保存指向条目文本的指针，条目本身不复制
+    char **envp = malloc((table->exported_count + 1) * sizeof(char *));
+    if (envp == NULL) {
+        return NULL;
+    }
+    size_t n = 0;
+    for (size_t i = 0; i < table->bucket_count; i++) {
+        for (Var *var = table->buckets[i]; var != NULL; var = var->next) {
+            if (var->exported) {
+                envp[n++] = var->entry;
+            }
+        }
+    }
+    envp[n] = NULL;
+    table->envp = envp;
+    return envp;
+}
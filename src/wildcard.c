@@ -0,0 +1,465 @@
+// 定义 POSIX 标准版本，启用 openat、fdopendir、fstatat、st_mtim
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE                     // readdir 的 d_type 和 DT_DIR 等常量
+
+// 引入自定义头文件
+#include "wildcard.h"                       // 函数声明
+
+// 引入标准库
+#include <stdio.h>                          // NULL
+#include <stdlib.h>                         // malloc, realloc, free, qsort
+#include <string.h>                         // strlen, strcmp, memcpy
+#include <stdint.h>                         // uint32_t
+#include <limits.h>                         // PATH_MAX
+#include <fcntl.h>                          // openat, O_DIRECTORY
+#include <unistd.h>                         // close, dup
+#include <dirent.h>                         // fdopendir, readdir
+#include <fnmatch.h>                        // fnmatch
+#include <sys/stat.h>                       // fstat, fstatat
+
+// 目录缓存的哈希桶数
+#define WILDCARD_CACHE_BUCKETS 256
+
+// ============================================
+// 目录内容缓存
+// ============================================
+
+// 一个目录的内容（不含 . 和 ..）
+typedef struct DirListing {
+    dev_t dev;                              // 目录标识：设备号 + inode
+    ino_t ino;
+    struct timespec mtime;                  // 读取时目录的修改时间
+    char *names;                            // 所有文件名，以 '\0' 分隔依次存放
+    size_t names_len;
+    uint32_t *offsets;                      // 每个文件名在 names 中的位置
+    unsigned char *types;                   // 每个文件的 d_type
+    int count;
+    struct DirListing *next;                // 同一哈希桶中的下一个
+} DirListing;
+
+static DirListing *g_dir_cache[WILDCARD_CACHE_BUCKETS];
+
+// 已经过期的目录内容：可能还有外层的遍历在使用，清空缓存时再释放
+static DirListing *g_retired = NULL;
+
+static void listing_free(DirListing *list) {
+    free(list->names);
+    free(list->offsets);
+    free(list->types);
+    free(list);
+}
+
+// 向目录内容中追加一个文件
+// 返回：0=成功，-1=内存不足
+static int listing_add(DirListing *list, int *capacity, size_t *names_capacity,
+                       const char *name, unsigned char type) {
+    size_t len = strlen(name) + 1;
+    if (list->names_len + len > *names_capacity) {
+        size_t new_capacity = (*names_capacity == 0) ? 4096 : *names_capacity * 2;
+        while (list->names_len + len > new_capacity) {
+            new_capacity *= 2;
+        }
+        char *names = realloc(list->names, new_capacity);
+        if (names == NULL) {
+            return -1;
+        }
+        list->names = names;
+        *names_capacity = new_capacity;
+    }
+    if (list->count == *capacity) {
+        int new_capacity = (*capacity == 0) ? 64 : *capacity * 2;
+        uint32_t *offsets = realloc(list->offsets, (size_t)new_capacity * sizeof(uint32_t));
+        if (offsets == NULL) {
+            return -1;
+        }
+        list->offsets = offsets;
+        unsigned char *types = realloc(list->types, (size_t)new_capacity);
+        if (types == NULL) {
+            return -1;
+        }
+        list->types = types;
+        *capacity = new_capacity;
+    }
+    memcpy(list->names + list->names_len, name, len);
+    list->offsets[list->count] = (uint32_t)list->names_len;
+    list->types[list->count] = type;
+    list->names_len += len;
+    list->count++;
+    return 0;
+}
+
+// 读取目录内容（dirfd 不会被关闭）
+// 返回：新的目录内容，失败返回 NULL
+static DirListing* listing_read(int dirfd, const struct stat *st) {
+    DirListing *list = calloc(1, sizeof(DirListing));
+    int fd = dup(dirfd);
+    DIR *dir = (fd >= 0) ? fdopendir(fd) : NULL;
+    if (list == NULL || dir == NULL) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        free(list);
+        return NULL;
+    }
+    rewinddir(dir);                         // dup 出来的描述符共享读取位置
+    list->dev = st->st_dev;
+    list->ino = st->st_ino;
+    list->mtime = st->st_mtim;
+
+    int capacity = 0;
+    size_t names_capacity = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        const char *name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+        if (listing_add(list, &capacity, &names_capacity, name, entry->d_type) != 0) {
+            closedir(dir);
+            listing_free(list);
+            return NULL;
+        }
+    }
+    closedir(dir);
+    return list;
+}
+
+// 取得目录的内容（优先使用缓存）
+// 返回：目录内容，失败返回 NULL
+static const DirListing* dir_listing(int dirfd) {
+    struct stat st;
+    if (fstat(dirfd, &st) != 0) {
+        return NULL;
+    }
+
+    DirListing **slot = &g_dir_cache[(unsigned long)st.st_ino % WILDCARD_CACHE_BUCKETS];
+    for (DirListing **p = slot; *p != NULL; p = &(*p)->next) {
+        DirListing *list = *p;
+        if (list->dev != st.st_dev || list->ino != st.st_ino) {
+            continue;
+        }
+        if (list->mtime.tv_sec == st.st_mtim.tv_sec && list->mtime.tv_nsec == st.st_mtim.tv_nsec) {
+            return list;
+        }
+        // 目录已经修改过（如同一行中前面的命令创建了文件）：重新读取
+        *p = list->next;
+        list->next = g_retired;
+        g_retired = list;
+        break;
+    }
+
+    DirListing *list = listing_read(dirfd, &st);
+    if (list != NULL) {
+        list->next = *slot;
+        *slot = list;
+    }
+    return list;
+}
+
+void wildcard_cache_clear(void) {
+    for (int i = 0; i < WILDCARD_CACHE_BUCKETS; i++) {
+        while (g_dir_cache[i] != NULL) {
+            DirListing *list = g_dir_cache[i];
+            g_dir_cache[i] = list->next;
+            listing_free(list);
+        }
+    }
+    while (g_retired != NULL) {
+        DirListing *list = g_retired;
+        g_retired = list->next;
+        listing_free(list);
+    }
+}
+
+// ============================================
+// 模式匹配
+// ============================================
+
+// 模式中一级目录的类型
+#define PART_LITERAL   0                    // 没有通配符：直接打开，不读取目录
+#define PART_SUFFIX    1                    // * 或 *.ext：比较后缀
+#define PART_PATTERN   2                    // 其他模式：fnmatch
+#define PART_RECURSIVE 3                    // **：任意层子目录
+
+typedef struct {
+    char *text;                             // 这一级的模式（PART_LITERAL 时已去掉转义）
+    int kind;
+    size_t suffix_len;                      // PART_SUFFIX：* 之后的文本长度
+} PatternPart;
+
+// 一次展开的状态
+typedef struct {
+    PatternPart *parts;
+    int count;
+    int dir_only;                           // 模式以 / 结尾：只匹配目录
+    Arena *arena;
+    char **matches;                         // 匹配结果（malloc 数组，字符串在 arena 中）
+    int match_count;
+    int match_capacity;
+    int error;                              // 内存不足
+    char path[PATH_MAX];                    // 当前路径
+} Walker;
+
+int wildcard_has_magic(const char *pattern) {
+    for (const char *p = pattern; *p != '\0'; p++) {
+        if (*p == '\\') {
+            if (p[1] == '\0') {
+                break;
+            }
+            p++;
+        } else if (*p == '*' || *p == '?') {
+            return 1;
+        } else if (*p == '[' && p[1] != '\0' && strchr(p + 2, ']') != NULL) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 去掉转义：\c -> c
+static void unescape(char *text) {
+    char *out = text;
+    for (const char *p = text; *p != '\0'; p++) {
+        if (*p == '\\' && p[1] != '\0') {
+            p++;
+        }
+        *out++ = *p;
+    }
+    *out = '\0';
+}
+
+// 确定一级目录的匹配方式
+static void classify_part(PatternPart *part) {
+    char *text = part->text;
+    if (!wildcard_has_magic(text)) {
+        part->kind = PART_LITERAL;
+        unescape(text);
+    } else if (strcmp(text, "**") == 0) {
+        part->kind = PART_RECURSIVE;
+    } else if (text[0] == '*' && !wildcard_has_magic(text + 1) && strchr(text + 1, '\\') == NULL) {
+        part->kind = PART_SUFFIX;
+        part->suffix_len = strlen(text + 1);
+    } else {
+        part->kind = PART_PATTERN;
+    }
+}
+
+// 判断文件名是否匹配这一级的模式
+static int part_match(const PatternPart *part, const char *name) {
+    if (part->kind == PART_SUFFIX) {
+        // 以 . 开头的文件不匹配 *
+        size_t len = strlen(name);
+        return name[0] != '.' && len >= part->suffix_len &&
+               memcmp(name + len - part->suffix_len, part->text + 1, part->suffix_len) == 0;
+    }
+    return fnmatch(part->text, name, FNM_PERIOD) == 0;
+}
+
+// 判断目录中的一个文件是否是目录
+// 说明：d_type 已知时不需要系统调用；follow 表示是否跟随符号链接
+static int entry_is_dir(int dirfd, const char *name, unsigned char type, int follow) {
+    if (type == DT_DIR) {
+        return 1;
+    }
+    if (type != DT_UNKNOWN && (type != DT_LNK || !follow)) {
+        return 0;
+    }
+    struct stat st;
+    return fstatat(dirfd, name, &st, follow ? 0 : AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(st.st_mode);
+}
+
+// 在当前路径（长度 len）后追加文件名
+// 返回：新长度，路径太长返回 0
+static size_t path_append(Walker *w, size_t len, const char *name) {
+    size_t name_len = strlen(name);
+    if (len + name_len + 2 > sizeof(w->path)) {
+        return 0;
+    }
+    memcpy(w->path + len, name, name_len + 1);
+    return len + name_len;
+}
+
+// 记录一个匹配结果（当前路径的前 len 个字符）
+static void add_match(Walker *w, size_t len) {
+    if (w->match_count == w->match_capacity) {
+        int capacity = (w->match_capacity == 0) ? 16 : w->match_capacity * 2;
+        char **matches = realloc(w->matches, (size_t)capacity * sizeof(char *));
+        if (matches == NULL) {
+            w->error = 1;
+            return;
+        }
+        w->matches = matches;
+        w->match_capacity = capacity;
+    }
+    char *match = arena_alloc(w->arena, len + (w->dir_only ? 2 : 1));
+    if (match == NULL) {
+        w->error = 1;
+        return;
+    }
+    memcpy(match, w->path, len);
+    if (w->dir_only) {
+        match[len++] = '/';
+    }
+    match[len] = '\0';
+    w->matches[w->match_count++] = match;
+}
+
+static void walk(Walker *w, int dirfd, size_t len, int index);
+
+// 进入子目录 name（当前路径已经追加了 name，长度为 len），匹配第 index 级
+static void descend(Walker *w, int dirfd, const char *name, size_t len, int index) {
+    int fd = openat(dirfd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return;                             // 没有权限或不是目录：跳过
+    }
+    w->path[len] = '/';
+    w->path[len + 1] = '\0';
+    walk(w, fd, len + 1, index);
+    close(fd);
+}
+
+// 在目录 dirfd（路径为 w->path 的前 len 个字符）中匹配第 index 级模式
+static void walk(Walker *w, int dirfd, size_t len, int index) {
+    const PatternPart *part = &w->parts[index];
+    int last = (index == w->count - 1);
+
+    if (part->kind == PART_LITERAL) {
+        // 没有通配符：不需要读取目录
+        size_t new_len = path_append(w, len, part->text);
+        if (new_len == 0) {
+            return;
+        }
+        if (!last) {
+            descend(w, dirfd, part->text, new_len, index + 1);
+            return;
+        }
+        struct stat st;
+        if (fstatat(dirfd, part->text, &st, w->dir_only ? 0 : AT_SYMLINK_NOFOLLOW) == 0 &&
+            (!w->dir_only || S_ISDIR(st.st_mode))) {
+            add_match(w, new_len);
+        }
+        return;
+    }
+
+    const DirListing *list = dir_listing(dirfd);
+    if (list == NULL) {
+        return;
+    }
+
+    if (part->kind == PART_RECURSIVE) {
+        // **：先在当前目录匹配下一级（0 层子目录），再进入每个子目录（不跟随符号链接）
+        if (!last) {
+            walk(w, dirfd, len, index + 1);
+        }
+        for (int i = 0; i < list->count && !w->error; i++) {
+            const char *name = list->names + list->offsets[i];
+            if (name[0] == '.') {
+                continue;
+            }
+            size_t new_len = path_append(w, len, name);
+            if (new_len == 0) {
+                continue;
+            }
+            int is_dir = entry_is_dir(dirfd, name, list->types[i], 0);
+            if (last && (is_dir || !w->dir_only)) {
+                add_match(w, new_len);
+            }
+            if (is_dir) {
+                descend(w, dirfd, name, new_len, index);
+            }
+        }
+        return;
+    }
+
+    for (int i = 0; i < list->count && !w->error; i++) {
+        const char *name = list->names + list->offsets[i];
+        if (!part_match(part, name)) {
+            continue;
+        }
+        size_t new_len = path_append(w, len, name);
+        if (new_len == 0) {
+            continue;
+        }
+        if (last) {
+            if (!w->dir_only || entry_is_dir(dirfd, name, list->types[i], 1)) {
+                add_match(w, new_len);
+            }
+        } else if (entry_is_dir(dirfd, name, list->types[i], 1)) {
+            descend(w, dirfd, name, new_len, index + 1);
+        }
+    }
+}
+
+static int compare_paths(const void *a, const void *b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+int wildcard_expand(const char *pattern, Arena *arena, char ***matches) {
+    *matches = NULL;
+
+    // 按 / 切分成若干级（连续的 / 当作一个）
+    char *copy = malloc(strlen(pattern) + 1);
+    PatternPart *parts = malloc((strlen(pattern) / 2 + 1) * sizeof(PatternPart));
+    Walker *w = calloc(1, sizeof(Walker));
+    if (copy == NULL || parts == NULL || w == NULL) {
+        free(copy);
+        free(parts);
+        free(w);
+        return -1;
+    }
+    strcpy(copy, pattern);
+    int count = 0;
+    for (char *p = copy; *p != '\0'; ) {
+        while (*p == '/') {
+            *p++ = '\0';
+        }
+        if (*p == '\0') {
+            break;
+        }
+        parts[count].text = p;
+        while (*p != '\0' && *p != '/') {
+            p++;
+        }
+        if (*p == '/') {
+            *p++ = '\0';
+        }
+        classify_part(&parts[count]);
+        count++;
+    }
+    size_t pattern_len = strlen(pattern);
+    w->dir_only = (pattern_len > 0 && pattern[pattern_len - 1] == '/');
+    w->parts = parts;
+    w->count = count;
+    w->arena = arena;
+
+    // 绝对路径从根目录开始，相对路径从当前目录开始（结果中不加 ./）
+    int absolute = (pattern[0] == '/');
+    size_t len = 0;
+    if (absolute) {
+        w->path[len++] = '/';
+        w->path[len] = '\0';
+    }
+    int dirfd = (count > 0) ? open(absolute ? "/" : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC) : -1;
+    if (dirfd >= 0) {
+        walk(w, dirfd, len, 0);
+        close(dirfd);
+    }
+
+    int result = w->error ? -1 : w->match_count;
+    if (result > 0) {
+        qsort(w->matches, (size_t)w->match_count, sizeof(char *), compare_paths);
+        char **array = arena_alloc(arena, (size_t)(w->match_count + 1) * sizeof(char *));
+        if (array == NULL) {
+            result = -1;
+        } else {
+            memcpy(array, w->matches, (size_t)w->match_count * sizeof(char *));
+            array[w->match_count] = NULL;
+            *matches = array;
+        }
+    }
+    free(w->matches);
+    free(w);
+    free(parts);
+    free(copy);
+    return result;
+}
@@ -0,0 +1,234 @@
+// 启用 GNU 扩展：fopencookie 用于把环形缓冲区包装成 FILE*
+#define _GNU_SOURCE
+
+// 引入自定义头文件
+#include "xio.h"                            // 标准流抽象声明
+
+// 引入标准库
+#include <stdio.h>                          // FILE, fopencookie, setvbuf
+#include <stdlib.h>                         // malloc, free, getenv
+#include <string.h>                         // memcpy, strcmp
+#include <errno.h>                          // errno, EPIPE
+#include <pthread.h>                        // pthread_mutex_t, pthread_cond_t
+#include <unistd.h>                         // sysconf
+#include <sys/mman.h>                       // mmap, munmap
+#include <sys/stat.h>                       // fstat, S_ISREG
+
+// 当前线程的输入/输出流
+__thread FILE *xio_cur_in = NULL;
+__thread FILE *xio_cur_out = NULL;
+
+// 管道中的内置命令是否使用线程运行（默认开启）
+static int g_threads_enabled = 1;
+
+// 环形缓冲区（一个读端 + 一个写端）
+typedef struct {
+    char *buf;                              // 数据区
+    size_t size;                            // 容量（字节）
+    size_t head;                            // 下一个可读字节的位置
+    size_t count;                           // 当前数据量
+    int writer_closed;                      // 写端已关闭（读端读完后得到 EOF）
+    int reader_closed;                      // 读端已关闭（写端再写入返回 EPIPE）
+    int refs;                               // 尚未关闭的端数量
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;               // 有数据可读或写端关闭
+    pthread_cond_t not_full;                // 有空间可写或读端关闭
+} XioRing;
+
+// ============================================
+// 初始化
+// ============================================
+void xio_init(void) {
+    const char *mode = getenv("XSHELL_PIPELINE");
+    g_threads_enabled = !(mode != NULL && strcmp(mode, "fork") == 0);
+}
+
+int xio_threads_enabled(void) {
+    return g_threads_enabled;
+}
+
+void xio_set_threads_enabled(int enabled) {
+    g_threads_enabled = enabled;
+}
+
+// 释放一端；两端都释放后销毁缓冲区
+static void ring_release(XioRing *ring) {
+    int refs = --ring->refs;
+    pthread_mutex_unlock(&ring->lock);
+    if (refs == 0) {
+        pthread_mutex_destroy(&ring->lock);
+        pthread_cond_destroy(&ring->not_empty);
+        pthread_cond_destroy(&ring->not_full);
+        free(ring->buf);
+        free(ring);
+    }
+}
+
+// 读端：从环形缓冲区取出数据（没有数据时阻塞，写端关闭且读完时返回 0 表示 EOF）
+static ssize_t ring_read(void *cookie, char *out, size_t size) {
+    XioRing *ring = cookie;
+    pthread_mutex_lock(&ring->lock);
+
+    while (ring->count == 0 && !ring->writer_closed) {
+        pthread_cond_wait(&ring->not_empty, &ring->lock);
+    }
+
+    size_t n = (size < ring->count) ? size : ring->count;
+    size_t first = ring->size - ring->head;             // 到缓冲区末尾的连续字节数
+    if (first > n) {
+        first = n;
+    }
+    memcpy(out, ring->buf + ring->head, first);
+    memcpy(out + first, ring->buf, n - first);          // 绕回开头的部分
+    ring->head = (ring->head + n) % ring->size;
+    ring->count -= n;
+
+    pthread_cond_signal(&ring->not_full);
+    pthread_mutex_unlock(&ring->lock);
+    return (ssize_t)n;
+}
+
+// 写端：把数据放入环形缓冲区（缓冲区满时阻塞，读端已关闭时返回 EPIPE）
+static ssize_t ring_write(void *cookie, const char *data, size_t size) {
+    XioRing *ring = cookie;
+    size_t written = 0;
+    pthread_mutex_lock(&ring->lock);
+
+    while (written < size) {
+        while (ring->count == ring->size && !ring->reader_closed) {
+            pthread_cond_wait(&ring->not_full, &ring->lock);
+        }
+        if (ring->reader_closed) {
+            pthread_mutex_unlock(&ring->lock);
+            if (written > 0) {
+                return (ssize_t)written;
+            }
+            errno = EPIPE;
+            return -1;
+        }
+
+        size_t space = ring->size - ring->count;
+        size_t n = (size - written < space) ? size - written : space;
+        size_t tail = (ring->head + ring->count) % ring->size;
+        size_t first = ring->size - tail;
+        if (first > n) {
+            first = n;
+        }
+        memcpy(ring->buf + tail, data + written, first);
+        memcpy(ring->buf, data + written + first, n - first);
+        ring->count += n;
+        written += n;
+
+        pthread_cond_signal(&ring->not_empty);
+    }
+
+    pthread_mutex_unlock(&ring->lock);
+    return (ssize_t)written;
+}
+
+static int ring_close_reader(void *cookie) {
+    XioRing *ring = cookie;
+    pthread_mutex_lock(&ring->lock);
+    ring->reader_closed = 1;
+    pthread_cond_broadcast(&ring->not_full);
+    ring_release(ring);
+    return 0;
+}
+
+static int ring_close_writer(void *cookie) {
+    XioRing *ring = cookie;
+    pthread_mutex_lock(&ring->lock);
+    ring->writer_closed = 1;
+    pthread_cond_broadcast(&ring->not_empty);
+    ring_release(ring);
+    return 0;
+}
+
+// ============================================
+// 创建环形缓冲区流对
+// ============================================
+int xio_channel_open(FILE **reader, FILE **writer) {
+    XioRing *ring = calloc(1, sizeof(XioRing));
+    if (ring == NULL) {
+        return -1;
+    }
+    ring->size = (size_t)XIO_BLOCK_SIZE * XIO_RING_BLOCKS;
+    ring->buf = malloc(ring->size);
+    if (ring->buf == NULL) {
+        free(ring);
+        return -1;
+    }
+    ring->refs = 2;
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->not_empty, NULL);
+    pthread_cond_init(&ring->not_full, NULL);
+
+    cookie_io_functions_t read_funcs = { ring_read, NULL, NULL, ring_close_reader };
+    cookie_io_functions_t write_funcs = { NULL, ring_write, NULL, ring_close_writer };
+
+    *reader = fopencookie(ring, "r", read_funcs);
+    if (*reader == NULL) {
+        pthread_mutex_destroy(&ring->lock);
+        pthread_cond_destroy(&ring->not_empty);
+        pthread_cond_destroy(&ring->not_full);
+        free(ring->buf);
+        free(ring);
+        return -1;
+    }
+    *writer = fopencookie(ring, "w", write_funcs);
+    if (*writer == NULL) {
+        fclose(*reader);                    // 只剩一个引用，写端也标记为关闭
+        pthread_mutex_lock(&ring->lock);
+        ring_release(ring);
+        return -1;
+    }
+
+    // 全缓冲：每次交接一整块数据，而不是每行加一次锁
+    setvbuf(*reader, NULL, _IOFBF, XIO_BLOCK_SIZE);
+    setvbuf(*writer, NULL, _IOFBF, XIO_BLOCK_SIZE);
+    return 0;
+}
+
+// ============================================
+// 包装文件描述符
+// ============================================
+FILE* xio_fdopen(int fd, const char *mode) {
+    FILE *fp = fdopen(fd, mode);
+    if (fp != NULL) {
+        setvbuf(fp, NULL, _IOFBF, XIO_BLOCK_SIZE);
+    }
+    return fp;
+}
+
+// ============================================
+// 映射普通文件
+// ============================================
+char* xio_map(FILE *file, size_t *len) {
+    struct stat st;
+    int fd = fileno(file);
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 || ftello(file) != 0) {
+        return NULL;
+    }
+    
+    size_t size = (size_t)st.st_size;
+    char *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+    // 文件大小不是页的整数倍时，映射末尾到页尾的部分都是 0，最后一行自然以 '\0' 结尾；
+    // 正好整页且最后一行没有换行时没有地方放 '\0'，不映射
+    long page = sysconf(_SC_PAGESIZE);
+    if (data[size - 1] != '\n' && page > 0 && size % (size_t)page == 0) {
+        munmap(data, size);
+        return NULL;
+    }
+    fseeko(file, 0, SEEK_END);
+    *len = size;
+    return data;
+}
+
+void xio_unmap(char *data, size_t len) {
+    if (data != NULL) {
+        munmap(data, len);
+    }
+}
@@ -3,13 +3,18 @@
 
 // 引入自定义头文件
 #include "xshell.h"      // Shell 核心定义（ShellContext 结构体、常量等）
-#include "parser.h"      // 命令解析器（parse_command, free_command）
+#include "parser.h"      // 命令解析器（parse_command_arena）
 #include "executor.h"    // 命令执行器（execute_command）
 #include "utils.h"       // 工具函数（is_empty_line, trim）
 #include "input.h"       // 输入处理（带 Tab 补全）
-#include "history.h"     // 历史记录系统（history_init, history_add, history_cleanup）
+#include "history.h"     // 历史记录系统（history_init, history_add, history_finish, history_cleanup）
 #include "alias.h"       // 别名管理系统（alias_init, alias_cleanup）
 #include "job.h"         // 作业管理系统（job_init, job_check_done）
+#include "launcher.h"    // 进程启动器（launcher_init）
+#include "xio.h"         // 管道线程引擎（xio_init）
+#include "script.h"      // 脚本预编译缓存（script_source）
+#include "wildcard.h"    // 通配符展开（wildcard_cache_clear）
+#include "frecency.h"    // 行内建议和 xcd -z 的模型（frecency_init, frecency_add_command）
 // 引入标准库
 #include <stdio.h>       // 标准输入输出（printf, fprintf, fgets, va_list）
 #include <stdlib.h>      // 标准库函数（getenv）
@@ -19,24 +24,7 @@
 #include <errno.h>       // 错误码（errno）
 #include <sys/types.h>   // PID 类型定义
 
-// 全局变量和回调函数
-// 全局指针：用于提示符回调函数访问 Shell 上下文
-// 说明：因为回调函数签名不能传递自定义参数，所以使用全局变量
-// 用途：在 Tab 补全显示选项后，回调函数需要访问上下文来显示提示符
-static ShellContext *g_shell_ctx = NULL;               // 全局 Shell 上下文指针
-
-// 提示符回调函数（用于 Tab 补全后重新显示提示符）
-// 功能：当用户按两次 Tab 显示所有匹配项后，调用此函数重新显示提示符
-// 使用场景：
-//   用户操作：[\home]# xcd l<Tab><Tab>
-//   系统显示：lab/  lost+found/
-//   此函数显示：[\home]# xcd l       <- 重新显示提示符和当前输入
-// 注意：此函数通过全局变量 g_shell_ctx 访问 Shell 上下文
-static void prompt_callback(void) {
-    if (g_shell_ctx != NULL) {                          // 检查全局指针是否有效
-        display_prompt(g_shell_ctx);                    // 调用提示符显示函数
-    }
-}
+extern char **environ;                                  // 启动时的环境变量
 
 // 初始化 Shell 环境
 int init_shell(ShellContext *ctx) {
@@ -49,6 +37,10 @@ int init_shell(ShellContext *ctx) {
     // 初始化上一个目录为当前目录（首次启动时没有"上一个"目录）
     strcpy(ctx->prev_dir, ctx->cwd);
     
+    // 导入环境变量到 Shell 变量表（全部作为导出变量）
+    vars_init(&ctx->vars);
+    vars_import(&ctx->vars, environ);
+    
     // 获取用户主目录（从环境变量 HOME）
     ctx->home_dir = getenv("HOME");  // getenv 返回环境变量的值
     if (ctx->home_dir == NULL) {     // 如果 HOME 环境变量不存在
@@ -64,25 +56,11 @@ int init_shell(ShellContext *ctx) {
         ctx->log_file = NULL;  // 设置为 NULL，日志功能将不工作
     }
     
-    // 设置 Shell 初始状态
-    ctx->running = 1;           // 设置运行标志为 1（表示 Shell 正在运行）
-    ctx->last_exit_status = 0;  // 上一条命令退出状态初始化为 0（成功）
-    
-    return 0;  // 初始化成功，返回 0
-}
-
-// Shell 主循环（核心逻辑）
-void shell_loop(ShellContext *ctx) {
-    char line[MAX_INPUT_LENGTH];  // 声明字符数组，存储用户输入的命令行（最大 4096 字节）
-    
-    // 设置全局上下文指针（用于提示符回调）
-    // 说明：将当前 Shell 上下文保存到全局变量，以便回调函数可以访问
-    // 用途：Tab 补全显示选项后，回调函数需要此指针来显示提示符
-    g_shell_ctx = ctx;
+    // 初始化进程启动器（默认 posix_spawn，可用 XSHELL_LAUNCHER=fork 切换）
+    launcher_init();
     
-    // 初始化历史记录系统
-    // 功能：加载保存的历史记录（从 ~/.xshell_history）
-    history_init();
+    // 初始化管道线程引擎（默认开启，可用 XSHELL_PIPELINE=fork 关闭）
+    xio_init();
     
     // 初始化别名系统
     // 功能：初始化别名表（清空所有别名）
@@ -93,27 +71,125 @@ void shell_loop(ShellContext *ctx) {
     job_init();
     job_install_signal_handler();
     
-    // 显示欢迎信息（Shell 启动时打印一次）
-    printf("######## Welcome to XShell! ########\n");
+    // 设置 Shell 初始状态
+    ctx->running = 1;           // 设置运行标志为 1（表示 Shell 正在运行）
+    ctx->last_exit_status = 0;  // 上一条命令退出状态初始化为 0（成功）
+    ctx->interactive = isatty(STDIN_FILENO);  // 标准输入是终端才进入交互模式（main 可以覆盖）
+    
+    return 0;  // 初始化成功，返回 0
+}
+
+// 多行命令的文本（按需增长）
+typedef struct {
+    char *text;
+    size_t len;
+    size_t capacity;
+} CommandBuffer;
+
+// 向命令文本追加 len 个字节
+// 返回：0=成功，-1=内存不足
+static int command_append(CommandBuffer *command, const char *text, size_t len) {
+    if (command->len + len + 1 > command->capacity) {
+        size_t capacity = (command->capacity == 0) ? MAX_INPUT_LENGTH : command->capacity;
+        while (command->len + len + 1 > capacity) {
+            capacity *= 2;
+        }
+        char *bigger = realloc(command->text, capacity);
+        if (bigger == NULL) {
+            return -1;
+        }
+        command->text = bigger;
+        command->capacity = capacity;
+    }
+    memcpy(command->text + command->len, text, len);
+    command->len += len;
+    command->text[command->len] = '\0';
+    return 0;
+}
+
+// 把多行输入的下一行拼接到命令后面
+// 说明：拼成单行（历史记录一行一条），行与行之间补上 "; "，
+//       但 do / | / && / || / ; 之后不需要分隔符（如 "for i in 1 2; do xecho $i; done"）
+//       raw=1（here-document 开始之后）：用换行连接，原样保留空行和行首空白
+// 返回：0=成功，-1=内存不足
+static int append_continuation_line(CommandBuffer *command, const char *next_line, int raw) {
+    if (raw) {
+        return (command_append(command, "\n", 1) == 0 &&
+                command_append(command, next_line, strlen(next_line)) == 0) ? 0 : -1;
+    }
+    
+    char *line = command->text;
+    while (command->len > 0 && (line[command->len - 1] == ' ' || line[command->len - 1] == '\t')) {
+        line[--command->len] = '\0';
+    }
+    while (*next_line == ' ' || *next_line == '\t') {
+        next_line++;
+    }
+    if (*next_line == '\0') {
+        return 0;  // 空行
+    }
+    
+    size_t len = command->len;
+    const char *sep = "; ";
+    if (len == 0 || line[len - 1] == ';' || line[len - 1] == '|' || line[len - 1] == '&' ||
+        (len >= 2 && strcmp(line + len - 2, "do") == 0 &&
+         (len == 2 || line[len - 3] == ' ' || line[len - 3] == ';'))) {
+        sep = " ";
+    }
+    
+    return (command_append(command, sep, strlen(sep)) == 0 &&
+            command_append(command, next_line, strlen(next_line)) == 0) ? 0 : -1;
+}
+
+// 读取下一行输入
+// 交互模式：逐字符读取，支持 Tab 补全和历史（见 input.c），一行最多 MAX_INPUT_LENGTH - 1 字节
+// 非交互模式：按块读取、按换行切分，不切换终端模式、不回显，行的长度不受限制
+// 参数：buffer / capacity - 行缓冲区（按需用 realloc 扩大），prompt - 交互模式下显示的提示符
+static char* read_input_line(ShellContext *ctx, FILE *in, char **buffer, size_t *capacity, const char *prompt) {
+    if (ctx->interactive) {
+        if (*capacity < MAX_INPUT_LENGTH) {
+            char *bigger = realloc(*buffer, MAX_INPUT_LENGTH);
+            if (bigger == NULL) {
+                perror("xshell");
+                return NULL;
+            }
+            *buffer = bigger;
+            *capacity = MAX_INPUT_LENGTH;
+        }
+        return read_line_with_completion(*buffer, *capacity, prompt);
+    }
+    return read_line_plain(in, buffer, capacity);
+}
+
+// 逐行读取并执行命令，直到输入结束或执行 quit
+static void run_input(ShellContext *ctx, FILE *in) {
+    char *line = NULL;                       // 用户输入的一行（按需增长）
+    size_t line_capacity = 0;
+    CommandBuffer command = { NULL, 0, 0 };  // 完整的命令（多行时拼接起来）
+    char last_cwd[PATH_MAX];                 // 上一条命令执行前的工作目录
+    strcpy(last_cwd, ctx->cwd);
     
     // 主循环：只要 ctx->running 为 1（真），就持续执行
     while (ctx->running) {
-        // 显示命令提示符（如 [\home\user\]#）
-        display_prompt(ctx);
+        // 回收已结束的后台作业（交互模式下在提示符前报告 Done）
+        if (ctx->interactive) {
+            job_check_done();
+        } else {
+            job_update_status();
+        }
+        
+        // 命令提示符（如 [\home\user\]#），由行编辑器显示
+        char prompt[PATH_MAX + 8];
+        prompt[0] = '\0';
+        if (ctx->interactive) {
+            format_prompt(ctx, prompt, sizeof(prompt));
+        }
         
-        // 从标准输入读取一行用户输入（支持 Tab 补全）
-        // 功能说明：
-        //   1. 逐字符读取（不等待回车）
-        //   2. Tab 键触发路径补全
-        //   3. 双击 Tab 显示所有匹配项
-        //   4. 退格键删除字符
-        //   5. Ctrl+D 退出
-        // 参数说明：
-        //   - line: 存储输入的缓冲区
-        //   - sizeof(line): 缓冲区大小
-        //   - prompt_callback: 提示符回调函数（显示匹配项后重新显示提示符）
-        if (read_line_with_completion(line, sizeof(line), prompt_callback) == NULL) {
-            printf("\n");  // 打印换行符（美化输出）
+        // 读取一行输入（Ctrl+D 或输入结束时返回 NULL）
+        if (read_input_line(ctx, in, &line, &line_capacity, prompt) == NULL) {
+            if (ctx->interactive) {
+                printf("\n");  // 打印换行符（美化输出）
+            }
             break;         // 跳出循环，Shell 将退出
         }
         
@@ -125,97 +201,123 @@ void shell_loop(ShellContext *ctx) {
             continue;  // 跳过本次循环，继续下一次循环
         }
         
-        // 检查是否是 for 循环的开始（多行支持）
-        char *trimmed = line;
-        while (*trimmed == ' ' || *trimmed == '\t') trimmed++;
-        if (strncmp(trimmed, "for ", 4) == 0) {
-            // 检查是否已经包含 done（单行形式）
-            if (strstr(trimmed, "done") == NULL) {
-                // 多行 for 循环，继续读取直到找到 done
-                char full_command[MAX_INPUT_LENGTH * 10];  // 足够大的缓冲区
-                strcpy(full_command, line);
-                strcat(full_command, " ");  // 添加空格分隔
-                
-                int found_done = 0;
-                while (!found_done && strlen(full_command) < sizeof(full_command) - MAX_INPUT_LENGTH) {
-                    // 显示继续提示符
-                    printf("> ");
-                    fflush(stdout);
-                    
-                    // 读取下一行
-                    char next_line[MAX_INPUT_LENGTH];
-                    if (read_line_with_completion(next_line, sizeof(next_line), prompt_callback) == NULL) {
-                        break;  // Ctrl+D 退出
-                    }
-                    
-                    // 去除换行符
-                    next_line[strcspn(next_line, "\n")] = '\0';
-                    
-                    // 追加到完整命令
-                    if (strlen(full_command) + strlen(next_line) + 2 < sizeof(full_command)) {
-                        strcat(full_command, next_line);
-                        strcat(full_command, " ");
-                    }
-                    
-                    // 检查是否包含 done
-                    char *next_trimmed = next_line;
-                    while (*next_trimmed == ' ' || *next_trimmed == '\t') next_trimmed++;
-                    if (strcmp(next_trimmed, "done") == 0 || 
-                        (strncmp(next_trimmed, "done", 4) == 0 && 
-                         (next_trimmed[4] == '\0' || next_trimmed[4] == ' ' || next_trimmed[4] == '\t'))) {
-                        found_done = 1;
-                    }
-                }
-                
-                // 去除末尾的空格
-                size_t len = strlen(full_command);
-                while (len > 0 && full_command[len - 1] == ' ') {
-                    full_command[--len] = '\0';
-                }
-                
-                // 使用完整命令替换 line
-                if (strlen(full_command) < sizeof(line)) {
-                    strcpy(line, full_command);
-                } else {
-                    // 命令太长，截断
-                    strncpy(line, full_command, sizeof(line) - 1);
-                    line[sizeof(line) - 1] = '\0';
-                }
+        command.len = 0;
+        if (command_append(&command, line, strlen(line)) != 0) {
+            perror("xshell");
+            break;
+        }
+        
+        // for 循环还没写完（缺少 do / done）或 here-document 还没有结束标记时继续读取下一行
+        // （here-document 开始之后，后面的行都用换行连接，结束标记必须单独一行）
+        int raw = 0;
+        int more;
+        while ((more = parse_is_incomplete(command.text)) != PARSE_COMPLETE) {
+            // 继续提示符为 "> "（第一行已经复制到 command，行缓冲区可以复用）
+            if (read_input_line(ctx, in, &line, &line_capacity, "> ") == NULL) {
+                break;  // Ctrl+D 退出
+            }
+            line[strcspn(line, "\n")] = '\0';
+            
+            raw |= (more == PARSE_MORE_HEREDOC);
+            if (append_continuation_line(&command, line, raw) != 0) {
+                fprintf(stderr, "xshell: command too long\n");
+                break;
             }
         }
         
-        // 添加命令到历史记录
+        // 添加命令到历史记录（只记录交互输入）
         // 说明：在执行命令前记录，即使命令失败也能保留历史
-        // 功能：自动过滤空行和重复命令
-        history_add(line);
+        // 功能：自动过滤空行和重复命令；含 here-document 的多行命令不记录（历史文件一行一条）
+        if (ctx->interactive && !raw) {
+            history_add(command.text);
+            frecency_add_command(command.text);     // 行内建议的模型（记在当前目录下）
+        }
+        
+        // 执行用户输入的命令，执行完后把命令（带耗时和退出状态）追加到历史文件
+        int status = execute_command_line(command.text, ctx);
+        if (ctx->interactive && !raw) {
+            history_finish(status);
+        }
         
-        // 执行用户输入的命令
-        execute_command_line(line, ctx);
+        // 工作目录变化了：记录到目录模型（xcd -z 使用）
+        if (ctx->interactive && strcmp(last_cwd, ctx->cwd) != 0) {
+            strcpy(last_cwd, ctx->cwd);
+            frecency_visit_dir(ctx->cwd);
+        }
         
         // 确保输出缓冲区被刷新
         fflush(stdout);
     }
+    free(line);
+    free(command.text);
+}
+
+// 执行启动配置文件 ~/.xshellrc（只在交互模式下执行）
+// 说明：通过脚本缓存执行（见 script.c），与 xsource 一样报告出错的行号
+static void load_rc_file(ShellContext *ctx) {
+    char path[PATH_MAX];
+    if (snprintf(path, sizeof(path), "%s/.xshellrc", ctx->home_dir) >= (int)sizeof(path)) {
+        return;
+    }
+    if (script_source(ctx, path, "xshellrc") < 0 && errno != ENOENT) {
+        XSHELL_LOG_PERROR(ctx, path);
+    }
+}
+
+// Shell 主循环（核心逻辑）
+void shell_loop(ShellContext *ctx) {
+    if (ctx->interactive) {
+        // 初始化历史记录系统
+        // 功能：加载保存的历史记录（从 ~/.xshell_history）
+        history_init();
+        
+        // 初始化行内建议和 xcd -z 的模型（目录得分保存在历史文件旁边）
+        char dirs_file[PATH_MAX + 16];
+        snprintf(dirs_file, sizeof(dirs_file), "%s/.xshell_dirs", ctx->cwd);
+        frecency_init(dirs_file);
+        frecency_visit_dir(ctx->cwd);
+        
+        // 执行启动配置文件 ~/.xshellrc（不存在时忽略）
+        load_rc_file(ctx);
+        
+        // 显示欢迎信息（Shell 启动时打印一次）
+        printf("######## Welcome to XShell! ########\n");
+    } else {
+        // 管道输入：按大块读取（必须在第一次读取之前设置）
+        input_use_block_buffer(stdin);
+    }
     
-    // 退出循环后，显示退出信息
-    printf("######## Quiting XShell ########\n");
-    
-    // 清理历史记录系统
-    // 功能：保存历史记录到文件并释放内存
-    history_cleanup();
+    run_input(ctx, stdin);
     
-    // 清理别名系统
-    // 功能：释放别名表内存
-    alias_cleanup();
+    if (ctx->interactive) {
+        // 退出循环后，显示退出信息
+        printf("######## Quiting XShell ########\n");
+        
+        // 清理历史记录系统
+        // 功能：保存历史记录到文件并释放内存
+        history_cleanup();
+        frecency_cleanup();
+    }
+}
+
+// 执行脚本文件
+int shell_run_file(ShellContext *ctx, const char *path) {
+    FILE *script = fopen(path, "r");
+    if (script == NULL) {
+        XSHELL_LOG_PERROR(ctx, path);
+        return 127;
+    }
+    input_use_block_buffer(script);
     
-    // 清理全局上下文指针
-    // 说明：将全局指针设置为 NULL，避免悬空指针（dangling pointer）
-    // 重要性：如果以后 shell_loop 可能被多次调用，这可以防止使用已释放的内存
-    g_shell_ctx = NULL;
+    ctx->interactive = 0;
+    run_input(ctx, script);
+    fclose(script);
+    return ctx->last_exit_status;
 }
 
-// 显示命令提示符
+// 生成命令提示符
 // 格式：[\home\user\]# 或 [~]#（如果在主目录）
-void display_prompt(ShellContext *ctx) {
+void format_prompt(ShellContext *ctx, char *buffer, size_t size) {
     char display_path[PATH_MAX];  // 声明临时字符数组，用于存储修改后的路径
     
     // 检查是否在主目录，如果是则显示 ~
@@ -235,395 +337,69 @@ void display_prompt(ShellContext *ctx) {
         }
     }
     
-    // 打印提示符到标准输出
-    printf("[%s]# ", display_path);  // 格式：[路径]#（末尾有空格）
-    fflush(stdout);  // 立即刷新标准输出缓冲区（确保提示符立即显示，不等换行）
+    // 格式：[路径]#（末尾有空格）
+    snprintf(buffer, size, "[%s]# ", display_path);
 }
 
-// 处理 for 循环
-// 语法：for i in {1..100}; do command done
-// 或：for i in word1 word2 word3; do command done
-static int execute_for_loop(const char *line, ShellContext *ctx) {
-    // 跳过 "for" 关键字
-    const char *p = line;
-    while (*p == ' ' || *p == '\t') p++;  // 跳过前导空白
-    if (strncmp(p, "for ", 4) != 0) {
-        return 0;  // 不是 for 循环
-    }
-    p += 4;  // 跳过 "for "
-    
-    // 提取循环变量名
-    while (*p == ' ' || *p == '\t') p++;  // 跳过空白
-    const char *var_start = p;
-    while (*p != '\0' && *p != ' ' && *p != '\t' && *p != ';') p++;
-    if (p == var_start) {
-        return 0;  // 没有变量名
-    }
-    size_t var_len = p - var_start;
-    char *var_name = malloc(var_len + 1);
-    if (var_name == NULL) {
-        return -1;
-    }
-    strncpy(var_name, var_start, var_len);
-    var_name[var_len] = '\0';
-    
-    // 跳过 "in"
-    while (*p == ' ' || *p == '\t') p++;
-    if (strncmp(p, "in ", 3) != 0) {
-        free(var_name);
-        return 0;  // 不是 for 循环
-    }
-    p += 3;
-    
-    // 提取列表（直到分号或 do）
-    while (*p == ' ' || *p == '\t') p++;
-    const char *list_start = p;
-    const char *list_end = NULL;
-    
-    // 查找分号或 do
-    const char *semicolon = strchr(p, ';');
-    const char *do_pos = strstr(p, " do");
-    if (semicolon != NULL && (do_pos == NULL || semicolon < do_pos)) {
-        list_end = semicolon;
-        p = semicolon + 1;
-    } else if (do_pos != NULL) {
-        list_end = do_pos;
-        p = do_pos;
-    } else {
-        free(var_name);
-        return 0;  // 没有找到分号或 do
-    }
-    
-    // 提取列表字符串
-    size_t list_len = list_end - list_start;
-    char *list_str = malloc(list_len + 1);
-    if (list_str == NULL) {
-        free(var_name);
-        return -1;
-    }
-    strncpy(list_str, list_start, list_len);
-    list_str[list_len] = '\0';
-    
-    // 展开列表（支持大括号展开）
-    char **expanded_list = NULL;
-    int list_count = 0;
-    
-    // 检查是否包含大括号
-    if (strchr(list_str, '{') != NULL) {
-        // 使用 expand_brace 展开（从 executor.c）
-        char** expand_brace(const char *arg);
-        expanded_list = expand_brace(list_str);
-        if (expanded_list != NULL) {
-            while (expanded_list[list_count] != NULL) {
-                list_count++;
-            }
-        }
-    } else {
-        // 简单的空格分隔列表
-        // 计算单词数量
-        const char *q = list_str;
-        int word_count = 0;
-        int in_word = 0;
-        while (*q != '\0') {
-            if (*q == ' ' || *q == '\t') {
-                if (in_word) {
-                    in_word = 0;
-                }
-            } else {
-                if (!in_word) {
-                    word_count++;
-                    in_word = 1;
-                }
-            }
-            q++;
-        }
-        
-        if (word_count > 0) {
-            expanded_list = malloc((word_count + 1) * sizeof(char*));
-            if (expanded_list != NULL) {
-                q = list_str;
-                int idx = 0;
-                in_word = 0;
-                const char *word_start = NULL;
-                while (*q != '\0') {
-                    if (*q == ' ' || *q == '\t') {
-                        if (in_word) {
-                            size_t word_len = q - word_start;
-                            expanded_list[idx] = malloc(word_len + 1);
-                            if (expanded_list[idx] != NULL) {
-                                strncpy(expanded_list[idx], word_start, word_len);
-                                expanded_list[idx][word_len] = '\0';
-                                idx++;
-                            }
-                            in_word = 0;
-                        }
-                    } else {
-                        if (!in_word) {
-                            word_start = q;
-                            in_word = 1;
-                        }
-                    }
-                    q++;
-                }
-                if (in_word) {
-                    size_t word_len = q - word_start;
-                    expanded_list[idx] = malloc(word_len + 1);
-                    if (expanded_list[idx] != NULL) {
-                        strncpy(expanded_list[idx], word_start, word_len);
-                        expanded_list[idx][word_len] = '\0';
-                        idx++;
-                    }
-                }
-                expanded_list[idx] = NULL;
-                list_count = idx;
-            }
-        }
-    }
-    
-    free(list_str);
-    
-    if (expanded_list == NULL || list_count == 0) {
-        free(var_name);
-        return 0;  // 无法展开列表
-    }
-    
-    // 跳过 "do"
-    while (*p == ' ' || *p == '\t') p++;
-    if (strncmp(p, "do", 2) != 0) {
-        // 释放列表
-        for (int i = 0; expanded_list[i] != NULL; i++) {
-            free(expanded_list[i]);
-        }
-        free(expanded_list);
-        free(var_name);
-        return 0;
-    }
-    p += 2;
-    
-    // 提取循环体（直到 done）
-    while (*p == ' ' || *p == '\t') p++;
-    const char *body_start = p;
-    
-    // 查找 "done"，但要确保是完整的单词
-    const char *done_pos = NULL;
-    const char *search = p;
-    while ((search = strstr(search, "done")) != NULL) {
-        // 检查 "done" 前后是否是单词边界
-        if ((search == p || search[-1] == ' ' || search[-1] == '\t' || search[-1] == ';') &&
-            (search[4] == '\0' || search[4] == ' ' || search[4] == '\t' || search[4] == ';' || search[4] == '\n')) {
-            done_pos = search;
-            break;
-        }
-        search += 4;
-    }
-    
-    if (done_pos == NULL) {
-        // 释放列表
-        for (int i = 0; expanded_list[i] != NULL; i++) {
-            free(expanded_list[i]);
-        }
-        free(expanded_list);
-        free(var_name);
-        return 0;
-    }
-    
-    size_t body_len = done_pos - body_start;
-    char *body_template = malloc(body_len + 1);
-    if (body_template == NULL) {
-        // 释放列表
-        for (int i = 0; expanded_list[i] != NULL; i++) {
-            free(expanded_list[i]);
-        }
-        free(expanded_list);
-        free(var_name);
-        return -1;
-    }
-    strncpy(body_template, body_start, body_len);
-    body_template[body_len] = '\0';
-    
-    // 去除循环体末尾的空白字符和分号
-    while (body_len > 0 && (body_template[body_len - 1] == ' ' || 
-                            body_template[body_len - 1] == '\t' ||
-                            body_template[body_len - 1] == ';')) {
-        body_template[--body_len] = '\0';
-    }
-    
-    // 对每个列表值执行循环体
-    int last_status = 0;
-    for (int i = 0; i < list_count; i++) {
-        // 替换循环变量
-        // 计算需要的空间：body_template + 变量值的最大长度
-        size_t max_var_len = strlen(expanded_list[i]) + 10;  // 变量值长度 + 一些余量
-        char *body = malloc(strlen(body_template) + max_var_len + 1);
-        if (body == NULL) {
-            break;
-        }
-        
-        // 简单的字符串替换：将 $var_name 替换为 expanded_list[i]
-        const char *src = body_template;
-        char *dst = body;
-        while (*src != '\0') {
-            if (*src == '$' && strncmp(src + 1, var_name, strlen(var_name)) == 0) {
-                char next_char = src[1 + strlen(var_name)];
-                // 检查变量名后是否是空白字符、结束符、引号或其他分隔符
-                if (next_char == '\0' || next_char == ' ' || next_char == '\t' || 
-                    next_char == ';' || next_char == '|' || next_char == '&' ||
-                    next_char == '<' || next_char == '>' || next_char == '"' ||
-                    next_char == '\'' || next_char == ')' || next_char == '}') {
-                    // 找到变量，替换
-                    size_t var_value_len = strlen(expanded_list[i]);
-                    if (dst + var_value_len >= body + strlen(body_template) + max_var_len) {
-                        // 缓冲区不足，重新分配
-                        size_t current_len = dst - body;
-                        size_t new_size = current_len + var_value_len + 100;
-                        char *new_body = realloc(body, new_size);
-                        if (new_body == NULL) {
-                            break;
-                        }
-                        body = new_body;
-                        dst = body + current_len;
-                    }
-                    strncpy(dst, expanded_list[i], var_value_len);
-                    dst += var_value_len;
-                    src += 1 + strlen(var_name);
-                } else {
-                    // 不是变量，直接复制
-                    *dst++ = *src++;
-                }
-            } else {
-                *dst++ = *src++;
-            }
-        }
-        *dst = '\0';
-        
-        // 执行循环体
-        int status = execute_command_line(body, ctx);
-        if (status != 0) {
-            last_status = status;
-        }
-        
-        free(body);
-    }
-    
-    // 释放资源
-    free(body_template);
-    for (int i = 0; expanded_list[i] != NULL; i++) {
-        free(expanded_list[i]);
-    }
-    free(expanded_list);
-    free(var_name);
-    
-    return (last_status == 0) ? 1 : -1;  // 1 表示成功处理，-1 表示有错误
-}
+// 命令行内存池：解析、展开一行命令所需的内存都从这里分配，执行完整体回退
+// 说明：用 mark/release 而不是清空，for 循环体、xsource 嵌套执行命令行时互不影响；
+//       第一个内存块一直保留，之后的命令行通常不再调用 malloc
+static Arena g_line_arena;
+
+static int run_command_line(const char *line, ShellContext *ctx, Arena *arena);
 
-// 执行命令行（支持 && 和 ||）
+// 执行命令行（支持 && || ; & 命令列表）
 int execute_command_line(const char *line, ShellContext *ctx) {
     if (line == NULL || *line == '\0') {
         return 0;
     }
     
-    // 检查是否是 for 循环
-    int for_status = execute_for_loop(line, ctx);
-    if (for_status != 0) {
-        ctx->last_exit_status = (for_status == 1) ? 0 : -1;
-        return ctx->last_exit_status;
-    }
-    
-    // 简单检查：如果没有 && 或 ||，直接解析并执行
-    char *and_check = strstr(line, "&&");
-    char *or_check = strstr(line, "||");
-    
-    if (and_check == NULL && or_check == NULL) {
-        // 没有命令链，直接执行
-        Command *cmd = parse_command(line);
-        if (cmd == NULL) {
-            return -1;
-        }
-        int status = execute_command(cmd, ctx);
-        ctx->last_exit_status = status;
-        free_command(cmd);
-        return status;
-    }
-    
-    // 有命令链，需要分割处理
-    char *line_copy = strdup(line);
-    if (line_copy == NULL) {
-        return -1;
-    }
-    
-    int last_status = 0;
-    char *current = line_copy;
-    
-    while (current != NULL && *current != '\0') {
-        // 跳过前导空白
-        while (*current == ' ' || *current == '\t') current++;
-        if (*current == '\0') break;
-        
-        // 查找下一个 && 或 ||
-        char *and_pos = strstr(current, "&&");
-        char *or_pos = strstr(current, "||");
-        
-        char *sep = NULL;
-        int sep_type = 0;  // 0=无, 1=&&, 2=||
-        
-        // 找最近的分隔符
-        if (and_pos != NULL && (or_pos == NULL || and_pos < or_pos)) {
-            sep = and_pos;
-            sep_type = 1;
-        } else if (or_pos != NULL) {
-            sep = or_pos;
-            sep_type = 2;
-        }
-        
-        // 获取下一段命令的起始位置
-        char *next = NULL;
-        if (sep != NULL) {
-            *sep = '\0';
-            next = sep + 2;
-        }
-        
-        // 去除当前命令尾部空白
-        size_t len = strlen(current);
-        while (len > 0 && (current[len-1] == ' ' || current[len-1] == '\t')) {
-            current[--len] = '\0';
-        }
-        
-        // 执行当前命令
-        if (*current != '\0') {
-            Command *cmd = parse_command(current);
-            if (cmd != NULL) {
-                last_status = execute_command(cmd, ctx);
-                ctx->last_exit_status = last_status;
-                free_command(cmd);
-            } else {
-                last_status = -1;
-                ctx->last_exit_status = last_status;
-            }
-        }
-        
-        // 根据分隔符类型和结果决定是否继续
-        if (sep_type == 1 && last_status != 0) {
-            // && 且失败，停止执行后续命令
-            break;
-        } else if (sep_type == 2 && last_status == 0) {
-            // || 且成功，停止执行后续命令
-            break;
+    ArenaMark mark = arena_mark(&g_line_arena);
+    int status = run_command_line(line, ctx, &g_line_arena);
+    arena_release(&g_line_arena, mark);
+    wildcard_cache_clear();                     // 目录内容只在同一行命令中缓存
+    return status;
+}
+
+// 在内存池 arena 中解析并执行一行命令
+static int run_command_line(const char *line, ShellContext *ctx, Arena *arena) {
+    // 整行一次解析成语法树（命令列表、管道、重定向），再交给执行器
+    char error[256];
+    Command *cmd = parse_command_quiet(line, arena, error, sizeof(error));
+    if (cmd == NULL) {
+        if (error[0] == '\0') {
+            return 0;                           // 空行或注释行
         }
-        
-        current = next;
+        // 语法错误：$? 为 2，-c 和脚本以失败状态退出
+        fprintf(stderr, "%s\n", error);
+        ctx->last_exit_status = SYNTAX_ERROR_STATUS;
+        return SYNTAX_ERROR_STATUS;
     }
-    
-    free(line_copy);
-    return last_status;
+    int status = execute_command(cmd, ctx);
+    ctx->last_exit_status = status;
+    return status;
 }
 
 // 清理 Shell 资源
 void cleanup_shell(ShellContext *ctx) {
+    // 释放命令行内存池
+    arena_destroy(&g_line_arena);
+    
     // 关闭日志文件
     if (ctx->log_file != NULL) {
         fclose(ctx->log_file);
         ctx->log_file = NULL;
     }
+    
+    // 释放缓存的脚本编译结果
+    script_cache_clear();
+    
+    // 清理别名系统
+    // 功能：释放别名表内存
+    alias_cleanup();
+    
+    // 释放 Shell 变量表
+    vars_destroy(&ctx->vars);
 }
 
 // 日志记录函数
@@ -0,0 +1,66 @@
+// ============================================
+// for 循环基准测试
+// ============================================
+// 用法：obj/bench/bench_for [循环次数] [xshell路径]
+// 说明：
+//   让 xshell 执行
+//     for i in {1..N}; do xecho $i > /dev/null; done
+//   输出总耗时、每次迭代的平均耗时（微秒）和 xshell 的最大内存占用。
+//   循环体只解析一次，每次迭代只绑定循环变量再执行；
+//   原来每次迭代都要替换文本并重新解析整个循环体。
+//   范围按需生成，最大内存占用不随循环次数增长。
+//   第二个参数可以指定其他版本的 xshell，方便对比改动前后。
+// ============================================
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#define SCRIPT_FILE "/tmp/xshell_bench_for.sh"
+
+// 获取单调时钟（秒）
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    int count = (argc > 1) ? atoi(argv[1]) : 100000;
+    const char *xshell = (argc > 2) ? argv[2] : "./xshell";
+
+    if (access(xshell, X_OK) != 0) {
+        fprintf(stderr, "bench_for: %s not found, run make first\n", xshell);
+        return 1;
+    }
+
+    FILE *script = fopen(SCRIPT_FILE, "w");
+    if (script == NULL) {
+        perror(SCRIPT_FILE);
+        return 1;
+    }
+    fprintf(script, "for i in {1..%d}; do xecho $i > /dev/null; done\n", count);
+    fclose(script);
+
+    char command[512];
+    snprintf(command, sizeof(command), "%s < " SCRIPT_FILE " > /dev/null 2>&1", xshell);
+    double start = now_sec();
+    if (system(command) != 0) {
+        fprintf(stderr, "bench_for: %s failed\n", xshell);
+    }
+    double elapsed = now_sec() - start;
+
+    printf("bench_for: for i in {1..%d}; do xecho $i > /dev/null; done (%s)\n", count, xshell);
+    struct rusage usage;
+    getrusage(RUSAGE_CHILDREN, &usage);
+    printf("  total %.2f s  %8.2f us/iteration  max RSS %ld KB\n",
+           elapsed, elapsed * 1e6 / count, usage.ru_maxrss);
+
+    unlink(SCRIPT_FILE);
+    return 0;
+}
@@ -0,0 +1,125 @@
+// ============================================
+// 历史搜索（Ctrl+R）基准测试
+// ============================================
+// 用法：obj/bench/bench_history [历史条数]
+// 说明：
+//   在临时目录中初始化历史记录（XHISTSIZE=条数），加入若干条模拟的命令，
+//   分别用逐条 strstr（原来的 Ctrl+R 实现）和 history_search()（三字母索引）
+//   查找一组查询，其中包括很少出现和不存在的命令。
+//   另外统计第一次搜索建立索引的耗时，以及模拟逐字输入一个查询的总耗时。
+// ============================================
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "history.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// 查询（前两个很常见，后面的很少出现或不存在）
+static const char *g_queries[] = { "make", "git st", "deploy-7777", "ssh host-9", "no-such-command" };
+#define QUERY_COUNT (int)(sizeof(g_queries) / sizeof(g_queries[0]))
+
+// 模拟的命令模板
+static const char *g_templates[] = {
+    "make -j8 target%d", "git status --short %d", "xls -l /var/log/app%d",
+    "xgrep -n ERROR build%d.log", "ssh host-%d uptime", "xcat notes%d.txt | xwc -l",
+};
+#define TEMPLATE_COUNT (int)(sizeof(g_templates) / sizeof(g_templates[0]))
+
+// 获取单调时钟（秒）
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 原来的实现：从新到旧逐条 strstr
+static int linear_search(const char *query) {
+    for (int i = history_count() - 1; i >= 0; i--) {
+        if (strstr(history_get(i), query) != NULL) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    int entries = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+    // 历史文件写在临时目录中，结束后删除
+    char dir[] = "/tmp/bench_history.XXXXXX";
+    char cwd[4096];
+    if (mkdtemp(dir) == NULL || getcwd(cwd, sizeof(cwd)) == NULL || chdir(dir) != 0) {
+        perror("bench_history");
+        return 1;
+    }
+    char size[32];
+    snprintf(size, sizeof(size), "%d", entries);
+    setenv("XHISTSIZE", size, 1);
+    history_init();
+
+    double start = now_sec();
+    char line[128];
+    for (int i = 0; i < entries; i++) {
+        int n = i % 9973;
+        if (i == entries / 10) {
+            snprintf(line, sizeof(line), "./deploy-7777 --prod");   // 只出现一次，而且很旧
+        } else {
+            snprintf(line, sizeof(line), g_templates[i % TEMPLATE_COUNT], n);
+        }
+        history_add(line);
+    }
+    double add_sec = now_sec() - start;
+    printf("bench_history: %d entries, %d queries\n", history_count(), QUERY_COUNT);
+    printf("  history_add          %8.3f s\n", add_sec);
+
+    start = now_sec();
+    history_search("xyz", history_count());      // 建立索引
+    printf("  index build          %8.3f s\n", now_sec() - start);
+
+    volatile int sink = 0;
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        int rounds = 10;
+        start = now_sec();
+        for (int r = 0; r < rounds; r++) {
+            sink += linear_search(g_queries[q]);
+        }
+        double linear_us = (now_sec() - start) * 1e6 / rounds;
+
+        start = now_sec();
+        for (int r = 0; r < rounds; r++) {
+            sink += history_search(g_queries[q], history_count());
+        }
+        double indexed_us = (now_sec() - start) * 1e6 / rounds;
+        printf("  %-16s strstr %10.1f us   trigram %8.1f us\n", g_queries[q], linear_us, indexed_us);
+    }
+
+    // 逐字输入 "deploy-7777"：每个按键都重新查找（与 Ctrl+R 的交互相同）
+    const char *typed = "deploy-7777";
+    char query[32];
+    start = now_sec();
+    for (size_t len = 1; len <= strlen(typed); len++) {
+        memcpy(query, typed, len);
+        query[len] = '\0';
+        sink += linear_search(query);
+    }
+    double linear_ms = (now_sec() - start) * 1e3;
+    start = now_sec();
+    for (size_t len = 1; len <= strlen(typed); len++) {
+        memcpy(query, typed, len);
+        query[len] = '\0';
+        sink += history_search(query, history_count());
+    }
+    double indexed_ms = (now_sec() - start) * 1e3;
+    printf("  typing \"%s\"   strstr %8.2f ms   trigram %8.2f ms\n", typed, linear_ms, indexed_ms);
+
+    history_cleanup();
+    unlink(".xshell_history");
+    if (chdir(cwd) == 0) {
+        rmdir(dir);
+    }
+    return 0;
+}
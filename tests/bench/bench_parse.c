@@ -0,0 +1,73 @@
+// ============================================
+// 命令解析吞吐量基准测试
+// ============================================
+// 用法：obj/bench/bench_parse [重复次数]
+// 说明：
+//   反复解析一组典型命令行（管道、重定向、引号、&& / || / ; 命令链），
+//   统计每行平均耗时和每秒解析的字节数。
+//   解析结果放在同一个内存池中，每行解析后回退（与 Shell 主循环相同）。
+// ============================================
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 测试用的命令行
+static const char *g_corpus[] = {
+    "xls -la /tmp",
+    "xecho \"hello world\" $HOME ~/file.txt >> /tmp/out.txt",
+    "xcat /etc/passwd | xgrep root | xcut -d : -f 1,7 | xsort | xuniq -c",
+    "gcc -Wall -Wextra -std=c99 -g -I./include -c src/parser.c -o obj/parser.o",
+    "NAME=\"value with spaces\"",
+    "xmkdir -p build && xcd build && xecho ok || xecho failed",
+    "xgrep -n 'a && b || c' notes.txt 2> /dev/null | xhead -n 5",
+    "xtouch a.txt ; xcp a.txt b.txt ; xrm a.txt",
+    "xsort < input.txt > sorted.txt 2>> errors.log",
+    "xecho 'single $HOME' \"double $USER\" mixed\\ word # trailing comment",
+    "sleep 10 &",
+    "xfind . -name \"*.c\" | xxargs xgrep -l main | xwc -l",
+};
+#define CORPUS_SIZE (int)(sizeof(g_corpus) / sizeof(g_corpus[0]))
+
+// 获取单调时钟（秒）
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 200000;
+
+    size_t corpus_bytes = 0;
+    for (int j = 0; j < CORPUS_SIZE; j++) {
+        corpus_bytes += strlen(g_corpus[j]);
+    }
+
+    printf("bench_parse: %d command lines (%zu bytes) x %d\n", CORPUS_SIZE, corpus_bytes, iterations);
+
+    Arena arena;
+    arena_init(&arena, 0);
+    int failed = 0;
+    double start = now_sec();
+    for (int i = 0; i < iterations; i++) {
+        for (int j = 0; j < CORPUS_SIZE; j++) {
+            ArenaMark mark = arena_mark(&arena);
+            if (parse_command_arena(g_corpus[j], &arena) == NULL) {
+                failed++;
+            }
+            arena_release(&arena, mark);
+        }
+    }
+    double elapsed = now_sec() - start;
+    arena_destroy(&arena);
+
+    double lines = (double)iterations * CORPUS_SIZE;
+    printf("  %7.1f ns/line  %7.1f MB/s  (%d failed)\n",
+           elapsed * 1e9 / lines, corpus_bytes * (double)iterations / elapsed / 1e6, failed);
+    return 0;
+}
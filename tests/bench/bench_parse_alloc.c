@@ -0,0 +1,100 @@
+// ============================================
+// 命令解析内存分配次数基准测试
+// ============================================
+// 用法：obj/bench/bench_parse_alloc [重复次数]
+// 说明：
+//   替换 malloc/calloc/realloc/free，统计解析一行命令需要调用多少次分配函数，
+//   以及平均耗时。对比两种用法：
+//     parse_command + free_command      每行一个内存池（一次 malloc）
+//     parse_command_arena + mark/release 复用同一个内存池（Shell 主循环的做法）
+// ============================================
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// glibc 导出的原始分配函数
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static unsigned long g_alloc_calls = 0;     // 分配函数调用次数
+
+void *malloc(size_t size) {
+    g_alloc_calls++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    g_alloc_calls++;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    g_alloc_calls++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+    __libc_free(ptr);
+}
+
+// 测试用的命令行
+static const char *g_lines[] = {
+    "xls -la /tmp",
+    "xecho \"hello world\" $HOME ~/file.txt >> /tmp/out.txt",
+    "xcat /etc/passwd | xgrep root | xcut -d : -f 1,7 | xsort | xuniq -c",
+    "gcc -Wall -Wextra -std=c99 -g -I./include -c src/parser.c -o obj/parser.o",
+    "NAME=\"value with spaces\"",
+};
+#define LINE_COUNT (int)(sizeof(g_lines) / sizeof(g_lines[0]))
+
+// 获取单调时钟（秒）
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 200000;
+
+    printf("bench_parse_alloc: %d command lines x %d\n", LINE_COUNT, iterations);
+
+    // 方式1：parse_command + free_command
+    unsigned long before = g_alloc_calls;
+    double start = now_sec();
+    for (int i = 0; i < iterations; i++) {
+        for (int j = 0; j < LINE_COUNT; j++) {
+            free_command(parse_command(g_lines[j]));
+        }
+    }
+    double elapsed = now_sec() - start;
+    double lines = (double)iterations * LINE_COUNT;
+    printf("  parse_command       : %6.2f allocs/line  %7.1f ns/line\n",
+           (g_alloc_calls - before) / lines, elapsed * 1e9 / lines);
+
+    // 方式2：复用内存池
+    Arena arena;
+    arena_init(&arena, 0);
+    before = g_alloc_calls;
+    start = now_sec();
+    for (int i = 0; i < iterations; i++) {
+        for (int j = 0; j < LINE_COUNT; j++) {
+            ArenaMark mark = arena_mark(&arena);
+            parse_command_arena(g_lines[j], &arena);
+            arena_release(&arena, mark);
+        }
+    }
+    elapsed = now_sec() - start;
+    printf("  parse_command_arena : %6.2f allocs/line  %7.1f ns/line\n",
+           (g_alloc_calls - before) / lines, elapsed * 1e9 / lines);
+    arena_destroy(&arena);
+
+    return 0;
+}
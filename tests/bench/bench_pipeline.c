@@ -0,0 +1,113 @@
+// ============================================
+// 管道吞吐量基准测试：线程阶段 vs fork 阶段
+// ============================================
+// 用法：obj/bench/bench_pipeline [日志大小MB] [短管道次数]
+// 说明：
+//   生成一个日志文件，然后让 xshell 执行纯内置命令管道：
+//     xcat log | xgrep ERR | xcut -d , -f 3 | xwc -l
+//   分别在 XSHELL_PIPELINE=thread（默认，内存环形缓冲区）和
+//   XSHELL_PIPELINE=fork（每个阶段一个子进程 + 内核管道）下运行，
+//   输出耗时和吞吐量（MB/s）。
+//   另外测量大量短管道（xecho | xgrep | xwc）的平均延迟，
+//   这时 fork 的固定开销占主导。
+// 注意：需要先 make 生成 ./xshell
+// ============================================
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOG_FILE    "/tmp/xshell_bench_pipeline.log"
+#define SCRIPT_FILE "/tmp/xshell_bench_pipeline.sh"
+
+// 获取单调时钟（秒）
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 生成约 size_mb 大小的日志文件，每 10 行有一行 ERR
+static size_t make_log(size_t size_mb) {
+    FILE *fp = fopen(LOG_FILE, "w");
+    if (fp == NULL) {
+        perror(LOG_FILE);
+        exit(1);
+    }
+    size_t total = 0;
+    for (long i = 0; total < size_mb * 1024 * 1024; i++) {
+        int n = fprintf(fp, "%ld,%s,/api/v1/items/%ld,took %ldms\n",
+                        i, (i % 10 == 0) ? "ERR" : "INFO", i % 1000, i % 97);
+        total += (size_t)n;
+    }
+    fclose(fp);
+    return total;
+}
+
+// 写入测试脚本
+static void write_script(const char *line, int repeat) {
+    FILE *script = fopen(SCRIPT_FILE, "w");
+    if (script == NULL) {
+        perror(SCRIPT_FILE);
+        exit(1);
+    }
+    for (int i = 0; i < repeat; i++) {
+        fprintf(script, "%s\n", line);
+    }
+    fclose(script);
+}
+
+// 在指定模式下运行一次测试脚本，返回耗时（秒）
+static double run(const char *mode) {
+    char command[256];
+    snprintf(command, sizeof(command),
+             "XSHELL_PIPELINE=%s ./xshell < " SCRIPT_FILE " > /dev/null 2>&1", mode);
+    double start = now_sec();
+    if (system(command) != 0) {
+        fprintf(stderr, "bench_pipeline: xshell failed (%s mode)\n", mode);
+    }
+    return now_sec() - start;
+}
+
+int main(int argc, char *argv[]) {
+    size_t size_mb = (argc > 1) ? (size_t)atoi(argv[1]) : 200;
+    int short_runs = (argc > 2) ? atoi(argv[2]) : 2000;
+
+    if (access("./xshell", X_OK) != 0) {
+        fprintf(stderr, "bench_pipeline: ./xshell not found, run make first\n");
+        return 1;
+    }
+
+    // 测试1：大文件吞吐量
+    size_t bytes = make_log(size_mb);
+    write_script("xcat " LOG_FILE " | xgrep ERR | xcut -d , -f 3 | xwc -l", 1);
+
+    printf("bench_pipeline: xcat | xgrep | xcut | xwc over %.1f MB\n", bytes / 1048576.0);
+
+    double thread_sec = run("thread");
+    double fork_sec = run("fork");
+    double mb = bytes / 1048576.0;
+
+    printf("  thread stages: %8.3f s  (%7.1f MB/s)\n", thread_sec, mb / thread_sec);
+    printf("  fork stages  : %8.3f s  (%7.1f MB/s)\n", fork_sec, mb / fork_sec);
+    printf("  speedup      : %8.2fx\n", fork_sec / thread_sec);
+
+    // 测试2：短管道延迟
+    write_script("xecho hello world | xgrep world | xwc -l", short_runs);
+    printf("bench_pipeline: %d short pipelines (xecho | xgrep | xwc)\n", short_runs);
+
+    thread_sec = run("thread");
+    fork_sec = run("fork");
+
+    printf("  thread stages: %8.1f us/pipeline\n", thread_sec * 1e6 / short_runs);
+    printf("  fork stages  : %8.1f us/pipeline\n", fork_sec * 1e6 / short_runs);
+    printf("  speedup      : %8.2fx\n", fork_sec / thread_sec);
+
+    unlink(LOG_FILE);
+    unlink(SCRIPT_FILE);
+    return 0;
+}
@@ -0,0 +1,79 @@
+// ============================================
+// 内置命令重定向基准测试
+// ============================================
+// 用法：obj/bench/bench_redirect [命令条数] [xshell路径]
+// 说明：
+//   让 xshell 执行一个由 N 行 "xecho foo >> 文件" 组成的脚本，
+//   再执行 N 行不带重定向的 "xecho foo" 作为对照，
+//   输出每条命令的平均耗时（微秒）。
+//   重定向在 Shell 进程内完成后，两者应当接近；
+//   原来每条带重定向的内置命令都要 fork 一次子进程。
+//   第二个参数可以指定其他版本的 xshell，方便对比改动前后。
+// ============================================
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define OUT_FILE    "/tmp/xshell_bench_redirect.out"
+#define SCRIPT_FILE "/tmp/xshell_bench_redirect.sh"
+
+// 获取单调时钟（秒）
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 写入 repeat 行相同命令的测试脚本
+static void write_script(const char *line, int repeat) {
+    FILE *script = fopen(SCRIPT_FILE, "w");
+    if (script == NULL) {
+        perror(SCRIPT_FILE);
+        exit(1);
+    }
+    for (int i = 0; i < repeat; i++) {
+        fprintf(script, "%s\n", line);
+    }
+    fclose(script);
+}
+
+// 运行一次测试脚本，返回耗时（秒）
+static double run(const char *xshell) {
+    char command[512];
+    snprintf(command, sizeof(command), "%s < " SCRIPT_FILE " > /dev/null 2>&1", xshell);
+    double start = now_sec();
+    if (system(command) != 0) {
+        fprintf(stderr, "bench_redirect: %s failed\n", xshell);
+    }
+    return now_sec() - start;
+}
+
+int main(int argc, char *argv[]) {
+    int count = (argc > 1) ? atoi(argv[1]) : 10000;
+    const char *xshell = (argc > 2) ? argv[2] : "./xshell";
+
+    if (access(xshell, X_OK) != 0) {
+        fprintf(stderr, "bench_redirect: %s not found, run make first\n", xshell);
+        return 1;
+    }
+
+    unlink(OUT_FILE);
+    write_script("xecho foo >> " OUT_FILE, count);
+    double redirect_sec = run(xshell);
+
+    write_script("xecho foo", count);
+    double plain_sec = run(xshell);
+
+    printf("bench_redirect: %d builtin commands (%s)\n", count, xshell);
+    printf("  xecho foo >> file : %8.1f us/command\n", redirect_sec * 1e6 / count);
+    printf("  xecho foo         : %8.1f us/command\n", plain_sec * 1e6 / count);
+
+    unlink(OUT_FILE);
+    unlink(SCRIPT_FILE);
+    return 0;
+}
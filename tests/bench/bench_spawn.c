@@ -0,0 +1,69 @@
+// ============================================
+// 启动延迟基准测试：posix_spawn vs fork + execv
+// ============================================
+// 用法：obj/bench/bench_spawn [次数] [堆大小MB]
+// 说明：
+//   先分配并写满一块堆内存，模拟一个“体积较大”的 Shell 进程，
+//   然后分别用两种启动方式反复启动 /bin/true 并等待其退出，
+//   输出每次启动的平均延迟（微秒）。
+//   堆越大，fork 需要复制的页表越多，两者差距越明显。
+// ============================================
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "launcher.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/wait.h>
+
+// 获取单调时钟（微秒）
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// 用指定方式启动 iterations 次 /bin/true，返回平均延迟（微秒）
+static double run(LaunchMode mode, int iterations) {
+    char *argv[] = {"true", NULL};
+    int fds[3] = {-1, -1, -1};
+
+    launcher_set_mode(mode);
+    double start = now_us();
+    for (int i = 0; i < iterations; i++) {
+        pid_t pid = launch_process("/bin/true", argv, NULL, fds, -1);
+        if (pid < 0) {
+            perror("launch_process");
+            exit(1);
+        }
+        waitpid(pid, NULL, 0);
+    }
+    return (now_us() - start) / iterations;
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 2000;
+    size_t heap_mb = (argc > 2) ? (size_t)atoi(argv[2]) : 256;
+
+    // 写满堆内存，确保页表真正建立
+    char *heap = malloc(heap_mb * 1024 * 1024);
+    if (heap == NULL) {
+        perror("malloc");
+        return 1;
+    }
+    memset(heap, 1, heap_mb * 1024 * 1024);
+
+    printf("bench_spawn: %d launches of /bin/true, %zu MB resident heap\n", iterations, heap_mb);
+
+    double fork_us = run(LAUNCH_FORK, iterations);
+    double spawn_us = run(LAUNCH_SPAWN, iterations);
+
+    printf("  fork + execv : %8.1f us/launch\n", fork_us);
+    printf("  posix_spawn  : %8.1f us/launch\n", spawn_us);
+    printf("  speedup      : %8.2fx\n", fork_us / spawn_us);
+
+    free(heap);
+    return 0;
+}
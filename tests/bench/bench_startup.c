@@ -0,0 +1,114 @@
+// ============================================
+// 启动延迟基准测试
+// ============================================
+// 用法：obj/bench/bench_startup [次数=200] [xshell路径]
+// 说明：
+//   反复启动 xshell 执行一条命令后退出，统计平均每次的耗时（启动到第一条命令完成）：
+//     管道输入：echo 'xecho hi' | xshell
+//     -c 参数： xshell -c 'xecho hi'（旧版本不支持时跳过）
+//   非交互模式不加载/保存历史记录，不显示欢迎信息和提示符，
+//   按块读取输入，不再每行切换两次终端模式。
+//   第二个参数可以指定其他版本的 xshell，方便对比改动前后。
+// ============================================
+
+#define _XOPEN_SOURCE 700                  // realpath, mkdtemp
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+// 获取单调时钟（秒）
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 启动一次 xshell 并等待结束；input 不为 NULL 时通过管道写入标准输入
+// 返回：xshell 的退出码，启动失败返回 -1
+static int run_once(const char *xshell, char *const argv[], const char *input) {
+    int fds[2];
+    if (input != NULL && pipe(fds) < 0) {
+        return -1;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        return -1;
+    }
+    if (pid == 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        if (input != NULL) {
+            dup2(fds[0], STDIN_FILENO);
+            close(fds[0]);
+            close(fds[1]);
+        } else {
+            int null_in = open("/dev/null", O_RDONLY);     // 旧版本不认识 -c 时读到 EOF 立即退出
+            dup2(null_in, STDIN_FILENO);
+        }
+        execv(xshell, argv);
+        _exit(127);
+    }
+    if (input != NULL) {
+        close(fds[0]);
+        ssize_t written = write(fds[1], input, strlen(input));
+        (void)written;
+        close(fds[1]);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+int main(int argc, char *argv[]) {
+    int count = (argc > 1) ? atoi(argv[1]) : 200;
+    const char *xshell = (argc > 2) ? argv[2] : "./xshell";
+
+    if (access(xshell, X_OK) != 0) {
+        fprintf(stderr, "bench_startup: %s not found, run make first\n", xshell);
+        return 1;
+    }
+
+    // 在临时目录中运行，旧版本写出的历史记录和日志不污染当前目录
+    char dir[] = "/tmp/xshell_bench_startup_XXXXXX";
+    char xshell_abs[4096];
+    if (realpath(xshell, xshell_abs) == NULL || mkdtemp(dir) == NULL || chdir(dir) != 0) {
+        perror("bench_startup");
+        return 1;
+    }
+
+    printf("bench_startup: %d runs (%s)\n", count, xshell);
+
+    char *pipe_argv[] = { xshell_abs, NULL };
+    double start = now_sec();
+    for (int i = 0; i < count; i++) {
+        run_once(xshell_abs, pipe_argv, "xecho hi\n");
+    }
+    printf("  echo 'xecho hi' | xshell  %8.1f us/run\n", (now_sec() - start) * 1e6 / count);
+
+    // 旧版本忽略 -c 参数（退出码总是 0），用一条失败的命令检测是否支持
+    char *probe_argv[] = { xshell_abs, "-c", "xcd /nonexistent_dir_12345", NULL };
+    char *c_argv[] = { xshell_abs, "-c", "xecho hi", NULL };
+    if (run_once(xshell_abs, probe_argv, NULL) != 0) {
+        start = now_sec();
+        for (int i = 0; i < count; i++) {
+            run_once(xshell_abs, c_argv, NULL);
+        }
+        printf("  xshell -c 'xecho hi'      %8.1f us/run\n", (now_sec() - start) * 1e6 / count);
+    } else {
+        printf("  xshell -c 'xecho hi'      (not supported)\n");
+    }
+
+    // 清理临时目录
+    unlink(".xshell_history");
+    unlink(".xshell_error");
+    if (chdir("/") == 0) {
+        rmdir(dir);
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+// ============================================
+// 变量查找基准测试
+// ============================================
+// 用法：obj/bench/bench_vars [查找次数]
+// 说明：
+//   环境中放入 64 个变量（与常见的登录环境规模相当），
+//   分别用 getenv()（线性扫描 environ）和 Shell 变量表 vars_get()（哈希查找）
+//   查找一组变量名，其中包括不存在的变量。
+//   另外统计 vars_envp() 在缓存命中时的耗时（每次启动外部命令都会调用）。
+// ============================================
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "vars.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+extern char **environ;
+
+#define FILL_VARS 64
+
+// 查找的变量名（最后一个不存在）
+static const char *g_names[] = { "HOME", "PATH", "USER", "BENCH_VAR_63", "BENCH_VAR_32", "NO_SUCH_VAR" };
+#define NAME_COUNT (int)(sizeof(g_names) / sizeof(g_names[0]))
+
+// 获取单调时钟（秒）
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+    // 补足环境变量数量
+    char name[32];
+    for (int i = 0; i < FILL_VARS; i++) {
+        snprintf(name, sizeof(name), "BENCH_VAR_%d", i);
+        setenv(name, "some value", 1);
+    }
+    int env_count = 0;
+    while (environ[env_count] != NULL) {
+        env_count++;
+    }
+
+    VarTable table;
+    vars_init(&table);
+    vars_import(&table, environ);
+
+    printf("bench_vars: %d variables, %d names x %d\n", env_count, NAME_COUNT, iterations);
+
+    // volatile 累加防止查找被优化掉
+    volatile size_t sink = 0;
+    double start = now_sec();
+    for (int i = 0; i < iterations; i++) {
+        for (int j = 0; j < NAME_COUNT; j++) {
+            sink += (size_t)getenv(g_names[j]);
+        }
+    }
+    double getenv_ns = (now_sec() - start) * 1e9 / ((double)iterations * NAME_COUNT);
+
+    start = now_sec();
+    for (int i = 0; i < iterations; i++) {
+        for (int j = 0; j < NAME_COUNT; j++) {
+            sink += (size_t)vars_get(&table, g_names[j]);
+        }
+    }
+    double table_ns = (now_sec() - start) * 1e9 / ((double)iterations * NAME_COUNT);
+
+    start = now_sec();
+    for (int i = 0; i < iterations; i++) {
+        sink += (size_t)vars_envp(&table);
+    }
+    double envp_ns = (now_sec() - start) * 1e9 / iterations;
+
+    printf("  getenv   %8.1f ns/lookup\n", getenv_ns);
+    printf("  vars_get %8.1f ns/lookup\n", table_ns);
+    printf("  vars_envp (cached) %8.1f ns/call\n", envp_ns);
+
+    vars_destroy(&table);
+    return 0;
+}
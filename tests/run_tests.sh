@@ -73,6 +73,18 @@ assert_success() {
     fi
 }
 
+# 断言：命令执行失败（非交互模式下 xshell 的退出码为最后一条命令的状态）
+assert_failure() {
+    local cmd="$1"
+    local desc="$2"
+    
+    if run_cmd "$cmd" >/dev/null 2>&1; then
+        fail "$desc"
+    else
+        pass "$desc"
+    fi
+}
+
 # 断言：文件存在
 assert_file_exists() {
     local file="$1"
@@ -182,7 +194,7 @@ assert_success "xcd /" "xcd: 切换到根目录"
 assert_success "xcd ~" "xcd: 切换到主目录"
 assert_success "xcd .." "xcd: 切换到上级目录"
 assert_contains "xcd --help" "用法" "xcd: --help"
-assert_contains "xcd /nonexistent_dir_12345" "" "xcd: 不存在目录错误处理"
+assert_failure "xcd /nonexistent_dir_12345" "xcd: 不存在目录错误处理"
 
 # 3. xls
 assert_success "xls" "xls: 列出当前目录"
@@ -225,7 +237,7 @@ echo "line2" >> "$TMPDIR/cat_test.txt"
 assert_contains "xcat $TMPDIR/cat_test.txt" "line1" "xcat: 显示内容"
 assert_contains "xcat -n $TMPDIR/cat_test.txt" "1" "xcat: -n 行号"
 assert_contains "xcat --help" "用法" "xcat: --help"
-assert_contains "xcat /nonexistent_file" "" "xcat: 不存在文件错误"
+assert_failure "xcat /nonexistent_file" "xcat: 不存在文件错误"
 
 # 9. xrm
 run_cmd "xtouch $TMPDIR/rm_test.txt"
@@ -512,6 +524,27 @@ assert_contains "xexport --help" "用法" "xexport: --help"
 assert_success "xexport DELME=1 && xunset DELME" "xunset: 删除变量"
 assert_contains "xunset --help" "用法" "xunset: --help"
 
+# Shell 变量：A=1 只在 Shell 内可见，导出后才传给子进程
+run_cmd "LOCALV=local_only; xecho \$LOCALV > $TMPDIR/var_local.txt; xenv > $TMPDIR/var_env.txt; env > $TMPDIR/var_child.txt" > /dev/null
+assert_file_contains "$TMPDIR/var_local.txt" "^local_only$" "变量: 未导出的变量可以展开"
+if grep -q "^LOCALV=" "$TMPDIR/var_env.txt" "$TMPDIR/var_child.txt"; then
+    fail "变量: 未导出的变量不传给子进程"
+else
+    pass "变量: 未导出的变量不传给子进程"
+fi
+run_cmd "EXPV=shared; xexport EXPV; env > $TMPDIR/var_export.txt; xunset EXPV; env > $TMPDIR/var_unset.txt" > /dev/null
+assert_file_contains "$TMPDIR/var_export.txt" "^EXPV=shared$" "变量: xexport VAR 导出已有变量"
+if grep -q "^EXPV=" "$TMPDIR/var_unset.txt"; then
+    fail "变量: xunset 后子进程看不到"
+else
+    pass "变量: xunset 后子进程看不到"
+fi
+
+# 特殊参数 $?
+run_cmd "xcd /nonexistent_dir_12345; xecho fail=\$? > $TMPDIR/var_status.txt; xecho ok=\${?} >> $TMPDIR/var_status.txt" > /dev/null
+assert_file_contains "$TMPDIR/var_status.txt" "^fail=1$" "变量: \$? 为上一条命令的失败状态"
+assert_file_contains "$TMPDIR/var_status.txt" "^ok=0$" "变量: \$? 为上一条命令的成功状态"
+
 # 49. xalias
 assert_success "xalias" "xalias: 显示别名"
 assert_success "xalias ll='xls -la'" "xalias: 设置别名"
@@ -521,6 +554,18 @@ assert_contains "xalias --help" "用法" "xalias: --help"
 assert_success "xalias test='xpwd' && xunalias test" "xunalias: 删除别名"
 assert_contains "xunalias --help" "用法" "xunalias: --help"
 
+# 别名在执行时展开（第一个单词），可以嵌套，不会循环
+run_cmd $'xalias greet=\'xecho hello\'\ngreet world > '"$TMPDIR"'/alias_run.txt' > /dev/null
+assert_file_contains "$TMPDIR/alias_run.txt" "^hello world$" "别名: 执行时展开"
+run_cmd $'xalias inner=\'xecho nested\' outer=inner\nouter ok > '"$TMPDIR"'/alias_nested.txt' > /dev/null
+assert_file_contains "$TMPDIR/alias_nested.txt" "^nested ok$" "别名: 嵌套展开"
+run_cmd $'xalias xecho=\'xecho loop\'\nxecho once > '"$TMPDIR"'/alias_loop.txt' > /dev/null
+assert_file_contains "$TMPDIR/alias_loop.txt" "^loop once$" "别名: 同名别名只展开一次"
+run_cmd $'xalias greet=\'xecho hello\'\n\\greet; xecho rc=$? > '"$TMPDIR"'/alias_quoted.txt' > /dev/null
+assert_file_contains "$TMPDIR/alias_quoted.txt" "^rc=127$" "别名: 转义的命令名不展开"
+run_cmd $'xalias d=\'xecho now $(xecho sub) `xecho bq`\'\nd > '"$TMPDIR"'/alias_subst.txt' > /dev/null
+assert_file_contains "$TMPDIR/alias_subst.txt" "^now sub bq$" "别名: 值中的命令替换"
+
 # ============================================
 # 八、进程与作业控制测试
 # ============================================
@@ -528,7 +573,7 @@ section "八、进程与作业控制"
 
 # 51. xkill
 assert_contains "xkill --help" "用法" "xkill: --help"
-assert_contains "xkill 99999" "" "xkill: 无效PID错误"
+assert_failure "xkill 99999" "xkill: 无效PID错误"
 
 # 52. xjobs
 assert_success "xjobs" "xjobs: 显示任务"
@@ -548,6 +593,8 @@ section "九、实用工具"
 # 55. xhelp
 assert_contains "xhelp" "XShell" "xhelp: 命令列表"
 assert_contains "xhelp xls" "xls" "xhelp: 指定命令"
+assert_contains "xhelp xgrep" "对应系统命令" "xhelp: 调用命令自身的 --help"
+assert_contains "xhelp" "xhash" "xhelp: 列表来自注册表"
 assert_contains "xhelp --help" "用法" "xhelp: --help"
 
 # 56. xtype
@@ -559,8 +606,19 @@ assert_contains "xtype --help" "用法" "xtype: --help"
 # 57. xwhich
 assert_contains "xwhich ls" "/" "xwhich: 查找路径"
 assert_success "xwhich cat grep" "xwhich: 多命令"
+assert_contains "xwhich xls" "shell builtin" "xwhich: 内置命令"
 assert_contains "xwhich --help" "用法" "xwhich: --help"
 
+# xhash（命令路径缓存）
+assert_contains "ls / > /dev/null && xhash" "/ls" "xhash: 执行后自动缓存"
+assert_contains "xhash cat && xhash -r && xhash" "empty" "xhash: -r 清空缓存"
+assert_contains "xhash cat && xexport PATH=/usr/bin:/bin && xhash" "empty" "xhash: 修改 PATH 后失效"
+mkdir -p "$TEST_DIR/hash1" "$TEST_DIR/hash2"
+printf '#!/bin/sh\necho "ran $0"\n' > "$TEST_DIR/hash1/hashtool"
+chmod +x "$TEST_DIR/hash1/hashtool"
+assert_contains "xexport PATH=$TEST_DIR/hash1:$TEST_DIR/hash2:/usr/bin:/bin && hashtool && xmv $TEST_DIR/hash1/hashtool $TEST_DIR/hash2/hashtool && hashtool" "hash2/hashtool" "xhash: 程序移动后重新查找"
+assert_contains "xhash --help" "用法" "xhash: --help"
+
 # 58. xsleep
 assert_success "xsleep 1" "xsleep: 休眠1秒"
 assert_contains "xsleep --help" "用法" "xsleep: --help"
@@ -580,8 +638,23 @@ assert_contains "xtime --help" "用法" "xtime: --help"
 # 61. xsource
 echo -e "xpwd\nxdate" > "$TMPDIR/script.sh"
 assert_contains "xsource $TMPDIR/script.sh" "/" "xsource: 执行脚本"
-assert_contains "xsource /nonexistent" "" "xsource: 不存在脚本"
+assert_failure "xsource /nonexistent" "xsource: 不存在脚本"
 assert_contains "xsource --help" "用法" "xsource: --help"
+printf 'for i in 1 2\ndo\n  xecho src$i\ndone\n' > "$TMPDIR/multi.xsh"
+assert_contains "xsource $TMPDIR/multi.xsh" "src2" "xsource: 多行 for 循环"
+# 重复执行使用缓存的编译结果；文件修改后重新编译
+OUT=$(run_cmd $'xsource '"$TMPDIR/multi.xsh"$'\nxecho "xecho reloaded" > '"$TMPDIR/multi.xsh"$'\nxsource '"$TMPDIR/multi.xsh" | tr '\n' ' ')
+if [ "$OUT" = "src1 src2 reloaded " ]; then
+    pass "xsource: 修改后重新编译"
+else
+    fail "xsource: 修改后重新编译"
+fi
+printf 'xecho ok\n\nfor ; do\n' > "$TMPDIR/bad.xsh"
+if echo "xsource $TMPDIR/bad.xsh" | $XSHELL 2>&1 | grep -q "bad.xsh:3: parse error"; then
+    pass "xsource: 语法错误报告行号"
+else
+    fail "xsource: 语法错误报告行号"
+fi
 
 # 62. xtec
 assert_contains "xtec --help" "用法" "xtec: --help"
@@ -624,11 +697,38 @@ assert_contains "x2048 --help" "用法" "x2048: --help"
 section "十一、管道操作"
 
 assert_success 'xecho "hello" | xcat' "管道: xecho | xcat"
-assert_contains 'xecho "line1\nline2\nline3" | xwc -l' "3" "管道: xecho | xwc -l"
+assert_contains 'xecho -e "line1\nline2\nline3" | xwc -l' "3" "管道: xecho | xwc -l"
 assert_success "xls /etc | xgrep conf" "管道: xls | xgrep"
 assert_success "xcat /etc/passwd | xhead -5 | xtail -1" "管道: 多重管道"
 assert_success "xps | xgrep -v grep | xhead -5" "管道: 三级管道"
 assert_contains 'xecho "A B C" | xtr " " "\n" | xsort' "A" "管道: xtr | xsort"
+assert_contains 'xecho "spawned" | cat' "spawned" "管道: 内置 | 外部命令"
+assert_contains 'ls /etc | xgrep passwd' "passwd" "管道: 外部 | 内置命令"
+if echo 'xecho "forked" | cat' | XSHELL_LAUNCHER=fork $XSHELL 2>/dev/null | grep -q "forked"; then
+    pass "管道: XSHELL_LAUNCHER=fork 对照路径"
+else
+    fail "管道: XSHELL_LAUNCHER=fork 对照路径"
+fi
+seq 1 20000 | sed 's/^/row,/' > "$TMPDIR/pipe_rows.txt"
+assert_contains "xcat $TMPDIR/pipe_rows.txt | xgrep 7 | xcut -d , -f 2 | xwc -l" "^ *6878$" "管道: 线程阶段大数据量"
+assert_contains "xcat $TMPDIR/pipe_rows.txt | cat | xtail -n 1" "row,20000" "管道: 线程 | 外部 | 线程"
+assert_contains "xcat $TMPDIR/pipe_rows.txt | xhead -n 2 | xwc -l" "^ *2$" "管道: 下游提前结束"
+if printf 'xecho a b | xgrep a | xwc -l\nxecho done\n' | XSHELL_PIPELINE=fork $XSHELL 2>/dev/null | grep -q "^ *1$"; then
+    pass "管道: XSHELL_PIPELINE=fork 对照路径"
+else
+    fail "管道: XSHELL_PIPELINE=fork 对照路径"
+fi
+# xxargs：批量构造参数（内置命令在进程内执行，外部命令用 -P 并行）
+assert_contains 'xecho -e "a\nb\n\nc" | xxargs xecho' "^a b c$" "xxargs: 打包参数、忽略空行"
+assert_contains 'xecho -e "a\nb\nc" | xxargs -n 1 xecho item | xwc -l' "^ *3$" "xxargs: -n 1 逐个执行"
+assert_contains 'seq 1 50 | xxargs -n 10 -P 4 /bin/echo | xwc -w' "^ *50$" "xxargs: -P 并行外部命令"
+if printf 'a b\0c\0' | $XSHELL -c 'xxargs -0 -n 1 /bin/echo' 2>/dev/null | grep -qx "a b"; then
+    pass "xxargs: -0 以 NUL 分隔"
+else
+    fail "xxargs: -0 以 NUL 分隔"
+fi
+assert_contains 'xecho -e "a\nb" | xxargs -n 1 /bin/false; xecho status=$?' "status=123" "xxargs: 命令失败退出码 123"
+assert_contains "xxargs --help" "用法" "xxargs: --help"
 
 # ============================================
 # 十二、重定向测试
@@ -654,16 +754,34 @@ assert_file_contains "$TMPDIR/append.txt" "append2" "重定向 >>: 追加新内
 run_cmd "xcat /nonexistent_12345 2> $TMPDIR/stderr.txt"
 assert_file_exists "$TMPDIR/stderr.txt" "重定向 2>: 创建错误文件"
 
+# 外部命令重定向（由启动器在子进程中 dup2）
+run_cmd "ls /etc > $TMPDIR/ext_redir.txt"
+assert_file_contains "$TMPDIR/ext_redir.txt" "passwd" "重定向 >: 外部命令"
+
 # 输入重定向 <
 echo "input_content" > "$TMPDIR/input.txt"
 assert_contains "xcat < $TMPDIR/input.txt" "input_content" "重定向 <: 输入重定向"
 
+# 内置命令在 Shell 进程内重定向：状态修改保留，之后的输出恢复到终端
+assert_contains "xcd $TMPDIR > $TMPDIR/cd_out.txt && xpwd" "$TMPDIR" "重定向: xcd 带重定向后目录改变"
+assert_contains "xecho hidden > $TMPDIR/restore.txt && xecho visible" "visible" "重定向: 执行后恢复标准输出"
+assert_contains "xwc -l < $TMPDIR/append.txt && xecho next" "next" "重定向 <: 不影响后续命令读取"
+run_cmd "xecho bg_redirect > $TMPDIR/bg_redir.txt &
+xsleep 1"
+assert_file_contains "$TMPDIR/bg_redir.txt" "bg_redirect" "重定向: 后台内置命令"
+
 # ============================================
 # 十三、后台任务测试
 # ============================================
 section "十三、后台任务"
 
 assert_success "xjobs" "后台任务: xjobs 空列表"
+assert_contains "$(printf 'xecho bg | xcat > %s/bg_pipe.txt &\nxsleep 1\nxjobs\nxcat %s/bg_pipe.txt' "$TMPDIR" "$TMPDIR")" "Done.*xecho bg | xcat" "后台任务: 整条管道作为一个作业"
+assert_contains "$(printf 'false | true | sh -c \"exit 3\"\nxecho \"ps=$PIPESTATUS\"')" "ps=1 0 3" "后台任务: PIPESTATUS 记录每个阶段"
+assert_contains "$(printf 'sleep 0 | sleep 0 &\nxsleep 1\nxjobs -l')" "maxrss" "后台任务: xjobs -l 显示资源使用"
+long_pipeline="xecho deep"
+for i in $(seq 120); do long_pipeline="$long_pipeline | xcat"; done
+assert_contains "$long_pipeline" "deep" "后台任务: 超过 100 个阶段的管道"
 # 后台执行需要特殊处理，这里只做基本检查
 skip "后台任务: & 操作符 (需要交互)"
 
@@ -703,6 +821,232 @@ assert_contains "xecho 'hello world'" "hello world" "边界: 单引号字符串"
 assert_success "xpwd && xdate" "边界: && 连接"
 assert_success "xpwd ; xdate" "边界: ; 连接"
 
+# 展开（结果分配在命令行内存池中）
+assert_contains 'xecho f{1..3}.txt' "f1.txt f2.txt f3.txt" "展开: 大括号"
+assert_contains 'xecho {1..10..3} {5..1..2}' "1 4 7 10 5 3 1" "展开: 大括号步长"
+assert_contains 'xecho f{08..10}' "f08 f09 f10" "展开: 大括号补零"
+run_cmd "for i in {1..20000..6}; do xecho \$i > $TMPDIR/for_range.txt; done"
+assert_file_contains "$TMPDIR/for_range.txt" "^19999$" "for: 大括号范围按需生成"
+assert_contains 'xecho $HOME/x ~/y' "$HOME/x $HOME/y" "展开: 变量和波浪号"
+LONG_ARGS=$(printf ' arg%d' $(seq 1 200))
+assert_contains "xecho$LONG_ARGS" "arg1 arg2 .* arg200" "展开: 参数数组增长"
+assert_contains 'for i in a b c; do xecho item_$i; done' "item_c" "展开: for 循环列表"
+run_cmd "for i in 1 2; do for j in a b; do xecho \$i\$j >> $TMPDIR/for_nested.txt; done; done"
+assert_file_contains "$TMPDIR/for_nested.txt" "2b" "for: 嵌套循环"
+run_cmd "for i in x y
+do
+  xecho line_\$i >> $TMPDIR/for_multi.txt
+done"
+assert_file_contains "$TMPDIR/for_multi.txt" "line_y" "for: 多行循环体"
+run_cmd "for i in q; do xecho '\$i' \"v\$i\" | xtr a-z A-Z > $TMPDIR/for_quote.txt; done"
+assert_file_contains "$TMPDIR/for_quote.txt" '^\$I VQ$' "for: 单引号内不替换、循环体含管道"
+# 并行循环：每次迭代的输出成组输出（不交错），退出码为失败的迭代数
+OUT=$(run_cmd 'for -P 3 i in {1..6}; do xecho a$i; xecho b$i; done' | paste -sd' ')
+if [ "$(echo "$OUT" | tr ' ' '\n' | sort | paste -sd' ')" = "a1 a2 a3 a4 a5 a6 b1 b2 b3 b4 b5 b6" ] &&
+   echo "$OUT" | grep -Eq '^(a([1-6]) b\2 ?)+$'; then
+    pass "for -P: 并行执行、输出按迭代成组"
+else
+    fail "for -P: 并行执行、输出按迭代成组"
+fi
+assert_contains 'for -P2 d in /nonexistent_a / /nonexistent_b; do xcd $d; done; xecho failed=$?' "failed=2" "for -P: 汇总退出码"
+# 通配符：排序、隐藏文件、引号内不展开、没有匹配时保留原单词、** 递归
+mkdir -p "$TMPDIR/glob/sub/deep"
+touch "$TMPDIR/glob/b.c" "$TMPDIR/glob/a.c" "$TMPDIR/glob/c.h" "$TMPDIR/glob/.hidden.c" "$TMPDIR/glob/sub/x.c" "$TMPDIR/glob/sub/deep/y.c"
+assert_contains "xecho $TMPDIR/glob/*.c" "glob/a.c $TMPDIR/glob/b.c$" "通配符: * 按字典序、不匹配隐藏文件"
+assert_contains "xecho \"$TMPDIR/glob/*.c\" $TMPDIR/glob/[c]?h" "glob/\\*.c $TMPDIR/glob/c.h$" "通配符: 引号内不展开、[...] 和 ?"
+assert_contains "xecho $TMPDIR/glob/*.none" "glob/\\*.none$" "通配符: 没有匹配时保留原单词"
+assert_contains "xcd $TMPDIR/glob && xecho **/*.c */" "^a.c b.c sub/deep/y.c sub/x.c sub/$" "通配符: ** 递归和 */"
+run_cmd "for f in $TMPDIR/glob/sub/*; do xecho item:\$f >> $TMPDIR/glob_for.txt; done"
+assert_file_contains "$TMPDIR/glob_for.txt" "item:$TMPDIR/glob/sub/x.c" "通配符: for 循环列表"
+# 命令替换：去掉末尾换行、未加引号时分割字段、内置命令/外部命令/子 Shell 三种执行方式
+assert_contains 'xecho [$(xecho a   b)] `xecho c`' "^\[a b\] c$" "命令替换: \$(...) 和反引号"
+assert_contains 'xecho "$(/bin/echo x; /bin/echo y)|" a$(/bin/echo "  b  c  ")d' "^y| a b c d$" "命令替换: 引号内不分割、外部命令"
+assert_contains 'xecho $(xecho a b | xtr a-z A-Z) $(xcd /; xpwd); xpwd' "^A B /$" "命令替换: 内置管道、子 Shell 不改变当前目录"
+assert_contains 'x=$(false); xecho st=$? $(xecho $(xecho nest))' "st=1 nest" "命令替换: 赋值的退出状态、嵌套"
+run_cmd "for f in \$(xecho p q); do xecho sub_\$f >> $TMPDIR/subst_for.txt; done"
+assert_file_contains "$TMPDIR/subst_for.txt" "sub_q" "命令替换: for 循环列表"
+# here-document / here-string：结束标记加引号时不展开、<<- 去掉制表符、大内容写到内存文件
+run_cmd "v=val; xcat <<EOF > $TMPDIR/heredoc.txt
+  \$v \$(xecho sub)
+
+EOF"
+assert_file_contains "$TMPDIR/heredoc.txt" "^  val sub$" "here-document: 展开变量和命令替换、保留行首空白"
+assert_contains "$(printf 'xcat <<'"'"'E'"'"' | xtr a-z A-Z\n$v x\nE')" '^\$V X$' "here-document: 引号中的结束标记、管道"
+assert_contains "$(printf 'xcat <<-E\n\t\tabc\n\tE')" '^abc$' "here-document: <<- 去掉行首制表符"
+assert_contains 'v=1; xcat <<< "s $v"; xwc -l <<<$(xecho a)' "^s 1$" "here-string: 展开并加上换行"
+BIG_HEREDOC="xwc -l <<EOF
+$(seq 1 20000)
+EOF"
+assert_contains "$BIG_HEREDOC" "20000" "here-document: 大内容（内存文件）"
+LONG_HEREDOC="xwc -c <<EOF
+$(head -c 10000 /dev/zero | tr '\0' a)
+EOF"
+assert_contains "$LONG_HEREDOC" "10001" "here-document: 超过 4096 字节的行"
+
+# 语法：整行一次解析（引号内的操作符不分割命令）
+run_cmd "xecho 'a && b; c | d' > $TMPDIR/syn_quote.txt"
+assert_file_contains "$TMPDIR/syn_quote.txt" "a && b; c | d" "语法: 引号内的 && ; |"
+run_cmd "xecho one > $TMPDIR/syn_seq.txt ; xecho two >> $TMPDIR/syn_seq.txt"
+assert_file_contains "$TMPDIR/syn_seq.txt" "two" "语法: ; 顺序执行"
+run_cmd "xcd /nonexistent_dir_12345 && xecho no > $TMPDIR/syn_and.txt || xecho yes > $TMPDIR/syn_or.txt"
+assert_file_not_exists "$TMPDIR/syn_and.txt" "语法: && 失败后跳过"
+assert_file_contains "$TMPDIR/syn_or.txt" "yes" "语法: || 失败后执行"
+run_cmd "xecho ok || xecho no > $TMPDIR/syn_skip.txt && xecho and > $TMPDIR/syn_and2.txt"
+assert_file_not_exists "$TMPDIR/syn_skip.txt" "语法: || 成功后跳过"
+assert_file_contains "$TMPDIR/syn_and2.txt" "and" "语法: && 看最后执行的命令"
+run_cmd "xecho '\$HOME' a\\ b \"x\\\"y\" > $TMPDIR/syn_escape.txt"
+assert_file_contains "$TMPDIR/syn_escape.txt" '^\$HOME a b x"y$' "语法: 单引号不展开、反斜杠转义"
+run_cmd "xcat /nonexistent_12345 2>> $TMPDIR/syn_err.txt ; xcat /nonexistent_12345 2>> $TMPDIR/syn_err.txt"
+if [ "$(wc -l < "$TMPDIR/syn_err.txt")" -ge 2 ]; then
+    pass "语法: 2>> 追加错误输出"
+else
+    fail "语法: 2>> 追加错误输出"
+fi
+run_cmd "> $TMPDIR/syn_empty.txt"
+assert_file_exists "$TMPDIR/syn_empty.txt" "语法: 只有重定向时创建文件"
+run_cmd 'xecho "unterminated' > /dev/null
+if [ $? -eq 2 ]; then
+    pass "语法: 引号未闭合不崩溃"
+else
+    fail "语法: 引号未闭合不崩溃"
+fi
+
+# ============================================
+# 十六、非交互模式
+# ============================================
+section "十六、非交互模式"
+
+# 管道输入：不显示欢迎信息和提示符
+OUT=$(echo "xecho quiet" | $XSHELL 2>/dev/null)
+if [ "$OUT" = "quiet" ]; then
+    pass "非交互: 管道输入只有命令输出"
+else
+    fail "非交互: 管道输入只有命令输出"
+fi
+
+# -c：执行一条命令行，退出码为最后一条命令的状态
+OUT=$($XSHELL -c 'xecho one; xecho two' 2>/dev/null | tr '\n' ' ')
+if [ "$OUT" = "one two " ]; then
+    pass "非交互: -c 执行命令行"
+else
+    fail "非交互: -c 执行命令行"
+fi
+$XSHELL -c 'xcd /nonexistent_dir_12345' 2>/dev/null
+if [ $? -ne 0 ]; then
+    pass "非交互: -c 退出码"
+else
+    fail "非交互: -c 退出码"
+fi
+$XSHELL -c 'xecho "' 2>/dev/null
+if [ $? -eq 2 ]; then
+    pass "非交互: 语法错误退出码为 2"
+else
+    fail "非交互: 语法错误退出码为 2"
+fi
+
+# 脚本文件：支持多行 for 循环
+printf 'for i in 1 2\ndo\n  xecho item$i\ndone\nxecho end\n' > "$TMPDIR/script.xsh"
+OUT=$($XSHELL "$TMPDIR/script.xsh" 2>/dev/null | tr '\n' ' ')
+if [ "$OUT" = "item1 item2 end " ]; then
+    pass "非交互: 执行脚本文件"
+else
+    fail "非交互: 执行脚本文件"
+fi
+$XSHELL /nonexistent_script_12345.xsh 2>/dev/null
+if [ $? -eq 127 ]; then
+    pass "非交互: 脚本不存在返回 127"
+else
+    fail "非交互: 脚本不存在返回 127"
+fi
+
+# 超过 4096 字节的行不截断、不丢弃
+LONG_WORD=$(head -c 10000 /dev/zero | tr '\0' a)
+printf 'xecho %s | xwc -c\n' "$LONG_WORD" > "$TMPDIR/long_line.xsh"
+OUT=$($XSHELL "$TMPDIR/long_line.xsh" 2>/dev/null | tr -d ' ')
+if [ "$OUT" = "10001" ]; then
+    pass "非交互: 长行完整读取"
+else
+    fail "非交互: 长行完整读取"
+fi
+
+# -s：强制从标准输入读取；非交互模式不写历史记录（历史文件在启动目录下）
+HIST_DIR="$TMPDIR/hist_dir"
+mkdir -p "$HIST_DIR"
+XSHELL_ABS="$(pwd)/xshell"
+(cd "$HIST_DIR" && echo "xecho no_history" | "$XSHELL_ABS" -s > /dev/null 2>&1)
+assert_file_not_exists "$HIST_DIR/.xshell_history" "非交互: 不写历史记录"
+
+# 交互模式（用 script 提供终端）：命令执行完追加到历史文件，带开始时间、耗时和退出状态
+if command -v script > /dev/null 2>&1; then
+    printf 'one\ntwo\n' > "$HIST_DIR/.xshell_history"
+    (cd "$HIST_DIR" && (sleep 0.5; printf 'xecho hi\r'; sleep 0.3; printf 'quit\r') |
+        timeout 5 script -qc "$XSHELL_ABS" /dev/null > /dev/null 2>&1)
+    if [ "$(head -2 "$HIST_DIR/.xshell_history" | tr '\n' ' ')" = "one two " ] &&
+       grep -qE '^: [0-9]+:[0-9]+:0;xecho hi$' "$HIST_DIR/.xshell_history"; then
+        pass "交互: 命令追加到历史文件"
+    else
+        fail "交互: 命令追加到历史文件"
+    fi
+
+    # 文件超过 XHISTFILESIZE 行时压缩为最新的 XHISTSIZE 条
+    printf 'one\ntwo\nthree\nfour\nfive\n' > "$HIST_DIR/.xshell_history"
+    (cd "$HIST_DIR" && (sleep 0.5; printf 'xecho hi\r'; sleep 0.3; printf 'quit\r') |
+        XHISTSIZE=3 timeout 5 script -qc "$XSHELL_ABS" /dev/null > /dev/null 2>&1)
+    if [ "$(sed 's/^: [0-9]*:[0-9]*:-\{0,1\}[0-9]*;//' "$HIST_DIR/.xshell_history" | tr '\n' ' ')" = "five xecho hi quit " ]; then
+        pass "交互: XHISTSIZE 限制历史条数"
+    else
+        fail "交互: XHISTSIZE 限制历史条数"
+    fi
+
+    # Ctrl+R 反向搜索：再按 Ctrl+R 跳到更旧的匹配
+    rm -f "$HIST_DIR/.xshell_history"
+    OUT=$(cd "$HIST_DIR" && (sleep 0.5; printf 'xecho first\r'; sleep 0.2; printf 'xecho second\r'; sleep 0.2
+        printf '\022xecho\022'; sleep 0.2; printf '\r'; sleep 0.1; printf '\r'; sleep 0.3; printf 'quit\r') |
+        timeout 5 script -qc "$XSHELL_ABS" /dev/null 2>&1)
+    if [ "$(printf '%s' "$OUT" | tr -d '\r' | grep -c '^first$')" = "2" ]; then
+        pass "交互: Ctrl+R 循环查找更旧的匹配"
+    else
+        fail "交互: Ctrl+R 循环查找更旧的匹配"
+    fi
+
+    # 行内建议：输入前缀后按右箭头接受得分最高的历史命令
+    OUT=$(cd "$HIST_DIR" && (sleep 0.5; printf 'xecho suggested line\r'; sleep 0.2; printf 'xecho sug'; sleep 0.2
+        printf '\033[C\r'; sleep 0.3; printf 'quit\r') | timeout 5 script -qc "$XSHELL_ABS" /dev/null 2>&1)
+    if [ "$(printf '%s' "$OUT" | tr -d '\r' | grep -c '^suggested line$')" = "2" ]; then
+        pass "交互: 右箭头接受行内建议"
+    else
+        fail "交互: 右箭头接受行内建议"
+    fi
+
+    # xcd -z：跳转到去过的、匹配关键字的目录
+    mkdir -p "$HIST_DIR/work/myproject"
+    OUT=$(cd "$HIST_DIR" && (sleep 0.5; printf 'xcd work/myproject\r'; sleep 0.2; printf 'xcd /\r'; sleep 0.2
+        printf 'xcd -z proj\r'; sleep 0.2; printf 'xpwd\r'; sleep 0.3; printf 'quit\r') |
+        timeout 5 script -qc "$XSHELL_ABS" /dev/null 2>&1)
+    if printf '%s' "$OUT" | tr -d '\r' | grep -q "^$HIST_DIR/work/myproject\$" &&
+       grep -q "work/myproject" "$HIST_DIR/.xshell_dirs"; then
+        pass "交互: xcd -z 按关键字跳转目录"
+    else
+        fail "交互: xcd -z 按关键字跳转目录"
+    fi
+
+    # 行编辑：UTF-8 字符按整个字符左移、删除；光标在行中间按回车执行整行
+    OUT=$(cd "$HIST_DIR" && (sleep 0.5; printf 'xecho 中文字符'; sleep 0.2; printf '\033[D\033[D\177\001\r'
+        sleep 0.3; printf 'quit\r') | timeout 5 script -qc "$XSHELL_ABS" /dev/null 2>&1)
+    if printf '%s' "$OUT" | tr -d '\r' | grep -q '^中字符$'; then
+        pass "交互: 编辑含中文的命令行"
+    else
+        fail "交互: 编辑含中文的命令行"
+    fi
+else
+    skip "交互: 命令追加到历史文件 (没有 script 命令)"
+    skip "交互: 右箭头接受行内建议 (没有 script 命令)"
+    skip "交互: xcd -z 按关键字跳转目录 (没有 script 命令)"
+    skip "交互: Ctrl+R 循环查找更旧的匹配 (没有 script 命令)"
+    skip "交互: XHISTSIZE 限制历史条数 (没有 script 命令)"
+    skip "交互: 编辑含中文的命令行 (没有 script 命令)"
+fi
+
 # ============================================
 # 测试结果汇总
 # ============================================